@@ -4,24 +4,24 @@ layout(location = 0) out vec4 FragColor;
 
 layout(location = 0) in vec2 vTexCoords;
 
-vec4 poissonBlur(sampler2D image, vec2 uv, uvec2 resolution, float radius) {
-    // Poisson disk offsets  precomputed sample pattern
-    vec2 poissonDisk[16] = vec2[](
-        vec2(-0.94201624, -0.39906216), vec2(0.94558609, -0.76890725),
-        vec2(-0.094184101, -0.92938870), vec2(0.34495938, 0.29387760),
-        vec2(-0.91588581, 0.45771432), vec2(-0.81544232, -0.87912464),
-        vec2(-0.38277543, 0.27676845), vec2(0.97484398, 0.75648379),
-        vec2(0.44323325, -0.97511554), vec2(0.53742981, -0.47373420),
-        vec2(-0.26496911, -0.41893023), vec2(0.79197514, 0.19090188),
-        vec2(-0.24188840, 0.99706507), vec2(-0.81409955, 0.91437590),
-        vec2(0.19984126, 0.78641367), vec2(0.14383161, -0.14100790)
-    );
+// Poisson disk offsets, shared by the blur and the shadow filter
+const vec2 sPoissonDisk[16] = vec2[](
+    vec2(-0.94201624, -0.39906216), vec2(0.94558609, -0.76890725),
+    vec2(-0.094184101, -0.92938870), vec2(0.34495938, 0.29387760),
+    vec2(-0.91588581, 0.45771432), vec2(-0.81544232, -0.87912464),
+    vec2(-0.38277543, 0.27676845), vec2(0.97484398, 0.75648379),
+    vec2(0.44323325, -0.97511554), vec2(0.53742981, -0.47373420),
+    vec2(-0.26496911, -0.41893023), vec2(0.79197514, 0.19090188),
+    vec2(-0.24188840, 0.99706507), vec2(-0.81409955, 0.91437590),
+    vec2(0.19984126, 0.78641367), vec2(0.14383161, -0.14100790)
+);
 
+vec4 poissonBlur(sampler2D image, vec2 uv, uvec2 resolution, float radius) {
     vec4 color = vec4(0.0);
     float total = 0.0;
 
     for (int i = 0; i < 16; i++) {
-        vec2 offset = poissonDisk[i] * radius / vec2(resolution);
+        vec2 offset = sPoissonDisk[i] * radius / vec2(resolution);
         color += texture(image, uv + offset);
         total += 1.0;
     }
@@ -29,23 +29,58 @@ vec4 poissonBlur(sampler2D image, vec2 uv, uvec2 resolution, float radius) {
     return color / total;
 }
 
-float CalcShadow(in vec3 position, float LdotN, uint idx)
+// Left and right handed views alike, the depth grows away from the camera
+float GetViewDepth(in vec3 position)
+{
+    float Forward = uCamera.Projection[2][3] < 0.0 ? -1.0 : 1.0;
+    return Forward * (uCamera.View * vec4(position, 1.0)).z;
+}
+
+float CalcShadow(in vec3 position, in vec3 normal, float LdotN, uint lightIdx)
 {
-    const float bias = 0.01;
+    const float bias = 0.0005;
+
+    if(uShadows.CascadeCount == 0)
+        return 1.0;
+
+    float ViewDepth = GetViewDepth(position);
+
+    uint CascadeIdx = 0;
 
-    vec4 orthoPosition = uDepthCameras[idx].Projection * uDepthCameras[idx].View * vec4(position, 1.0);
+    while(CascadeIdx < uShadows.CascadeCount && ViewDepth > uShadows.Cascades[CascadeIdx].x)
+        CascadeIdx++;
 
-    vec2 texCoord = (orthoPosition.xy + vec2(1.0)) * 0.5;
+    // Past the shadow distance
+    if(CascadeIdx == uShadows.CascadeCount)
+        return 1.0;
 
-    //float occlusionDepth = texture(uDepthMap[idx], texCoord).r;
+    // Pushing the lookup along the normal by a texel or so hides the acne
+    vec3 OffsetPosition = position + normal * 1.5 * uShadows.Cascades[CascadeIdx].y;
 
-    float occlusionDepth = poissonBlur(uDepthMap[idx], texCoord, uvec2(2048, 2048), 1.0).r;
+    Camera DepthCamera = uDepthCameras[lightIdx * uShadows.CascadeCount + CascadeIdx];
+    vec4 orthoPosition = DepthCamera.Projection * DepthCamera.View * vec4(OffsetPosition, 1.0);
 
-    // No blurring yet
-    if(orthoPosition.z > occlusionDepth + bias * (1.1 - LdotN))
-        return 0.0;
+    vec2 TileScale = vec2(uShadows.TileResolution) / vec2(uShadows.AtlasResolution);
+    vec2 TileOrigin = vec2(CascadeIdx, lightIdx) * TileScale;
+    vec2 TexelSize = 1.0 / vec2(uShadows.AtlasResolution);
 
-    return 1.0;
+    vec2 texCoord = TileOrigin + (orthoPosition.xy * 0.5 + 0.5) * TileScale;
+
+    // The filter must not bleed into the neighbouring tiles
+    vec2 TileMin = TileOrigin + 0.5 * TexelSize;
+    vec2 TileMax = TileOrigin + TileScale - 0.5 * TexelSize;
+
+    float Lit = 0.0;
+
+    for(int i = 0; i < 16; i++)
+    {
+        vec2 SampleCoord = clamp(texCoord + sPoissonDisk[i] * TexelSize, TileMin, TileMax);
+        float occlusionDepth = texture(uShadowAtlas, SampleCoord).r;
+
+        Lit += orthoPosition.z > occlusionDepth + bias * (1.1 - LdotN) ? 0.0 : 1.0;
+    }
+
+    return Lit / 16.0;
 }
 
 vec3 GetCameraPosition()
@@ -58,6 +93,27 @@ vec3 GetCameraPosition()
     return -(uCamera.View[3].x * a + uCamera.View[3].y * b + uCamera.View[3].z * c);
 }
 
+uint GetClusterIndex(in vec3 position)
+{
+    float Depth = GetViewDepth(position);
+
+    float SliceScale = float(uClusters.GridSize.z) / log(uClusters.Far / uClusters.Near);
+    uint Slice = uint(clamp(log(max(Depth, 1e-4) / uClusters.Near) * SliceScale, 0.0, float(uClusters.GridSize.z - 1)));
+
+    uvec2 Tile = min(uvec2(gl_FragCoord.xy) / uClusters.TileSize, uClusters.GridSize.xy - 1);
+
+    return (Slice * uClusters.GridSize.y + Tile.y) * uClusters.GridSize.x + Tile.x;
+}
+
+// Fades the light out towards its culling radius instead of cutting it off
+float RangeWindow(float distance, float radius)
+{
+    float Ratio = distance / radius;
+    float Window = clamp(1.0 - Ratio * Ratio * Ratio * Ratio, 0.0, 1.0);
+
+    return Window * Window;
+}
+
 void main()
 {
     vec4 PositionValue = texture(uPositions, vTexCoords);
@@ -67,6 +123,10 @@ void main()
     vec4 BitangentValue = texture(uBitangents, vTexCoords);
 
     uvec3 RenderableMetaData = uvec3(PositionValue.w + 0.5, NormalValue.w + 0.5, TexCoordValue.w + 0.5);
+
+    // The tile may be shared with other materials
+    if(RenderableMetaData.y != pMaterialRef)
+        discard;
     vec3 Position = PositionValue.xyz;
     vec3 Normal = normalize(NormalValue.xyz);
     vec3 Tangent = normalize(TangentValue.xyz);
@@ -85,19 +145,30 @@ void main()
     {
         bsdfInput.LightDir = -normalize(sDirectionalLights[i].Direction);
         float LdotN = dot(bsdfInput.LightDir, bsdfInput.Normal);
-        FragColor.xyz += Evaluate(bsdfInput) * CalcShadow(Position, LdotN, i);
+        FragColor.xyz += Evaluate(bsdfInput) * CalcShadow(Position, Normal, LdotN, i);
         //FragColor.xyz = normalize(GetCameraPosition() - Position.xyz);
     }
 
-    for(uint i = 0; i < pPointLightCount; i++)
+    // Only the lights binned into this pixel's cluster can reach it
+    uint ClusterIdx = GetClusterIndex(Position);
+    uint ClusterLightCount = sClusterLightCounts[ClusterIdx];
+    uint SlotBase = ClusterIdx * uClusters.GridSize.w;
+
+    for(uint i = 0; i < ClusterLightCount; i++)
     {
-        vec3 LightDisplace = sPointLights[i].Position - Position.xyz;
+        PointLightSrc LightSrc = sPointLights[sClusterLightIndices[SlotBase + i]];
 
-        bsdfInput.LightDir = -normalize(LightDisplace);
+        vec3 LightDisplace = LightSrc.Position - Position.xyz;
 
         float Distance = length(LightDisplace);
-        float Attenuation = Distance * (Distance * sPointLights[i].DropRate.x + sPointLights[i].DropRate.y);
 
-        FragColor.xyz += Evaluate(bsdfInput) / Attenuation;
+        if(Distance >= LightSrc.Radius)
+            continue;
+
+        bsdfInput.LightDir = -normalize(LightDisplace);
+
+        float Attenuation = Distance * (Distance * LightSrc.DropRate.x + LightSrc.DropRate.y);
+
+        FragColor.xyz += Evaluate(bsdfInput) * RangeWindow(Distance, LightSrc.Radius) / Attenuation;
     }
 }
@@ -26,6 +26,9 @@ layout (location = 3) out vec4 oBitangent;
 layout (location = 4) out vec3 oTexCoords;
 layout (location = 5) out vec3 oMetaData;
 
+// Has to match the depth prepass bit for bit, the depth is tested for equality
+invariant gl_Position;
+
 void main()
 {
 	uint ModelIdx = uint(iMetaData.r + 0.5);
@@ -19,7 +19,9 @@ struct PointLightSrc
 {
     vec3 Position;
     vec3 Intensity;
+    vec3 Color;
     vec2 DropRate;
+    float Radius;
 };
 
 struct BSDFInput
@@ -43,7 +45,8 @@ layout(set = 0, binding = 2) uniform sampler2D uTexCoords;
 layout(set = 0, binding = 3) uniform sampler2D uTangents;
 layout(set = 0, binding = 4) uniform sampler2D uBitangents;
 
-layout(set = 0, binding = 5) uniform sampler2D uDepthMap[MAX_DEPTH_ARRAY];
+// Cascades along the x axis, directional lights along the y axis
+layout(set = 0, binding = 5) uniform sampler2D uShadowAtlas;
 
 layout(std430, set = 1, binding = 0) readonly buffer DirectionalLights
 {
@@ -55,6 +58,7 @@ layout(std430, set = 1, binding = 1) readonly buffer PointLights
     PointLightSrc sPointLights[];
 };
 
+// One per atlas tile, i.e. light index * cascade count + cascade index
 layout(std430, set = 1, binding = 2) readonly buffer DepthCameras
 {
     Camera uDepthCameras[];
@@ -65,6 +69,34 @@ layout(std140, set = 1, binding = 3) uniform CameraUniform
     Camera uCamera;
 };
 
+// Point lights binned into view space clusters by the light culling pass
+layout(std140, set = 1, binding = 4) uniform LightClusterUniform
+{
+    uvec4 GridSize; // xyz: cluster count, w: light slots per cluster
+    uvec2 TileSize;
+    float Near;
+    float Far;
+    uvec2 Resolution;
+} uClusters;
+
+layout(std430, set = 1, binding = 5) readonly buffer ClusterLightCounts
+{
+    uint sClusterLightCounts[];
+};
+
+layout(std430, set = 1, binding = 6) readonly buffer ClusterLightIndices
+{
+    uint sClusterLightIndices[];
+};
+
+layout(std140, set = 1, binding = 7) uniform ShadowAtlasUniform
+{
+    vec4 Cascades[MAX_SHADOW_CASCADES]; // x: far end in view depth, y: world size of a texel
+    uvec2 TileResolution;
+    uvec2 AtlasResolution;
+    uint CascadeCount;
+} uShadows;
+
 
 /* Declaration of shader parameters
 * Example:
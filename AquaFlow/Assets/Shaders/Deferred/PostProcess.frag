@@ -5,7 +5,22 @@ layout(location = 0) in vec2 vTexCoords;
 
 layout(set = 0, binding = 0) uniform sampler2D uTexture;
 
+// Adapted by the auto exposure pass, zero when it's turned off
+layout(std430, set = 0, binding = 1) readonly buffer ExposureState
+{
+	float sExposure;
+	float sAdaptedLuminance;
+};
+
+vec3 ToneMap(in vec3 color, float exposure)
+{
+	return vec3(1.0) - exp(-color * exposure);
+}
+
 void main()
 {
 	FragColor = texture(uTexture, vTexCoords);
+
+	if (sExposure > 0.0)
+		FragColor.rgb = ToneMap(FragColor.rgb, sExposure);
 }
@@ -0,0 +1,30 @@
+#version 440 core
+
+// The position stream of the shadow pass, seen through the main camera
+layout(location = 0) in vec4 iPosition;
+layout(location = 1) in vec4 iMatMeshID;
+
+layout(set = 0, binding = 0) uniform CameraInfo
+{
+	mat4 uProjection;
+	mat4 uView;
+};
+
+layout(std430, set = 0, binding = 1) buffer ModelMatrices
+{
+	mat4 sModels[];
+};
+
+// The geometry buffer tests for equal depths, so the transform is the same as in Defer.vert
+invariant gl_Position;
+
+void main()
+{
+	uint ModelIdx = uint(iMatMeshID.r + 0.5);
+
+	mat4 Model = sModels[ModelIdx];
+
+	vec4 VertexPos = Model * iPosition;
+
+	gl_Position = uProjection * uView * VertexPos;
+}
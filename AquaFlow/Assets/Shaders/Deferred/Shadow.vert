@@ -11,7 +11,8 @@ struct CameraInfo
 
 layout(push_constant) uniform ShaderConstants
 {
-	uint pLightSrcIdx;
+	// Atlas tile being drawn, i.e. light index * cascade count + cascade index
+	uint pCascadeIdx;
 };
 
 layout(set = 0, binding = 0) readonly buffer CameraInfoBuffer
@@ -34,5 +35,9 @@ void main()
 	InvertY[1][1] = -1.0;
 
 	vec4 VertexPos = Model * iPosition;
-	gl_Position = sCameraInfos[pLightSrcIdx].Projection * sCameraInfos[pLightSrcIdx].View * VertexPos;
+	gl_Position = sCameraInfos[pCascadeIdx].Projection * sCameraInfos[pCascadeIdx].View * VertexPos;
+
+	// Casters between the light and the near plane still throw shadows, they're flattened onto it
+	// The cascades are orthographic, so w is one and the clamp is exact
+	gl_Position.z = max(gl_Position.z, 0.0);
 }
@@ -2,6 +2,22 @@ import DiffuseBSDF
 
 layout(set = 2, binding = 0) uniform sampler2D uTexture;
 
+// Lets the back end sample the lights directly
+#define MATERIAL_EVALUATES_DIRECTION
+
+vec3 GetBaseColor(in CollisionInfo collisionInfo)
+{
+	return texture(uTexture, GetSurfaceFrame(collisionInfo).TexCoords).rgb;
+}
+
+vec3 EvaluateDirection(in Ray ray, in CollisionInfo collisionInfo, in vec3 direction)
+{
+	if (dot(collisionInfo.Normal, direction) <= 0.0)
+		return vec3(0.0);
+
+	return LambertianBRDF(collisionInfo.Normal, direction, GetBaseColor(collisionInfo));
+}
+
 SampleInfo Evaluate(in Ray ray, in CollisionInfo collisionInfo)
 {
 	DiffuseBSDF_Input diffuseInput;
@@ -9,11 +25,7 @@ SampleInfo Evaluate(in Ray ray, in CollisionInfo collisionInfo)
 	diffuseInput.Normal = collisionInfo.Normal;
 	diffuseInput.BaseColor = vec3(0.6, 0.6, 0.6);
 
-	Face face = sFaces[collisionInfo.PrimitiveID];
-
-	vec2 tex = GetTexCoords(face, collisionInfo);
-
-	diffuseInput.BaseColor = texture(uTexture, tex).rgb;
+	diffuseInput.BaseColor = GetBaseColor(collisionInfo);
 	//diffuseInput.BaseColor = vec3(0.6);
 
 	SampleInfo sampleInfo = SampleDiffuseBSDF(diffuseInput);
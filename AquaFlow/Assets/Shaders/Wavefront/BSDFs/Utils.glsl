@@ -1,6 +1,8 @@
 #ifndef UTILS_GLSL
 #define UTILS_GLSL
 
+// Barycentric weights of the hits: r -> Indices.x, g -> Indices.y, b -> Indices.z
+
 vec2 GetTexCoords(in Face face, in CollisionInfo collisionInfo)
 {
 	vec2 t1 = sTexCoords[face.Indices.r];
@@ -12,4 +14,95 @@ vec2 GetTexCoords(in Face face, in CollisionInfo collisionInfo)
 		+ t3 * collisionInfo.bCoords.b;
 }
 
-#endif
\ No newline at end of file
+// Not normalized, zero when the mesh came without normals
+vec3 InterpolateNormal(in Face face, in CollisionInfo collisionInfo)
+{
+	return sNormals[face.Indices.r] * collisionInfo.bCoords.r
+		+ sNormals[face.Indices.g] * collisionInfo.bCoords.g
+		+ sNormals[face.Indices.b] * collisionInfo.bCoords.b;
+}
+
+vec4 InterpolateTangent(in Face face, in CollisionInfo collisionInfo)
+{
+	return sTangents[face.Indices.r] * collisionInfo.bCoords.r
+		+ sTangents[face.Indices.g] * collisionInfo.bCoords.g
+		+ sTangents[face.Indices.b] * collisionInfo.bCoords.b;
+}
+
+// Shading frame of a hit, reconstructed from the primitive and the barycentrics
+// Normal faces the incoming ray just like collisionInfo.Normal does
+struct SurfaceFrame
+{
+	vec3 Normal;
+	vec3 Tangent;
+	vec3 Bitangent;
+	vec2 TexCoords;
+};
+
+SurfaceFrame GetSurfaceFrame(in CollisionInfo collisionInfo)
+{
+	Face face = sFaces[collisionInfo.PrimitiveID];
+
+	SurfaceFrame frame;
+	frame.TexCoords = GetTexCoords(face, collisionInfo);
+	frame.Normal = collisionInfo.Normal;
+
+#if MOTION_BLUR
+	// Vertex attributes of the moving meshes are in object space
+	bool Moving = face.InstanceIndex != 0xffffffffu && sInstanceMotions[face.InstanceIndex].Moving != 0;
+
+	MotionFrame motionFrame;
+
+	if (Moving)
+		motionFrame = GetMotionFrame(sInstanceMotions[face.InstanceIndex], collisionInfo.Time);
+#endif
+
+#if SMOOTH_SHADING
+	vec3 Normal = InterpolateNormal(face, collisionInfo);
+
+#if MOTION_BLUR
+	if (Moving && dot(Normal, Normal) > SHADING_TOLERANCE * SHADING_TOLERANCE)
+		Normal = NormalToWorld(Normal, motionFrame);
+#endif
+
+	// Vertex normals point outwards, the geometric one is flipped towards the ray
+	if (dot(Normal, Normal) > SHADING_TOLERANCE * SHADING_TOLERANCE)
+		frame.Normal = normalize(Normal) * sign(dot(Normal, collisionInfo.Normal) + SHADING_TOLERANCE);
+#endif
+
+	vec4 Tangent = InterpolateTangent(face, collisionInfo);
+
+#if MOTION_BLUR
+	if (Moving)
+		Tangent.xyz = DirectionToWorld(Tangent.xyz, motionFrame);
+#endif
+
+	// Gram-Schmidt against the shading normal, or any frame when the mesh has no tangents
+	vec3 Orthogonal = Tangent.xyz - frame.Normal * dot(frame.Normal, Tangent.xyz);
+
+	if (dot(Orthogonal, Orthogonal) > SHADING_TOLERANCE * SHADING_TOLERANCE)
+	{
+		frame.Tangent = normalize(Orthogonal);
+		frame.Bitangent = cross(frame.Normal, frame.Tangent) * (Tangent.w < 0.0 ? -1.0 : 1.0);
+	}
+	else
+	{
+		frame.Tangent = abs(frame.Normal.x) > abs(frame.Normal.z) ?
+			normalize(vec3(frame.Normal.z, 0.0, -frame.Normal.x)) :
+			normalize(vec3(0.0, -frame.Normal.z, frame.Normal.y));
+
+		frame.Bitangent = cross(frame.Normal, frame.Tangent);
+	}
+
+	return frame;
+}
+
+// Takes a tangent space normal map texel as stored in the texture, i.e. in [0, 1]
+vec3 ApplyNormalMap(in SurfaceFrame frame, in vec3 texel)
+{
+	vec3 Mapped = texel * 2.0 - 1.0;
+
+	return normalize(mat3(frame.Tangent, frame.Bitangent, frame.Normal) * Mapped);
+}
+
+#endif
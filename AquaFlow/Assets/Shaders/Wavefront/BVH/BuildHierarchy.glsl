@@ -0,0 +1,129 @@
+#version 440
+
+layout(local_size_x = WORKGROUP_SIZE) in;
+
+#include "LBVHCommon.glsl"
+
+// Karras, "Maximizing Parallelism in the Construction of BVHs, Octrees, and k-d Trees"
+// Every internal node finds its range and split from the sorted morton codes alone
+
+uint SortedCode(int idx)
+{
+	return sMortonRefs[pSortedBuffer * pFaceCount + uint(idx)].Code;
+}
+
+int CountLeadingZeros(uint value)
+{
+	return value == 0 ? 32 : 31 - findMSB(value);
+}
+
+// Length of the common prefix, duplicate codes fall back to their indices
+int Delta(int i, int j)
+{
+	if (j < 0 || j >= int(pFaceCount))
+		return -1;
+
+	uint codeI = SortedCode(i);
+	uint codeJ = SortedCode(j);
+
+	if (codeI == codeJ)
+		return 32 + CountLeadingZeros(uint(i) ^ uint(j));
+
+	return CountLeadingZeros(codeI ^ codeJ);
+}
+
+void WriteLeaf(uint leafIdx)
+{
+	uint FaceIdx = sMortonRefs[pSortedBuffer * pFaceCount + leafIdx].FaceIdx;
+	Face face = sInputFaces[FaceIdx];
+
+	sFaces[pFaceOffset + leafIdx] = face;
+
+	vec3 A = sPositions[face.Indices.x];
+	vec3 B = sPositions[face.Indices.y];
+	vec3 C = sPositions[face.Indices.z];
+
+	uint NodeIdx = InternalNodeCount() + leafIdx;
+
+	sNodes[pNodeOffset + NodeIdx].MinBound = min(A, min(B, C)) - vec3(TOLERANCE);
+	sNodes[pNodeOffset + NodeIdx].MaxBound = max(A, max(B, C)) + vec3(TOLERANCE);
+
+	sNodes[pNodeOffset + NodeIdx].BeginIndex = pFaceOffset + leafIdx;
+	sNodes[pNodeOffset + NodeIdx].EndIndex = pFaceOffset + leafIdx + 1;
+
+	// The leaves point back at the root, same as the host builder
+	sNodes[pNodeOffset + NodeIdx].FirstChildIndex = pNodeOffset;
+	sNodes[pNodeOffset + NodeIdx].SecondChildIndex = pNodeOffset;
+}
+
+void WriteInternal(int i)
+{
+	// Direction of the range
+	int d = Delta(i, i + 1) - Delta(i, i - 1) >= 0 ? 1 : -1;
+
+	// Upper bound for the length of the range
+	int MinDelta = Delta(i, i - d);
+	int MaxLength = 2;
+
+	while (Delta(i, i + MaxLength * d) > MinDelta)
+		MaxLength *= 2;
+
+	// Binary search for the other end
+	int Length = 0;
+
+	for (int t = MaxLength / 2; t >= 1; t /= 2)
+	{
+		if (Delta(i, i + (Length + t) * d) > MinDelta)
+			Length += t;
+	}
+
+	int j = i + Length * d;
+	int NodeDelta = Delta(i, j);
+
+	// Binary search for the split position
+	int Split = 0;
+	int Divisor = 2;
+
+	for (;;)
+	{
+		int t = (Length + Divisor - 1) / Divisor;
+
+		if (Delta(i, i + (Split + t) * d) > NodeDelta)
+			Split += t;
+
+		if (t <= 1)
+			break;
+
+		Divisor *= 2;
+	}
+
+	int Gamma = i + Split * d + min(d, 0);
+
+	uint Left = min(i, j) == Gamma ? InternalNodeCount() + uint(Gamma) : uint(Gamma);
+	uint Right = max(i, j) == Gamma + 1 ? InternalNodeCount() + uint(Gamma) + 1 : uint(Gamma) + 1;
+
+	sNodes[pNodeOffset + i].FirstChildIndex = pNodeOffset + Left;
+	sNodes[pNodeOffset + i].SecondChildIndex = pNodeOffset + Right;
+
+	sNodes[pNodeOffset + i].BeginIndex = pFaceOffset + uint(min(i, j));
+	sNodes[pNodeOffset + i].EndIndex = pFaceOffset + uint(max(i, j)) + 1;
+
+	sParents[Left] = uint(i);
+	sParents[Right] = uint(i);
+}
+
+void main()
+{
+	uint GlobalIdx = gl_GlobalInvocationID.x;
+
+	if (GlobalIdx >= pFaceCount)
+		return;
+
+	WriteLeaf(GlobalIdx);
+
+	if (GlobalIdx == 0)
+		sParents[0] = INVALID_INDEX;
+
+	if (GlobalIdx < InternalNodeCount())
+		WriteInternal(int(GlobalIdx));
+}
@@ -0,0 +1,21 @@
+#version 440
+
+layout(local_size_x = WORKGROUP_SIZE) in;
+
+#include "LBVHCommon.glsl"
+
+void main()
+{
+	uint GlobalIdx = gl_GlobalInvocationID.x;
+
+	if (GlobalIdx >= pFaceCount)
+		return;
+
+	vec3 Centroid = FaceCentroid(sInputFaces[GlobalIdx]);
+
+	for (int i = 0; i < 3; i++)
+	{
+		atomicMin(sCentroidBounds.MinBound[i], FloatToOrderedUint(Centroid[i]));
+		atomicMax(sCentroidBounds.MaxBound[i], FloatToOrderedUint(Centroid[i]));
+	}
+}
@@ -0,0 +1,94 @@
+#version 440
+
+layout(local_size_x = WORKGROUP_SIZE) in;
+
+#include "LBVHCommon.glsl"
+
+// Every internal node becomes a wide node over its grand children, mirroring WideBVHFactory's layout
+// Wide node i corresponds to binary node i; the ones at odd depths are written but never referenced
+
+uint ChildOf(uint localIdx, uint slot)
+{
+	return LocalNodeIndex(slot == 0 ? sNodes[pNodeOffset + localIdx].FirstChildIndex :
+		sNodes[pNodeOffset + localIdx].SecondChildIndex);
+}
+
+void main()
+{
+	uint GlobalIdx = gl_GlobalInvocationID.x;
+
+	if (GlobalIdx >= max(InternalNodeCount(), 1))
+		return;
+
+	uint Children[4];
+	uint ChildCount = 0;
+
+	if (IsLeafNode(GlobalIdx))
+	{
+		// Single leaf mesh
+		Children[ChildCount++] = GlobalIdx;
+	}
+	else
+	{
+		for (uint i = 0; i < 2; i++)
+		{
+			uint Child = ChildOf(GlobalIdx, i);
+
+			if (IsLeafNode(Child))
+			{
+				Children[ChildCount++] = Child;
+				continue;
+			}
+
+			Children[ChildCount++] = ChildOf(Child, 0);
+			Children[ChildCount++] = ChildOf(Child, 1);
+		}
+	}
+
+	vec3 MinBound = vec3(FLT_MAX);
+	vec3 MaxBound = vec3(-FLT_MAX);
+
+	for (uint i = 0; i < ChildCount; i++)
+	{
+		MinBound = min(MinBound, sNodes[pNodeOffset + Children[i]].MinBound);
+		MaxBound = max(MaxBound, sNodes[pNodeOffset + Children[i]].MaxBound);
+	}
+
+	WideNode wideNode;
+	wideNode.Origin = MinBound;
+	wideNode.Exponents = 0;
+	wideNode.ChildIndex = uvec4(WIDE_BVH_INVALID_CHILD);
+	wideNode.ChildFaceCount = uvec4(0);
+	wideNode.QuantizedMin = uvec4(0);
+	wideNode.QuantizedMax = uvec4(0);
+
+	vec3 Scale;
+
+	for (int axis = 0; axis < 3; axis++)
+	{
+		float Extent = max(MaxBound[axis] - MinBound[axis], 1.0e-30);
+		int Exponent = clamp(int(ceil(log2(Extent / 255.0))), -127, 128);
+
+		Scale[axis] = exp2(float(Exponent));
+		wideNode.Exponents |= uint(Exponent + 127) << (8 * axis);
+	}
+
+	for (uint i = 0; i < ChildCount; i++)
+	{
+		Node child = sNodes[pNodeOffset + Children[i]];
+
+		// Rounding outwards keeps the quantized box conservative
+		uvec3 qMin = uvec3(clamp(floor((child.MinBound - wideNode.Origin) / Scale), vec3(0.0), vec3(255.0)));
+		uvec3 qMax = uvec3(clamp(ceil((child.MaxBound - wideNode.Origin) / Scale), vec3(0.0), vec3(255.0)));
+
+		wideNode.QuantizedMin[i] = qMin.x | (qMin.y << 8) | (qMin.z << 16);
+		wideNode.QuantizedMax[i] = qMax.x | (qMax.y << 8) | (qMax.z << 16);
+
+		bool Leaf = IsLeafNode(Children[i]);
+
+		wideNode.ChildIndex[i] = Leaf ? child.BeginIndex : pWideNodeOffset + Children[i];
+		wideNode.ChildFaceCount[i] = Leaf ? child.EndIndex - child.BeginIndex : 0;
+	}
+
+	sWideNodes[pWideNodeOffset + GlobalIdx] = wideNode;
+}
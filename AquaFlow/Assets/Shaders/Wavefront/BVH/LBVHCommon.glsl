@@ -0,0 +1,124 @@
+#ifndef LBVH_COMMON_GLSL
+#define LBVH_COMMON_GLSL
+
+// Shared layout of the GPU linear BVH builder
+// Every pass builds one mesh, the offsets place its output next to the previously submitted meshes
+// Internal nodes are stored at [0, FaceCount - 1) and the leaves at [FaceCount - 1, 2 * FaceCount - 1)
+
+#include "../Wavefront/Common.glsl"
+
+#define INVALID_INDEX 0xffffffffu
+
+struct Face
+{
+	uvec4 Indices;
+
+	uint MaterialRef;
+	uint InstanceIndex;
+
+	uint FaceID;
+	uint Padding2;
+};
+
+struct MortonRef
+{
+	uint Code;
+	uint FaceIdx;
+};
+
+layout(push_constant) uniform BuildData
+{
+	uint pFaceCount;
+	uint pFaceOffset;
+	uint pNodeOffset;
+	uint pWideNodeOffset;
+	uint pSortedBuffer;
+};
+
+layout(std430, set = 0, binding = 0) readonly buffer VertexBuffer
+{
+	vec3 sPositions[];
+};
+
+// Copy of the faces before the build, the hierarchy pass writes them back in the sorted order
+layout(std430, set = 0, binding = 1) readonly buffer InputFaceBuffer
+{
+	Face sInputFaces[];
+};
+
+layout(std430, set = 0, binding = 2) buffer FaceBuffer
+{
+	Face sFaces[];
+};
+
+layout(std430, set = 0, binding = 3) coherent buffer NodeBuffer
+{
+	Node sNodes[];
+};
+
+layout(std430, set = 0, binding = 4) buffer WideNodeBuffer
+{
+	WideNode sWideNodes[];
+};
+
+// Two halves, ping-ponged by the merge sorter
+layout(std430, set = 0, binding = 5) buffer MortonBuffer
+{
+	MortonRef sMortonRefs[];
+};
+
+layout(std430, set = 0, binding = 6) coherent buffer ParentBuffer
+{
+	uint sParents[];
+};
+
+layout(std430, set = 0, binding = 7) coherent buffer VisitFlagBuffer
+{
+	uint sVisitFlags[];
+};
+
+// Order preserving uint encoding of the centroid bounds so that they can be reduced atomically
+layout(std430, set = 0, binding = 8) buffer CentroidBoundBuffer
+{
+	uvec4 MinBound;
+	uvec4 MaxBound;
+} sCentroidBounds;
+
+uint FloatToOrderedUint(float value)
+{
+	uint bits = floatBitsToUint(value);
+	return (bits & 0x80000000u) != 0 ? ~bits : bits | 0x80000000u;
+}
+
+float OrderedUintToFloat(uint value)
+{
+	return uintBitsToFloat((value & 0x80000000u) != 0 ? value & 0x7fffffffu : ~value);
+}
+
+vec3 FaceCentroid(in Face face)
+{
+	return (sPositions[face.Indices.x] + sPositions[face.Indices.y] + sPositions[face.Indices.z]) / 3.0;
+}
+
+uint InternalNodeCount()
+{
+	return pFaceCount - 1;
+}
+
+bool IsLeafNode(uint localIdx)
+{
+	return localIdx >= InternalNodeCount();
+}
+
+uint LocalNodeIndex(uint globalIdx)
+{
+	return globalIdx - pNodeOffset;
+}
+
+float SurfaceArea(in vec3 minBound, in vec3 maxBound)
+{
+	vec3 extent = max(maxBound - minBound, vec3(0.0));
+	return 2.0 * (extent.x * extent.y + extent.y * extent.z + extent.z * extent.x);
+}
+
+#endif
@@ -0,0 +1,47 @@
+#version 440
+
+layout(local_size_x = WORKGROUP_SIZE) in;
+
+#include "LBVHCommon.glsl"
+
+// Spreads the lowest 10 bits so that there are two zeros between every bit
+uint ExpandBits(uint value)
+{
+	value = (value * 0x00010001u) & 0xFF0000FFu;
+	value = (value * 0x00000101u) & 0x0F00F00Fu;
+	value = (value * 0x00000011u) & 0xC30C30C3u;
+	value = (value * 0x00000005u) & 0x49249249u;
+
+	return value;
+}
+
+uint MortonCode(in vec3 position)
+{
+	vec3 quantized = clamp(position * 1024.0, vec3(0.0), vec3(1023.0));
+
+	return (ExpandBits(uint(quantized.x)) << 2) |
+		(ExpandBits(uint(quantized.y)) << 1) | ExpandBits(uint(quantized.z));
+}
+
+void main()
+{
+	uint GlobalIdx = gl_GlobalInvocationID.x;
+
+	if (GlobalIdx >= pFaceCount)
+		return;
+
+	vec3 MinBound, MaxBound;
+
+	for (int i = 0; i < 3; i++)
+	{
+		MinBound[i] = OrderedUintToFloat(sCentroidBounds.MinBound[i]);
+		MaxBound[i] = OrderedUintToFloat(sCentroidBounds.MaxBound[i]);
+	}
+
+	vec3 Extent = max(MaxBound - MinBound, vec3(1.0e-20));
+	vec3 Centroid = FaceCentroid(sInputFaces[GlobalIdx]);
+
+	// Written into the first half, the sorter takes it from there
+	sMortonRefs[GlobalIdx].Code = MortonCode((Centroid - MinBound) / Extent);
+	sMortonRefs[GlobalIdx].FaceIdx = GlobalIdx;
+}
@@ -0,0 +1,46 @@
+#version 440
+
+// Acceleration structure builds want the triangle indices tightly packed
+// Copies the indices of every session face, in the same order as sFaces, into three uints per face
+
+layout(local_size_x = WORKGROUP_SIZE) in;
+
+struct Face
+{
+	uvec4 Indices;
+
+	uint MaterialRef;
+	uint InstanceIndex;
+
+	uint FaceID;
+	uint Padding2;
+};
+
+layout(push_constant) uniform PackData
+{
+	uint pFaceCount;
+};
+
+layout(std430, set = 0, binding = 0) readonly buffer FaceBuffer
+{
+	Face sFaces[];
+};
+
+layout(std430, set = 0, binding = 1) writeonly buffer IndexBuffer
+{
+	uint sIndices[];
+};
+
+void main()
+{
+	uint FaceIdx = gl_GlobalInvocationID.x;
+
+	if (FaceIdx >= pFaceCount)
+		return;
+
+	uvec4 Indices = sFaces[FaceIdx].Indices;
+
+	sIndices[3 * FaceIdx + 0] = Indices.x;
+	sIndices[3 * FaceIdx + 1] = Indices.y;
+	sIndices[3 * FaceIdx + 2] = Indices.z;
+}
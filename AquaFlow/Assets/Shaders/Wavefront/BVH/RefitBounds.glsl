@@ -0,0 +1,148 @@
+#version 440
+
+layout(local_size_x = WORKGROUP_SIZE) in;
+
+#include "LBVHCommon.glsl"
+
+// Bottom up pass, one thread per leaf; the second thread to reach a node owns it
+// Once both children are final, the node tries tree rotations (Kensler, "Tree Rotations for
+// Improving Bounding Volume Hierarchies") which act as a small treelet refinement
+
+uint FirstChild(uint localIdx)
+{
+	return LocalNodeIndex(sNodes[pNodeOffset + localIdx].FirstChildIndex);
+}
+
+uint SecondChild(uint localIdx)
+{
+	return LocalNodeIndex(sNodes[pNodeOffset + localIdx].SecondChildIndex);
+}
+
+float UnionArea(uint a, uint b)
+{
+	return SurfaceArea(min(sNodes[pNodeOffset + a].MinBound, sNodes[pNodeOffset + b].MinBound),
+		max(sNodes[pNodeOffset + a].MaxBound, sNodes[pNodeOffset + b].MaxBound));
+}
+
+float NodeArea(uint a)
+{
+	return SurfaceArea(sNodes[pNodeOffset + a].MinBound, sNodes[pNodeOffset + a].MaxBound);
+}
+
+void EncloseChildren(uint localIdx)
+{
+	uint Left = FirstChild(localIdx);
+	uint Right = SecondChild(localIdx);
+
+	sNodes[pNodeOffset + localIdx].MinBound =
+		min(sNodes[pNodeOffset + Left].MinBound, sNodes[pNodeOffset + Right].MinBound);
+	sNodes[pNodeOffset + localIdx].MaxBound =
+		max(sNodes[pNodeOffset + Left].MaxBound, sNodes[pNodeOffset + Right].MaxBound);
+
+	sNodes[pNodeOffset + localIdx].BeginIndex =
+		min(sNodes[pNodeOffset + Left].BeginIndex, sNodes[pNodeOffset + Right].BeginIndex);
+	sNodes[pNodeOffset + localIdx].EndIndex =
+		max(sNodes[pNodeOffset + Left].EndIndex, sNodes[pNodeOffset + Right].EndIndex);
+}
+
+// Swaps the child 'sibling' of 'parent' with the grand child 'grandChild' found under 'pivot'
+void Rotate(uint parent, uint sibling, uint pivot, uint grandChild)
+{
+	if (FirstChild(parent) == sibling)
+		sNodes[pNodeOffset + parent].FirstChildIndex = pNodeOffset + grandChild;
+	else
+		sNodes[pNodeOffset + parent].SecondChildIndex = pNodeOffset + grandChild;
+
+	if (FirstChild(pivot) == grandChild)
+		sNodes[pNodeOffset + pivot].FirstChildIndex = pNodeOffset + sibling;
+	else
+		sNodes[pNodeOffset + pivot].SecondChildIndex = pNodeOffset + sibling;
+
+	sParents[grandChild] = parent;
+	sParents[sibling] = pivot;
+
+	EncloseChildren(pivot);
+}
+
+void TryRotations(uint localIdx)
+{
+	uint Left = FirstChild(localIdx);
+	uint Right = SecondChild(localIdx);
+
+	// The area of 'localIdx' never changes, only the area of the child taking the swapped node does
+	float BestDelta = -1.0e-6 * NodeArea(localIdx);
+	uint BestSibling = INVALID_INDEX, BestPivot = INVALID_INDEX, BestGrandChild = INVALID_INDEX;
+
+	if (!IsLeafNode(Right))
+	{
+		uint RightA = FirstChild(Right);
+		uint RightB = SecondChild(Right);
+		float RightArea = NodeArea(Right);
+
+		float Delta = UnionArea(Left, RightB) - RightArea;
+
+		if (Delta < BestDelta)
+		{
+			BestDelta = Delta; BestSibling = Left; BestPivot = Right; BestGrandChild = RightA;
+		}
+
+		Delta = UnionArea(Left, RightA) - RightArea;
+
+		if (Delta < BestDelta)
+		{
+			BestDelta = Delta; BestSibling = Left; BestPivot = Right; BestGrandChild = RightB;
+		}
+	}
+
+	if (!IsLeafNode(Left))
+	{
+		uint LeftA = FirstChild(Left);
+		uint LeftB = SecondChild(Left);
+		float LeftArea = NodeArea(Left);
+
+		float Delta = UnionArea(Right, LeftB) - LeftArea;
+
+		if (Delta < BestDelta)
+		{
+			BestDelta = Delta; BestSibling = Right; BestPivot = Left; BestGrandChild = LeftA;
+		}
+
+		Delta = UnionArea(Right, LeftA) - LeftArea;
+
+		if (Delta < BestDelta)
+		{
+			BestDelta = Delta; BestSibling = Right; BestPivot = Left; BestGrandChild = LeftB;
+		}
+	}
+
+	if (BestSibling != INVALID_INDEX)
+		Rotate(localIdx, BestSibling, BestPivot, BestGrandChild);
+}
+
+void main()
+{
+	uint GlobalIdx = gl_GlobalInvocationID.x;
+
+	// A single leaf is already the whole tree
+	if (GlobalIdx >= pFaceCount || pFaceCount < 2)
+		return;
+
+	uint NodeIdx = sParents[InternalNodeCount() + GlobalIdx];
+
+	while (NodeIdx != INVALID_INDEX)
+	{
+		// Make sure that the bounds written by this thread are visible before handing the node over
+		memoryBarrierBuffer();
+
+		if (atomicAdd(sVisitFlags[NodeIdx], 1) == 0)
+			return;
+
+		EncloseChildren(NodeIdx);
+
+#if TREE_ROTATIONS
+		TryRotations(NodeIdx);
+#endif
+
+		NodeIdx = sParents[NodeIdx];
+	}
+}
@@ -0,0 +1,130 @@
+#ifndef ENVIRONMENT_MAP_GLSL
+#define ENVIRONMENT_MAP_GLSL
+
+// Importance sampling of the equirectangular environment map
+// The CDFs are built by TraceSession::SetEnvironmentMap, texels are weighted by luminance * sin(theta)
+// The uv mapping matches SampleCubeMap in the shader back end
+
+#define ENVIRONMENT_DISTANCE 1.0e30
+
+bool EnvironmentExists()
+{
+	return uSkyboxExists != 0 && uEnvIntegral > 0.0;
+}
+
+vec2 EnvironmentDirectionToUV(in vec3 direction)
+{
+	float Theta = acos(clamp(direction.y, -1.0, 1.0));
+	float Phi = atan(direction.z, direction.x);
+
+	float u = (Phi + uSkyboxColor.w + MATH_PI) / (2.0 * MATH_PI);
+	float v = Theta / MATH_PI;
+
+	return vec2(fract(u), clamp(v, 0.0, 1.0));
+}
+
+vec3 EnvironmentUVToDirection(in vec2 uv)
+{
+	float Theta = uv.y * MATH_PI;
+	float Phi = uv.x * 2.0 * MATH_PI - MATH_PI - uSkyboxColor.w;
+
+	float SinTheta = sin(Theta);
+
+	return vec3(SinTheta * cos(Phi), cos(Theta), SinTheta * sin(Phi));
+}
+
+uint EnvironmentTexelIndex(in vec2 uv)
+{
+	uvec2 Texel = min(uvec2(uv * vec2(uEnvResolution)), uEnvResolution - 1);
+	return Texel.y * uEnvResolution.x + Texel.x;
+}
+
+vec3 LookupEnvironment(in vec3 direction)
+{
+	return sEnvironmentTexels[EnvironmentTexelIndex(EnvironmentDirectionToUV(direction))].rgb;
+}
+
+// First entry in [begin, begin + count) whose CDF exceeds Xi
+uint SearchCDF(uint begin, uint count, float Xi)
+{
+	uint Low = 0;
+	uint High = count - 1;
+
+	while (Low < High)
+	{
+		uint Mid = (Low + High) / 2;
+
+		if (sEnvironmentCDF[begin + Mid] > Xi)
+			High = Mid;
+		else
+			Low = Mid + 1;
+	}
+
+	return Low;
+}
+
+float EnvironmentTexelWeight(uint row, uint col)
+{
+	uint RowBegin = uEnvResolution.y + row * uEnvResolution.x;
+
+	float Marginal = sEnvironmentCDF[row] - (row == 0 ? 0.0 : sEnvironmentCDF[row - 1]);
+	float Conditional = sEnvironmentCDF[RowBegin + col] - (col == 0 ? 0.0 : sEnvironmentCDF[RowBegin + col - 1]);
+
+	return Marginal * Conditional;
+}
+
+// Solid angle pdf of sampling the given direction; useful for the MIS weights
+float EnvironmentPDF(in vec3 direction)
+{
+	if (!EnvironmentExists())
+		return 0.0;
+
+	vec2 uv = EnvironmentDirectionToUV(direction);
+	uvec2 Texel = min(uvec2(uv * vec2(uEnvResolution)), uEnvResolution - 1);
+
+	float SinTheta = sin(uv.y * MATH_PI);
+
+	if (SinTheta <= SHADING_TOLERANCE)
+		return 0.0;
+
+	float TexelCount = float(uEnvResolution.x * uEnvResolution.y);
+
+	return EnvironmentTexelWeight(Texel.y, Texel.x) * TexelCount / (2.0 * MATH_PI * MATH_PI * SinTheta);
+}
+
+LightSample SampleEnvironment()
+{
+	LightSample lightSample;
+	lightSample.IsInvalid = true;
+	lightSample.IsDelta = false;
+	lightSample.PDF = 0.0;
+	lightSample.Radiance = vec3(0.0);
+
+	if (!EnvironmentExists())
+		return lightSample;
+
+	uint Row = SearchCDF(0, uEnvResolution.y, GetRandom(sRandomSeed));
+	uint Col = SearchCDF(uEnvResolution.y + Row * uEnvResolution.x, uEnvResolution.x, GetRandom(sRandomSeed));
+
+	// Jitter inside the texel
+	vec2 uv = (vec2(Col, Row) + vec2(GetRandom(sRandomSeed), GetRandom(sRandomSeed))) / vec2(uEnvResolution);
+
+	float SinTheta = sin(uv.y * MATH_PI);
+
+	if (SinTheta <= SHADING_TOLERANCE)
+		return lightSample;
+
+	float TexelCount = float(uEnvResolution.x * uEnvResolution.y);
+
+	lightSample.Direction = EnvironmentUVToDirection(uv);
+	lightSample.Distance = ENVIRONMENT_DISTANCE;
+	lightSample.Position = lightSample.Direction * ENVIRONMENT_DISTANCE;
+	lightSample.Normal = -lightSample.Direction;
+	lightSample.Radiance = sEnvironmentTexels[Row * uEnvResolution.x + Col].rgb;
+	lightSample.PDF = EnvironmentTexelWeight(Row, Col) * TexelCount / (2.0 * MATH_PI * MATH_PI * SinTheta);
+	lightSample.IsInvalid = lightSample.PDF <= 0.0;
+
+	return lightSample;
+}
+
+#endif
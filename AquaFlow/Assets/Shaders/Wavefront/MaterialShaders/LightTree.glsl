@@ -0,0 +1,150 @@
+#ifndef LIGHT_TREE_GLSL
+#define LIGHT_TREE_GLSL
+
+// Many light sampling through the light tree built by the TraceSession
+// Each step picks a child proportional to its estimated contribution at the shading point,
+// so the noise per sample stays roughly the same no matter how many emitters the scene has
+
+#define LIGHT_TREE_MAX_DEPTH 64
+#define INVALID_EMITTER_INDEX 0xffffffffu
+
+struct LightSample
+{
+	vec3 Position;
+	vec3 Normal;
+	vec3 Direction; // From the shading point towards the light
+	float Distance;
+
+	vec3 Radiance;
+	float PDF; // Solid angle pdf including the probability of picking the emitter
+
+	bool IsDelta; // Point lights can't be hit by the BSDF samples
+	bool IsInvalid;
+};
+
+float LightNodeImportance(in LightTreeNode node, in vec3 position)
+{
+	vec3 Center = 0.5 * (node.MinBound + node.MaxBound);
+	vec3 HalfExtent = 0.5 * (node.MaxBound - node.MinBound);
+
+	vec3 Offset = position - Center;
+
+	// Don't let the importance blow up once the point sits inside the bounds
+	float DistanceSq = max(dot(Offset, Offset), dot(HalfExtent, HalfExtent));
+
+	return node.Power / max(DistanceSq, SHADING_TOLERANCE);
+}
+
+// Returns the emitter index along with the probability of picking it
+uint PickLightEmitter(in vec3 position, out float pmf)
+{
+	pmf = 1.0;
+
+	if (sLightTree[0].Power <= 0.0)
+		return INVALID_EMITTER_INDEX;
+
+	uint NodeIdx = 0;
+
+	for (int Depth = 0; Depth < LIGHT_TREE_MAX_DEPTH; Depth++)
+	{
+		LightTreeNode node = sLightTree[NodeIdx];
+
+		if (node.EmitterIndex != INVALID_EMITTER_INDEX)
+			return node.EmitterIndex;
+
+		float FirstImportance = LightNodeImportance(sLightTree[node.FirstChildIndex], position);
+		float SecondImportance = LightNodeImportance(sLightTree[node.SecondChildIndex], position);
+
+		float TotalImportance = FirstImportance + SecondImportance;
+
+		if (TotalImportance <= 0.0)
+			return INVALID_EMITTER_INDEX;
+
+		float FirstProbability = FirstImportance / TotalImportance;
+
+		if (GetRandom(sRandomSeed) < FirstProbability)
+		{
+			NodeIdx = node.FirstChildIndex;
+			pmf *= FirstProbability;
+		}
+		else
+		{
+			NodeIdx = node.SecondChildIndex;
+			pmf *= 1.0 - FirstProbability;
+		}
+	}
+
+	return INVALID_EMITTER_INDEX;
+}
+
+LightSample SampleLightSource(in vec3 position)
+{
+	LightSample lightSample;
+	lightSample.IsInvalid = true;
+	lightSample.IsDelta = false;
+	lightSample.PDF = 0.0;
+	lightSample.Radiance = vec3(0.0);
+
+	float EmitterPMF;
+	uint EmitterIdx = PickLightEmitter(position, EmitterPMF);
+
+	if (EmitterIdx == INVALID_EMITTER_INDEX || EmitterPMF <= 0.0)
+		return lightSample;
+
+	LightEmitter emitter = sLightEmitters[EmitterIdx];
+
+	if (emitter.PrimitiveID == INVALID_EMITTER_INDEX)
+	{
+		// Point light; intensity falls off with the squared distance
+		vec3 Offset = emitter.Position - position;
+		float DistanceSq = max(dot(Offset, Offset), SHADING_TOLERANCE);
+
+		lightSample.Position = emitter.Position;
+		lightSample.Distance = sqrt(DistanceSq);
+		lightSample.Direction = Offset / lightSample.Distance;
+		lightSample.Normal = -lightSample.Direction;
+		lightSample.Radiance = emitter.Radiance / DistanceSq;
+		lightSample.PDF = EmitterPMF;
+		lightSample.IsDelta = true;
+		lightSample.IsInvalid = false;
+
+		return lightSample;
+	}
+
+	uvec4 Indices = sFaces[emitter.PrimitiveID].Indices;
+
+	vec3 A = sPositions[Indices.x];
+	vec3 B = sPositions[Indices.y];
+	vec3 C = sPositions[Indices.z];
+
+	// Uniform point on the triangle
+	float Xi1 = sqrt(GetRandom(sRandomSeed));
+	float Xi2 = GetRandom(sRandomSeed);
+
+	lightSample.Position = (1.0 - Xi1) * A + Xi1 * (1.0 - Xi2) * B + Xi1 * Xi2 * C;
+
+	vec3 Cross = cross(B - A, C - A);
+	float Area = 0.5 * length(Cross);
+
+	vec3 Offset = lightSample.Position - position;
+	float DistanceSq = dot(Offset, Offset);
+
+	lightSample.Distance = sqrt(DistanceSq);
+	lightSample.Direction = Offset / max(lightSample.Distance, SHADING_TOLERANCE);
+	lightSample.Normal = normalize(Cross);
+
+	// Both sides emit, see LightTreeFactory::AddTriangleEmitter
+	float CosTheta = abs(dot(lightSample.Normal, lightSample.Direction));
+
+	if (Area <= 0.0 || CosTheta <= SHADING_TOLERANCE)
+		return lightSample;
+
+	// Converting the area measure into solid angle
+	lightSample.PDF = EmitterPMF * DistanceSq / (Area * CosTheta);
+	lightSample.Radiance = emitter.Radiance;
+	lightSample.IsInvalid = false;
+
+	return lightSample;
+}
+
+#endif
@@ -1,5 +1,6 @@
 // Shader back end of the material pipeline
 // Uses the place holder shader: SampleInfo Evaluate(in Ray, in CollisionInfo);
+// and optionally: vec3 EvaluateDirection(in Ray, in CollisionInfo, in vec3 direction);
 
 // Post processing for cube map texture
 vec3 GammaCorrectionInv(in vec3 color)
@@ -79,9 +80,8 @@ SampleInfo EvokeShader(in Ray ray, in CollisionInfo collisionInfo, in uint mater
 			skyboxInfo.IsInvalid = false;
 			skyboxInfo.Throughput = vec3(1.0);
 
-			if (uSkyboxExists != 0)
-				//sampleInfo.Luminance = SampleCubeMap(ray.Direction, pSkyboxColor.w);
-				skyboxInfo.Luminance = vec3(1.0, 0.0, 0.0);
+			if (EnvironmentExists())
+				skyboxInfo.Luminance = LookupEnvironment(ray.Direction);
 			else
 				skyboxInfo.Luminance = uSkyboxColor.rgb;
 
@@ -93,11 +93,64 @@ SampleInfo EvokeShader(in Ray ray, in CollisionInfo collisionInfo, in uint mater
 	}
 }
 
+#ifdef MATERIAL_EVALUATES_DIRECTION
+
+// Next event estimation; picks the light tree or the environment and queues a shadow ray towards it
+// The occlusion pass tests the segment and the regeneration pass adds the radiance if it's clear
+// Returns the PATH_FLAG_* bits of the emitters that could have been picked, their bsdf hits are dropped later
+// The shadow ray leaves from the geometric surface, collisionInfo carries the shading normal
+uint SampleDirectLight(in Ray ray, in CollisionInfo collisionInfo, in vec3 geometricNormal,
+	in vec3 pathLuminance, uint slot)
+{
+	bool LightsExist = sLightTree[0].Power > 0.0;
+	bool EnvExists = EnvironmentExists();
+
+	if (!(LightsExist || EnvExists))
+		return 0u;
+
+	uint Flags = (LightsExist ? PATH_FLAG_SAMPLED_LIGHTS : 0u) |
+		(EnvExists ? PATH_FLAG_SAMPLED_ENVIRONMENT : 0u);
+
+	float LightsProbability = LightsExist ? (EnvExists ? 0.5 : 1.0) : 0.0;
+	bool PickLights = GetRandom(sRandomSeed) < LightsProbability;
+
+	LightSample lightSample = PickLights ?
+		SampleLightSource(collisionInfo.IntersectionPoint) : SampleEnvironment();
+
+	float PickPDF = PickLights ? LightsProbability : 1.0 - LightsProbability;
+	float PDF = lightSample.PDF * PickPDF;
+
+	if (lightSample.IsInvalid || PDF <= 0.0)
+		return Flags;
+
+	vec3 Contribution = EvaluateDirection(ray, collisionInfo, lightSample.Direction) *
+		lightSample.Radiance / PDF;
+
+	if (MaxComponent(Contribution) <= 0.0)
+		return Flags;
+
+	float sign = dot(lightSample.Direction, geometricNormal) > 0.0 ? 1.0 : -1.0;
+
+	ShadowRay shadowRay;
+	shadowRay.Origin = collisionInfo.IntersectionPoint + sign * geometricNormal * SHADING_TOLERANCE;
+	shadowRay.Direction = lightSample.Direction;
+	shadowRay.MaxDistance = lightSample.Distance;
+	shadowRay.Time = collisionInfo.Time;
+	shadowRay.Radiance = vec4(pathLuminance * Contribution, 0.0);
+
+	sShadowRays[slot] = shadowRay;
+
+	return Flags;
+}
+
+#endif
+
 void main()
 {
 	uint GlobalIdx = gl_GlobalInvocationID.x;
 
-	if (GlobalIdx >= uRayCount)
+	// Dispatched indirectly over the compacted live paths
+	if (GlobalIdx >= sPathQueue.ActiveCount)
 		return;
 
 	if (uRayCount == 0)
@@ -107,6 +160,9 @@ void main()
 	RayInfo rayInfo = sRayInfos[GetActiveIndex(GlobalIdx)];
 	Ray ray = sRays[GetActiveIndex(GlobalIdx)];
 
+	if (ray.Active != 0)
+		return;
+
 	//sRayInfos[GetActiveIndex(GlobalIdx)].Luminance = vec4(0.0);
 	//
 	//return;
@@ -142,6 +198,18 @@ void main()
 	if (!(MaterialPass || InactivePass))
 		return;
 
+	// Materials shade with the interpolated normal, rays still leave from the actual triangle
+	vec3 GeometricNormal = collisionInfo.Normal;
+
+	if (MaterialPass)
+	{
+		vec3 ShadingNormal = GetSurfaceFrame(collisionInfo).Normal;
+
+		// Interpolated normals facing away from the viewer would leak light, the flat normal is kept there
+		if (dot(ShadingNormal, -ray.Direction) > 0.0)
+			collisionInfo.Normal = ShadingNormal;
+	}
+
 	// Sampling and dispatching to the approapriate shader
 	SampleInfo sampleInfo;
 
@@ -150,6 +218,17 @@ void main()
 	else
 		sampleInfo = Evaluate(ray, collisionInfo);
 
+	// Light sampling happens before the path luminance takes in the bsdf sample
+	if (!InactivePass)
+	{
+	#ifdef MATERIAL_EVALUATES_DIRECTION
+		sRayInfos[GetActiveIndex(GlobalIdx)].Flags =
+			SampleDirectLight(ray, collisionInfo, GeometricNormal, rayInfo.Luminance.rgb, GlobalIdx);
+	#else
+		sRayInfos[GetActiveIndex(GlobalIdx)].Flags = 0;
+	#endif
+	}
+
 	//SampleInfo sampleInfo = EvokeShader(ray, collisionInfo, MaterialRef);
 
 	// prevent the throughput from dropping too much
@@ -189,11 +268,13 @@ void main()
 	else
 		sRayInfos[GetActiveIndex(GlobalIdx)].Luminance = vec4(0.0, 0.0, 0.0, 1.0);
 
-	float sign = sampleInfo.IsReflected ? 1.0 : -1.0;
+	// With shading normals the side has to come from the direction itself rather than IsReflected
+	float sign = MaterialPass ? (dot(sampleInfo.Direction, GeometricNormal) > 0.0 ? 1.0 : -1.0) :
+		(sampleInfo.IsReflected ? 1.0 : -1.0);
 
 	// Aim at the sampled direction
 	sRays[GetActiveIndex(GlobalIdx)].Origin =
-		collisionInfo.IntersectionPoint + sign * collisionInfo.Normal * SHADING_TOLERANCE;
+		collisionInfo.IntersectionPoint + sign * GeometricNormal * SHADING_TOLERANCE;
 
 	sRays[GetActiveIndex(GlobalIdx)].Direction = sampleInfo.Direction;
 
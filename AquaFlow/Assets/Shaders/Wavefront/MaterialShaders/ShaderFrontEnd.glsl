@@ -9,6 +9,13 @@
 * SHADER_TOLERANCE = 0.001, POWER_HEURISTIC_EXP = 2.0,
 * EMPTY_MATERIAL_ID = -1, SKYBOX_MATERIAL_ID = -2, LIGHT_MATERIAL_ID = -3,
 * RR_CUTOFF_CONST = -4 (indicates that the path was terminated through russian roulette)
+*
+* collisionInfo.Normal holds the interpolated normal when SMOOTH_SHADING is set, materials can get the
+* uvs and the tangent frame through SurfaceFrame GetSurfaceFrame(in CollisionInfo) for their textures
+*
+* Materials may also define MATERIAL_EVALUATES_DIRECTION along with
+* vec3 EvaluateDirection(in Ray, in CollisionInfo, in vec3 direction), returning f * cos for the
+* given direction; the back end then samples the lights at every hit through a shadow ray
 */
 
 layout(local_size_x = WORKGROUP_SIZE) in;
@@ -27,7 +34,7 @@ struct Face
 	uvec4 Indices;
 
 	uint MaterialRef;
-	uint Padding1;
+	uint InstanceIndex; // Mesh the face belongs to, -1 for the light sources
 
 	uint FaceID;
 	uint Padding2;
@@ -82,6 +89,50 @@ layout(std430, set = 0, binding = 8) readonly buffer LightPropsBuffer
 
 layout(set = 0, binding = 9) uniform sampler2D uCubeMap;
 
+layout(std430, set = 0, binding = 10) readonly buffer PathQueueBuffer
+{
+	PathQueue sPathQueue;
+};
+
+layout(std430, set = 0, binding = 11) readonly buffer LightEmitterBuffer
+{
+	LightEmitter sLightEmitters[];
+};
+
+layout(std430, set = 0, binding = 12) readonly buffer LightTreeBuffer
+{
+	LightTreeNode sLightTree[];
+};
+
+layout(std430, set = 0, binding = 13) readonly buffer EnvironmentTexelBuffer
+{
+	vec4 sEnvironmentTexels[];
+};
+
+// Marginal CDF over the rows, followed by the conditional CDF of every row
+layout(std430, set = 0, binding = 14) readonly buffer EnvironmentCDFBuffer
+{
+	float sEnvironmentCDF[];
+};
+
+// Written by the materials defining MATERIAL_EVALUATES_DIRECTION, one slot per path
+layout(std430, set = 0, binding = 15) buffer ShadowRayBuffer
+{
+	ShadowRay sShadowRays[];
+};
+
+// Tangent in xyz and the handedness of the bitangent in w, zero when the mesh came without them
+layout(std430, set = 0, binding = 16) readonly buffer TangentBuffer
+{
+	vec4 sTangents[];
+};
+
+// One per mesh, the shading frame of the moving ones is taken to world space at the hit time
+layout(std430, set = 0, binding = 17) readonly buffer InstanceMotionBuffer
+{
+	InstanceMotion sInstanceMotions[];
+};
+
 layout(std140, set = 1, binding = 0) uniform ShaderData
 {
 	uint uRayCount;
@@ -90,6 +141,10 @@ layout(std140, set = 1, binding = 0) uniform ShaderData
 	// Skybox stuff...
 	uint uSkyboxExists;
 	vec4 uSkyboxColor; // The alpha channel holds the rotation of the cube map
+
+	// Environment map importance sampling
+	uvec2 uEnvResolution;
+	float uEnvIntegral;
 };
 
 uint GetActiveIndex(uint index)
@@ -32,6 +32,14 @@ layout(std430, set = 0, binding = 1) buffer CountBuffer
 	uint sCounts[];
 };
 
+#if LIVE_COUNT
+// Leading word of the path queue, only the elements below it are counted
+layout(std430, set = 0, binding = 2) readonly buffer LiveCountBuffer
+{
+	uint sLiveCount;
+};
+#endif
+
 void main()
 {
 	uint GlobalIdx = gl_GlobalInvocationID.x;
@@ -39,6 +47,11 @@ void main()
 	if (GlobalIdx >= pBufferSize)
 		return;
 
+#if LIVE_COUNT
+	if (GlobalIdx >= sLiveCount)
+		return;
+#endif
+
 	for (uint i = 0; i < pLargestElem; i++)
 	{
 		atomicAdd(sCounts[i], uint(sBuffer[GlobalIdx].CompareElem == i));
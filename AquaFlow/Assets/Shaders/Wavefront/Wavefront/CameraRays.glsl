@@ -0,0 +1,96 @@
+#ifndef CAMERA_RAYS_GLSL
+#define CAMERA_RAYS_GLSL
+
+// Shared by the ray generation and the path regeneration stages
+// Expects DescSet0.glsl, DescSet1.glsl and Random.glsl to be included before
+
+struct PhysicalCameraInfo
+{
+	// Physical properties (in mm)...
+	vec2 SensorSize;
+	float FocalLength;
+	float ApertureSize;
+	float FocalDistance; // in meters...
+	float FOV; // in degrees...
+};
+
+PhysicalCameraInfo GetPhysicalCamera()
+{
+	PhysicalCameraInfo cameraInfo;
+	cameraInfo.SensorSize = uCamera.SensorSize;
+	cameraInfo.FocalLength = uCamera.FocalLength;
+	cameraInfo.ApertureSize = uCamera.ApertureSize;
+	cameraInfo.FocalDistance = uCamera.FocalDistance;
+	cameraInfo.FOV = uCamera.FOV;
+
+	return cameraInfo;
+}
+
+// Converting the pixel position into normalized uv coordinates 
+// from [0, Width] --> [-1, 1] and from [0, Height] --> [-1, 1]
+vec2 GetFilmCoordinates(in ivec2 positionOnImage)
+{
+	vec2 uv = vec2(positionOnImage) / vec2(uSceneInfo.ImageResolution) * 2.0 - 1.0;
+	uv.y = -uv.y;
+
+	return uv;
+}
+
+Ray CreateCameraRay(in vec2 uv, in PhysicalCameraInfo cameraInfo, in mat4 viewMatrix, inout uint seed)
+{
+	// Get the ray in camera's local coordinate space
+	Ray ray;
+
+	ray.Origin = vec3(0.0);
+	ray.Direction = normalize(vec3(uv * cameraInfo.SensorSize, cameraInfo.FocalLength));
+
+	if (cameraInfo.ApertureSize > 0.0)
+	{
+		vec2 LensSample = SampleOnUnitDisk(seed);
+
+		// Perturb the origin a little bit
+		vec3 NewOrigin = ray.Origin + cameraInfo.ApertureSize * vec3(LensSample, 0.0) * 1E-3;
+		
+		float Distance = cameraInfo.FocalDistance / ray.Direction.z;
+		vec3 FocalPoint = GetPoint(ray, Distance);
+
+		// Get the new direction towards the focal point from the pertubed origin
+		vec3 NewDirection = normalize(FocalPoint - NewOrigin);
+
+		// Set the new origin and the direction to form a new ray
+		ray.Origin = NewOrigin;
+		ray.Direction = NewDirection;
+	}
+
+	vec4 CameraPosition = inverse(viewMatrix) * vec4(0.0, 0.0, 0.0, 1.0);
+
+	// Transform the ray into the world coordinate space
+	ray.Origin = vec3(CameraPosition + vec4(ray.Origin, 1.0));
+	ray.Direction = transpose(mat3(viewMatrix)) * ray.Direction;
+
+	ray.MaterialIndex = 0;
+	ray.Active = 0; // zero represents the active path
+
+	return ray;
+}
+
+RayInfo CreateCameraRayInfo(in uvec2 position, inout uint seed)
+{
+	RayInfo rayInfo;
+	rayInfo.ImageCoordinate = position;
+	rayInfo.Depth = 0;
+	rayInfo.Flags = 0;
+	rayInfo.Luminance = vec4(1.0);
+	rayInfo.Throughput = vec3(1.0);
+
+	// Every path picks its own instant within the shutter interval
+#if MOTION_BLUR
+	rayInfo.Time = GetRandom(seed);
+#else
+	rayInfo.Time = 0.0;
+#endif
+
+	return rayInfo;
+}
+
+#endif
@@ -12,8 +12,39 @@ struct Ray
 struct RayInfo
 {
 	uvec2 ImageCoordinate;
+	uint Depth; // Number of bounces the path has taken so far
+	uint Flags; // PATH_FLAG_* bits set by the last material pass
 	vec4 Luminance;
-	vec4 Throughput;
+	vec3 Throughput;
+	float Time; // Shutter time of the path in [0, 1), zero without motion blur
+};
+
+// The last vertex already sampled these emitters through a shadow ray,
+// so hitting them with the bsdf sample mustn't count them twice
+#define PATH_FLAG_SAMPLED_LIGHTS         1u
+#define PATH_FLAG_SAMPLED_ENVIRONMENT    2u
+
+// Visibility query issued by the material passes, one slot per path
+// Radiance is added to the pixel of the path if nothing blocks the segment
+struct ShadowRay
+{
+	vec3 Origin;
+	float MaxDistance; // Zero marks an empty slot
+	vec3 Direction;
+	float Time; // Shutter time of the path that issued it
+	vec4 Radiance;
+};
+
+struct PathQueue
+{
+	uint ActiveCount;
+	uint NextActiveCount;
+	uint SampleCounter;
+	uint SampleBudget;
+
+	// Indirect dispatch arguments (x, y, z, padding)
+	uvec4 IntersectionDispatch;
+	uvec4 MaterialDispatch;
 };
 
 struct Material
@@ -26,6 +57,23 @@ struct Material
 	float RefractiveIndex;
 };
 
+// Object to world transform of a mesh at the shutter open and close, static meshes leave Moving at zero
+struct InstanceMotion
+{
+	vec4 StartRotation; // Quaternion in (x, y, z, w)
+	vec4 EndRotation;
+
+	vec3 StartTranslation;
+	uint Moving;
+	vec3 EndTranslation;
+	float Padding1;
+
+	vec3 StartScale;
+	float Padding2;
+	vec3 EndScale;
+	float Padding3;
+};
+
 struct LightProperties
 {
 	vec3 Color;
@@ -34,7 +82,7 @@ struct LightProperties
 struct MeshInfo
 {
 	uint BeginIndex;
-	uint Padding;
+	uint WideRootIndex;
 	uint EndIndex;
 	uint MaterialIndex;
 };
@@ -42,11 +90,32 @@ struct MeshInfo
 struct LightInfo
 {
 	uint BeginIndex;
-	uint Padding;
+	uint WideRootIndex;
 	uint EndIndex;
 	uint LightPropsIndex;
 };
 
+struct LightEmitter
+{
+	vec3 Position;
+	uint PrimitiveID; // -1 marks a point light
+
+	vec3 Radiance;
+	float Power;
+};
+
+struct LightTreeNode
+{
+	vec3 MinBound;
+	float Power;
+
+	vec3 MaxBound;
+	uint EmitterIndex; // Valid for the leaves only
+
+	uint FirstChildIndex;
+	uint SecondChildIndex;
+};
+
 struct Node
 {
 	vec3 MinBound;
@@ -60,6 +129,21 @@ struct Node
 	uint SecondChildIndex;
 };
 
+#define WIDE_BVH_INVALID_CHILD 0xffffffffu
+
+struct WideNode
+{
+	vec3 Origin;
+	uint Exponents; // Biased (by 127) power of two scales of x, y and z
+
+	uvec4 ChildIndex; // Node index, or the first face for the leaves
+	uvec4 ChildFaceCount; // Zero for the interior children
+
+	// x, y and z packed into the lowest three bytes
+	uvec4 QuantizedMin;
+	uvec4 QuantizedMax;
+};
+
 struct CollisionInfo
 {
 	// Values set by the collision solver...
@@ -78,6 +162,8 @@ struct CollisionInfo
 	// Booleans...
 	bool HitOccured;
 	bool IsLightSrc;
+
+	float Time; // Shutter time the hit was found at
 };
 
 struct RayRef
@@ -33,4 +33,29 @@ layout(set = 0, binding = 4) buffer RayInfoBuffer
 	RayInfo sRayInfos[];
 };
 
+layout(set = 0, binding = 5) buffer PathQueueBuffer
+{
+	PathQueue sPathQueue;
+};
+
+// Radiance of the finished paths is accumulated in fixed point so that it can be added atomically
+#define SAMPLE_ACCUMULATION_SCALE 1024.0
+#define MAX_SAMPLE_RADIANCE 64.0
+
+layout(set = 0, binding = 6) buffer SampleAccumulatorBuffer
+{
+	uvec4 sSampleAccumulator[];
+};
+
+layout(set = 0, binding = 7) buffer ShadowRayBuffer
+{
+	ShadowRay sShadowRays[];
+};
+
+// One bit per shadow ray slot, set by the occlusion pass when the segment is blocked
+layout(set = 0, binding = 8) buffer OcclusionMaskBuffer
+{
+	uint sOcclusionMask[];
+};
+
 #endif
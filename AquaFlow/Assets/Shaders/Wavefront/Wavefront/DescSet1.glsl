@@ -8,7 +8,7 @@ struct Face
 	uvec4 Indices;
 
 	uint MaterialRef;
-	uint Padding1;
+	uint InstanceIndex; // Mesh the face belongs to, -1 for the light sources
 
 	uint FaceID;
 	uint Padding2;
@@ -39,10 +39,10 @@ layout(std430, set = 1, binding = 4) readonly buffer NodeBuffer
 	Node sNodes[];
 };
 
-// Temporary... will be removed once the runtime material evaluation is implemented
-layout(std430, set = 1, binding = 5) readonly buffer MaterialBuffer
+// Collapsed four wide nodes, traversed instead of sNodes when WIDE_BVH is set
+layout(std430, set = 1, binding = 5) readonly buffer WideNodeBuffer
 {
-	Material sMaterialInfos[];
+	WideNode sWideNodes[];
 };
 
 layout(std430, set = 1, binding = 6) readonly buffer LightPropsBuffer
@@ -76,4 +76,12 @@ layout(std140, set = 1, binding = 9) uniform SceneInfo
 
 layout(set = 1, binding = 10) uniform sampler2D uCubeMap;
 
+// Binding 11 is the top level acceleration structure of the ray query kernels (RayQuery.glsl)
+
+// One per mesh, only read when MOTION_BLUR is set
+layout(std430, set = 1, binding = 12) readonly buffer InstanceMotionBuffer
+{
+	InstanceMotion sInstanceMotions[];
+};
+
 #endif
\ No newline at end of file
@@ -0,0 +1,50 @@
+#version 460
+
+#extension GL_EXT_ray_query : require
+
+// Closest hit kernel of the ray query backend, a drop in replacement for Intersection.glsl
+
+layout(local_size_x = WORKGROUP_SIZE) in;
+
+#include "DescSet0.glsl"
+#include "DescSet1.glsl"
+#include "RayQuery.glsl"
+
+layout(push_constant) uniform RayData
+{
+	uint pRayCount;
+	uint pActiveBuffer;
+};
+
+uint IndexOffset(uint index)
+{
+	return pRayCount * pActiveBuffer + index;
+}
+
+void main()
+{
+	uint GlobalIdx = gl_GlobalInvocationID.x;
+
+	// Dispatched indirectly over the live paths only
+	if (GlobalIdx >= sPathQueue.ActiveCount)
+		return;
+
+	if (sRays[IndexOffset(GlobalIdx)].Active != 0)
+		return;
+
+	Ray ray = sRays[IndexOffset(GlobalIdx)];
+
+	CollisionInfo closestHit;
+	closestHit.HitOccured = false;
+	closestHit.IsLightSrc = false;
+	closestHit.RayDis = MAX_DIS;
+
+	if (!TraceClosestHit(closestHit, ray))
+		closestHit.MaterialIndex = -2;
+
+	sCollisionInfos[IndexOffset(GlobalIdx)] = closestHit;
+
+	// Setting the necessary markers for the next stages
+	sRays[IndexOffset(GlobalIdx)].MaterialIndex =
+		closestHit.IsLightSrc && closestHit.HitOccured ? -3 : closestHit.MaterialIndex;
+}
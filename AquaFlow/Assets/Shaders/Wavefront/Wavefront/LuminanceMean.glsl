@@ -11,44 +11,41 @@ layout(set = 2, binding = 2, rgba32f) uniform image2D uColorVariance;
 
 layout(push_constant) uniform ShaderData
 {
-	uint pRayCount;
-	uint pActiveBuffer;
+	uint pPixelCount;
+	uint pTileWidth;
 };
 
-uint ActiveBufferIndex(uint index)
-{
-	return pRayCount * pActiveBuffer + index;
-}
-
-uint InactiveBufferIndex(uint index)
-{
-	return pRayCount * (1 - pActiveBuffer) + index;
-}
-
+// Resolves the samples accumulated by the path regeneration stage into the running pixel mean
+// The alpha channel of the mean image holds the number of samples averaged so far
 void main()
 {
 	uint GlobalIdx = gl_GlobalInvocationID.x;
 
-	if (GlobalIdx >= pRayCount)
+	if (GlobalIdx >= pPixelCount)
 		return;
 
-	uvec2 Coordinate = sRayInfos[ActiveBufferIndex(GlobalIdx)].ImageCoordinate;
-	vec3 IncomingLight = sRayInfos[ActiveBufferIndex(GlobalIdx)].Luminance.rgb;
+	uvec4 Accumulated = sSampleAccumulator[GlobalIdx];
+	sSampleAccumulator[GlobalIdx] = uvec4(0);
 
-	uint activeIdx = sRays[ActiveBufferIndex(GlobalIdx)].Active;
+	ivec2 Coordinate = ivec2(GlobalIdx % pTileWidth, GlobalIdx / pTileWidth);
 
-	// Add luminances which only hit the skybox or a light src...
-	//if (activeIdx != -3 && activeIdx != -2)
-	if (activeIdx != -3)
-		IncomingLight = vec3(1.0, 0.0, 0.0);
+	vec4 Existing = imageLoad(uColorMean, Coordinate);
 
-	vec3 ExistingColor = imageLoad(uColorMean, ivec2(Coordinate)).rgb;
+	// First frame after a reset discards the history
+	float PrevCount = uSceneInfo.FrameCount == 1 ? 0.0 : Existing.a;
+	vec3 PrevSum = uSceneInfo.FrameCount == 1 ? vec3(0.0) : Existing.rgb * PrevCount;
 
-	vec3 Delta = IncomingLight - ExistingColor;
-	vec3 Color = ExistingColor + Delta / uSceneInfo.FrameCount;
+	float SampleCount = PrevCount + float(Accumulated.a);
+
+	if (SampleCount == 0.0)
+	{
+		imageStore(uColorMean, Coordinate, vec4(0.0));
+		imageStore(uImageOutput, Coordinate, vec4(0.0, 0.0, 0.0, 1.0));
+		return;
+	}
 
-	//Color = vec3(1.0);
+	vec3 Color = (PrevSum + vec3(Accumulated.rgb) / SAMPLE_ACCUMULATION_SCALE) / SampleCount;
 
-	imageStore(uColorMean, ivec2(Coordinate), vec4(Color, 1.0));
-	imageStore(uImageOutput, ivec2(Coordinate), vec4(Color, 1.0));
+	imageStore(uColorMean, Coordinate, vec4(Color, SampleCount));
+	imageStore(uImageOutput, Coordinate, vec4(Color, 1.0));
 }
@@ -0,0 +1,77 @@
+#ifndef MOTION_GLSL
+#define MOTION_GLSL
+
+// Motion blur helpers shared by the traversal kernels and the material passes
+// Moving meshes keep their vertices and BVHs in object space; rays are brought into it
+// with the transform interpolated at their shutter time, hits are taken back to world space
+
+struct MotionFrame
+{
+	vec4 Rotation;
+	vec3 Translation;
+	vec3 Scale;
+};
+
+vec4 SlerpQuaternion(in vec4 a, in vec4 b, float t)
+{
+	float CosTheta = dot(a, b);
+
+	// Going the short way around
+	b = CosTheta < 0.0 ? -b : b;
+	CosTheta = abs(CosTheta);
+
+	// Nearly parallel, a plain lerp is accurate enough and avoids the division
+	if (CosTheta > 0.9995)
+		return normalize(mix(a, b, t));
+
+	float Theta = acos(CosTheta);
+	float SinTheta = sin(Theta);
+
+	return (sin((1.0 - t) * Theta) * a + sin(t * Theta) * b) / SinTheta;
+}
+
+vec3 RotateVector(in vec4 q, in vec3 v)
+{
+	vec3 u = cross(q.xyz, v) * 2.0;
+	return v + q.w * u + cross(q.xyz, u);
+}
+
+vec4 ConjugateQuaternion(in vec4 q)
+{
+	return vec4(-q.xyz, q.w);
+}
+
+MotionFrame GetMotionFrame(in InstanceMotion motion, float time)
+{
+	MotionFrame frame;
+	frame.Rotation = SlerpQuaternion(motion.StartRotation, motion.EndRotation, time);
+	frame.Translation = mix(motion.StartTranslation, motion.EndTranslation, time);
+	frame.Scale = mix(motion.StartScale, motion.EndScale, time);
+
+	return frame;
+}
+
+// The direction isn't normalized, so the ray parameter of a hit is the same in both spaces
+Ray ToObjectSpace(in Ray ray, in MotionFrame frame)
+{
+	vec4 Inverse = ConjugateQuaternion(frame.Rotation);
+
+	Ray objectRay = ray;
+	objectRay.Origin = RotateVector(Inverse, ray.Origin - frame.Translation) / frame.Scale;
+	objectRay.Direction = RotateVector(Inverse, ray.Direction) / frame.Scale;
+
+	return objectRay;
+}
+
+// Normals go through the inverse transpose, i.e. the rotation and the reciprocal scale
+vec3 NormalToWorld(in vec3 normal, in MotionFrame frame)
+{
+	return normalize(RotateVector(frame.Rotation, normal / frame.Scale));
+}
+
+vec3 DirectionToWorld(in vec3 direction, in MotionFrame frame)
+{
+	return RotateVector(frame.Rotation, direction * frame.Scale);
+}
+
+#endif
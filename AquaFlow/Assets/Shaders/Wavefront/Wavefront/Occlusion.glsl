@@ -0,0 +1,41 @@
+#version 440
+
+/*
+	Any hit counterpart of Intersection.glsl
+
+	* Runs over the shadow rays written by the material passes of the current bounce
+	* Traversal stops at the first blocker, nothing but a single bit per slot is written
+	* The regeneration pass consumes the mask and clears it for the next bounce
+*/
+
+layout(local_size_x = WORKGROUP_SIZE) in;
+
+#define STACK_SIZE 64
+
+#include "DescSet0.glsl"
+#include "DescSet1.glsl"
+#include "Traversal.glsl"
+
+void main()
+{
+	uint GlobalIdx = gl_GlobalInvocationID.x;
+
+	// Shadow rays share the slots of the live paths
+	if (GlobalIdx >= sPathQueue.ActiveCount)
+		return;
+
+	ShadowRay shadowRay = sShadowRays[GlobalIdx];
+
+	if (shadowRay.MaxDistance <= 0.0)
+		return;
+
+	Ray ray;
+	ray.Origin = shadowRay.Origin;
+	ray.Direction = shadowRay.Direction;
+
+	// Shortened so that the emitter at the end of the segment doesn't block itself
+	float MaxDistance = shadowRay.MaxDistance * (1.0 - TOLERANCE) - TOLERANCE;
+
+	if (IsOccluded(ray, MaxDistance, shadowRay.Time))
+		atomicOr(sOcclusionMask[GlobalIdx / 32], 1u << (GlobalIdx % 32));
+}
@@ -0,0 +1,35 @@
+#version 460
+
+#extension GL_EXT_ray_query : require
+
+// Any hit kernel of the ray query backend, a drop in replacement for Occlusion.glsl
+
+layout(local_size_x = WORKGROUP_SIZE) in;
+
+#include "DescSet0.glsl"
+#include "DescSet1.glsl"
+#include "RayQuery.glsl"
+
+void main()
+{
+	uint GlobalIdx = gl_GlobalInvocationID.x;
+
+	// Shadow rays share the slots of the live paths
+	if (GlobalIdx >= sPathQueue.ActiveCount)
+		return;
+
+	ShadowRay shadowRay = sShadowRays[GlobalIdx];
+
+	if (shadowRay.MaxDistance <= 0.0)
+		return;
+
+	Ray ray;
+	ray.Origin = shadowRay.Origin;
+	ray.Direction = shadowRay.Direction;
+
+	// Shortened so that the emitter at the end of the segment doesn't block itself
+	float MaxDistance = shadowRay.MaxDistance * (1.0 - TOLERANCE) - TOLERANCE;
+
+	if (TraceAnyHit(ray, MaxDistance))
+		atomicOr(sOcclusionMask[GlobalIdx / 32], 1u << (GlobalIdx % 32));
+}
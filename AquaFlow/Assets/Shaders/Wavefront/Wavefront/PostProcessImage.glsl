@@ -2,14 +2,21 @@
 
 layout(local_size_x = WORKGROUP_SIZE_X, local_size_y = WORKGROUP_SIZE_Y) in;
 
-layout(set = 0, binding = 0, rgba8) uniform image2D uImageOutput;
+layout(set = 0, binding = 0, rgba8) uniform writeonly image2D uImageOutput;
+layout(set = 0, binding = 1, rgba32f) uniform readonly image2D uColorMean;
+
+// Adapted to the pixel mean by the auto exposure pass, never leaves the GPU
+layout(std430, set = 0, binding = 2) readonly buffer ExposureState
+{
+	float sExposure;
+	float sAdaptedLuminance;
+};
 
 layout(push_constant) uniform ShaderData
 {
 	uint pImageX;
 	uint pImageY;
 	uint pPostProcessKey;
-	uint pExposure;
 };
 
 // Post-processing...
@@ -34,7 +41,7 @@ vec3 GammaCorrectionInv(in vec3 color)
 void ApplyPostProcess(inout vec3 Color)
 {
 	if ((pPostProcessKey & APPLY_TONE_MAP) != 0)
-		Color = ToneMap(Color, pExposure);
+		Color = ToneMap(Color, sExposure);
 
 	if ((pPostProcessKey & APPLY_GAMMA_CORRECTION) != 0)
 		Color = GammaCorrection(Color);
@@ -50,11 +57,9 @@ void main()
 	if (Position.x >= pImageX || Position.y >= pImageY)
 		return;
 
-	vec3 Color = imageLoad(uImageOutput, ivec2(Position)).rgb;
+	vec3 Color = imageLoad(uColorMean, ivec2(Position)).rgb;
 
 	ApplyPostProcess(Color);
 
-	Color = vec3(0.2);
-
 	imageStore(uImageOutput, ivec2(Position), vec4(Color, 1.0));
 }
@@ -22,7 +22,8 @@ void main()
 {
 	uint GlobalIdx = gl_GlobalInvocationID.x;
 
-	if (GlobalIdx >= pRayCount)
+	// Only the compacted live paths take part in the sort
+	if (GlobalIdx >= sPathQueue.ActiveCount)
 		return;
 
 	uint InactiveBuffer = 1 - pActiveBuffer;
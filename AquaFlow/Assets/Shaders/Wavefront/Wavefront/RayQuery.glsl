@@ -0,0 +1,72 @@
+#ifndef RAY_QUERY_GLSL
+#define RAY_QUERY_GLSL
+
+// Hardware counterpart of Traversal.glsl, traces the acceleration structures built from the session geometry
+// Every mesh and light source is an instance of the top level structure; its custom index holds
+// the offset of its faces in sFaces, so the committed face is the same one the compute path would find
+// The including shader must enable GL_EXT_ray_query right after the version directive
+
+layout(set = 1, binding = 11) uniform accelerationStructureEXT uTopLevel;
+
+uint GetCommittedFace(rayQueryEXT rayQuery)
+{
+	return rayQueryGetIntersectionInstanceCustomIndexEXT(rayQuery, true) +
+		rayQueryGetIntersectionPrimitiveIndexEXT(rayQuery, true);
+}
+
+bool TraceClosestHit(inout CollisionInfo closestHit, in Ray ray)
+{
+	rayQueryEXT rayQuery;
+
+	rayQueryInitializeEXT(rayQuery, uTopLevel, gl_RayFlagsOpaqueEXT, 0xff,
+		ray.Origin, 0.0, ray.Direction, MAX_DIS);
+
+	// All the geometry is opaque, there are no candidates to confirm
+	while (rayQueryProceedEXT(rayQuery)) {}
+
+	if (rayQueryGetIntersectionTypeEXT(rayQuery, true) == gl_RayQueryCommittedIntersectionNoneEXT)
+		return false;
+
+	uint faceIdx = GetCommittedFace(rayQuery);
+	Face face = sFaces[faceIdx];
+
+	vec3 A = sPositions[face.Indices.x];
+	vec3 B = sPositions[face.Indices.y];
+	vec3 C = sPositions[face.Indices.z];
+
+	// Same conventions as CheckRayTriangleCollision; the hardware barycentrics weigh B and C
+	vec2 barycentrics = rayQueryGetIntersectionBarycentricsEXT(rayQuery, true);
+	vec3 Normal = normalize(cross(B - A, C - A));
+
+	closestHit.RayDis = rayQueryGetIntersectionTEXT(rayQuery, true);
+	closestHit.IntersectionPoint = ray.Origin + closestHit.RayDis * ray.Direction;
+	closestHit.bCoords = vec3(1.0 - barycentrics.x - barycentrics.y, barycentrics.x, barycentrics.y);
+
+	closestHit.NormalInverted = dot(Normal, ray.Direction) < 0.0 ? 1.0 : -1.0;
+	closestHit.Normal = Normal * closestHit.NormalInverted;
+
+	closestHit.PrimitiveID = faceIdx;
+	closestHit.MaterialIndex = face.MaterialRef;
+
+	closestHit.HitOccured = true;
+	closestHit.IsLightSrc = face.FaceID == LIGHT_FACE_ID;
+
+	return true;
+}
+
+bool TraceAnyHit(in Ray ray, float maxDis)
+{
+	if (maxDis <= 0.0)
+		return false;
+
+	rayQueryEXT rayQuery;
+
+	rayQueryInitializeEXT(rayQuery, uTopLevel, gl_RayFlagsOpaqueEXT | gl_RayFlagsTerminateOnFirstHitEXT,
+		0xff, ray.Origin, 0.0, ray.Direction, maxDis);
+
+	while (rayQueryProceedEXT(rayQuery)) {}
+
+	return rayQueryGetIntersectionTypeEXT(rayQuery, true) != gl_RayQueryCommittedIntersectionNoneEXT;
+}
+
+#endif
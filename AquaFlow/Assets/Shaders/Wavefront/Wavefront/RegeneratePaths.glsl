@@ -0,0 +1,157 @@
+#version 440
+
+/*
+	Runs after the material passes of every bounce
+	
+	* Finished paths splat their radiance into the sample accumulator
+	* Unoccluded shadow rays of the bounce add their light sample to the pixel of their path
+	* Empty and finished slots are refilled with fresh camera rays until the sample budget runs out
+	* Live paths are compacted into the inactive half of the ray buffers, so the next
+	  intersection and material passes only run over sPathQueue.NextActiveCount slots
+*/
+
+layout(local_size_x = WORKGROUP_SIZE) in;
+
+#include "DescSet0.glsl"
+#include "DescSet1.glsl"
+#include "Random.glsl"
+#include "CameraRays.glsl"
+
+layout(push_constant) uniform RegenerationData
+{
+	mat4 pViewMatrix;
+	uint pRNG_Seed;
+	uint pRayCount;
+	uint pActiveBuffer;
+	uint pMaxBounceLimit;
+};
+
+uint ActiveBufferIndex(uint index)
+{
+	return pRayCount * pActiveBuffer + index;
+}
+
+uint InactiveBufferIndex(uint index)
+{
+	return pRayCount * (1 - pActiveBuffer) + index;
+}
+
+uint GetTilePixelCount()
+{
+	ivec2 TileSize = uSceneInfo.MaxBound - uSceneInfo.MinBound;
+	return uint(TileSize.x * TileSize.y);
+}
+
+void SplatRadiance(in uvec2 imageCoordinate, in vec3 radiance, uint sampleCount)
+{
+	uvec3 FixedRadiance = uvec3(clamp(radiance, vec3(0.0), vec3(MAX_SAMPLE_RADIANCE)) *
+		SAMPLE_ACCUMULATION_SCALE + 0.5);
+
+	ivec2 TileSize = uSceneInfo.MaxBound - uSceneInfo.MinBound;
+	uint PixelIdx = imageCoordinate.y * TileSize.x + imageCoordinate.x;
+
+	atomicAdd(sSampleAccumulator[PixelIdx].r, FixedRadiance.r);
+	atomicAdd(sSampleAccumulator[PixelIdx].g, FixedRadiance.g);
+	atomicAdd(sSampleAccumulator[PixelIdx].b, FixedRadiance.b);
+	atomicAdd(sSampleAccumulator[PixelIdx].a, sampleCount);
+}
+
+void AccumulateSample(in Ray ray, in RayInfo rayInfo)
+{
+	// Only the paths which hit a light src or escaped into the sky carry any radiance
+	vec3 Radiance = vec3(0.0);
+
+	if (ray.Active == -3 && (rayInfo.Flags & PATH_FLAG_SAMPLED_LIGHTS) == 0u)
+		Radiance = rayInfo.Luminance.rgb;
+
+	if (ray.Active == -2 && (rayInfo.Flags & PATH_FLAG_SAMPLED_ENVIRONMENT) == 0u)
+		Radiance = rayInfo.Luminance.rgb;
+
+	SplatRadiance(rayInfo.ImageCoordinate, Radiance, 1);
+}
+
+// Adds the light sampled by the last material pass if the occlusion pass found the segment clear
+// The slot is emptied either way; the sample itself is counted when the path retires
+void ResolveShadowRay(uint slot, in uvec2 imageCoordinate)
+{
+	if (sShadowRays[slot].MaxDistance <= 0.0)
+		return;
+
+	uint Bit = 1u << (slot % 32);
+	bool Occluded = (sOcclusionMask[slot / 32] & Bit) != 0u;
+
+	if (!Occluded)
+		SplatRadiance(imageCoordinate, sShadowRays[slot].Radiance.rgb, 0);
+
+	sShadowRays[slot].MaxDistance = 0.0;
+
+	if (Occluded)
+		atomicAnd(sOcclusionMask[slot / 32], ~Bit);
+}
+
+bool RegeneratePath(out Ray ray, out RayInfo rayInfo)
+{
+	uint SampleIdx = atomicAdd(sPathQueue.SampleCounter, 1);
+
+	if (SampleIdx >= sPathQueue.SampleBudget)
+		return false;
+
+	// Consecutive samples walk over the tile, one pixel after another
+	ivec2 TileSize = uSceneInfo.MaxBound - uSceneInfo.MinBound;
+	uint PixelIdx = SampleIdx % GetTilePixelCount();
+
+	uvec2 Position = uvec2(PixelIdx % TileSize.x, PixelIdx / TileSize.x);
+	ivec2 PositionOnImage = uSceneInfo.MinBound + ivec2(Position);
+
+	uint Seed = SampleIdx ^ pRNG_Seed;
+	GetRandom(Seed);
+
+	if (Seed == 0)
+		Seed = 87129283;
+
+	ray = CreateCameraRay(GetFilmCoordinates(PositionOnImage), GetPhysicalCamera(), pViewMatrix, Seed);
+	rayInfo = CreateCameraRayInfo(Position, Seed);
+
+	return true;
+}
+
+void main()
+{
+	uint GlobalIdx = gl_GlobalInvocationID.x;
+
+	if (GlobalIdx >= pRayCount)
+		return;
+
+	Ray ray;
+	RayInfo rayInfo;
+
+	// Slots past the active count were freed by an earlier pass
+	bool Alive = false;
+
+	if (GlobalIdx < sPathQueue.ActiveCount)
+	{
+		ray = sRays[ActiveBufferIndex(GlobalIdx)];
+		rayInfo = sRayInfos[ActiveBufferIndex(GlobalIdx)];
+
+		ResolveShadowRay(GlobalIdx, rayInfo.ImageCoordinate);
+
+		rayInfo.Depth++;
+
+		// Paths running out of bounces are retired without contributing anything
+		Alive = ray.Active == 0 && rayInfo.Depth < pMaxBounceLimit;
+
+		if (!Alive)
+			AccumulateSample(ray, rayInfo);
+	}
+
+	if (!Alive)
+		Alive = RegeneratePath(ray, rayInfo);
+
+	if (!Alive)
+		return;
+
+	uint Slot = atomicAdd(sPathQueue.NextActiveCount, 1);
+
+	sRays[InactiveBufferIndex(Slot)] = ray;
+	sRayInfos[InactiveBufferIndex(Slot)] = rayInfo;
+}
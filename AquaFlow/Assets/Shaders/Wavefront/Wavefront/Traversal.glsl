@@ -0,0 +1,443 @@
+#ifndef TRAVERSAL_GLSL
+#define TRAVERSAL_GLSL
+
+// BVH traversal shared by the closest hit (Intersection.glsl) and the any hit (Occlusion.glsl) kernels
+// Expects the sNodes/sWideNodes, sFaces and sPositions buffers of DescSet1.glsl
+// and sInstanceMotions when MOTION_BLUR is set
+
+#include "Motion.glsl"
+
+struct AABB_CollisionInfo
+{
+	bool HitOccured;
+	float RayDis;
+};
+
+void SwapWithCondition(inout float a, inout float b, bool condition)
+{
+	float Temp = b;
+	b = condition ? a : b;
+	a = condition ? Temp : a;
+}
+
+void CheckRayTriangleCollision(inout CollisionInfo hitInfo, in Ray ray, in vec3 A, in vec3 B, in vec3 C)
+{
+	hitInfo.HitOccured = false;
+
+	vec3 E1 = B - A;
+	vec3 E2 = C - A;
+
+	// Normal, Determinant and the ray dis calculation
+	vec3 Normal = normalize(cross(E1, E2));
+
+	vec3 H = cross(ray.Direction, E2);
+	float Determinant = dot(E1, H);
+
+	float DeterminantInv = 1.0 / Determinant;
+
+	vec3 T = ray.Origin - A;
+	vec3 Q = cross(T, E1);
+	float Alpha = dot(E2, Q) * DeterminantInv;
+
+	// Calculate barycentric coords
+	vec3 bCoords;
+
+	bCoords.g = dot(T, H) * DeterminantInv;
+	bCoords.b = dot(ray.Direction, Q) * DeterminantInv;
+	bCoords.r = 1.0 - bCoords.b - bCoords.g;
+
+	// Prepare the HitInfo buffer
+	hitInfo.bCoords = bCoords;
+	hitInfo.IntersectionPoint = ray.Origin + Alpha * ray.Direction;
+	hitInfo.Normal = Normal;
+	hitInfo.RayDis = Alpha;
+
+	hitInfo.HitOccured = (bCoords.x >= 0.0 && bCoords.y >= 0.0 && bCoords.z >= 0.0) &&
+		Alpha > 0.0 && abs(Determinant) > TOLERANCE;
+
+	hitInfo.NormalInverted = dot(Normal, ray.Direction) < 0 ? 1.0 : -1.0;
+	hitInfo.Normal *= hitInfo.NormalInverted;
+}
+
+void CheckRayAABB_Collision(inout AABB_CollisionInfo hitInfo,
+	in Ray ray, in vec3 minCorner, in vec3 maxCorner)
+{
+	hitInfo.HitOccured = false;
+
+	float tMin = (minCorner.x - ray.Origin.x) / ray.Direction.x;
+	float tMax = (maxCorner.x - ray.Origin.x) / ray.Direction.x;
+
+	SwapWithCondition(tMin, tMax, tMin > tMax);
+
+	float tyMin = (minCorner.y - ray.Origin.y) / ray.Direction.y;
+	float tyMax = (maxCorner.y - ray.Origin.y) / ray.Direction.y;
+
+	SwapWithCondition(tyMin, tyMax, tyMin > tyMax);
+
+	float txMin = tMin;
+	float txMax = tMax;
+
+	tMin = max(tMin, tyMin);
+	tMax = min(tMax, tyMax);
+
+	float tzMin = (minCorner.z - ray.Origin.z) / ray.Direction.z;
+	float tzMax = (maxCorner.z - ray.Origin.z) / ray.Direction.z;
+
+	SwapWithCondition(tzMin, tzMax, tzMin > tzMax);
+
+	tMin = max(tMin, tzMin);
+	tMax = min(tMax, tzMax);
+
+	hitInfo.HitOccured =
+		(tMin < tzMax) && (tzMin < tMax) &&
+		(tMin < tyMax) && (tyMin < tMax) &&
+		((tMin < tMax) && (tMax > 0.0));
+
+	hitInfo.RayDis = tMin > 0.0 ? tMin : 0.0;
+}
+
+#if !WIDE_BVH
+bool FindCollisionNode(inout CollisionInfo ClosestHit, in Ray ray, in uint rootIndex)
+{
+	bool FoundCloser = false;
+
+	CollisionInfo hitInfo;
+
+	AABB_CollisionInfo hitInfoAABB;
+
+	uint NodeStackIndices[STACK_SIZE];
+	uint StackPtr = 0;
+
+	NodeStackIndices[StackPtr++] = rootIndex;
+
+	while (StackPtr != 0)
+	{
+		uint CurrentIndex = NodeStackIndices[--StackPtr];
+
+		CheckRayAABB_Collision(hitInfoAABB, ray,
+			sNodes[CurrentIndex].MinBound, sNodes[CurrentIndex].MaxBound);
+
+		NodeStackIndices[StackPtr++] = sNodes[CurrentIndex].FirstChildIndex;
+		NodeStackIndices[StackPtr++] = sNodes[CurrentIndex].SecondChildIndex;
+
+		bool Revert = !hitInfoAABB.HitOccured || hitInfoAABB.RayDis > ClosestHit.RayDis ||
+			sNodes[CurrentIndex].FirstChildIndex == rootIndex;
+
+		StackPtr -= Revert ? 2 : 0;
+
+		if (sNodes[CurrentIndex].FirstChildIndex == rootIndex && hitInfoAABB.HitOccured)
+		{
+			for (uint j = sNodes[CurrentIndex].BeginIndex;
+				j < sNodes[CurrentIndex].EndIndex; j++)
+			{
+				CheckRayTriangleCollision(hitInfo, ray,
+					sPositions[sFaces[j].Indices.x],
+					sPositions[sFaces[j].Indices.y],
+					sPositions[sFaces[j].Indices.z]);
+
+				hitInfo.PrimitiveID = j;
+				hitInfo.MaterialIndex = sFaces[j].MaterialRef;
+
+				bool Replaced = hitInfo.HitOccured &&
+					(hitInfo.RayDis < ClosestHit.RayDis);
+
+				FoundCloser = FoundCloser || Replaced;
+
+				ClosestHit = Replaced ? hitInfo : ClosestHit;
+			}
+		}
+	}
+
+	return FoundCloser;
+}
+#endif
+
+bool TestFaceRange(inout CollisionInfo ClosestHit, in Ray ray, uint begin, uint end)
+{
+	bool FoundCloser = false;
+
+	CollisionInfo hitInfo;
+
+	for (uint j = begin; j < end; j++)
+	{
+		CheckRayTriangleCollision(hitInfo, ray,
+			sPositions[sFaces[j].Indices.x],
+			sPositions[sFaces[j].Indices.y],
+			sPositions[sFaces[j].Indices.z]);
+
+		hitInfo.PrimitiveID = j;
+		hitInfo.MaterialIndex = sFaces[j].MaterialRef;
+
+		bool Replaced = hitInfo.HitOccured &&
+			(hitInfo.RayDis < ClosestHit.RayDis);
+
+		FoundCloser = FoundCloser || Replaced;
+
+		ClosestHit = Replaced ? hitInfo : ClosestHit;
+	}
+
+	return FoundCloser;
+}
+
+uint UnpackQuantized(uint packed, uint axis)
+{
+	return (packed >> (8 * axis)) & 0xffu;
+}
+
+vec3 GetWideNodeScale(in WideNode node)
+{
+	return vec3(
+		exp2(float(int(UnpackQuantized(node.Exponents, 0)) - 127)),
+		exp2(float(int(UnpackQuantized(node.Exponents, 1)) - 127)),
+		exp2(float(int(UnpackQuantized(node.Exponents, 2)) - 127)));
+}
+
+bool FindCollisionWideNode(inout CollisionInfo ClosestHit, in Ray ray, in uint rootIndex)
+{
+	bool FoundCloser = false;
+
+	AABB_CollisionInfo hitInfoAABB;
+
+	uint NodeStackIndices[STACK_SIZE];
+	float NodeStackDistances[STACK_SIZE];
+	uint StackPtr = 0;
+
+	NodeStackIndices[StackPtr] = rootIndex;
+	NodeStackDistances[StackPtr++] = 0.0;
+
+	while (StackPtr != 0)
+	{
+		--StackPtr;
+
+		// The closest hit might have moved since this node was pushed
+		if (NodeStackDistances[StackPtr] > ClosestHit.RayDis)
+			continue;
+
+		WideNode node = sWideNodes[NodeStackIndices[StackPtr]];
+		vec3 scale = GetWideNodeScale(node);
+
+		uint InteriorIndices[4];
+		float InteriorDistances[4];
+		uint InteriorCount = 0;
+
+		for (uint i = 0; i < 4; i++)
+		{
+			if (node.ChildIndex[i] == WIDE_BVH_INVALID_CHILD)
+				continue;
+
+			vec3 qMin = vec3(UnpackQuantized(node.QuantizedMin[i], 0),
+				UnpackQuantized(node.QuantizedMin[i], 1), UnpackQuantized(node.QuantizedMin[i], 2));
+
+			vec3 qMax = vec3(UnpackQuantized(node.QuantizedMax[i], 0),
+				UnpackQuantized(node.QuantizedMax[i], 1), UnpackQuantized(node.QuantizedMax[i], 2));
+
+			CheckRayAABB_Collision(hitInfoAABB, ray,
+				node.Origin + qMin * scale, node.Origin + qMax * scale);
+
+			if (!hitInfoAABB.HitOccured || hitInfoAABB.RayDis > ClosestHit.RayDis)
+				continue;
+
+			// Leaves are tested right away, they don't need another node fetch
+			if (node.ChildFaceCount[i] != 0)
+			{
+				bool Replaced = TestFaceRange(ClosestHit, ray, node.ChildIndex[i],
+					node.ChildIndex[i] + node.ChildFaceCount[i]);
+
+				FoundCloser = FoundCloser || Replaced;
+				continue;
+			}
+
+			// Insertion sort so that the nearest child is pushed last
+			uint Slot = InteriorCount++;
+
+			while (Slot > 0 && InteriorDistances[Slot - 1] < hitInfoAABB.RayDis)
+			{
+				InteriorIndices[Slot] = InteriorIndices[Slot - 1];
+				InteriorDistances[Slot] = InteriorDistances[Slot - 1];
+				Slot--;
+			}
+
+			InteriorIndices[Slot] = node.ChildIndex[i];
+			InteriorDistances[Slot] = hitInfoAABB.RayDis;
+		}
+
+		for (uint i = 0; i < InteriorCount; i++)
+		{
+			NodeStackIndices[StackPtr] = InteriorIndices[i];
+			NodeStackDistances[StackPtr++] = InteriorDistances[i];
+		}
+	}
+
+	return FoundCloser;
+}
+
+bool FindClosestCollision(inout CollisionInfo ClosestHit, in Ray ray, in uint rootIndex, in uint wideRootIndex)
+{
+#if WIDE_BVH
+	return FindCollisionWideNode(ClosestHit, ray, wideRootIndex);
+#else
+	return FindCollisionNode(ClosestHit, ray, rootIndex);
+#endif
+}
+
+// Any hit variants; they only answer whether something lies within maxDis and bail out on the first hit
+
+bool CheckRayTriangleOcclusion(in Ray ray, in vec3 A, in vec3 B, in vec3 C, float maxDis)
+{
+	vec3 E1 = B - A;
+	vec3 E2 = C - A;
+
+	vec3 H = cross(ray.Direction, E2);
+	float Determinant = dot(E1, H);
+
+	if (abs(Determinant) <= TOLERANCE)
+		return false;
+
+	float DeterminantInv = 1.0 / Determinant;
+
+	vec3 T = ray.Origin - A;
+	float u = dot(T, H) * DeterminantInv;
+
+	vec3 Q = cross(T, E1);
+	float v = dot(ray.Direction, Q) * DeterminantInv;
+
+	float Alpha = dot(E2, Q) * DeterminantInv;
+
+	return u >= 0.0 && v >= 0.0 && u + v <= 1.0 && Alpha > 0.0 && Alpha < maxDis;
+}
+
+bool TestFaceRangeAnyHit(in Ray ray, uint begin, uint end, float maxDis)
+{
+	for (uint j = begin; j < end; j++)
+	{
+		if (CheckRayTriangleOcclusion(ray,
+			sPositions[sFaces[j].Indices.x],
+			sPositions[sFaces[j].Indices.y],
+			sPositions[sFaces[j].Indices.z], maxDis))
+			return true;
+	}
+
+	return false;
+}
+
+#if !WIDE_BVH
+bool FindAnyCollisionNode(in Ray ray, in uint rootIndex, float maxDis)
+{
+	AABB_CollisionInfo hitInfoAABB;
+
+	uint NodeStackIndices[STACK_SIZE];
+	uint StackPtr = 0;
+
+	NodeStackIndices[StackPtr++] = rootIndex;
+
+	while (StackPtr != 0)
+	{
+		uint CurrentIndex = NodeStackIndices[--StackPtr];
+
+		CheckRayAABB_Collision(hitInfoAABB, ray,
+			sNodes[CurrentIndex].MinBound, sNodes[CurrentIndex].MaxBound);
+
+		if (!hitInfoAABB.HitOccured || hitInfoAABB.RayDis > maxDis)
+			continue;
+
+		if (sNodes[CurrentIndex].FirstChildIndex == rootIndex)
+		{
+			if (TestFaceRangeAnyHit(ray, sNodes[CurrentIndex].BeginIndex,
+				sNodes[CurrentIndex].EndIndex, maxDis))
+				return true;
+
+			continue;
+		}
+
+		NodeStackIndices[StackPtr++] = sNodes[CurrentIndex].FirstChildIndex;
+		NodeStackIndices[StackPtr++] = sNodes[CurrentIndex].SecondChildIndex;
+	}
+
+	return false;
+}
+#endif
+
+bool FindAnyCollisionWideNode(in Ray ray, in uint rootIndex, float maxDis)
+{
+	AABB_CollisionInfo hitInfoAABB;
+
+	uint NodeStackIndices[STACK_SIZE];
+	uint StackPtr = 0;
+
+	NodeStackIndices[StackPtr++] = rootIndex;
+
+	while (StackPtr != 0)
+	{
+		WideNode node = sWideNodes[NodeStackIndices[--StackPtr]];
+		vec3 scale = GetWideNodeScale(node);
+
+		// No ordering here, any blocker will do
+		for (uint i = 0; i < 4; i++)
+		{
+			if (node.ChildIndex[i] == WIDE_BVH_INVALID_CHILD)
+				continue;
+
+			vec3 qMin = vec3(UnpackQuantized(node.QuantizedMin[i], 0),
+				UnpackQuantized(node.QuantizedMin[i], 1), UnpackQuantized(node.QuantizedMin[i], 2));
+
+			vec3 qMax = vec3(UnpackQuantized(node.QuantizedMax[i], 0),
+				UnpackQuantized(node.QuantizedMax[i], 1), UnpackQuantized(node.QuantizedMax[i], 2));
+
+			CheckRayAABB_Collision(hitInfoAABB, ray,
+				node.Origin + qMin * scale, node.Origin + qMax * scale);
+
+			if (!hitInfoAABB.HitOccured || hitInfoAABB.RayDis > maxDis)
+				continue;
+
+			if (node.ChildFaceCount[i] != 0)
+			{
+				if (TestFaceRangeAnyHit(ray, node.ChildIndex[i],
+					node.ChildIndex[i] + node.ChildFaceCount[i], maxDis))
+					return true;
+
+				continue;
+			}
+
+			NodeStackIndices[StackPtr++] = node.ChildIndex[i];
+		}
+	}
+
+	return false;
+}
+
+bool FindAnyCollision(in Ray ray, in uint rootIndex, in uint wideRootIndex, float maxDis)
+{
+#if WIDE_BVH
+	return FindAnyCollisionWideNode(ray, wideRootIndex, maxDis);
+#else
+	return FindAnyCollisionNode(ray, rootIndex, maxDis);
+#endif
+}
+
+// Tests the segment [0, maxDis) of the ray against every light source and mesh
+// Light sources never move, the meshes are tested at the given shutter time
+bool IsOccluded(in Ray ray, float maxDis, float time)
+{
+	for (uint i = 0; i < uSceneInfo.LightCount; i++)
+	{
+		if (FindAnyCollision(ray, sLightInfos[i].BeginIndex, sLightInfos[i].WideRootIndex, maxDis))
+			return true;
+	}
+
+	for (uint i = 0; i < uSceneInfo.MeshCount; i++)
+	{
+		Ray meshRay = ray;
+
+	#if MOTION_BLUR
+		if (sInstanceMotions[i].Moving != 0)
+			meshRay = ToObjectSpace(ray, GetMotionFrame(sInstanceMotions[i], time));
+	#endif
+
+		if (FindAnyCollision(meshRay, sMeshInfos[i].BeginIndex, sMeshInfos[i].WideRootIndex, maxDis))
+			return true;
+	}
+
+	return false;
+}
+
+#endif
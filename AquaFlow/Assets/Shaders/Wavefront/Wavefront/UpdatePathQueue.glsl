@@ -0,0 +1,44 @@
+#version 440
+
+// Single invocation pass; flips the path queue counters and writes the indirect dispatch arguments
+
+layout(local_size_x = 1) in;
+
+#include "DescSet0.glsl"
+
+layout(push_constant) uniform QueueData
+{
+	uint pPixelCount;
+	uint pSampleGrant; // Non zero grants more samples instead of flipping the counters
+};
+
+uvec4 GetDispatchArgs(uint invocations, uint workGroupSize)
+{
+	return uvec4((invocations + workGroupSize - 1) / workGroupSize, 1, 1, 0);
+}
+
+void main()
+{
+	if (pSampleGrant != 0)
+	{
+		// The counter overshoots the budget when many slots regenerate at once
+		uint Counter = min(sPathQueue.SampleCounter, sPathQueue.SampleBudget);
+
+		sPathQueue.SampleCounter = Counter;
+		sPathQueue.SampleBudget = Counter + pSampleGrant;
+	}
+	else
+	{
+		sPathQueue.ActiveCount = sPathQueue.NextActiveCount;
+		sPathQueue.NextActiveCount = 0;
+
+		sPathQueue.IntersectionDispatch = GetDispatchArgs(sPathQueue.ActiveCount, INTERSECTION_WORKGROUP_SIZE);
+		sPathQueue.MaterialDispatch = GetDispatchArgs(sPathQueue.ActiveCount, MATERIAL_WORKGROUP_SIZE);
+	}
+
+	// Keep the counter from overflowing, the pixel a sample lands on stays the same
+	uint Wrap = (min(sPathQueue.SampleCounter, sPathQueue.SampleBudget) / pPixelCount) * pPixelCount;
+
+	sPathQueue.SampleCounter -= Wrap;
+	sPathQueue.SampleBudget -= Wrap;
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include "PipelineConfig.h"
+
+AQUA_BEGIN
+
+enum class BloomPass : uint32_t
+{
+	eDownsample        = 0, // 13 tap filter of the level above, the HDR image for level zero
+	eUpsample          = 1, // adds the tent filtered level below onto its own
+	eComposite         = 2, // blends level zero into a copy of the HDR image
+};
+
+// Runs the whole bloom chain, one dispatch per level in each direction and one for the composite
+class BloomPipeline : public vkLib::ComputePipeline
+{
+public:
+	BloomPipeline() = default;
+	BloomPipeline(vkLib::PShader shader);
+
+	virtual ~BloomPipeline() = default;
+
+	virtual void UpdateDescriptors();
+
+	void operator()(vk::CommandBuffer cmd, const BloomInfo& info) const;
+
+	void SetInfo(vkLib::Buffer<BloomInfo> info) { mInfo = info; }
+	void SetSource(vkLib::ImageView source, vkLib::Core::Ref<vk::Sampler> sampler)
+	{ mSource = source; mSampler = sampler; }
+
+	void SetChain(vkLib::Buffer<glm::vec4> chain) { mChain = chain; }
+	void SetTarget(vkLib::ImageView target) { mTarget = target; }
+
+	vkLib::ImageView GetSource() const { return mSource; }
+
+private:
+	vkLib::Buffer<BloomInfo> mInfo; // Bound at (set: 0, binding: 0)
+
+	vkLib::ImageView mSource; // (set: 0, binding: 1)
+	vkLib::Core::Ref<vk::Sampler> mSampler;
+
+	vkLib::Buffer<glm::vec4> mChain; // (set: 0, binding: 2)
+	vkLib::ImageView mTarget; // (set: 0, binding: 3)
+};
+
+AQUA_END
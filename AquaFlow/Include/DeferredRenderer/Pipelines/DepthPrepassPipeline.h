@@ -0,0 +1,26 @@
+#pragma once
+#include "ShadowPipeline.h"
+
+AQUA_BEGIN
+
+// Lays down the scene depth ahead of the geometry buffer, so the expensive attachments
+// are only written once per pixel. Same position stream and state as the shadow pass,
+// but seen through the main camera
+class DepthPrepassPipeline : public ShadowPipeline
+{
+public:
+	DepthPrepassPipeline() = default;
+	DepthPrepassPipeline(vkLib::PShader shader, vkLib::Framebuffer depthBuffer)
+		: ShadowPipeline(shader, depthBuffer, GetPositionBindings()) {}
+
+	virtual ~DepthPrepassPipeline() = default;
+
+	virtual void UpdateDescriptors() override;
+
+	void SetCamera(CameraBuf camera) { mCamera = camera; }
+
+private:
+	mutable CameraBuf mCamera; // Bound at (set: 0, binding: 0)
+};
+
+AQUA_END
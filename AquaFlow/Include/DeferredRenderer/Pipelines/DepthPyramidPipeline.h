@@ -0,0 +1,35 @@
+#pragma once
+#include "PipelineConfig.h"
+
+AQUA_BEGIN
+
+// Reduces the depth buffer into a chain of ever smaller levels, one dispatch per level
+class DepthPyramidPipeline : public vkLib::ComputePipeline
+{
+public:
+	DepthPyramidPipeline() = default;
+	DepthPyramidPipeline(vkLib::PShader shader);
+
+	virtual ~DepthPyramidPipeline() = default;
+
+	virtual void UpdateDescriptors();
+
+	void operator()(vk::CommandBuffer cmd, const DepthPyramidInfo& info) const;
+
+	void SetDepth(vkLib::ImageView depth, vkLib::Core::Ref<vk::Sampler> sampler)
+	{ mDepth = depth; mSampler = sampler; }
+
+	void SetPyramidInfo(vkLib::Buffer<DepthPyramidInfo> info) { mPyramidInfo = info; }
+	void SetPyramid(vkLib::Buffer<float> pyramid) { mPyramid = pyramid; }
+
+	vkLib::ImageView GetDepth() const { return mDepth; }
+
+private:
+	vkLib::ImageView mDepth; // Bound at (set: 0, binding: 0)
+	vkLib::Core::Ref<vk::Sampler> mSampler;
+
+	vkLib::Buffer<DepthPyramidInfo> mPyramidInfo; // (set: 0, binding: 1)
+	vkLib::Buffer<float> mPyramid; // (set: 0, binding: 2)
+};
+
+AQUA_END
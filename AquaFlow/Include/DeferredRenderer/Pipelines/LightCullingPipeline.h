@@ -0,0 +1,34 @@
+#pragma once
+#include "PipelineConfig.h"
+
+AQUA_BEGIN
+
+// Bins the point lights into the view space clusters, one invocation per cluster
+class LightCullingPipeline : public vkLib::ComputePipeline
+{
+public:
+	LightCullingPipeline() = default;
+	LightCullingPipeline(vkLib::PShader shader);
+
+	virtual ~LightCullingPipeline() = default;
+
+	virtual void UpdateDescriptors();
+
+	void operator()(vk::CommandBuffer cmd, uint32_t pointLightCount, uint32_t clusterCount) const;
+
+	void SetCamera(CameraBuf camera) { mCamera = camera; }
+	void SetPointLights(vkLib::Buffer<PointLightSrc> lights) { mPointLights = lights; }
+	void SetClusterInfo(vkLib::Buffer<LightClusterInfo> clusterInfo) { mClusterInfo = clusterInfo; }
+	void SetClusterLights(vkLib::Buffer<uint32_t> counts, vkLib::Buffer<uint32_t> indices)
+	{ mLightCounts = counts; mLightIndices = indices; }
+
+private:
+	CameraBuf mCamera; // Bound at (set: 0, binding: 0)
+	vkLib::Buffer<LightClusterInfo> mClusterInfo; // (set: 0, binding: 1)
+	vkLib::Buffer<PointLightSrc> mPointLights; // (set: 0, binding: 2)
+
+	vkLib::Buffer<uint32_t> mLightCounts; // (set: 0, binding: 3)
+	vkLib::Buffer<uint32_t> mLightIndices; // (set: 0, binding: 4)
+};
+
+AQUA_END
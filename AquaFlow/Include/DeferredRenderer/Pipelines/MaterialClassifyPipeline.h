@@ -0,0 +1,39 @@
+#pragma once
+#include "PipelineConfig.h"
+
+AQUA_BEGIN
+
+// Finds the materials present in every screen tile of the geometry buffer,
+// and appends the tile to the indirect draws of those materials
+class MaterialClassifyPipeline : public vkLib::ComputePipeline
+{
+public:
+	MaterialClassifyPipeline() = default;
+	MaterialClassifyPipeline(vkLib::PShader shader);
+
+	virtual ~MaterialClassifyPipeline() = default;
+
+	virtual void UpdateDescriptors();
+
+	// The draws must have been reset before the dispatch
+	void operator()(vk::CommandBuffer cmd, const glm::uvec2& tileCount) const;
+
+	void SetNormals(vkLib::ImageView normals, vkLib::Core::Ref<vk::Sampler> sampler)
+	{ mNormals = normals; mSampler = sampler; }
+
+	void SetTileInfo(vkLib::Buffer<MaterialTileInfo> tileInfo) { mTileInfo = tileInfo; }
+	void SetDraws(vkLib::Buffer<vk::DrawIndirectCommand> draws) { mDraws = draws; }
+	void SetTiles(vkLib::Buffer<uint32_t> tiles) { mTiles = tiles; }
+
+	vkLib::ImageView GetNormals() const { return mNormals; }
+
+private:
+	vkLib::ImageView mNormals; // Bound at (set: 0, binding: 0), material index sits in w
+	vkLib::Core::Ref<vk::Sampler> mSampler;
+
+	vkLib::Buffer<MaterialTileInfo> mTileInfo; // (set: 0, binding: 1)
+	vkLib::Buffer<vk::DrawIndirectCommand> mDraws; // (set: 0, binding: 2)
+	vkLib::Buffer<uint32_t> mTiles; // (set: 0, binding: 3)
+};
+
+AQUA_END
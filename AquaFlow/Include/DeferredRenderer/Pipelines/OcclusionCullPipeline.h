@@ -0,0 +1,44 @@
+#pragma once
+#include "PipelineConfig.h"
+
+AQUA_BEGIN
+
+enum class OcclusionPhase : uint32_t
+{
+	eEarly             = 0, // draws what was visible last frame
+	eLate              = 1, // tests everything against the depth pyramid of the early draws
+};
+
+// Turns the renderable bounds into the indirect draws of the geometry buffer, one invocation per renderable
+// The early list takes the first half of the draws, the late list the second
+class OcclusionCullPipeline : public vkLib::ComputePipeline
+{
+public:
+	OcclusionCullPipeline() = default;
+	OcclusionCullPipeline(vkLib::PShader shader);
+
+	virtual ~OcclusionCullPipeline() = default;
+
+	virtual void UpdateDescriptors();
+
+	void operator()(vk::CommandBuffer cmd, OcclusionPhase phase, uint32_t candidateCount) const;
+
+	void SetCamera(CameraBuf camera) { mCamera = camera; }
+	void SetPyramid(vkLib::Buffer<DepthPyramidInfo> info, vkLib::Buffer<float> pyramid)
+	{ mPyramidInfo = info; mPyramid = pyramid; }
+
+	void SetCandidates(vkLib::Buffer<OcclusionCandidate> candidates) { mCandidates = candidates; }
+	void SetVisibility(vkLib::Buffer<uint32_t> visibility) { mVisibility = visibility; }
+	void SetDraws(vkLib::Buffer<vk::DrawIndexedIndirectCommand> draws) { mDraws = draws; }
+
+private:
+	CameraBuf mCamera; // Bound at (set: 0, binding: 0)
+	vkLib::Buffer<DepthPyramidInfo> mPyramidInfo; // (set: 0, binding: 1)
+	vkLib::Buffer<float> mPyramid; // (set: 0, binding: 2)
+
+	vkLib::Buffer<OcclusionCandidate> mCandidates; // (set: 0, binding: 3)
+	vkLib::Buffer<uint32_t> mVisibility; // (set: 0, binding: 4)
+	vkLib::Buffer<vk::DrawIndexedIndirectCommand> mDraws; // (set: 0, binding: 5)
+};
+
+AQUA_END
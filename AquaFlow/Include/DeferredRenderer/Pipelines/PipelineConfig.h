@@ -54,6 +54,97 @@ struct PointLightSrc
 	alignas(16) glm::vec4 Intensity;
 	alignas(16) glm::vec4 Color;
 	alignas(8) glm::vec2 DropRate;
+	// Beyond this distance the light is culled away, filled by the environment when left at zero
+	alignas(4) float Radius = 0.0f;
+};
+
+// Shared by the light culling pass and the material shaders
+struct LightClusterInfo
+{
+	alignas(16) glm::uvec4 GridSize; // xyz: cluster count, w: light slots per cluster
+	alignas(8) glm::uvec2 TileSize;
+	alignas(4) float Near;
+	alignas(4) float Far;
+	alignas(8) glm::uvec2 Resolution;
+};
+
+// Screen tiles each deferred material is drawn over, filled by the classification pass
+struct MaterialTileInfo
+{
+	alignas(8) glm::uvec2 TileSize;
+	alignas(8) glm::uvec2 TileCount;
+	alignas(8) glm::uvec2 Resolution;
+	alignas(4) uint32_t MaterialCount;
+	alignas(4) uint32_t TileCapacity; // tile slots per material
+};
+
+#define MAX_SHADOW_CASCADES     8
+
+// Layout of the shadow atlas, every directional light owns a row of cascade tiles
+struct ShadowAtlasInfo
+{
+	// x: far end of the cascade in view depth, y: world size of a cascade texel
+	alignas(16) glm::vec4 Cascades[MAX_SHADOW_CASCADES];
+	alignas(8) glm::uvec2 TileResolution;
+	alignas(8) glm::uvec2 AtlasResolution;
+	alignas(4) uint32_t CascadeCount;
+};
+
+#define MAX_DEPTH_PYRAMID_LEVELS     16
+
+// Every level keeps the farthest depth of the four texels below, level zero is half the screen
+struct DepthPyramidInfo
+{
+	alignas(16) glm::uvec4 Levels[MAX_DEPTH_PYRAMID_LEVELS]; // xy: size, z: offset into the pyramid
+	alignas(8) glm::uvec2 Resolution;
+	alignas(4) uint32_t LevelCount = 0;
+	alignas(4) uint32_t CandidateCount = 0;
+};
+
+// World space bounds of a renderable and its range in the index buffer
+struct OcclusionCandidate
+{
+	alignas(16) glm::vec4 MinBound;
+	alignas(16) glm::vec4 MaxBound;
+	alignas(4) uint32_t FirstIndex;
+	alignas(4) uint32_t IndexCount;
+};
+
+// The ambient occlusion is traced at half the resolution of the shading buffer
+struct SSAOInfo
+{
+	alignas(8) glm::uvec2 Resolution;
+	alignas(8) glm::uvec2 HalfResolution;
+	alignas(4) uint32_t DirectionCount = 8;
+	alignas(4) uint32_t StepCount = 4;
+	alignas(4) float Radius = 0.5f;
+	alignas(4) float Intensity = 1.0f;
+	alignas(4) float DepthSharpness = 32.0f;
+};
+
+#define MAX_BLOOM_LEVELS             8
+
+// Mip chain of the bloom packed into a single buffer, level zero is half the screen
+struct BloomInfo
+{
+	alignas(16) glm::uvec4 Levels[MAX_BLOOM_LEVELS]; // xy: size, z: offset into the chain
+	alignas(16) glm::vec4 Color; // rgb: tint, a: strength
+	alignas(8) glm::uvec2 Resolution;
+	alignas(4) uint32_t LevelCount = 0;
+	alignas(4) float Radius = 1.0f;
+};
+
+// Cameras and sample offsets of two consecutive frames, the jitter is in pixels of the internal resolution
+struct TemporalInfo
+{
+	alignas(16) glm::mat4 ViewProjection; // without the jitter
+	alignas(16) glm::mat4 InvViewProjection;
+	alignas(16) glm::mat4 PrevViewProjection;
+	alignas(8) glm::vec2 Jitter = { 0.0f, 0.0f };
+	alignas(8) glm::uvec2 InternalResolution;
+	alignas(8) glm::uvec2 OutputResolution;
+	alignas(4) float BlendFactor = 0.1f;
+	alignas(4) uint32_t HistoryValid = 0;
 };
 
 using FragmentAttributes = std::vector<VaryingAttribute>;
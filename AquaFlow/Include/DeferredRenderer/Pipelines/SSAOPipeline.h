@@ -0,0 +1,64 @@
+#pragma once
+#include "PipelineConfig.h"
+
+AQUA_BEGIN
+
+// Traces the ambient occlusion of the geometry buffer at half resolution, one invocation per half resolution texel
+// Every texel keeps its occlusion and view depth for the upsample
+class SSAOPipeline : public vkLib::ComputePipeline
+{
+public:
+	SSAOPipeline() = default;
+	SSAOPipeline(vkLib::PShader shader);
+
+	virtual ~SSAOPipeline() = default;
+
+	virtual void UpdateDescriptors();
+
+	void operator()(vk::CommandBuffer cmd, const glm::uvec2& size) const;
+
+	void SetCamera(CameraBuf camera) { mCamera = camera; }
+	void SetInfo(vkLib::Buffer<SSAOInfo> info) { mInfo = info; }
+
+	void SetGeometry(vkLib::ImageView positions, vkLib::ImageView normals, vkLib::Core::Ref<vk::Sampler> sampler)
+	{ mPositions = positions; mNormals = normals; mSampler = sampler; }
+
+	void SetHalfOcclusion(vkLib::Buffer<glm::vec2> occlusion) { mHalfOcclusion = occlusion; }
+
+	vkLib::ImageView GetPositions() const { return mPositions; }
+	vkLib::ImageView GetNormals() const { return mNormals; }
+
+protected:
+	CameraBuf mCamera; // Bound at (set: 0, binding: 0)
+	vkLib::Buffer<SSAOInfo> mInfo; // (set: 0, binding: 1)
+
+	vkLib::ImageView mPositions; // (set: 0, binding: 2)
+	vkLib::ImageView mNormals; // (set: 0, binding: 3)
+	vkLib::Core::Ref<vk::Sampler> mSampler;
+
+	vkLib::Buffer<glm::vec2> mHalfOcclusion; // (set: 0, binding: 4), x: occlusion, y: view depth
+};
+
+// Brings the half resolution occlusion back to full resolution with a depth aware filter,
+// and writes the occluded shading buffer into a copy the post processing reads from
+class SSAOUpsamplePipeline : public SSAOPipeline
+{
+public:
+	SSAOUpsamplePipeline() = default;
+	SSAOUpsamplePipeline(vkLib::PShader shader) : SSAOPipeline(shader) {}
+
+	virtual ~SSAOUpsamplePipeline() = default;
+
+	virtual void UpdateDescriptors() override;
+
+	void SetShading(vkLib::ImageView shading) { mShading = shading; }
+	void SetTarget(vkLib::ImageView target) { mTarget = target; }
+
+	vkLib::ImageView GetShading() const { return mShading; }
+
+private:
+	vkLib::ImageView mShading; // (set: 0, binding: 5)
+	vkLib::ImageView mTarget; // (set: 0, binding: 6)
+};
+
+AQUA_END
@@ -16,6 +16,12 @@ public:
 	void SetModels(Mat4Buf mats) { mModels = mats; }
 	void SetCamerasInfos(DepthCameraBuf camera) { mCameraInfos = camera; }
 
+	// Positions and the metadata holding the model index, nothing else is needed for the depth
+	static VertexBindingMap GetPositionBindings();
+
+protected:
+	mutable Mat4Buf mModels; // Bound at (set: 0, binding: 1)
+
 private:
 
 	glm::uvec2 mScrSize;
@@ -23,7 +29,6 @@ private:
 	VertexBindingMap mVertexBindings;
 
 	mutable DepthCameraBuf mCameraInfos;
-	mutable Mat4Buf mModels; // Bound at (set: 0, binding: 1)
 
 private:
 	void SetupConfig(vkLib::GraphicsPipelineConfig& config, const glm::uvec2& scrSize);
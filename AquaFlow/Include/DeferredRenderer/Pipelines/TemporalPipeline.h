@@ -0,0 +1,79 @@
+#pragma once
+#include "PipelineConfig.h"
+
+AQUA_BEGIN
+
+// Writes the screen space motion of every pixel of the geometry buffer since the last frame
+// The model index in the position's w picks how far the renderable itself moved
+class MotionVectorPipeline : public vkLib::ComputePipeline
+{
+public:
+	MotionVectorPipeline() = default;
+	MotionVectorPipeline(vkLib::PShader shader);
+
+	virtual ~MotionVectorPipeline() = default;
+
+	virtual void UpdateDescriptors();
+
+	void operator()(vk::CommandBuffer cmd, const glm::uvec2& size) const;
+
+	void SetInfo(vkLib::Buffer<TemporalInfo> info) { mInfo = info; }
+
+	void SetGeometry(vkLib::ImageView positions, vkLib::ImageView normals, vkLib::Core::Ref<vk::Sampler> sampler)
+	{ mPositions = positions; mNormals = normals; mSampler = sampler; }
+
+	void SetModelMotions(Mat4Buf motions) { mModelMotions = motions; }
+	void SetMotionVectors(vkLib::Buffer<glm::vec2> motionVectors) { mMotionVectors = motionVectors; }
+
+	vkLib::ImageView GetPositions() const { return mPositions; }
+	vkLib::ImageView GetNormals() const { return mNormals; }
+
+private:
+	vkLib::Buffer<TemporalInfo> mInfo; // Bound at (set: 0, binding: 0)
+
+	vkLib::ImageView mPositions; // (set: 0, binding: 1)
+	vkLib::ImageView mNormals; // (set: 0, binding: 2)
+	vkLib::Core::Ref<vk::Sampler> mSampler;
+
+	Mat4Buf mModelMotions; // (set: 0, binding: 3), last frame's model times the inverse of the current one
+	vkLib::Buffer<glm::vec2> mMotionVectors; // (set: 0, binding: 4)
+};
+
+// Accumulates the jittered frames into a history at the output resolution
+// The two histories take turns, one is read while the other is written
+class TemporalResolvePipeline : public vkLib::ComputePipeline
+{
+public:
+	TemporalResolvePipeline() = default;
+	TemporalResolvePipeline(vkLib::PShader shader);
+
+	virtual ~TemporalResolvePipeline() = default;
+
+	virtual void UpdateDescriptors();
+
+	void operator()(vk::CommandBuffer cmd, const glm::uvec2& size, uint32_t parity) const;
+
+	void SetInfo(vkLib::Buffer<TemporalInfo> info) { mInfo = info; }
+	void SetSource(vkLib::ImageView source, vkLib::Core::Ref<vk::Sampler> sampler)
+	{ mSource = source; mSampler = sampler; }
+
+	void SetMotionVectors(vkLib::Buffer<glm::vec2> motionVectors) { mMotionVectors = motionVectors; }
+	void SetHistories(vkLib::Buffer<glm::vec4> first, vkLib::Buffer<glm::vec4> second)
+	{ mHistories[0] = first; mHistories[1] = second; }
+
+	void SetTarget(vkLib::ImageView target) { mTarget = target; }
+
+	vkLib::ImageView GetSource() const { return mSource; }
+
+private:
+	vkLib::Buffer<TemporalInfo> mInfo; // Bound at (set: 0, binding: 0)
+
+	vkLib::ImageView mSource; // (set: 0, binding: 1)
+	vkLib::Core::Ref<vk::Sampler> mSampler;
+
+	vkLib::Buffer<glm::vec2> mMotionVectors; // (set: 0, binding: 2)
+	vkLib::Buffer<glm::vec4> mHistories[2]; // (set: 0, binding: 3 and 4)
+	vkLib::ImageView mTarget; // (set: 0, binding: 5)
+};
+
+AQUA_END
@@ -1,5 +1,6 @@
 #pragma once
 #include "PipelineConfig.h"
+#include "../../Utils/AutoExposure.h"
 
 AQUA_BEGIN
 
@@ -10,6 +11,7 @@ public:
 	inline TextureVisualizer(const vkLib::PShader& shader, vkLib::Framebuffer framebuffer);
 
 	inline void UpdateTexture(vkLib::ImageView texture, vkLib::Core::Ref<vk::Sampler> sampler);
+	inline void UpdateExposure(vkLib::Buffer<ExposureState> exposure);
 
 	vkLib::ImageView GetTexture() const { return mTexture; }
 
@@ -73,4 +75,12 @@ void TextureVisualizer::UpdateTexture(vkLib::ImageView texture, vkLib::Core::Ref
 	this->UpdateDescriptor({ 0, 0, 0 }, samplerInfo);
 }
 
+void TextureVisualizer::UpdateExposure(vkLib::Buffer<ExposureState> exposure)
+{
+	vkLib::StorageBufferWriteInfo exposureInfo{};
+	exposureInfo.Buffer = exposure.GetNativeHandles().Handle;
+
+	this->UpdateDescriptor({ 0, 1, 0 }, exposureInfo);
+}
+
 AQUA_END
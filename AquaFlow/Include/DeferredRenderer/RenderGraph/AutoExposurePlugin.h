@@ -0,0 +1,49 @@
+#pragma once
+#include "RenderPlugin.h"
+
+#include "../../Utils/AutoExposure.h"
+
+AQUA_BEGIN
+
+class AutoExposurePlugin : public RenderPlugin
+{
+public:
+	AutoExposurePlugin() = default;
+	~AutoExposurePlugin() = default;
+
+	void SetShader(vkLib::PShader shader) { mShader = shader; }
+	void SetResources(SharedRef<ExposureResources> exposure) { mExposure = exposure; }
+
+	virtual void AddPlugin(EXEC_NAMESPACE::GraphBuilder& graph, const std::string& name) override
+	{
+		auto exposure = mExposure;
+
+		graph[name] = CreateOp(name, EXEC_NAMESPACE::OpType::eCompute);
+
+		graph[name].Cmp = MakeRef(mPipelineBuilder.BuildComputePipeline<ExposurePipeline>(mShader));
+
+		graph[name].Fn = [exposure](vk::CommandBuffer cmd, const EXEC_NAMESPACE::Operation& op)
+			{
+				EXEC_NAMESPACE::Executioner exec(cmd, op);
+
+				auto& pipeline = *reinterpret_cast<ExposurePipeline*>(GetRefAddr(op.Cmp));
+				auto source = pipeline.GetSource();
+
+				// the adaptation runs on the time between the recorded frames
+				AdvanceExposure(*exposure);
+
+				source->BeginCommands(cmd);
+				source->RecordTransitionLayout(vk::ImageLayout::eGeneral);
+
+				pipeline(cmd, exposure->Layout.Resolution);
+
+				source->EndCommands();
+			};
+	}
+
+private:
+	vkLib::PShader mShader;
+	SharedRef<ExposureResources> mExposure;
+};
+
+AQUA_END
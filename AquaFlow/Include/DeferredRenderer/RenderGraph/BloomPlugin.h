@@ -0,0 +1,47 @@
+#pragma once
+#include "RenderPlugin.h"
+
+#include "../Pipelines/BloomPipeline.h"
+
+AQUA_BEGIN
+
+class BloomPlugin : public RenderPlugin
+{
+public:
+	BloomPlugin() = default;
+	~BloomPlugin() = default;
+
+	void SetShader(vkLib::PShader shader) { mShader = shader; }
+	void SetInfo(const BloomInfo& info) { mInfo = info; }
+
+	virtual void AddPlugin(EXEC_NAMESPACE::GraphBuilder& graph, const std::string& name) override
+	{
+		BloomInfo info = mInfo;
+
+		graph[name] = CreateOp(name, EXEC_NAMESPACE::OpType::eCompute);
+
+		graph[name].Cmp = MakeRef(mPipelineBuilder.BuildComputePipeline<BloomPipeline>(mShader));
+
+		graph[name].Fn = [info](vk::CommandBuffer cmd, const EXEC_NAMESPACE::Operation& op)
+			{
+				EXEC_NAMESPACE::Executioner exec(cmd, op);
+
+				auto& pipeline = *reinterpret_cast<BloomPipeline*>(GetRefAddr(op.Cmp));
+				auto source = pipeline.GetSource();
+
+				source->BeginCommands(cmd);
+				source->RecordTransitionLayout(vk::ImageLayout::eGeneral);
+
+				pipeline(cmd, info);
+
+				source->EndCommands();
+			};
+	}
+
+private:
+	BloomInfo mInfo;
+
+	vkLib::PShader mShader;
+};
+
+AQUA_END
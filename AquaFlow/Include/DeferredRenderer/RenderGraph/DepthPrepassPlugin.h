@@ -0,0 +1,65 @@
+#pragma once
+#include "RenderPlugin.h"
+#include "OcclusionCullPlugin.h"
+
+#include "../Pipelines/DepthPrepassPipeline.h"
+
+AQUA_BEGIN
+
+class DepthPrepassPlugin : public RenderPlugin
+{
+public:
+	DepthPrepassPlugin() = default;
+	~DepthPrepassPlugin() = default;
+
+	void SetShader(vkLib::PShader shader) { mShader = shader; }
+	void SetDepthBuffer(vkLib::Framebuffer framebuffer) { mDepthBuffer = framebuffer; }
+
+	// Without the culled draws, the whole index buffer is drawn at once
+	void SetDraws(SharedRef<OcclusionDraws> draws, OcclusionDrawList list) { mDraws = draws; mDrawList = list; }
+
+	virtual void AddPlugin(EXEC_NAMESPACE::GraphBuilder& graph, const std::string& name) override
+	{
+		auto draws = mDraws;
+		OcclusionDrawList list = mDrawList;
+
+		graph[name] = CreateOp(name, EXEC_NAMESPACE::OpType::eGraphics);
+
+		graph[name].GFX = MakeRef(mPipelineBuilder.BuildGraphicsPipeline<DepthPrepassPipeline>(mShader, mDepthBuffer));
+
+		graph[name].Fn = [draws, list](vk::CommandBuffer cmd, const EXEC_NAMESPACE::Operation& op)
+			{
+				EXEC_NAMESPACE::Executioner exec(cmd, op);
+
+				auto& pipeline = *op.GFX;
+
+				if (draws)
+					pipeline.SetIndexIndirectBuffer(draws->Commands);
+
+				pipeline.Begin(cmd);
+
+				pipeline.Activate();
+
+				if (!draws)
+					pipeline.DrawIndexed(0, 0, 0, 1);
+				else
+				{
+					glm::uvec2 range = draws->GetRange(list);
+
+					pipeline.DrawIndexedIndirect(range.x * sizeof(vk::DrawIndexedIndirectCommand),
+						sizeof(vk::DrawIndexedIndirectCommand), range.y);
+				}
+
+				pipeline.End();
+			};
+	}
+
+private:
+	vkLib::PShader mShader;
+	vkLib::Framebuffer mDepthBuffer;
+
+	SharedRef<OcclusionDraws> mDraws;
+	OcclusionDrawList mDrawList = OcclusionDrawList::eEarly;
+};
+
+AQUA_END
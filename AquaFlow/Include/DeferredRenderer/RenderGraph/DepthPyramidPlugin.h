@@ -0,0 +1,47 @@
+#pragma once
+#include "RenderPlugin.h"
+#include "OcclusionCullPlugin.h"
+
+#include "../Pipelines/DepthPyramidPipeline.h"
+
+AQUA_BEGIN
+
+class DepthPyramidPlugin : public RenderPlugin
+{
+public:
+	DepthPyramidPlugin() = default;
+	~DepthPyramidPlugin() = default;
+
+	void SetShader(vkLib::PShader shader) { mShader = shader; }
+	void SetDraws(SharedRef<OcclusionDraws> draws) { mDraws = draws; }
+
+	virtual void AddPlugin(EXEC_NAMESPACE::GraphBuilder& graph, const std::string& name) override
+	{
+		auto draws = mDraws;
+
+		graph[name] = CreateOp(name, EXEC_NAMESPACE::OpType::eCompute);
+
+		graph[name].Cmp = MakeRef(mPipelineBuilder.BuildComputePipeline<DepthPyramidPipeline>(mShader));
+
+		graph[name].Fn = [draws](vk::CommandBuffer cmd, const EXEC_NAMESPACE::Operation& op)
+			{
+				EXEC_NAMESPACE::Executioner exec(cmd, op);
+
+				auto& pipeline = *reinterpret_cast<DepthPyramidPipeline*>(GetRefAddr(op.Cmp));
+				auto depth = pipeline.GetDepth();
+
+				depth->BeginCommands(cmd);
+				depth->RecordTransitionLayout(vk::ImageLayout::eGeneral);
+
+				pipeline(cmd, draws->Layout);
+
+				depth->EndCommands();
+			};
+	}
+
+private:
+	vkLib::PShader mShader;
+	SharedRef<OcclusionDraws> mDraws;
+};
+
+AQUA_END
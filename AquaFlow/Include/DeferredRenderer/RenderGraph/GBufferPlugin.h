@@ -1,5 +1,6 @@
 #pragma once
 #include "RenderPlugin.h"
+#include "OcclusionCullPlugin.h"
 #include "../Pipelines/DeferredPipeline.h"
 
 AQUA_BEGIN
@@ -14,6 +15,12 @@ public:
 	void SetGBuffer(vkLib::Framebuffer framebuffer) { mGBuffer = framebuffer; }
 	void SetBindings(VertexBindingMap bindings) { mBindings = bindings; }
 
+	// Without the culled draws, the whole index buffer is drawn at once
+	void SetDraws(SharedRef<OcclusionDraws> draws, OcclusionDrawList list) { mDraws = draws; mDrawList = list; }
+
+	// The depth is already there, only the fragments matching it are written
+	void SetDepthPrepassed(bool prepassed) { mDepthPrepassed = prepassed; }
+
 	virtual void AddPlugin(EXEC_NAMESPACE::GraphBuilder& graph, const std::string& name) override
 	{
 		EXEC_NAMESPACE::Operation oper = CreateOp(name, EXEC_NAMESPACE::OpType::eGraphics);
@@ -21,14 +28,34 @@ public:
 
 		oper.GFX = MakeRef(pipeline);
 
-		oper.Fn = [graph](vk::CommandBuffer cmd, const EXEC_NAMESPACE::Operation& op)
+		auto draws = mDraws;
+		OcclusionDrawList list = mDrawList;
+		bool prepassed = mDepthPrepassed;
+
+		oper.Fn = [draws, list, prepassed](vk::CommandBuffer cmd, const EXEC_NAMESPACE::Operation& op)
 			{
 				EXEC_NAMESPACE::Executioner exec(cmd, op);
 
+				if (draws)
+					op.GFX->SetIndexIndirectBuffer(draws->Commands);
+
+				op.GFX->SetDepthCompareOp(prepassed ? vk::CompareOp::eEqual : vk::CompareOp::eLess);
+				op.GFX->SetDepthWriteEnable(!prepassed);
+
 				op.GFX->Begin(cmd);
 
 				op.GFX->Activate();
-				op.GFX->DrawIndexed(0, 0, 0, 1);
+
+				if (!draws)
+					op.GFX->DrawIndexed(0, 0, 0, 1);
+				else
+				{
+					glm::uvec2 range = draws->GetRange(list);
+
+					// the early pass still has to clear the targets when nothing is drawn
+					op.GFX->DrawIndexedIndirect(range.x * sizeof(vk::DrawIndexedIndirectCommand),
+						sizeof(vk::DrawIndexedIndirectCommand), range.y);
+				}
 
 				op.GFX->End();
 			};
@@ -40,6 +67,11 @@ private:
 	VertexBindingMap mBindings;
 	vkLib::Framebuffer mGBuffer;
 	vkLib::PShader mShader;
+
+	SharedRef<OcclusionDraws> mDraws;
+	OcclusionDrawList mDrawList = OcclusionDrawList::eEarly;
+
+	bool mDepthPrepassed = false;
 };
 
 AQUA_END
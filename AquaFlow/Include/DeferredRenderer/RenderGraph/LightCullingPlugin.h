@@ -0,0 +1,46 @@
+#pragma once
+#include "RenderPlugin.h"
+
+#include "../Pipelines/LightCullingPipeline.h"
+#include "../Renderer/Environment.h"
+
+AQUA_BEGIN
+
+class LightCullingPlugin : public RenderPlugin
+{
+public:
+	LightCullingPlugin() = default;
+	~LightCullingPlugin() = default;
+
+	void SetShader(vkLib::PShader shader) { mShader = shader; }
+	void SetEnvironment(EnvironmentRef env) { mEnv = env; }
+	void SetClusterCount(uint32_t count) { mClusterCount = count; }
+
+	virtual void AddPlugin(EXEC_NAMESPACE::GraphBuilder& graph, const std::string& name) override
+	{
+		EnvironmentRef env = mEnv;
+		uint32_t clusterCount = mClusterCount;
+
+		graph[name] = CreateOp(name, EXEC_NAMESPACE::OpType::eCompute);
+
+		graph[name].Cmp = MakeRef(mPipelineBuilder.BuildComputePipeline<LightCullingPipeline>(mShader));
+
+		graph[name].Fn = [env, clusterCount](vk::CommandBuffer cmd, const EXEC_NAMESPACE::Operation& op)
+			{
+				EXEC_NAMESPACE::Executioner exec(cmd, op);
+
+				auto& pipeline = *reinterpret_cast<LightCullingPipeline*>(GetRefAddr(op.Cmp));
+
+				// the light count may change without the graph being rebuilt
+				pipeline(cmd, static_cast<uint32_t>(env->GetPointLightCount()), clusterCount);
+			};
+	}
+
+private:
+	uint32_t mClusterCount = 0;
+
+	vkLib::PShader mShader;
+	EnvironmentRef mEnv;
+};
+
+AQUA_END
@@ -0,0 +1,71 @@
+#pragma once
+#include "RenderPlugin.h"
+
+#include "../Pipelines/MaterialClassifyPipeline.h"
+
+AQUA_BEGIN
+
+class MaterialClassifyPlugin : public RenderPlugin
+{
+public:
+	MaterialClassifyPlugin() = default;
+	~MaterialClassifyPlugin() = default;
+
+	void SetShader(vkLib::PShader shader) { mShader = shader; }
+	void SetDraws(vkLib::Buffer<vk::DrawIndirectCommand> draws) { mDraws = draws; }
+
+	void SetTileCount(const glm::uvec2& tileCount) { mTileCount = tileCount; }
+	void SetTileCapacity(uint32_t capacity) { mTileCapacity = capacity; }
+	void SetMaterialCount(uint32_t count) { mMaterialCount = count; }
+
+	virtual void AddPlugin(EXEC_NAMESPACE::GraphBuilder& graph, const std::string& name) override
+	{
+		auto draws = mDraws;
+		glm::uvec2 tileCount = mTileCount;
+
+		// Six vertices per tile, every material owns a contiguous range of instances
+		std::vector<vk::DrawIndirectCommand> resetDraws(mMaterialCount);
+
+		for (uint32_t i = 0; i < mMaterialCount; i++)
+			resetDraws[i] = vk::DrawIndirectCommand(6, 0, 0, i * mTileCapacity);
+
+		graph[name] = CreateOp(name, EXEC_NAMESPACE::OpType::eCompute);
+
+		graph[name].Cmp = MakeRef(mPipelineBuilder.BuildComputePipeline<MaterialClassifyPipeline>(mShader));
+
+		graph[name].Fn = [draws, tileCount, resetDraws](vk::CommandBuffer cmd, const EXEC_NAMESPACE::Operation& op)
+			{
+				EXEC_NAMESPACE::Executioner exec(cmd, op);
+
+				auto& pipeline = *reinterpret_cast<MaterialClassifyPipeline*>(GetRefAddr(op.Cmp));
+				auto normals = pipeline.GetNormals();
+
+				// the tile counters start over every frame
+				cmd.updateBuffer<vk::DrawIndirectCommand>(draws.GetNativeHandles().Handle, 0, resetDraws);
+
+				vk::MemoryBarrier resetBarrier{};
+				resetBarrier.setSrcAccessMask(vk::AccessFlagBits::eTransferWrite);
+				resetBarrier.setDstAccessMask(vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite);
+
+				cmd.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eComputeShader,
+					vk::DependencyFlags(), resetBarrier, nullptr, nullptr);
+
+				normals->BeginCommands(cmd);
+				normals->RecordTransitionLayout(vk::ImageLayout::eGeneral);
+
+				pipeline(cmd, tileCount);
+
+				normals->EndCommands();
+			};
+	}
+
+private:
+	glm::uvec2 mTileCount = { 0, 0 };
+	uint32_t mTileCapacity = 0;
+	uint32_t mMaterialCount = 0;
+
+	vkLib::PShader mShader;
+	vkLib::Buffer<vk::DrawIndirectCommand> mDraws;
+};
+
+AQUA_END
@@ -0,0 +1,97 @@
+#pragma once
+#include "RenderPlugin.h"
+
+#include "../Pipelines/OcclusionCullPipeline.h"
+
+AQUA_BEGIN
+
+// The lists a geometry pass draws from; with the depth prepass, the geometry buffer draws both at once
+enum class OcclusionDrawList
+{
+	eEarly             = 1,
+	eLate              = 2,
+	eBoth              = 3,
+};
+
+// Draw lists of the geometry buffer, refilled on the GPU every frame
+// The visibility of every renderable is carried over to the next frame's early list
+struct OcclusionDraws
+{
+	vkLib::Buffer<OcclusionCandidate> Candidates;
+	vkLib::Buffer<uint32_t> Visibility;
+	vkLib::Buffer<vk::DrawIndexedIndirectCommand> Commands; // the early list followed by the late list
+
+	vkLib::Buffer<DepthPyramidInfo> PyramidInfo;
+	vkLib::Buffer<float> Pyramid;
+
+	DepthPyramidInfo Layout;
+
+	// x: first index, y: index count; the visibility only holds while these stay the same
+	std::vector<glm::uvec2> IndexRanges;
+
+	// Once the renderables change, everything is drawn in the early list for a frame
+	bool ResetVisibility = true;
+
+	// x: first command, y: command count
+	glm::uvec2 GetRange(OcclusionDrawList list) const
+	{
+		uint32_t count = Layout.CandidateCount;
+
+		if (list == OcclusionDrawList::eBoth)
+			return { 0, 2 * count };
+
+		return { list == OcclusionDrawList::eLate ? count : 0, count };
+	}
+};
+
+class OcclusionCullPlugin : public RenderPlugin
+{
+public:
+	OcclusionCullPlugin() = default;
+	~OcclusionCullPlugin() = default;
+
+	void SetShader(vkLib::PShader shader) { mShader = shader; }
+	void SetDraws(SharedRef<OcclusionDraws> draws) { mDraws = draws; }
+	void SetPhase(OcclusionPhase phase) { mPhase = phase; }
+
+	virtual void AddPlugin(EXEC_NAMESPACE::GraphBuilder& graph, const std::string& name) override
+	{
+		auto draws = mDraws;
+		OcclusionPhase phase = mPhase;
+
+		graph[name] = CreateOp(name, EXEC_NAMESPACE::OpType::eCompute);
+
+		graph[name].Cmp = MakeRef(mPipelineBuilder.BuildComputePipeline<OcclusionCullPipeline>(mShader));
+
+		graph[name].Fn = [draws, phase](vk::CommandBuffer cmd, const EXEC_NAMESPACE::Operation& op)
+			{
+				EXEC_NAMESPACE::Executioner exec(cmd, op);
+
+				auto& pipeline = *reinterpret_cast<OcclusionCullPipeline*>(GetRefAddr(op.Cmp));
+
+				if (phase == OcclusionPhase::eEarly && draws->ResetVisibility)
+				{
+					cmd.fillBuffer(draws->Visibility.GetNativeHandles().Handle, 0, VK_WHOLE_SIZE, 1);
+
+					vk::MemoryBarrier resetBarrier{};
+					resetBarrier.setSrcAccessMask(vk::AccessFlagBits::eTransferWrite);
+					resetBarrier.setDstAccessMask(vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite);
+
+					cmd.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eComputeShader,
+						vk::DependencyFlags(), resetBarrier, nullptr, nullptr);
+
+					draws->ResetVisibility = false;
+				}
+
+				pipeline(cmd, phase, draws->Layout.CandidateCount);
+			};
+	}
+
+private:
+	OcclusionPhase mPhase = OcclusionPhase::eEarly;
+
+	vkLib::PShader mShader;
+	SharedRef<OcclusionDraws> mDraws;
+};
+
+AQUA_END
@@ -0,0 +1,52 @@
+#pragma once
+#include "RenderPlugin.h"
+
+#include "../Pipelines/SSAOPipeline.h"
+
+AQUA_BEGIN
+
+class SSAOPlugin : public RenderPlugin
+{
+public:
+	SSAOPlugin() = default;
+	~SSAOPlugin() = default;
+
+	void SetShader(vkLib::PShader shader) { mShader = shader; }
+	void SetHalfResolution(const glm::uvec2& resolution) { mHalfResolution = resolution; }
+
+	virtual void AddPlugin(EXEC_NAMESPACE::GraphBuilder& graph, const std::string& name) override
+	{
+		glm::uvec2 halfResolution = mHalfResolution;
+
+		graph[name] = CreateOp(name, EXEC_NAMESPACE::OpType::eCompute);
+
+		graph[name].Cmp = MakeRef(mPipelineBuilder.BuildComputePipeline<SSAOPipeline>(mShader));
+
+		graph[name].Fn = [halfResolution](vk::CommandBuffer cmd, const EXEC_NAMESPACE::Operation& op)
+			{
+				EXEC_NAMESPACE::Executioner exec(cmd, op);
+
+				auto& pipeline = *reinterpret_cast<SSAOPipeline*>(GetRefAddr(op.Cmp));
+				auto positions = pipeline.GetPositions();
+				auto normals = pipeline.GetNormals();
+
+				positions->BeginCommands(cmd);
+				positions->RecordTransitionLayout(vk::ImageLayout::eGeneral);
+
+				normals->BeginCommands(cmd);
+				normals->RecordTransitionLayout(vk::ImageLayout::eGeneral);
+
+				pipeline(cmd, halfResolution);
+
+				normals->EndCommands();
+				positions->EndCommands();
+			};
+	}
+
+private:
+	glm::uvec2 mHalfResolution = { 0, 0 };
+
+	vkLib::PShader mShader;
+};
+
+AQUA_END
@@ -0,0 +1,57 @@
+#pragma once
+#include "RenderPlugin.h"
+
+#include "../Pipelines/SSAOPipeline.h"
+
+AQUA_BEGIN
+
+class SSAOUpsamplePlugin : public RenderPlugin
+{
+public:
+	SSAOUpsamplePlugin() = default;
+	~SSAOUpsamplePlugin() = default;
+
+	void SetShader(vkLib::PShader shader) { mShader = shader; }
+	void SetResolution(const glm::uvec2& resolution) { mResolution = resolution; }
+
+	virtual void AddPlugin(EXEC_NAMESPACE::GraphBuilder& graph, const std::string& name) override
+	{
+		glm::uvec2 resolution = mResolution;
+
+		graph[name] = CreateOp(name, EXEC_NAMESPACE::OpType::eCompute);
+
+		graph[name].Cmp = MakeRef(mPipelineBuilder.BuildComputePipeline<SSAOUpsamplePipeline>(mShader));
+
+		graph[name].Fn = [resolution](vk::CommandBuffer cmd, const EXEC_NAMESPACE::Operation& op)
+			{
+				EXEC_NAMESPACE::Executioner exec(cmd, op);
+
+				auto& pipeline = *reinterpret_cast<SSAOUpsamplePipeline*>(GetRefAddr(op.Cmp));
+				auto positions = pipeline.GetPositions();
+				auto normals = pipeline.GetNormals();
+				auto shading = pipeline.GetShading();
+
+				positions->BeginCommands(cmd);
+				positions->RecordTransitionLayout(vk::ImageLayout::eGeneral);
+
+				normals->BeginCommands(cmd);
+				normals->RecordTransitionLayout(vk::ImageLayout::eGeneral);
+
+				shading->BeginCommands(cmd);
+				shading->RecordTransitionLayout(vk::ImageLayout::eGeneral);
+
+				pipeline(cmd, resolution);
+
+				shading->EndCommands();
+				normals->EndCommands();
+				positions->EndCommands();
+			};
+	}
+
+private:
+	glm::uvec2 mResolution = { 0, 0 };
+
+	vkLib::PShader mShader;
+};
+
+AQUA_END
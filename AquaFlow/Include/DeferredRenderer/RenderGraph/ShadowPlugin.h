@@ -5,6 +5,27 @@
 
 AQUA_BEGIN
 
+// Culled draw lists of the atlas tiles, refilled on the CPU whenever the camera moves
+// The static casters live in a cached layer of their own, redrawn only when their tile changes,
+// and every frame the atlas starts from that layer before the dynamic casters go on top
+struct ShadowAtlasDraws
+{
+	vkLib::Buffer<vk::DrawIndexedIndirectCommand> Commands;
+
+	// x: first command, y: command count; one per tile
+	std::vector<glm::uvec2> StaticRanges;
+	std::vector<glm::uvec2> DynamicRanges;
+
+	// One framebuffer per tile, so that a single tile can be cleared and redrawn
+	std::vector<vkLib::Framebuffer> StaticTiles;
+
+	std::vector<uint8_t> StaticDirty; // the static layer of the tile is out of date
+	std::vector<uint8_t> AtlasStale; // the atlas tile holds more than its static layer
+
+	glm::uvec2 TileResolution = { 0, 0 };
+	uint32_t CascadeCount = 0;
+};
+
 class ShadowPlugin : public RenderPlugin
 {
 public:
@@ -14,38 +35,104 @@ public:
 	void SetShader(vkLib::PShader shader) { mShader = shader; }
 	void SetDepthBuffer(vkLib::Framebuffer framebuffer) { mDepthBuffer = framebuffer; }
 	void SetBindings(VertexBindingMap bindings) { mVertexBindings = bindings; }
-	void SetCameraOffset(uint32_t offset) { mOffset = offset; }
+	void SetDraws(SharedRef<ShadowAtlasDraws> draws) { mDraws = draws; }
 
 	virtual void AddPlugin(EXEC_NAMESPACE::GraphBuilder& graph, const std::string& name) override
 	{
-		uint32_t offset = mOffset;
+		auto draws = mDraws;
+		auto depthBuffer = mDepthBuffer;
 
 		graph[name] = CreateOp(name, EXEC_NAMESPACE::OpType::eGraphics);
 
 		graph[name].GFX = MakeRef(mPipelineBuilder.BuildGraphicsPipeline<ShadowPipeline>(mShader, mDepthBuffer, mVertexBindings));
 
-		graph[name].Fn = [graph, offset](vk::CommandBuffer cmd, const EXEC_NAMESPACE::Operation& op)
+		graph[name].Fn = [draws, depthBuffer](vk::CommandBuffer cmd, const EXEC_NAMESPACE::Operation& op)
 			{
 				EXEC_NAMESPACE::Executioner exec(cmd, op);
 
-				op.GFX->Begin(cmd);
+				auto& pipeline = *op.GFX;
+				uint32_t tileCount = static_cast<uint32_t>(draws->StaticTiles.size());
+
+				auto drawTile = [&pipeline, draws](vkLib::Framebuffer target, const glm::uvec2& offset, uint32_t tileIdx, const glm::uvec2& range)
+					{
+						pipeline.SetFramebuffer(target);
+
+						pipeline.SetViewport(vk::Viewport((float)offset.x, (float)offset.y,
+							(float)draws->TileResolution.x, (float)draws->TileResolution.y, 0.0f, 1.0f));
+						pipeline.SetScissor(vk::Rect2D(vk::Offset2D(offset.x, offset.y),
+							vk::Extent2D(draws->TileResolution.x, draws->TileResolution.y)));
+
+						pipeline.Activate();
+
+						pipeline.SetShaderConstant("eVertex.ShaderConstants.Index_0", tileIdx);
+						pipeline.DrawIndexedIndirect(range.x * sizeof(vk::DrawIndexedIndirectCommand),
+							sizeof(vk::DrawIndexedIndirectCommand), range.y);
+					};
+
+				pipeline.SetIndexIndirectBuffer(draws->Commands);
+
+				pipeline.Begin(cmd);
+
+				// The render passes load the tiles, so they're cleared up front
+				for (uint32_t tileIdx = 0; tileIdx < tileCount; tileIdx++)
+				{
+					if (!draws->StaticDirty[tileIdx])
+						continue;
+
+					auto tileImage = *draws->StaticTiles[tileIdx].GetDepthStencilAttachment();
 
-				op.GFX->Activate();
+					tileImage.BeginCommands(cmd);
+					tileImage.RecordClearDepthStencil({ 1.0f, 0 });
+					tileImage.EndCommands();
 
-				op.GFX->SetShaderConstant("eVertex.ShaderConstants.Index_0", offset);
-				op.GFX->DrawIndexed(0, 0, 0, 1);
+					if (draws->StaticRanges[tileIdx].y != 0)
+						drawTile(draws->StaticTiles[tileIdx], glm::uvec2(0), tileIdx, draws->StaticRanges[tileIdx]);
 
-				op.GFX->End();
+					draws->StaticDirty[tileIdx] = false;
+					draws->AtlasStale[tileIdx] = true;
+				}
+
+				// Tiles the dynamic casters didn't touch, now or last frame, are left as they are
+				auto atlasImage = *depthBuffer.GetDepthStencilAttachment();
+
+				atlasImage.BeginCommands(cmd);
+
+				for (uint32_t tileIdx = 0; tileIdx < tileCount; tileIdx++)
+				{
+					bool dynamic = draws->DynamicRanges[tileIdx].y != 0;
+
+					if (!draws->AtlasStale[tileIdx] && !dynamic)
+						continue;
+
+					// Cascades along the x axis, lights along the y axis
+					glm::uvec2 tile = { tileIdx % draws->CascadeCount, tileIdx / draws->CascadeCount };
+
+					atlasImage.RecordCopy(*draws->StaticTiles[tileIdx].GetDepthStencilAttachment(), tile * draws->TileResolution);
+					draws->AtlasStale[tileIdx] = dynamic;
+				}
+
+				atlasImage.EndCommands();
+
+				for (uint32_t tileIdx = 0; tileIdx < tileCount; tileIdx++)
+				{
+					if (draws->DynamicRanges[tileIdx].y == 0)
+						continue;
+
+					glm::uvec2 tile = { tileIdx % draws->CascadeCount, tileIdx / draws->CascadeCount };
+
+					drawTile(depthBuffer, tile * draws->TileResolution, tileIdx, draws->DynamicRanges[tileIdx]);
+				}
+
+				pipeline.End();
 			};
 	}
 
 private:
-	uint32_t mOffset = 0;
-
 	VertexBindingMap mVertexBindings;
 	vkLib::PShader mShader;
 	vkLib::Framebuffer mDepthBuffer;
+
+	SharedRef<ShadowAtlasDraws> mDraws;
 };
 
 AQUA_END
-
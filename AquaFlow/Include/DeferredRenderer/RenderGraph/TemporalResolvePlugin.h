@@ -0,0 +1,62 @@
+#pragma once
+#include "RenderPlugin.h"
+
+#include "../Pipelines/TemporalPipeline.h"
+
+AQUA_BEGIN
+
+// Buffers of the temporal passes, and the frame they're at
+// The back end advances it once per draw call, before anything is recorded
+struct TemporalState
+{
+	vkLib::Buffer<TemporalInfo> Info;
+	vkLib::Buffer<glm::vec2> MotionVectors;
+	vkLib::Buffer<glm::vec4> Histories[2];
+	Mat4Buf ModelMotions;
+
+	TemporalInfo Layout;
+	std::vector<glm::mat4> PrevModels;
+
+	uint32_t FrameIndex = 0;
+};
+
+class TemporalResolvePlugin : public RenderPlugin
+{
+public:
+	TemporalResolvePlugin() = default;
+	~TemporalResolvePlugin() = default;
+
+	void SetShader(vkLib::PShader shader) { mShader = shader; }
+	void SetState(SharedRef<TemporalState> state) { mState = state; }
+
+	virtual void AddPlugin(EXEC_NAMESPACE::GraphBuilder& graph, const std::string& name) override
+	{
+		auto state = mState;
+
+		graph[name] = CreateOp(name, EXEC_NAMESPACE::OpType::eCompute);
+
+		graph[name].Cmp = MakeRef(mPipelineBuilder.BuildComputePipeline<TemporalResolvePipeline>(mShader));
+
+		graph[name].Fn = [state](vk::CommandBuffer cmd, const EXEC_NAMESPACE::Operation& op)
+			{
+				EXEC_NAMESPACE::Executioner exec(cmd, op);
+
+				auto& pipeline = *reinterpret_cast<TemporalResolvePipeline*>(GetRefAddr(op.Cmp));
+				auto source = pipeline.GetSource();
+
+				source->BeginCommands(cmd);
+				source->RecordTransitionLayout(vk::ImageLayout::eGeneral);
+
+				// reads the history the last frame wrote
+				pipeline(cmd, state->Layout.OutputResolution, state->FrameIndex % 2);
+
+				source->EndCommands();
+			};
+	}
+
+private:
+	vkLib::PShader mShader;
+	SharedRef<TemporalState> mState;
+};
+
+AQUA_END
@@ -17,13 +17,23 @@ private:
 	void SetCtx(vkLib::Context ctx);
 
 	void SetEnvironment(EnvironmentRef env);
+	void SetCamera(CameraBuf camera);
 
 	void SetFeaturesInfos(const FeatureInfoMap& featureInfo);
 	void SetFeatureFlags(RendererFeatureFlags flags);
+	void SetSSAOFeature(const SSAOFeature& feature);
+	void SetBloomFeature(const BloomEffectFeature& feature);
+	void SetTemporalAAFeature(const TemporalAAFeature& feature);
+	void SetAutoExposureFeature(const AutoExposureFeature& feature);
+
+	// Once per frame, returns the camera jittered to this frame's sub pixel offset
+	CameraInfo AdvanceTemporalFrame(const CameraInfo& camera);
 
 	void PrepareFeatures();
 	void PrepareSSAO();
+	void PrepareTemporalAA();
 	void PrepareBloomEffect();
+	void PrepareAutoExposure();
 	void PreparePostProcessing();
 	void CreateGraph();
 
@@ -32,6 +42,7 @@ private:
 
 	void PrepareFramebuffers(const glm::uvec2& rendererResolution);
 	void SetShadingFrameBuffer(vkLib::Framebuffer framebuffer);
+	void SetGBuffer(vkLib::Framebuffer gBuffer);
 
 	EXEC_NAMESPACE::Graph GetGraph() const;
 	EXEC_NAMESPACE::GraphList GetGraphList() const;
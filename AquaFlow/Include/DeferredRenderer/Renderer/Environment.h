@@ -57,6 +57,8 @@ private:
 	void RegenerateBuffers(vkLib::ResourcePool pool);
 	void Update();
 
+	static float CalcPointLightRadius(const PointLightSrc& src, float cutoff);
+
 	friend class Renderer;
 };
 
@@ -1,5 +1,6 @@
 #pragma once
 #include "RendererConfig.h"
+#include "../../Utils/AutoExposure.h"
 
 AQUA_BEGIN
 
@@ -11,28 +12,65 @@ struct FeatureInfo
 	vkLib::GenericBuffer UniBuffer;
 };
 
+// Horizon based occlusion, DirectionCount directions around every pixel marched in StepCount steps
+// Traced at half resolution and upsampled against the full resolution depth
 struct SSAOFeature
 {
-	alignas(4) uint32_t SampleCount = 8;
-	alignas(4) float Radius = 0.1f;
-	// we'll deal with it when implementing the SSAO
-	alignas(4) std::uniform_real_distribution<float> Distribution;
+	alignas(4) uint32_t DirectionCount = 8;
+	alignas(4) uint32_t StepCount = 4;
+	alignas(4) float Radius = 0.5f; // in world units
+	alignas(4) float Intensity = 1.0f;
+	// how quickly the upsample stops trusting the half resolution texels at a different depth
+	alignas(4) float DepthSharpness = 32.0f;
 };
 
+// The camera frustum up to CascadeDepth is split into CascadeDivisions slices (MAX_SHADOW_CASCADES at most)
+// Each slice gets a BaseResolution tile of the shadow atlas per directional light
 struct ShadowCascadeFeature
 {
 	alignas(8) glm::uvec2 BaseResolution = { 2048, 2048 };
 	alignas(4) float CascadeDepth = 500.0f;
-	alignas(4) uint32_t CascadeDivisions = 8;
+	alignas(4) uint32_t CascadeDivisions = 4;
+	alignas(4) float NearClip = 0.1f;
+	// 0 splits the slices uniformly, 1 logarithmically
+	alignas(4) float SplitLambda = 0.75f;
 };
 
+// The HDR image is downsampled LevelCount times (MAX_BLOOM_LEVELS at most) and filtered back up the chain
+// There is no threshold, the bloom is blended in by Strength so the image keeps its energy
 struct BloomEffectFeature
 {
-	alignas(16) glm::vec3 Color = { 10.0f, 10.0f, 10.0f };
-	alignas(4) float Radius = 0.1f;
-	alignas(4) float Threshold = 100.0f;
+	alignas(16) glm::vec3 Color = { 1.0f, 1.0f, 1.0f };
+	alignas(4) float Radius = 1.0f; // of the upsample's tent filter, in texels of the smaller level
+	alignas(4) float Strength = 0.04f;
+	alignas(4) uint32_t LevelCount = 6;
 };
 
+// The view frustum is split into screen tiles and exponential depth slices
+// Every cluster keeps the point lights touching it, and shading only walks that list
+struct LightClusterFeature
+{
+	glm::uvec2 TileSize = { 64, 64 };
+	uint32_t DepthSlices = 24;
+	uint32_t MaxLightsPerCluster = 128;
+
+	// Slicing range in view space, should hug the camera's clipping planes
+	float Near = 0.1f;
+	float Far = 500.0f;
+};
+
+// Every frame lands on a different sub pixel offset and is accumulated along the motion vectors
+// The shading buffer sets the internal resolution, the output can be larger to trade shading cost for detail
+struct TemporalAAFeature
+{
+	glm::uvec2 OutputResolution = { 0, 0 }; // zero keeps the shading buffer's resolution
+	float BlendFactor = 0.1f; // weight of the new frame once the history is valid
+	uint32_t JitterPhases = 8;
+};
+
+// Measured on the final HDR image every frame, the post process tone maps with the adapted exposure
+using AutoExposureFeature = ExposureSettings;
+
 using FeatureInfoMap = std::unordered_map<RenderingFeature, FeatureInfo>;
 
 AQUA_END
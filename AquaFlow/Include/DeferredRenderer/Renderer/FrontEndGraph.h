@@ -8,6 +8,31 @@ AQUA_BEGIN
 
 struct FrontEndGraphConfig;
 
+struct LightClusterBuffers
+{
+	vkLib::Buffer<LightClusterInfo> mInfo;
+	vkLib::Buffer<uint32_t> mLightCounts;
+	vkLib::Buffer<uint32_t> mLightIndices; // MaxLightsPerCluster slots per cluster
+};
+
+struct ShadowAtlasBuffers
+{
+	vkLib::Buffer<ShadowAtlasInfo> mInfo;
+	vkLib::Buffer<CameraInfo> mCameras; // one per atlas tile
+};
+
+// World space bounds and index range of a renderable inside the vertex factory
+struct ShadowCaster
+{
+	glm::vec3 MinBound = glm::vec3(std::numeric_limits<float>::max());
+	glm::vec3 MaxBound = glm::vec3(-std::numeric_limits<float>::max());
+	uint32_t FirstIndex = 0;
+	uint32_t IndexCount = 0;
+
+	// Static casters are cached in the shadow atlas, dynamic ones are drawn every frame
+	bool Dynamic = false;
+};
+
 class FrontEndGraph
 {
 private:
@@ -21,11 +46,21 @@ private:
 
 	void SetFeatureFlags(RendererFeatureFlags flags);
 	void SetShadowFeature(const ShadowCascadeFeature& feature);
+	void SetLightClusterFeature(const LightClusterFeature& feature);
+
+	void SetCamera(CameraBuf camera);
+	void SetShadowCasters(const std::vector<ShadowCaster>& casters);
+	// Redraws the cached static layer on the next frame
+	void InvalidateStaticShadows();
+
+	// Fits the cascades around the camera frustum and culls the casters into the tiles
+	void UpdateShadowCascades(const CameraInfo& camera);
 
 	void SetVertexFactory(VertexFactory& factory);
 
 	void PrepareFeatures();
 	void PrepareDepthCascades();
+	void PrepareLightClusters();
 	void CreateGraph();
 
 	void SetModels(Mat4Buf models);
@@ -33,14 +68,22 @@ private:
 
 	void PrepareFramebuffers(const glm::uvec2& rendererResolution);
 	void PrepareDepthBuffers();
+	void PrepareClusterBuffers();
 
 	EXEC_NAMESPACE::Graph GetGraph() const;
 	EXEC_NAMESPACE::GraphList GetGraphList() const;
 
 	std::vector<std::string> GetOutputs() const;
 
-	std::vector<vkLib::ImageView> GetDepthViews() const;
-	std::vector <vkLib::Framebuffer> GetDepthbuffers() const;
+	vkLib::ImageView GetShadowAtlasView() const;
+	vkLib::Framebuffer GetShadowAtlas() const;
+	ShadowAtlasBuffers GetShadowAtlasBuffers() const;
+
+	LightClusterBuffers GetLightClusterBuffers() const;
+
+	bool IsShadowEnabled() const;
+
+	static ShadowCaster TransformBounds(const ShadowCaster& caster, const glm::mat4& transform);
 
 private:
 	SharedRef<FrontEndGraphConfig> mConfig;
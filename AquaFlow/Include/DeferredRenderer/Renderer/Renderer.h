@@ -26,11 +26,15 @@ public:
 	void EnableFeatures(RendererFeatureFlags flags);
 	void DisableFeatures(RendererFeatureFlags flags);
 
+	// The occlusion culling samples its depth, so the depth attachment needs the sampled usage
 	void SetShadingbuffer(vkLib::Framebuffer framebuffer);
 
 	void SetSSAOConfig(const SSAOFeature& config);
 	void SetShadowConfig(const ShadowCascadeFeature& config);
 	void SetBloomEffectConfig(const BloomEffectFeature& config);
+	void SetTemporalAAConfig(const TemporalAAFeature& config);
+	void SetAutoExposureConfig(const AutoExposureFeature& config);
+	void SetLightClusterConfig(const LightClusterFeature& config);
 	void SetEnvironment(EnvironmentRef env);
 	void PrepareFeatures(); // first stage of preparation; setting up the renderer features and the environment
 
@@ -54,6 +58,10 @@ public:
 	// we could even render points in the three space
 	void SubmitPoints(const std::string& pointIsland, const vk::ArrayProxy<Point>& points);
 
+	// Moves an already submitted renderable, the motion is picked up by the temporal pass
+	// The shadow and occlusion culling bounds follow right away, no upload needed
+	void SetModelMatrix(const std::string& name, const glm::mat4& model);
+
 	void RemoveRenderable(const std::string& name);
 	void ClearRenderables();
 
@@ -65,6 +73,11 @@ public:
 
 	void ActivateRenderables(const vk::ArrayProxy<std::string>& names);
 	void DeactivateRenderables(const vk::ArrayProxy<std::string>& names);
+
+	// Renderables are static shadow casters by default, cached until they or the lights change
+	// Moving ones should be marked dynamic; takes effect on the next upload
+	void MarkRenderablesDynamic(const vk::ArrayProxy<std::string>& names);
+	void MarkRenderablesStatic(const vk::ArrayProxy<std::string>& names);
 	void UploadRenderables(); // uploading vertices to GPU; can be done each frame
 
 	void UpdateDescriptors(); // updating the material and env descriptors
@@ -96,6 +109,8 @@ private:
 
 	void PrepareShadingNetwork();
 	void PrepareFramebuffers();
+	void PrepareDepthPyramid();
+	void PrepareMaterialTiles();
 	void ConnectFrontEndToShadingNetwork();
 	void ConnectBackEndToShadingNetwork();
 
@@ -11,6 +11,10 @@ enum class RenderingFeature : uint64_t
 	eSSAO              = 2,
 	eBloomEffect       = 4,
 	eMotionBlur        = 8,
+	eOcclusionCulling  = 16,
+	eDepthPrepass      = 32,
+	eTemporalAA        = 64,
+	eAutoExposure      = 128,
 };
 
 enum class PostProcessing : uint32_t
@@ -58,6 +62,8 @@ struct DirectionalLightInfo
 struct PointLightInfo
 {
 	PointLightSrc SrcInfo;
+	// The light is cut off once its strongest channel falls below this
+	float Cutoff = 0.005f;
 	mutable uint32_t Offset = 0;
 };
 
@@ -54,7 +54,7 @@ struct Face
 	alignas(16) glm::uvec4 Indices;
 
 	alignas(4) uint32_t MaterialRef;
-	alignas(4) uint32_t Padding1;
+	alignas(4) uint32_t InstanceIndex; // Written by the path tracer, the mesh the face was submitted with
 
 	alignas(4) uint32_t FaceID;
 	alignas(4) uint32_t Padding2;
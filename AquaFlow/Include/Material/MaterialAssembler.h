@@ -14,6 +14,8 @@ public:
 	void SetPipelineBuilder(vkLib::PipelineBuilder builder) { mPipelineBuilder = builder; }
 
 	std::expected<MAT_NAMESPACE::Material, vkLib::CompileError> ConstructRayTracingMaterial(const std::string& shader, const vkLib::PreprocessorDirectives& directives = {});
+	// Same compiled shader, a new pipeline with its own descriptor sets
+	MAT_NAMESPACE::Material CloneRayTracingMaterial(const MAT_NAMESPACE::Material& material);
 	std::expected<MAT_NAMESPACE::Material, vkLib::CompileError> ConstructDeferGFXMaterial(const std::string& shader, vkLib::GraphicsPipelineConfig config, const vkLib::PreprocessorDirectives& directives = {});
 
 private:
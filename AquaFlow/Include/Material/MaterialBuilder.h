@@ -12,6 +12,12 @@ struct RTMaterialCreateInfo
 	float ShadingTolerance = 0.01f;
 	float PowerHeuristics = 2.0f;
 
+	// Shade with the interpolated vertex normals instead of the flat triangle ones
+	bool SmoothShading = true;
+
+	// Set by the estimator, must agree with the MOTION_BLUR macro of its kernels
+	bool MotionBlur = false;
+
 	int EmptyMaterialID = -1;
 	int SkyboxMaterialID = -2;
 	int LightMaterialID = -3;
@@ -46,6 +52,10 @@ public:
 	MaterialInstance BuildRTInstance(const RTMaterialCreateInfo& createInfo);
 	MaterialInstance BuildDeferGFXInstance(const DeferGFXMaterialCreateInfo& createInfo);
 
+	// Shares the shader and the parameter buffer, but binds its resources independently
+	// Lets several executors run the same material at once
+	MaterialInstance CloneRTInstance(const MaterialInstance& instance);
+
 	void InitializeInstance(MaterialInstance& instance, MAT_NAMESPACE::Material material, MAT_NAMESPACE::ShaderParameterSet& set);
 	void RegisterMaterial(const std::string& name, MaterialInstance instance) 
 	{ mMaterialCache[name] = instance; }
@@ -0,0 +1,96 @@
+#pragma once
+#include "../Core/AqCore.h"
+
+AQUA_BEGIN
+
+#define EXPOSURE_HISTOGRAM_SIZE 256
+
+// What the exposure adapts towards, shared by the deferred back end and the wavefront post process
+struct ExposureSettings
+{
+	float MinLogLuminance = -10.0f; // log2 of the darkest luminance the histogram tells apart
+	float MaxLogLuminance = 4.0f;
+	float Key = 0.18f; // the average luminance is mapped to this
+	float AdaptationRate = 1.5f; // per second
+	float MinExposure = 1.0e-3f;
+	float MaxExposure = 1.0e3f;
+};
+
+struct ExposureInfo
+{
+	alignas(8) glm::uvec2 Resolution = { 0, 0 };
+	alignas(4) float MinLogLuminance = -10.0f;
+	alignas(4) float MaxLogLuminance = 4.0f;
+	alignas(4) float Key = 0.18f;
+	alignas(4) float AdaptationRate = 1.5f;
+	alignas(4) float DeltaTime = 0.0f; // seconds since the last measurement
+	alignas(4) float MinExposure = 1.0e-3f;
+	alignas(4) float MaxExposure = 1.0e3f;
+};
+
+// Only ever written by the GPU, tone mapping passes bind it directly
+struct ExposureState
+{
+	alignas(4) float Exposure = 1.0f;
+	alignas(4) float AdaptedLuminance = 0.0f; // zero until the first measurement
+};
+
+enum class ExposurePass : uint32_t
+{
+	eHistogram         = 0, // bins the log luminance of every pixel
+	eAdapt             = 1, // averages the bins, eases the exposure towards them and clears the histogram
+};
+
+// Builds a log luminance histogram of an HDR image and adapts the exposure to its average
+// EXPOSURE_HISTOGRAM_SIZE must be inserted into the shader, one invocation per bin in each workgroup
+class ExposurePipeline : public vkLib::ComputePipeline
+{
+public:
+	ExposurePipeline() = default;
+	ExposurePipeline(vkLib::PShader shader);
+
+	virtual ~ExposurePipeline() = default;
+
+	virtual void UpdateDescriptors();
+
+	void operator()(vk::CommandBuffer cmd, const glm::uvec2& size) const;
+
+	void SetInfo(vkLib::Buffer<ExposureInfo> info) { mInfo = info; }
+	void SetSource(vkLib::ImageView source, vkLib::Core::Ref<vk::Sampler> sampler)
+	{ mSource = source; mSampler = sampler; }
+
+	void SetHistogram(vkLib::Buffer<uint32_t> histogram) { mHistogram = histogram; }
+	void SetState(vkLib::Buffer<ExposureState> state) { mState = state; }
+
+	vkLib::ImageView GetSource() const { return mSource; }
+
+private:
+	vkLib::Buffer<ExposureInfo> mInfo; // Bound at (set: 0, binding: 0)
+
+	vkLib::ImageView mSource; // (set: 0, binding: 1)
+	vkLib::Core::Ref<vk::Sampler> mSampler;
+
+	vkLib::Buffer<uint32_t> mHistogram; // (set: 0, binding: 2)
+	vkLib::Buffer<ExposureState> mState; // (set: 0, binding: 3)
+};
+
+// Buffers of the exposure passes, one set per image being measured
+struct ExposureResources
+{
+	vkLib::Buffer<ExposureInfo> Info;
+	vkLib::Buffer<uint32_t> Histogram;
+	vkLib::Buffer<ExposureState> State;
+
+	ExposureInfo Layout;
+	std::chrono::steady_clock::time_point LastMeasurement;
+};
+
+ExposureResources CreateExposureResources(vkLib::ResourcePool& pool);
+
+// Starts the adaptation over, the first measurement after it snaps straight to the scene
+void ResetExposure(ExposureResources& exposure, const glm::uvec2& resolution, const ExposureSettings& settings);
+
+// Once per measured frame, before the passes are recorded
+void AdvanceExposure(ExposureResources& exposure);
+
+AQUA_END
@@ -0,0 +1,110 @@
+#pragma once
+#include "RayTracingStructures.h"
+
+AQUA_BEGIN
+PH_BEGIN
+
+// Builds the Vulkan acceleration structures traced by the ray query backend (VK_KHR_ray_query)
+// Every mesh and light source of a session becomes one bottom level structure over the shared vertex buffer,
+// instanced once in the top level with its face offset as the custom index
+// Only needs VK_KHR_acceleration_structure and VK_KHR_ray_query, no ray tracing pipelines,
+// so software implementations such as lavapipe can run it as well
+
+// Packs the face indices the way the acceleration structure builds want them
+struct FaceIndexPackPipeline : public vkLib::ComputePipeline
+{
+	FaceIndexPackPipeline() = default;
+	FaceIndexPackPipeline(const vkLib::PShader& shader) { this->SetShader(shader); }
+
+	void UpdateDescriptors();
+
+// Fields...
+	FaceBuffer mFaces;
+	vkLib::Buffer<uint32_t> mIndices;
+};
+
+// Range of the session faces covered by one bottom level structure
+struct AccelerationStructureGeometry
+{
+	uint32_t FaceOffset = 0;
+	uint32_t FaceCount = 0;
+};
+
+struct AccelerationStructure
+{
+	vk::AccelerationStructureKHR Handle;
+	vk::DeviceAddress Address = 0;
+
+	vkLib::Buffer<uint8_t> Storage;
+};
+
+// NOTE: not thread safe
+class AccelerationStructureBuilder
+{
+public:
+	AccelerationStructureBuilder(vkLib::Context context, vkLib::ResourcePool pool,
+		const FaceIndexPackPipeline& packer, uint32_t workGroupSize);
+	~AccelerationStructureBuilder();
+
+	AccelerationStructureBuilder(const AccelerationStructureBuilder&) = delete;
+	AccelerationStructureBuilder& operator=(const AccelerationStructureBuilder&) = delete;
+
+	// The context must have VK_KHR_acceleration_structure and VK_KHR_ray_query enabled,
+	// along with the accelerationStructure, rayQuery and bufferDeviceAddress features
+	static bool IsSupported(const vkLib::Context& context);
+
+	// The vertex buffer must be created with the usage returned here
+	static vk::BufferUsageFlags GetVertexBufferUsage();
+
+	// Returns the index of the geometry, empty ranges are kept but never instanced
+	uint32_t AddGeometry(uint32_t faceOffset, uint32_t faceCount);
+	void Clear() { mGeometries.clear(); }
+
+	// Builds every bottom level structure and the top level one over them
+	void Record(vk::CommandBuffer commandBuffer, const GeometryBuffers& geometry);
+
+	// Rebuilds a single geometry after its vertices moved or its faces were reordered
+	// The top level structure is rebuilt as well, its handle stays the same
+	void RecordUpdate(vk::CommandBuffer commandBuffer, const GeometryBuffers& geometry, uint32_t geometryIdx);
+
+	vk::AccelerationStructureKHR GetTopLevel() const { return mTopLevel.Handle; }
+
+private:
+	vkLib::Core::Ref<vk::Device> mDevice;
+	vk::detail::DispatchLoaderDynamic mDispatcher;
+	vkLib::ResourcePool mResourcePool;
+
+	FaceIndexPackPipeline mPacker;
+	uint32_t mWorkGroupSize = 256;
+
+	std::vector<AccelerationStructureGeometry> mGeometries;
+	std::vector<AccelerationStructure> mBottomLevels;
+	AccelerationStructure mTopLevel;
+
+	vkLib::Buffer<uint32_t> mIndices;
+	vkLib::Buffer<vk::AccelerationStructureInstanceKHR> mInstances;
+	vkLib::Buffer<uint8_t> mScratch;
+
+	vk::DeviceSize mScratchAlignment = 256;
+
+private:
+	void RecordBuild(vk::CommandBuffer commandBuffer, const GeometryBuffers& geometry,
+		uint32_t firstGeometry, uint32_t geometryCount);
+
+	void RecordIndexPacking(vk::CommandBuffer commandBuffer, const FaceBuffer& faces);
+	void RecordTopLevel(vk::CommandBuffer commandBuffer, vk::AccelerationStructureBuildGeometryInfoKHR buildInfo,
+		uint32_t instanceCount, vk::DeviceAddress scratchAddress);
+
+	// Recreates the structure when its storage is too small, the handle changes then
+	void ReserveStructure(AccelerationStructure& structure, vk::AccelerationStructureTypeKHR type, vk::DeviceSize size);
+	void DestroyStructure(AccelerationStructure& structure);
+
+	vk::DeviceAddress ReserveScratch(vk::DeviceSize size);
+	vk::DeviceAddress GetAddress(vk::Buffer buffer) const;
+
+	void InsertBarrier(vk::CommandBuffer commandBuffer, vk::PipelineStageFlags srcStage, vk::AccessFlags srcAccess,
+		vk::PipelineStageFlags dstStage, vk::AccessFlags dstAccess);
+};
+
+PH_END
+AQUA_END
@@ -0,0 +1,64 @@
+#pragma once
+#include "RaytracingStructures.h"
+#include "Core.h"
+
+AQUA_BEGIN
+PH_BEGIN
+
+// Bump whenever the layout of the Face, Node or WideNode structures or the builders change
+#define BVH_CACHE_VERSION      1
+
+// Everything that changes the built tree besides the geometry itself
+struct BVHBuildSettings
+{
+	uint32_t Depth = 0;
+	float SpatialSplitBudget = 0.0f;
+};
+
+// Persists built BVHs on the disk, one file per mesh, named after a hash of the geometry and settings
+// Files are memory mapped on load, so a hit costs about as much as copying the arrays out
+// The vertices aren't stored, they're part of the key and come back from the mesh itself
+
+// NOTE: not thread safe
+class BVHCache
+{
+public:
+	BVHCache() = default;
+	explicit BVHCache(const std::filesystem::path& directory);
+
+	// Creates the directory if it doesn't exist yet
+	void SetDirectory(const std::filesystem::path& directory);
+	const std::filesystem::path& GetDirectory() const { return mDirectory; }
+
+	static uint64_t HashKey(const MeshData& meshData, const BVHBuildSettings& settings);
+
+	// Returns false on a miss, a stale version or a corrupted file; bvh is left untouched then
+	bool Load(uint64_t key, const MeshData& meshData, BVH& bvh) const;
+	bool Store(uint64_t key, const BVH& bvh) const;
+
+private:
+	std::filesystem::path mDirectory;
+
+	struct FileHeader
+	{
+		char Magic[4] = { 'A', 'Q', 'B', 'V' };
+		uint32_t Version = BVH_CACHE_VERSION;
+		uint64_t Key = 0;
+
+		// Guards against a different compiler or struct packing reading the file
+		uint32_t FaceStride = sizeof(Face);
+		uint32_t NodeStride = sizeof(Node);
+		uint32_t WideNodeStride = sizeof(WideNode);
+		uint32_t VertexCount = 0;
+
+		uint64_t FaceCount = 0;
+		uint64_t NodeCount = 0;
+		uint64_t WideNodeCount = 0;
+	};
+
+private:
+	std::filesystem::path GetFilepath(uint64_t key) const;
+};
+
+PH_END
+AQUA_END
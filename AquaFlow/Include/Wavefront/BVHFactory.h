@@ -14,7 +14,7 @@ struct SplitStrategy
 	SplitFunction mSplit;
 };
 
-// TODO: The only thing remaining now is to utilize GPU to construct BVH structure
+// The GPU counterpart lives in LBVHBuilder.h
 
 // NOTE: not thread safe
 // TODO: yet to test out...
@@ -26,11 +26,23 @@ public:
 	void SetDepth(int depth) { mDepth = depth; }
 	void SetSplitStrategy(const SplitStrategy& strategy) { mStrategy = strategy; }
 
+	// Switches the build to a binned SAH builder with spatial splits (SBVH)
+	// The budget is the fraction of extra face references the splits may create, zero turns it off
+	// Split references get duplicated in the face array of the built BVH
+	void SetSpatialSplitBudget(float budget) { mSpatialSplitBudget = budget; }
+
 	template <typename VertIt, typename IdxIt>
 	BVH Build(VertIt vBeg, VertIt vEnd, IdxIt iBeg, IdxIt iEnd);
 
 	void Cleanup();
 
+	// Keeps the topology and recomputes the node bounds bottom up from bvh.Vertices
+	// Relies on the children being stored after their parents, which is how Build lays them out
+	void Refit(BVH& bvh) const;
+
+	// Surface area heuristic cost of the tree, relative to the root; used to tell how far refits degraded it
+	static float SAHCost(const BVH& bvh);
+
 private:
 	BVH mCurrent;
 	std::vector<glm::vec3> mVertices;
@@ -41,6 +53,12 @@ private:
 
 	SplitStrategy mStrategy{ DefaultSplitFn::sSpatialSplit };
 
+	// SBVH...
+	float mSpatialSplitBudget = 0.0f;
+	float mSpatialSplitAlpha = 1.0e-5f; // Overlap (relative to the root area) needed before trying a spatial split
+	uint32_t mSpatialSplitBins = 16;
+	size_t mDuplicateBudget = 0;
+
 public:
 	struct DefaultSplitFn
 	{
@@ -68,6 +86,32 @@ private:
 	glm::vec3 TriangleCentroid(uint32_t i);
 	std::pair<Box, Box> SplitBox(const Node& node);
 	std::pair<Node, Node> MakeChildNodes(const Node& parentNode, const Box& leftBox, const Box& rightBox);
+
+	// SBVH...
+	struct Reference
+	{
+		glm::vec3 Min;
+		glm::vec3 Max;
+		uint32_t FaceIdx;
+	};
+
+	struct SplitCandidate
+	{
+		float Cost = FLT_MAX;
+		int Axis = -1;
+		float Position = 0.0f;
+		float Overlap = 0.0f; // Surface area shared by the two children
+		bool Spatial = false;
+	};
+
+	void BuildSpatialSplits();
+	void SplitReferences(uint32_t nodeIdx, std::vector<Reference>& refs, std::vector<Face>& faces, int depth, float rootArea);
+
+	SplitCandidate FindObjectSplit(const std::vector<Reference>& refs, const Node& node) const;
+	SplitCandidate FindSpatialSplit(const std::vector<Reference>& refs, const Node& node) const;
+
+	// Bounds of the part of the reference between lo and hi along the axis
+	bool ClipReference(const Reference& ref, int axis, float lo, float hi, Reference& clipped) const;
 };
 
 template <typename VertIt, typename IdxIt>
@@ -80,13 +124,20 @@ BVH AQUA_NAMESPACE::PH_FLUX_NAMESPACE::BVHFactory::Build(VertIt vBeg, VertIt vEn
 
 	Clear();
 
-	Node& rootNode = mCurrent.Nodes.emplace_back();
+	if (mSpatialSplitBudget > 0.0f && !mFaces.empty())
+	{
+		BuildSpatialSplits();
+	}
+	else
+	{
+		Node& rootNode = mCurrent.Nodes.emplace_back();
 
-	rootNode.BeginIndex = 0;
-	rootNode.EndIndex = static_cast<uint32_t>(mFaces.size());
+		rootNode.BeginIndex = 0;
+		rootNode.EndIndex = static_cast<uint32_t>(mFaces.size());
 
-	EncloseIntoBoundingBox(rootNode);
-	SplitRecursive(rootNode, mDepth);
+		EncloseIntoBoundingBox(rootNode);
+		SplitRecursive(rootNode, mDepth);
+	}
 
 	mCurrent.Vertices = std::move(mVertices);
 	mCurrent.Faces = std::move(mFaces);
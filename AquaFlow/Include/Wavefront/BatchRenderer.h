@@ -0,0 +1,79 @@
+#pragma once
+#include "TileScheduler.h"
+
+AQUA_BEGIN
+PH_BEGIN
+
+// Renders a list of camera/time jobs against one committed trace session
+// The BVHs, pipelines, ray buffers and the target are made once and reused by every job,
+// only the camera and whatever the scene update touches change in between
+
+struct BatchJob
+{
+	glm::mat4 CameraView = glm::mat4(1.0f);
+
+	// Handed to the scene update, the estimator itself has no notion of the animation time
+	float Time = 0.0f;
+
+	// Written as a binary PPM, left out when empty
+	std::filesystem::path OutputPath;
+};
+
+// Poses the scene for a job, e.g. through UpdateRenderable or SetRenderableMotion
+// Must not begin a new scope, the BVH layout and the descriptors are shared by all the jobs
+using BatchSceneUpdateFn = std::function<void(TraceSession&, const BatchJob&)>;
+
+// NOTE: not thread safe
+class BatchRenderer
+{
+public:
+	BatchRenderer() = default;
+	~BatchRenderer() = default;
+
+	BatchRenderer(const BatchRenderer&) = delete;
+	BatchRenderer& operator=(const BatchRenderer&) = delete;
+
+	BatchRenderer(BatchRenderer&&) = default;
+	BatchRenderer& operator=(BatchRenderer&&) = default;
+
+	// Renders the jobs in order and returns how many of them made it to the disk
+	size_t Render(const std::vector<BatchJob>& jobs);
+
+	// Renders a single job and leaves the result in the presentable
+	TraceResult Render(const BatchJob& job);
+
+	void SetDepth(uint32_t depth);
+	void SetTraceSession(const TraceSession& traceSession);
+	void SetSceneUpdate(const BatchSceneUpdateFn& sceneUpdate) { mSceneUpdate = sceneUpdate; }
+
+	template<typename Iter>
+	void SetMaterialPipelines(Iter Begin, Iter End)
+	{
+		mScheduler.SetMaterialPipelines(Begin, End);
+		mValidated = false;
+	}
+
+	// Getters...
+	TileScheduler& GetScheduler() { return mScheduler; }
+	vkLib::Image GetPresentable() const { return mScheduler.GetPresentable(); }
+	TraceSession GetTraceSession() const { return mSession; }
+
+private:
+	TileScheduler mScheduler;
+	TraceSession mSession;
+
+	BatchSceneUpdateFn mSceneUpdate;
+
+	// Host visible copy of the target, one RGBA8 texel per element
+	vkLib::Buffer<uint32_t> mReadback;
+
+	bool mValidated = false;
+
+private:
+	bool WriteImage(const std::filesystem::path& path);
+
+	friend class WavefrontEstimator;
+};
+
+PH_END
+AQUA_END
@@ -20,6 +20,10 @@ public:
 
 	TraceResult Trace();
 
+	// Records the whole trace into its own command buffers and hands it to a single queue in one batch
+	// Returns without waiting; the queue must be idle again before the next trace of this executor
+	TraceResult Submit(vkLib::Core::Ref<vkLib::Core::Queue> worker);
+
 	void Validate() { ConstructExecutionGraphs(mDepth); }
 
 	void SetDepth(uint32_t depth) { mDepth = depth; }
@@ -33,10 +37,25 @@ public:
 
 	void SetCameraView(const glm::mat4& cameraView);
 
+	// Moves the tile within the target resolution, the live paths are thrown away
+	void SetTileOrigin(const glm::ivec2& origin);
+
+	// The next trace starts over with fresh paths and an empty pixel mean
+	void InvalidatePaths() { mExecutionBlock.ResetPaths = true; }
+
+	// Without any flags the presentable holds the raw pixel mean; takes effect on the next Validate
+	void SetPostProcess(PostProcessFlags flags) { mPostProcess = flags; }
+
+	// Tone mapping follows the exposure adapted to the tile, the adaptation starts over here
+	// Tiles of a TileScheduler are left raw, the scheduler measures and post processes the whole target
+	void SetExposureSettings(const ExposureSettings& settings);
+
 	// Getters...
 	TraceSession GetTraceSession() const { return mExecutorInfo->TracingSession; }
 
 	glm::ivec2 GetTargetResolution() const { return mExecutorInfo->Target.ImageResolution; }
+	glm::ivec2 GetTileSize() const { return mExecutorInfo->CreateInfo.TileSize; }
+	glm::ivec2 GetTileOrigin() const { return mExecutionBlock.TileOrigin; }
 	vkLib::Image GetPresentable() const { return mExecutorInfo->Target.Presentable; }
 	vkLib::Buffer<WavefrontSceneInfo> GetSceneInfo() const { return mExecutorInfo->Scene; }
 
@@ -45,6 +64,7 @@ public:
 	CollisionInfoBuffer GetCollisionBuffer() const { return mExecutorInfo->CollisionInfos; }
 	RayRefBuffer GetRayRefBuffer() const { return mExecutorInfo->RayRefs; }
 	RayInfoBuffer GetRayInfoBuffer() const { return mExecutorInfo->RayInfos; }
+	PathQueueBuffer GetPathQueue() const { return mExecutorInfo->PathQueue; }
 	vkLib::Buffer<uint32_t> GetMaterialRefCounts() const { return mExecutorInfo->RefCounts; }
 	vkLib::Image GetVariance() const { return mExecutorInfo->Target.PixelVariance; }
 	vkLib::Image GetMean() const { return mExecutorInfo->Target.PixelMean; }
@@ -63,6 +83,9 @@ private:
 	ExecutionBlock mExecutionBlock;
 
 	std::vector<vk::CommandBuffer> mCmdBufs;
+	std::vector<vk::CommandBuffer> mSubmitCmdBufs; // One per operation, allocated by the first Submit
+
+	PassTimestamps mTimestamps;
 
 private:
 	Executor(const ExecutorCreateInfo& createInfo);
@@ -71,6 +94,9 @@ private:
 
 	uint32_t GetRandomNumber();
 
+	// Common prologue of Trace and Submit
+	void BeginTrace();
+
 	void RecordRayGenerator(vk::CommandBuffer commandBuffer, uint32_t pActiveBuffer);
 
 	void ExecuteRaySortFinisher(vk::CommandBuffer commandBuffer);
@@ -78,13 +104,22 @@ private:
 	void ExecuteRayCounter(vk::CommandBuffer commandBuffer);
 	void ExecuteRaySortPreparer(vk::CommandBuffer commandBuffer, uint32_t pActiveBuffer);
 	void RecordIntersectionTester(vk::CommandBuffer commandBuffer, uint32_t pActiveBuffer);
-	void RecordLuminanceMean(vk::CommandBuffer commandBuffer, uint32_t pActiveBuffer);
+	void RecordOcclusionTester(vk::CommandBuffer commandBuffer);
+	void RecordPathRegenerator(vk::CommandBuffer commandBuffer, uint32_t pActiveBuffer);
+	void RecordPathQueueUpdate(vk::CommandBuffer commandBuffer, uint32_t pSampleGrant);
+	void RecordLuminanceMean(vk::CommandBuffer commandBuffer);
+	void RecordExposure(vk::CommandBuffer commandBuffer);
 	void RecordPostProcess(vk::CommandBuffer commandBuffer);
 
-	void UpdateSceneInfo();
+	void UpdateSceneInfo(bool resetPaths);
+	void ResetPathQueue();
 
 	void InvalidateMaterialData();
 
+	// Both are no-ops unless the timestamps are armed; the pair index is handed from one to the other
+	uint32_t BeginPassTimestamp(vk::CommandBuffer commandBuffer, WavefrontPass pass);
+	void EndPassTimestamp(vk::CommandBuffer commandBuffer, uint32_t pairIdx);
+
 private:
 	void AssignMaterialsResources(MaterialInstance& instance, const SessionInfo& TracingSession);
 	void RecordMaterialPipeline(vk::CommandBuffer cmd, uint32_t pMaterialRef, uint32_t pBounceIdx, uint32_t pActiveBuffer);
@@ -94,6 +129,7 @@ private:
 	void Sweep(EXEC_NAMESPACE::GraphBuilder& builder, uint32_t currDepth, const std::string& closingOp = "");
 
 	friend class WavefrontEstimator;
+	friend class WorkgroupTuner;
 };
 
 template<typename Iter>
@@ -14,6 +14,7 @@ struct ExecutionPipelines
 {
 	RayGenerationPipeline RayGenerator; // Simulates physical camera...
 	IntersectionPipeline IntersectionPipeline; // Intersection testing stage...
+	OcclusionPipeline OcclusionTester; // Any hit testing of the shadow rays...
 
 	// Sorting stages...
 	RaySortEpiloguePipeline RaySortPreparer;
@@ -28,7 +29,12 @@ struct ExecutionPipelines
 	// All of them will deactivate the ray
 	MaterialInstance InactiveRayShader; // TODO: Skybox shader hasn't been implemented yet...
 
+	// Path regeneration stages...
+	PathRegenerationPipeline PathRegenerator; // Refills the terminated paths and compacts the wavefront
+	PathQueuePipeline PathQueueUpdater; // Writes the indirect dispatch arguments for the next bounce
+
 	LuminanceMeanPipeline LuminanceMean; // Accumulates the incoming light into an average sum
+	ExposurePipeline Exposure; // Adapts the exposure of the tone mapping to the pixel mean
 	PostProcessImagePipeline PostProcessor; // For post processing...
 };
 
@@ -36,14 +42,43 @@ struct ExecutionBlock
 {
 	uint32_t BounceIdx = 0;
 	uint32_t ActiveBuffer = 0;
+
+	// Paths live across the traces; they're only thrown away when the session or the tile changes
+	bool ResetPaths = true;
+
+	// Top left pixel of the traced tile within the target resolution
+	glm::ivec2 TileOrigin = { 0, 0 };
+	// Traces accumulated into the pixel mean of the tile so far
+	uint32_t FrameCount = 0;
+};
+
+enum class WavefrontPass
+{
+	eIntersection           = 0,
+	eMaterialEval           = 1,
+};
+
+// Timestamp pairs written around the intersection and material dispatches
+// Only armed by the WorkgroupTuner, the pool belongs to it
+struct PassTimestamps
+{
+	vk::QueryPool Pool;
+	uint32_t Capacity = 0; // In pairs
+
+	// Pass of every pair written by the current trace
+	std::vector<WavefrontPass> Passes;
 };
 
 struct ExecutorCreateInfo
 {
+	// The ray buffers and the target images are sized for one tile
 	glm::ivec2 TargetResolution = { 1920, 1080 };
 	glm::ivec2 TileSize = { 1920, 1080 };
 
 	bool AllowSorting = true;
+
+	// Camera samples handed out to every pixel per trace by the path regeneration
+	uint32_t SamplesPerPixel = 4;
 };
 
 struct ExecutionInfo
@@ -60,6 +95,14 @@ struct ExecutionInfo
 	CollisionInfoBuffer CollisionInfos;
 	RayRefBuffer RayRefs; // For sorting...
 
+	PathQueueBuffer PathQueue; // Live path count, sample counter and the indirect dispatch arguments
+	SampleAccumulatorBuffer SampleAccumulator; // Radiance of the finished paths, resolved by the luminance mean
+
+	ExposureResources Exposure; // Measured on the pixel mean of the tile, never read back
+
+	ShadowRayBuffer ShadowRays; // One slot per live path, written by the material passes
+	OcclusionMaskBuffer OcclusionMask; // One bit per shadow ray
+
 	vkLib::Buffer<uint32_t> RefCounts; // Resized by the SetMaterialPipelines
 	vkLib::Buffer<WavefrontSceneInfo> Scene;
 
@@ -0,0 +1,102 @@
+#pragma once
+#include "RayTracingStructures.h"
+#include "SortRecorder.h"
+
+AQUA_BEGIN
+PH_BEGIN
+
+// GPU linear BVH builder: centroid bounds -> morton codes -> sort -> Karras hierarchy
+// -> bottom up refit with tree rotations -> wide node collapse
+// The output uses the same node and face layout as the BVHFactory and WideBVHFactory,
+// so the intersection kernel can't tell the two builders apart
+
+enum class LBVHStage
+{
+	eCentroidBounds            = 1,
+	eMortonCodes               = 2,
+	eHierarchy                 = 3,
+	eRefit                     = 4,
+	eCollapse                  = 5,
+};
+
+using MortonRef = typename SortRecorder<uint32_t>::ArrayRef;
+
+struct LBVHBuildPipeline : public vkLib::ComputePipeline
+{
+	LBVHBuildPipeline() = default;
+	LBVHBuildPipeline(const vkLib::PShader& shader) { this->SetShader(shader); }
+
+	void UpdateDescriptors();
+
+// Fields...
+	LBVHStage mStage = LBVHStage::eCentroidBounds;
+
+	GeometryBuffers mGeometry;
+	FaceBuffer mInputFaces;
+
+	vkLib::Buffer<MortonRef> mMortonRefs;
+	vkLib::Buffer<uint32_t> mParents;
+	vkLib::Buffer<uint32_t> mVisitFlags;
+	vkLib::Buffer<glm::uvec4> mCentroidBounds;
+};
+
+struct LBVHPipelines
+{
+	LBVHBuildPipeline CentroidBounds;
+	LBVHBuildPipeline MortonCodes;
+	LBVHBuildPipeline Hierarchy;
+	LBVHBuildPipeline Refit;
+	LBVHBuildPipeline Collapse;
+};
+
+struct LBVHBuildInfo
+{
+	// Vertices are read and the faces, nodes and wide nodes are written in place
+	GeometryBuffers Geometry;
+
+	uint32_t FaceCount = 0;
+	uint32_t FaceOffset = 0;
+	uint32_t NodeOffset = 0;
+	uint32_t WideNodeOffset = 0;
+};
+
+// NOTE: not thread safe
+class LBVHBuilder
+{
+public:
+	LBVHBuilder() = default;
+	LBVHBuilder(vkLib::PipelineBuilder builder, vkLib::ResourcePool pool,
+		const LBVHPipelines& pipelines, uint32_t workGroupSize);
+
+	// The faces in [FaceOffset, FaceOffset + FaceCount) are reordered in place, so rebuilding
+	// a mesh after its vertices moved is just another call with the same info
+	// The node ranges must already be reserved (see GetNodeCount and GetWideNodeCount)
+	void Record(vk::CommandBuffer commandBuffer, const LBVHBuildInfo& buildInfo);
+
+	static uint32_t GetNodeCount(uint32_t faceCount) { return 2 * faceCount - 1; }
+	static uint32_t GetWideNodeCount(uint32_t faceCount) { return std::max(faceCount, 2u) - 1; }
+
+private:
+	LBVHPipelines mPipelines;
+	std::shared_ptr<SortRecorder<uint32_t>> mSorter;
+
+	// Scratch...
+	FaceBuffer mInputFaces;
+	vkLib::Buffer<uint32_t> mParents;
+	vkLib::Buffer<uint32_t> mVisitFlags;
+	vkLib::Buffer<glm::uvec4> mCentroidBounds;
+
+	uint32_t mWorkGroupSize = 256;
+
+private:
+	void ReserveScratch(uint32_t faceCount);
+	void UpdateDescriptors(const LBVHBuildInfo& buildInfo);
+
+	void RecordStage(vk::CommandBuffer commandBuffer, const LBVHBuildPipeline& pipeline,
+		const LBVHBuildInfo& buildInfo, uint32_t threadCount, uint32_t sortedBuffer);
+
+	void InsertBarrier(vk::CommandBuffer commandBuffer, vk::PipelineStageFlags srcStage, vk::AccessFlags srcAccess);
+};
+
+PH_END
+AQUA_END
@@ -0,0 +1,43 @@
+#pragma once
+#include "RayTracingStructures.h"
+#include "Core.h"
+
+AQUA_BEGIN
+PH_BEGIN
+
+// Builds a binary hierarchy over the emitters of a trace session
+// The tree is traversed on the GPU to pick a light proportional to its estimated contribution
+
+// NOTE: not thread safe
+class LightTreeFactory
+{
+public:
+	LightTreeFactory() = default;
+
+	void AddTriangleEmitter(const glm::vec3& a, const glm::vec3& b, const glm::vec3& c,
+		uint32_t primitiveID, const glm::vec3& radiance);
+
+	void AddPointEmitter(const glm::vec3& position, const glm::vec3& intensity);
+
+	// Emitters are reordered, every leaf references exactly one of them
+	LightTree Build();
+
+	void Clear();
+
+	size_t GetEmitterCount() const { return mEmitters.size(); }
+
+private:
+	std::vector<LightEmitter> mEmitters;
+	std::vector<Box> mBounds;
+
+	std::vector<uint32_t> mOrder;
+	LightTree mCurrent;
+
+private:
+	uint32_t BuildRecursive(uint32_t begin, uint32_t end);
+
+	glm::vec3 GetCentroid(uint32_t emitterIdx) const;
+};
+
+PH_END
+AQUA_END
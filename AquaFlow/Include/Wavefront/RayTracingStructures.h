@@ -43,8 +43,34 @@ struct Ray
 struct RayInfo
 {
 	alignas(16) glm::uvec2 ImageCoordinate;
+	alignas(4)  uint32_t Depth; // Number of bounces the path has taken so far
+	alignas(4)  uint32_t Flags; // Emitters sampled by the last material pass, see PATH_FLAG_* in Common.glsl
 	alignas(16) glm::vec4 Luminance;
-	alignas(16) glm::vec4 Throughput;
+	alignas(16) glm::vec3 Throughput;
+	alignas(4)  float Time; // Shutter time of the path in [0, 1), zero without motion blur
+};
+
+// Visibility query written by the material passes and resolved by the occlusion pass
+struct ShadowRay
+{
+	alignas(16) glm::vec3 Origin;
+	alignas(4)  float MaxDistance = 0.0f; // Zero marks an empty slot
+	alignas(16) glm::vec3 Direction;
+	alignas(4)  float Time = 0.0f; // Shutter time of the path that issued it
+	alignas(16) glm::vec4 Radiance;
+};
+
+// Shared between the regeneration and the intersection/material passes
+// The dispatch fields are consumed directly by vkCmdDispatchIndirect
+struct PathQueue
+{
+	alignas(4) uint32_t ActiveCount = 0; // Live paths in the active half of the ray buffers
+	alignas(4) uint32_t NextActiveCount = 0; // Paths appended to the inactive half by the regeneration pass
+	alignas(4) uint32_t SampleCounter = 0; // Global sample index handed out to the regenerated paths
+	alignas(4) uint32_t SampleBudget = 0; // Regeneration stops once the counter reaches the budget
+
+	alignas(16) glm::uvec4 IntersectionDispatch = glm::uvec4(0, 1, 1, 0);
+	alignas(16) glm::uvec4 MaterialDispatch = glm::uvec4(0, 1, 1, 0);
 };
 
 // Set 1
@@ -77,6 +103,10 @@ struct ShaderData
 	alignas(4) uint32_t uSkyboxExists = false;
 	// The alpha channel contains the rotation of the cube map
 	alignas(16) glm::vec4 uSkyboxColor = glm::vec4(0.0f, 1.0f, 1.0f, 0.0f);
+
+	// Environment map importance sampling
+	alignas(8) glm::uvec2 uEnvResolution = glm::uvec2(0);
+	alignas(4) float uEnvIntegral = 0.0f; // Sum of the luminance * sin(theta) weights
 };
 
 struct LightProperties
@@ -87,7 +117,7 @@ struct LightProperties
 struct LightInfo
 {
 	alignas(4) uint32_t BeginIndex = 0;
-	alignas(4) uint32_t Padding = 0;
+	alignas(4) uint32_t WideRootIndex = 0; // Root of the collapsed wide BVH
 	alignas(4) uint32_t EndIndex = 0;
 	alignas(4) uint32_t LightPropIndex = uint32_t(-1);
 };
@@ -95,11 +125,29 @@ struct LightInfo
 struct MeshInfo
 {
 	alignas(4) uint32_t BeginIndex = 0;
-	alignas(4) uint32_t Padding = 0;
+	alignas(4) uint32_t WideRootIndex = 0; // Root of the collapsed wide BVH
 	alignas(4) uint32_t EndIndex = 0;
 	alignas(4) uint32_t MaterialIndex = uint32_t(-1);
 };
 
+// Object to world transform of a mesh at the shutter open and close
+// Static meshes leave Moving at zero and are traced with the vertices as submitted
+struct InstanceMotion
+{
+	alignas(16) glm::vec4 StartRotation = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f); // Quaternion in (x, y, z, w)
+	alignas(16) glm::vec4 EndRotation = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+
+	alignas(16) glm::vec3 StartTranslation = glm::vec3(0.0f);
+	alignas(4)  uint32_t Moving = 0;
+	alignas(16) glm::vec3 EndTranslation = glm::vec3(0.0f);
+	alignas(4)  float Padding1 = 0.0f;
+
+	alignas(16) glm::vec3 StartScale = glm::vec3(1.0f);
+	alignas(4)  float Padding2 = 0.0f;
+	alignas(16) glm::vec3 EndScale = glm::vec3(1.0f);
+	alignas(4)  float Padding3 = 0.0f;
+};
+
 struct SceneInfo
 {
 	alignas(8) glm::ivec2 MinBound = glm::ivec2(0, 0);
@@ -133,6 +181,28 @@ struct WavefrontSceneInfo
 	alignas(4) uint32_t FrameCount = 1;
 };
 
+// Emissive triangle or analytic point light referenced by the light tree
+struct LightEmitter
+{
+	alignas(16) glm::vec3 Position = glm::vec3(0.0f); // Only used by the point lights
+	alignas(4)  uint32_t PrimitiveID = uint32_t(-1); // Face index of an emissive triangle; -1 marks a point light
+
+	alignas(16) glm::vec3 Radiance = glm::vec3(0.0f); // Intensity for the point lights
+	alignas(4)  float Power = 0.0f; // Estimated flux, drives the importance while traversing the tree
+};
+
+struct LightTreeNode
+{
+	alignas(16) glm::vec3 MinBound = glm::vec3(0.0f);
+	alignas(4)  float Power = 0.0f; // Summed over all the emitters below the node
+
+	alignas(16) glm::vec3 MaxBound = glm::vec3(0.0f);
+	alignas(4)  uint32_t EmitterIndex = uint32_t(-1); // Valid for the leaves only
+
+	alignas(4)  uint32_t FirstChildIndex = 0;
+	alignas(4)  uint32_t SecondChildIndex = 0;
+};
+
 struct CollisionInfo
 {
 	// Values set by the collision solver...
@@ -151,6 +221,8 @@ struct CollisionInfo
 	// Booleans...
 	alignas(4)  bool HitOccured;
 	alignas(4)  bool IsLightSrc;
+
+	alignas(4)  float Time; // Shutter time the hit was found at
 };
 
 struct CameraData
@@ -168,6 +240,8 @@ using VertexBuffer = vkLib::Buffer<glm::vec4>;
 using FaceBuffer = vkLib::Buffer<Face>;
 using NormalBuffer = vkLib::Buffer<glm::vec4>;
 using TexCoordBuffer = vkLib::Buffer<glm::vec2>;
+// Tangent in xyz, handedness of the bitangent in w; zero when the mesh has none
+using TangentBuffer = vkLib::Buffer<glm::vec4>;
 
 struct Node
 {
@@ -182,13 +256,44 @@ struct Node
 	alignas(4) uint32_t SecondChildIndex = 0;
 };
 
+#define WIDE_BVH_WIDTH            4
+#define WIDE_BVH_INVALID_CHILD    uint32_t(-1)
+
+// Four children per node, collapsed from the binary build
+// Child bounds are quantized to 8 bits per plane relative to the node origin
+struct WideNode
+{
+	alignas(16) glm::vec3 Origin = glm::vec3(0.0f);
+	alignas(4)  uint32_t Exponents = 0; // Biased (by 127) power of two scales of x, y and z in the lowest three bytes
+
+	alignas(16) glm::uvec4 ChildIndex = glm::uvec4(WIDE_BVH_INVALID_CHILD); // Node index, or the first face for the leaves
+	alignas(16) glm::uvec4 ChildFaceCount = glm::uvec4(0); // Zero for the interior children
+
+	// x, y and z packed into the lowest three bytes
+	alignas(16) glm::uvec4 QuantizedMin = glm::uvec4(0);
+	alignas(16) glm::uvec4 QuantizedMax = glm::uvec4(0);
+};
+
 using NodeBuffer = vkLib::Buffer<Node>;
+using WideNodeBuffer = vkLib::Buffer<WideNode>;
 using LightPropsBuffer = vkLib::Buffer<LightProperties>;
 using CollisionInfoBuffer = vkLib::Buffer<CollisionInfo>;
 using RayBuffer = vkLib::Buffer<Ray>;
 using RayInfoBuffer = vkLib::Buffer<RayInfo>;
+using PathQueueBuffer = vkLib::Buffer<PathQueue>;
+using ShadowRayBuffer = vkLib::Buffer<ShadowRay>;
+
+// One bit per shadow ray, set when the segment is blocked
+using OcclusionMaskBuffer = vkLib::Buffer<uint32_t>;
+
+// Fixed point radiance sums in rgb, sample count in alpha
+using SampleAccumulatorBuffer = vkLib::Buffer<glm::uvec4>;
+
+using LightEmitterBuffer = vkLib::Buffer<LightEmitter>;
+using LightTreeBuffer = vkLib::Buffer<LightTreeNode>;
 
 using MeshInfoBuffer = vkLib::Buffer<MeshInfo>;
+using InstanceMotionBuffer = vkLib::Buffer<InstanceMotion>;
 using LightInfoBuffer = vkLib::Buffer<LightInfo>;
 
 using ShaderDataUniform = vkLib::Buffer<ShaderData>;
@@ -198,10 +303,12 @@ struct GeometryBuffers
 	VertexBuffer Vertices;
 	NormalBuffer Normals;
 	TexCoordBuffer TexCoords;
+	TangentBuffer Tangents;
 
 	FaceBuffer Faces;
 
 	NodeBuffer Nodes;
+	WideNodeBuffer WideNodes;
 };
 
 struct BVH
@@ -209,6 +316,13 @@ struct BVH
 	std::vector<glm::vec3> Vertices;
 	std::vector<Face> Faces;
 	std::vector<Node> Nodes;
+	std::vector<WideNode> WideNodes;
+};
+
+struct LightTree
+{
+	std::vector<LightEmitter> Emitters;
+	std::vector<LightTreeNode> Nodes;
 };
 
 struct EstimatorTarget
@@ -217,6 +331,9 @@ struct EstimatorTarget
 	vkLib::Image PixelVariance{};
 	vkLib::Image Presentable{};
 
+	// The exposure histogram fetches the mean through it
+	vkLib::Core::Ref<vk::Sampler> MeanSampler;
+
 	glm::ivec2 ImageResolution{};
 };
 
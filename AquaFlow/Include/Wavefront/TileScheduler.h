@@ -0,0 +1,138 @@
+#pragma once
+#include "Executor.h"
+
+AQUA_BEGIN
+PH_BEGIN
+
+// Splits a large target into tiles and keeps several of them in flight at once
+// Every slot is a complete executor (ray buffers, pipelines, semaphores, command buffers)
+// pinned to its own worker queue of the compute family, so the tiles never wait on each other
+
+struct TileSchedulerCreateInfo
+{
+	glm::ivec2 TargetResolution = { 1920, 1080 };
+	glm::ivec2 TileSize = { 512, 512 };
+
+	// Zero means one slot per worker queue
+	uint32_t TilesInFlight = 0;
+
+	// Traces spent on a tile before it's copied out and the slot moves on
+	uint32_t PassesPerTile = 1;
+
+	bool AllowSorting = true;
+	uint32_t SamplesPerPixel = 4;
+};
+
+struct TileRegion
+{
+	glm::ivec2 Origin = { 0, 0 };
+	glm::ivec2 Extent = { 0, 0 }; // Cropped to the target resolution
+};
+
+struct TileSlot
+{
+	Executor Tracer;
+	vkLib::Core::Ref<vkLib::Core::Queue> Worker;
+
+	// Tile still being traced on the worker, copied into the target once the queue drains
+	int64_t PendingTile = -1;
+};
+
+using CloneMaterialFn = std::function<MaterialInstance(const MaterialInstance&)>;
+
+// NOTE: not thread safe
+class TileScheduler
+{
+public:
+	TileScheduler() = default;
+	~TileScheduler() = default;
+
+	// The executors record lambdas pointing at themselves, so the slots must stay put
+	TileScheduler(const TileScheduler&) = delete;
+	TileScheduler& operator=(const TileScheduler&) = delete;
+
+	TileScheduler(TileScheduler&&) = default;
+	TileScheduler& operator=(TileScheduler&&) = default;
+
+	// Traces every tile of the target and blocks until all of them are copied in
+	TraceResult Trace();
+
+	void Validate();
+
+	void SetDepth(uint32_t depth);
+	void SetTraceSession(const TraceSession& traceSession);
+	void SetCameraView(const glm::mat4& cameraView);
+	void SetSortingFlag(bool allowSort);
+
+	// Applied to the whole target once every tile is in, the tiles themselves stay raw
+	void SetPostProcess(PostProcessFlags flags) { mPostProcess = flags; }
+
+	// One exposure for the whole target, measured on every tile of the frame; the adaptation starts over here
+	void SetExposureSettings(const ExposureSettings& settings);
+
+	// The first slot runs the given instances, the others run clones of them
+	template<typename Iter>
+	void SetMaterialPipelines(Iter Begin, Iter End);
+
+	// Getters...
+	vkLib::Image GetPresentable() const { return mTarget; }
+	glm::ivec2 GetTargetResolution() const { return mCreateInfo.TargetResolution; }
+	const std::vector<TileRegion>& GetTiles() const { return mTiles; }
+	size_t GetTilesInFlight() const { return mSlots.size(); }
+
+private:
+	std::vector<TileSlot> mSlots;
+	std::vector<TileRegion> mTiles;
+
+	vkLib::Image mTarget;
+
+	// The pixel means of the tiles are gathered here when there's a post process to run
+	vkLib::Image mTargetMean;
+
+	PostProcessFlags mPostProcess;
+
+	ExposureResources mExposure; // Shared by every tile, so they can't disagree on the tone mapping
+	ExposurePipeline mExposurePipeline;
+	PostProcessImagePipeline mPostProcessor;
+
+	vkLib::CommandBufferAllocator mCmdAlloc;
+	vk::CommandBuffer mPostProcessCmd;
+
+	TileSchedulerCreateInfo mCreateInfo;
+	CloneMaterialFn mCloneMaterial;
+
+private:
+	void SplitTarget();
+	void CollectTile(TileSlot& slot);
+
+	// A single exposure measurement over the gathered means, then the post process of the whole target
+	void PostProcessTarget();
+
+	friend class WavefrontEstimator;
+};
+
+template<typename Iter>
+inline void TileScheduler::SetMaterialPipelines(Iter Begin, Iter End)
+{
+	std::vector<MaterialInstance> instances(Begin, End);
+
+	if (mSlots.empty())
+		return;
+
+	mSlots.front().Tracer.SetMaterialPipelines(instances.begin(), instances.end());
+
+	// Materials keep their descriptors in the pipeline, which can't be shared by the tiles in flight
+	for (size_t i = 1; i < mSlots.size(); i++)
+	{
+		std::vector<MaterialInstance> clones;
+		clones.reserve(instances.size());
+
+		for (const auto& instance : instances)
+			clones.emplace_back(mCloneMaterial(instance));
+
+		mSlots[i].Tracer.SetMaterialPipelines(clones.begin(), clones.end());
+	}
+}
+
+PH_END
+AQUA_END
@@ -15,13 +15,43 @@ public:
 	void Begin(const WavefrontTraceInfo& beginInfo);
 	// (Only works at eReceiving stage)
 	// (For developers: eLightSrc corresponds to face id -- 1 and eObject corresponds to 0)
-	void SubmitRenderable(const MeshData& meshData, uint32_t bvhDepth);
+	// Deformable renderables reserve room for a full rebuild and can later be changed with UpdateRenderable
+	void SubmitRenderable(const MeshData& meshData, uint32_t bvhDepth, bool deformable = false);
 	// (Only works at eReceiving stage)
 	// (For developers: eLightSrc corresponds to face id -- 1 and eObject corresponds to 0)
 	void SubmitLightSrc(const MeshData& meshData, const glm::vec3& lightIntensity, uint32_t bvhDepth);
+	// (Only works at eReceiving stage)
+	// Point lights can't be hit by the rays; they're only reachable by sampling the light tree
+	void SubmitPointLight(const glm::vec3& position, const glm::vec3& intensity);
 	// Ending the scope (eReceiving state --> eReady state)
 	void End();
 
+	// eGPU builds the renderables with the linear BVH builder, the bvhDepth is ignored then
+	// Light sources always use the CPU builder since their emitters refer to the final face order
+	void SetBVHBuildMode(BVHBuildMode mode) { mSessionInfo->BuildMode = mode; }
+
+	// Enables spatial splits for the CPU built static renderables, e.g 0.3 allows 30% duplicated faces
+	// Light sources and deformable renderables keep the plain splits
+	void SetSpatialSplitBudget(float budget) { mSessionInfo->SpatialSplitBudget = budget; }
+
+	// CPU built trees get stored in and loaded from this directory, keyed by the geometry and build settings
+	// The cache survives Begin, so reopening the same scene skips the builder altogether
+	void SetBVHCacheDirectory(const std::filesystem::path& directory) { mSessionInfo->Cache.SetDirectory(directory); }
+
+	// (Only works at eReady/eTracing stage)
+	// Moves the vertices of a deformable renderable, the faces must stay the same
+	// CPU built trees are refitted and only rebuilt once the SAH cost grew past the rebuild threshold;
+	// GPU built trees are simply rebuilt since that's as cheap as a refit on the device
+	void UpdateRenderable(uint32_t renderableIdx, const MeshData& meshData);
+	void SetRebuildThreshold(float threshold) { mSessionInfo->RebuildThreshold = threshold; }
+
+	// (Only works at eReceiving/eReady/eTracing stage)
+	// Gives the renderable an object to world transform at the shutter open and close; its submitted
+	// vertices are taken as object space from then on. Only translation, rotation and positive scale are kept
+	// Needs an estimator created with MotionBlur, otherwise the renderable stays where it was submitted
+	void SetRenderableMotion(uint32_t renderableIdx, const glm::mat4& start, const glm::mat4& end);
+	void RemoveRenderableMotion(uint32_t renderableIdx);
+
 	// To compute the iterations from the beginning again
 	// (eReady/eTracing --> eReady state)
 	void Clear();
@@ -30,12 +60,19 @@ public:
 	// (eReady/eTracing/eReset state --> eReset state)
 	void Reset();
 
+	// Linear radiance of an equirectangular image, row major from the top
+	// Builds the marginal/conditional CDFs so that the sky can be sampled as a light
+	// Only within the open scope, unlike the removal which can happen any time
+	void SetEnvironmentMap(const std::vector<glm::vec4>& radiance, const glm::uvec2& resolution, float rotation = 0.0f);
+	void RemoveEnvironmentMap();
+
 	// TODO: Maybe assert here as well if the path tracer is in the receiving state...
 	void SetCameraSpecs(const PhysicalCamera& camera);
 	void SetCameraView(const glm::mat4& view);
 
 	// Getters...
 	TraceSessionState GetState() const { return mSessionInfo->State; }
+	BVHBuildMode GetBVHBuildMode() const { return mSessionInfo->BuildMode; }
 
 	GeometryBuffers GetLocalBuffers() const { return mSessionInfo->LocalBuffers; }
 	vkLib::Buffer<PhysicalCamera> GetPhysicalCameraBuffer() const { return mSessionInfo->CameraSpecsBuffer; }
@@ -52,15 +89,35 @@ private:
 	void Cleanup();
 
 	void UpdateSceneBuffers();
+	void UpdateLightTree();
 
-	BVH CreateBVH(const MeshData& meshData, uint32_t bvhDepth);
+	// Deformed meshes change every update, there's no point in caching their trees
+	BVH CreateBVH(const MeshData& meshData, uint32_t bvhDepth, float spatialSplitBudget = 0.0f, bool cacheable = true);
+	void BuildBVHOnGPU(uint32_t faceCount, uint32_t faceOffset, uint32_t nodeOffset, uint32_t wideNodeOffset);
+
+	// Ray query backend only; rebuilds everything, or just the structure of the given renderable
+	void BuildAccelerationStructures(const RenderableRecord* record = nullptr);
 
 	void CopyAllVertexAttribs(BVH& bvhStruct, const MeshData& meshData, RenderableType renderableType);
 
+	// Light sources have no instance, their faces get uint32_t(-1)
+	void WriteFaces(const std::vector<Face>& faces, size_t faceOffset, size_t vertexOffset,
+		RenderableType renderableType, uint32_t instanceIndex);
+	void WriteBVHNodes(const BVH& bvhStruct, size_t faceOffset, size_t nodeOffset, size_t wideNodeOffset);
+
+	void RefitRenderable(RenderableRecord& record);
+	void RebuildRenderable(RenderableRecord& record);
+
+	// Appends to the local buffer
 	template <typename T, typename Iter, typename Fn>
 	void CopyVertexAttrib(vkLib::Buffer<T>& SharedBuffer, vkLib::Buffer<T>& LocalBuffer,
 		Iter Begin, Iter End, Fn CopyRoutine);
 
+	// Overwrites the local buffer from LocalOffset onwards, the range must already exist
+	template <typename T, typename Iter, typename Fn>
+	void WriteVertexAttrib(vkLib::Buffer<T>& SharedBuffer, vkLib::Buffer<T>& LocalBuffer,
+		size_t LocalOffset, Iter Begin, Iter End, Fn CopyRoutine);
+
 	friend class WavefrontEstimator;
 	friend class Executor;
 };
@@ -69,19 +126,35 @@ template <typename T, typename Iter, typename Fn>
 void PH_FLUX_NAMESPACE::TraceSession::CopyVertexAttrib(vkLib::Buffer<T>& SharedBuffer, 
 	vkLib::Buffer<T>& LocalBuffer, Iter Begin, Iter End, Fn CopyRoutine)
 {
-	// TODO: CopyVertexAttrib calls vkLib::CopyBufferRegions internally
+	size_t LocalBufferSize = LocalBuffer.GetSize();
+	size_t HostCount = End - Begin;
+
+	if (HostCount == 0)
+		return;
+
+	LocalBuffer.Resize(LocalBufferSize + HostCount);
+
+	WriteVertexAttrib(SharedBuffer, LocalBuffer, LocalBufferSize, Begin, End, CopyRoutine);
+}
+
+template <typename T, typename Iter, typename Fn>
+void PH_FLUX_NAMESPACE::TraceSession::WriteVertexAttrib(vkLib::Buffer<T>& SharedBuffer, 
+	vkLib::Buffer<T>& LocalBuffer, size_t LocalOffset, Iter Begin, Iter End, Fn CopyRoutine)
+{
+	// TODO: WriteVertexAttrib calls vkLib::CopyBufferRegions internally
 	// This function utilizes GPU to copy from shared buffers to locals
 	// This is inherently slow! This process can be batched together for multiple meshes
 	
 	// The way you can do this is by first letting the shared buffer fill to certain max extent
 	// And then immediately flush it out into the local buffer once it fills to that threshold
 
-	size_t LocalBufferSize = LocalBuffer.GetSize();
 	size_t HostCount = End - Begin;
 
 	if (HostCount == 0)
 		return;
 
+	_STL_ASSERT(LocalOffset + HostCount <= LocalBuffer.GetSize(), "Writing past the end of the local buffer!");
+
 	SharedBuffer.Clear();
 	SharedBuffer.Resize(HostCount);
 
@@ -92,11 +165,9 @@ void PH_FLUX_NAMESPACE::TraceSession::CopyVertexAttrib(vkLib::Buffer<T>& SharedB
 
 	SharedBuffer.UnmapMemory();
 
-	LocalBuffer.Resize(LocalBufferSize + HostCount);
-
 	vk::BufferCopy CopyInfo{};
 	CopyInfo.setSrcOffset(0);
-	CopyInfo.setDstOffset(LocalBufferSize);
+	CopyInfo.setDstOffset(LocalOffset);
 	CopyInfo.setSize(HostCount);
 
 	vkLib::CopyBufferRegions(LocalBuffer, SharedBuffer, std::vector<vk::BufferCopy>({ CopyInfo }));
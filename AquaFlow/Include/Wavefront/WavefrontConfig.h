@@ -4,6 +4,10 @@
 #include "SortRecorder.h"
 #include "WavefrontWorkflow.h"
 #include "RayGenerationPipeline.h"
+#include "LightTreeFactory.h"
+#include "LBVHBuilder.h"
+#include "AccelerationStructureBuilder.h"
+#include "BVHCache.h"
 
 #include "../Material/MaterialConfig.h"
 
@@ -32,22 +36,88 @@ enum class TraceSessionState
 	eTracing           = 4,
 };
 
+enum class BVHBuildMode
+{
+	eCPU               = 1,
+	eGPU               = 2,
+};
+
 struct MaterialShaderError
 {
 	std::string Info;
 	MaterialPreprocessState State;
 };
 
+// Where a renderable landed inside the session buffers, so that it can be updated in place
+struct RenderableRecord
+{
+	uint32_t VertexOffset = 0;
+	uint32_t VertexCount = 0;
+	uint32_t FaceOffset = 0;
+	uint32_t FaceCount = 0;
+
+	// Deformable renderables reserve enough nodes for any tree over their faces
+	uint32_t NodeOffset = 0;
+	uint32_t NodeCapacity = 0;
+	uint32_t WideNodeOffset = 0;
+	uint32_t WideNodeCapacity = 0;
+
+	uint32_t BVHDepth = 0;
+	BVHBuildMode BuildMode = BVHBuildMode::eCPU;
+
+	bool Deformable = false;
+
+	// Bottom level structure of the ray query backend
+	uint32_t GeometryIdx = 0;
+
+	// Host copy of the tree in local indices; only kept for deformable CPU builds
+	BVH HostBVH;
+	float BuildCost = 0.0f; // SAH cost right after the last full build
+};
+
 struct SessionInfo
 {
 	MeshInfoBuffer MeshInfos;
+	InstanceMotionBuffer InstanceMotions; // One per mesh, parallel to MeshInfos
 	LightInfoBuffer LightInfos;
 
 	LightPropsBuffer LightPropsInfos;
 
+	// Many light sampling...
+	LightTreeFactory LightTreeBuilder;
+	LightEmitterBuffer LightEmitters;
+	LightTreeBuffer LightTree;
+
+	// Equirectangular environment; marginal CDF over the rows followed by the conditional CDF of every row
+	vkLib::Buffer<glm::vec4> EnvironmentTexels;
+	vkLib::Buffer<float> EnvironmentCDF;
+	glm::uvec2 EnvironmentResolution = glm::uvec2(0);
+	float EnvironmentIntegral = 0.0f;
+	float EnvironmentRotation = 0.0f;
+
 	GeometryBuffers SharedBuffers;
 	GeometryBuffers LocalBuffers;
 
+	// GPU BVH construction...
+	BVHBuildMode BuildMode = BVHBuildMode::eCPU;
+	std::shared_ptr<LBVHBuilder> GPUBuilder;
+	vkLib::Core::Executor BuildWorkers;
+	vkLib::CommandBufferAllocator BuildCmdAlloc;
+	vk::CommandBuffer BuildCmd;
+
+	// Acceleration structures, only created when the estimator traces with ray queries
+	std::shared_ptr<AccelerationStructureBuilder> RayQueryBuilder;
+
+	// Refitting...
+	std::vector<RenderableRecord> Renderables;
+	float RebuildThreshold = 1.5f; // Rebuild once the SAH cost of a refitted tree grows past this factor
+
+	// Fraction of extra face references the SBVH builder may create, zero keeps the plain splits
+	float SpatialSplitBudget = 0.0f;
+
+	// CPU built trees are looked up here before building, disabled while it has no directory
+	BVHCache Cache;
+
 	vkLib::Buffer<PhysicalCamera> CameraSpecsBuffer;
 	vkLib::Buffer<ShaderData> ShaderConstData;
 
@@ -69,12 +139,22 @@ struct WavefrontEstimatorCreateInfo
 	vkLib::Context Context;
 	std::string ShaderDirectory;
 
-	// Work group sizes for pipelines
+	// Work group sizes for pipelines, WorkgroupTuner picks the last two for the device
 	glm::ivec2 RayGenWorkgroupSize = { 256, 256 };
 	uint32_t IntersectionWorkgroupSize = 256;
 	uint32_t MaterialEvalWorkgroupSize = 256;
 
 	float Tolerance = 0.001f;
+
+	// Traverse the collapsed four wide BVH instead of the binary one
+	bool WideBVH = true;
+
+	// eAuto and eRayQuery fall back to eCompute unless the context enables the ray query extensions
+	IntersectionBackend Backend = IntersectionBackend::eAuto;
+
+	// Samples a shutter time per path and moves the renderables given a motion through TraceSession::SetRenderableMotion
+	// The KHR ray query extensions can't interpolate instances, so this always traces with eCompute
+	bool MotionBlur = false;
 };
 
 PH_END
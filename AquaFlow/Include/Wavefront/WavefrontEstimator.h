@@ -1,5 +1,7 @@
 #pragma once
 #include "Executor.h"
+#include "TileScheduler.h"
+#include "BatchRenderer.h"
 
 #include "../Execution/GraphBuilder.h"
 
@@ -24,12 +26,19 @@ public:
 
 	TraceSession CreateTraceSession();
 	Executor CreateExecutor(const ExecutorCreateInfo& createInfo);
+	TileScheduler CreateTileScheduler(const TileSchedulerCreateInfo& createInfo);
+
+	// Same tiling as CreateTileScheduler, PassesPerTile is the sample budget of every job
+	BatchRenderer CreateBatchRenderer(const TileSchedulerCreateInfo& createInfo);
 
 	std::expected<::AQUA_NAMESPACE::MaterialInstance, vkLib::CompileError> 
 		CreateMaterialInstance(const RTMaterialCreateInfo& createInfo);
 
 	static std::string GetShaderDirectory() { return "../AquaFlow/Include/Shaders/"; }
 
+	// eCompute or eRayQuery, eAuto is resolved at construction
+	IntersectionBackend GetIntersectionBackend() const { return mCreateInfo.Backend; }
+
 private:
 	// Resources...
 	vkLib::PipelineBuilder mPipelineBuilder;
@@ -60,11 +69,17 @@ private:
 
 	vkLib::PShader GetRayGenerationShader();
 	vkLib::PShader GetIntersectionShader();
+	vkLib::PShader GetOcclusionShader();
 	vkLib::PShader GetRaySortEpilogueShader(RaySortEvent sortEvent);
 	vkLib::PShader GetRayRefCounterShader();
 	vkLib::PShader GetPrefixSumShader();
 	vkLib::PShader GetLuminanceMeanShader();
+	vkLib::PShader GetPathRegenerationShader();
+	vkLib::PShader GetPathQueueShader();
+	vkLib::PShader GetLBVHShader(LBVHStage stage);
+	vkLib::PShader GetFaceIndexPackShader();
 	vkLib::PShader GetPostProcessImageShader();
+	vkLib::PShader GetAutoExposureShader();
 };
 
 PH_END
@@ -1,6 +1,7 @@
 #pragma once
 #include "RayTracingStructures.h"
 #include "../Utils/CompilerErrorChecker.h"
+#include "../Utils/AutoExposure.h"
 
 #include "MergeSorterPipeline.h"
 
@@ -25,6 +26,14 @@ enum class PostProcessFlagBits
 
 using PostProcessFlags = vk::Flags<PostProcessFlagBits>;
 
+// How the intersection and occlusion kernels find the hits
+enum class IntersectionBackend
+{
+	eCompute                    = 1, // Stack traversal of the BVHs in a compute shader
+	eRayQuery                   = 2, // VK_KHR_ray_query over acceleration structures built from the same geometry
+	eAuto                       = 3, // Ray queries when the context supports them, compute otherwise
+};
+
 struct IntersectionPipeline : public vkLib::ComputePipeline
 {
 	IntersectionPipeline() = default;
@@ -36,6 +45,8 @@ struct IntersectionPipeline : public vkLib::ComputePipeline
 
 // Fields...
 	RayBuffer mRays;
+	RayInfoBuffer mRayInfos; // Only read for the shutter times
+	PathQueueBuffer mPathQueue;
 
 	GeometryBuffers mGeometryBuffers;
 	CollisionInfoBuffer mCollisionInfos;
@@ -43,13 +54,53 @@ struct IntersectionPipeline : public vkLib::ComputePipeline
 	MeshInfoBuffer mMeshInfos;
 	LightInfoBuffer mLightInfos;
 	LightPropsBuffer mLightProps;
+	InstanceMotionBuffer mInstanceMotions;
 
 	vkLib::Buffer<WavefrontSceneInfo> mSceneInfo;
 
+	// Must agree with the WIDE_BVH macro of the shader
+	bool mWideBVH = true;
+	// Must agree with the MOTION_BLUR macro of the shader
+	bool mMotionBlur = false;
+
+	// Must agree with the shader the pipeline was built from; the top level structure is only read by eRayQuery
+	IntersectionBackend mBackend = IntersectionBackend::eCompute;
+	vk::AccelerationStructureKHR mTopLevel;
+
 private:
 	inline void UpdateGeometryBuffers();
 };
 
+// Any hit traversal over the shadow rays, writes one bit per ray into the occlusion mask
+struct OcclusionPipeline : public vkLib::ComputePipeline
+{
+	OcclusionPipeline() = default;
+	OcclusionPipeline(const vkLib::PShader& shader) { this->SetShader(shader); }
+
+	void UpdateDescriptors();
+
+// Fields...
+	ShadowRayBuffer mShadowRays;
+	OcclusionMaskBuffer mOcclusionMask;
+	PathQueueBuffer mPathQueue;
+
+	GeometryBuffers mGeometryBuffers;
+
+	MeshInfoBuffer mMeshInfos;
+	LightInfoBuffer mLightInfos;
+	InstanceMotionBuffer mInstanceMotions;
+
+	vkLib::Buffer<WavefrontSceneInfo> mSceneInfo;
+
+	// Must agree with the WIDE_BVH macro of the shader
+	bool mWideBVH = true;
+	// Must agree with the MOTION_BLUR macro of the shader
+	bool mMotionBlur = false;
+
+	IntersectionBackend mBackend = IntersectionBackend::eCompute;
+	vk::AccelerationStructureKHR mTopLevel;
+};
+
 struct RaySortEpiloguePipeline : public vkLib::ComputePipeline
 {
 	RaySortEpiloguePipeline() = default;
@@ -63,6 +114,7 @@ struct RaySortEpiloguePipeline : public vkLib::ComputePipeline
 	CollisionInfoBuffer mCollisionInfos;
 
 	RayRefBuffer mRayRefs;
+	PathQueueBuffer mPathQueue; // Bounds the sort to the live paths
 
 	RaySortEvent mSortingEvent = RaySortEvent::ePrepare;
 
@@ -78,6 +130,7 @@ struct RayRefCounterPipeline : public vkLib::ComputePipeline
 // Fields...
 	RayRefBuffer mRayRefs;
 	vkLib::Buffer<uint32_t> mRefCounts;
+	PathQueueBuffer mPathQueue;
 };
 
 // TODO: Make a proper Prefix summer
@@ -103,11 +156,44 @@ struct LuminanceMeanPipeline : public vkLib::ComputePipeline
 	vkLib::Image mPixelVariance;
 	vkLib::Image mPresentable;
 
+	SampleAccumulatorBuffer mSampleAccumulator;
+	vkLib::Buffer<WavefrontSceneInfo> mSceneInfo;
+};
+
+// Retires the finished paths, refills the empty slots with camera rays and compacts the live ones
+struct PathRegenerationPipeline : public vkLib::ComputePipeline
+{
+	PathRegenerationPipeline() = default;
+	PathRegenerationPipeline(const vkLib::PShader& shader) { this->SetShader(shader); }
+
+	void UpdateDescriptors();
+
+// Fields...
 	RayBuffer mRays;
 	RayInfoBuffer mRayInfos;
+	PathQueueBuffer mPathQueue;
+	SampleAccumulatorBuffer mSampleAccumulator;
+
+	// Light samples of the bounce, added to the accumulator when unoccluded
+	ShadowRayBuffer mShadowRays;
+	OcclusionMaskBuffer mOcclusionMask;
+
+	vkLib::Buffer<PhysicalCamera> mCamera;
 	vkLib::Buffer<WavefrontSceneInfo> mSceneInfo;
 };
 
+// Single invocation pass which flips the queue counters and writes the indirect dispatch arguments
+struct PathQueuePipeline : public vkLib::ComputePipeline
+{
+	PathQueuePipeline() = default;
+	PathQueuePipeline(const vkLib::PShader& shader) { this->SetShader(shader); }
+
+	void UpdateDescriptors();
+
+// Fields...
+	PathQueueBuffer mPathQueue;
+};
+
 struct PostProcessImagePipeline : public vkLib::ComputePipeline
 {
 	PostProcessImagePipeline() = default;
@@ -116,6 +202,8 @@ struct PostProcessImagePipeline : public vkLib::ComputePipeline
 	void UpdateDescriptors();
 
 	vkLib::Image mPresentable;
+	vkLib::Image mPixelMean; // Tone mapped into the presentable
+	vkLib::Buffer<ExposureState> mExposure;
 };
 
 PH_END
@@ -0,0 +1,37 @@
+#pragma once
+#include "RaytracingStructures.h"
+#include "Core.h"
+
+AQUA_BEGIN
+PH_BEGIN
+
+// Collapses the binary BVH produced by the BVHFactory into WIDE_BVH_WIDTH-wide nodes
+// Every wide node stores its child boxes quantized to 8 bits against its own bounds,
+// which brings a node down to 80 bytes for four children instead of 48 bytes for two
+
+// NOTE: not thread safe
+class WideBVHFactory
+{
+public:
+	WideBVHFactory() = default;
+
+	// The binary nodes are left untouched, the wide nodes are returned
+	std::vector<WideNode> Build(const std::vector<Node>& nodes);
+
+private:
+	const std::vector<Node>* mNodes = nullptr;
+	std::vector<WideNode> mWideNodes;
+
+private:
+	uint32_t CollapseRecursive(uint32_t binaryIdx);
+
+	// Opens up the interior children with the largest surface area until the node is full
+	std::vector<uint32_t> GatherChildren(uint32_t binaryIdx) const;
+	void QuantizeChildren(WideNode& wideNode, const Node& parent, const std::vector<uint32_t>& children) const;
+
+	bool IsLeaf(const Node& node) const { return node.FirstChildIndex == 0 && node.SecondChildIndex == 0; }
+	float SurfaceArea(const Node& node) const;
+};
+
+PH_END
+AQUA_END
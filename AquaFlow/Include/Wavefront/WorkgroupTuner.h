@@ -0,0 +1,100 @@
+#pragma once
+#include "WavefrontEstimator.h"
+
+AQUA_BEGIN
+PH_BEGIN
+
+// Picks the intersection and material work group sizes for the device at hand
+// Every candidate gets an estimator of its own, since the sizes are baked into the shaders,
+// and the dispatches of a few real traces are timed with GPU timestamps
+// The winners are kept in a small text profile per device and driver, so the benchmark runs once
+
+#define WORKGROUP_PROFILE_VERSION      1
+
+struct WorkgroupProfile
+{
+	uint32_t VendorID = 0;
+	uint32_t DeviceID = 0;
+	uint32_t DriverVersion = 0;
+
+	uint32_t IntersectionWorkgroupSize = 256;
+	uint32_t MaterialEvalWorkgroupSize = 256;
+
+	void Apply(WavefrontEstimatorCreateInfo& createInfo) const
+	{
+		createInfo.IntersectionWorkgroupSize = IntersectionWorkgroupSize;
+		createInfo.MaterialEvalWorkgroupSize = MaterialEvalWorkgroupSize;
+	}
+};
+
+struct WorkgroupTunerCreateInfo
+{
+	// Everything but the two work group sizes is used as is
+	WavefrontEstimatorCreateInfo EstimatorInfo;
+
+	// Powers of two, the sorter and the prefix sums rely on it; sizes beyond the device limits are skipped
+	std::vector<uint32_t> Candidates = { 32, 64, 128, 256, 512 };
+
+	glm::ivec2 Resolution = { 512, 512 };
+	uint32_t Depth = 4;
+
+	// Untimed traces that fill the path queue and warm up the caches
+	uint32_t WarmupTraces = 1;
+	uint32_t TimedTraces = 4;
+
+	std::filesystem::path ProfileDirectory;
+};
+
+struct WorkgroupTiming
+{
+	uint32_t WorkgroupSize = 0;
+
+	// Per trace, summed over the bounces (and the materials)
+	double IntersectionMs = 0.0;
+	double MaterialEvalMs = 0.0;
+};
+
+// Builds the benchmark scene with the estimator being measured and hands it to the executor,
+// i.e. creates the trace session and the materials and calls SetTraceSession and SetMaterialPipelines
+using WorkgroupTunerSetupFn = std::function<void(WavefrontEstimator&, Executor&)>;
+
+// NOTE: not thread safe
+class WorkgroupTuner
+{
+public:
+	WorkgroupTuner(const WorkgroupTunerCreateInfo& createInfo);
+
+	WorkgroupTuner(const WorkgroupTuner&) = delete;
+	WorkgroupTuner& operator=(const WorkgroupTuner&) = delete;
+
+	// Timestamps must be supported on the compute queues
+	static bool IsSupported(const vkLib::Context& context);
+
+	// Returns the stored profile of the device, or benchmarks the candidates and stores the winners
+	WorkgroupProfile LoadOrTune(const WorkgroupTunerSetupFn& setup);
+
+	WorkgroupProfile Tune(const WorkgroupTunerSetupFn& setup);
+
+	// Misses on a stale version, a corrupted file or a different driver
+	std::optional<WorkgroupProfile> Load() const;
+	bool Store(const WorkgroupProfile& profile) const;
+
+	const std::vector<WorkgroupTiming>& GetTimings() const { return mTimings; }
+
+private:
+	WorkgroupTunerCreateInfo mCreateInfo;
+
+	vkLib::Core::Ref<vk::Device> mDevice;
+	vk::PhysicalDeviceProperties mDeviceProps;
+
+	std::vector<WorkgroupTiming> mTimings;
+
+private:
+	WorkgroupTiming Measure(uint32_t workgroupSize, const WorkgroupTunerSetupFn& setup);
+
+	WorkgroupProfile GetDeviceProfile() const;
+	std::filesystem::path GetFilepath() const;
+};
+
+PH_END
+AQUA_END
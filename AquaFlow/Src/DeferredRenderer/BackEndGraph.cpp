@@ -3,6 +3,12 @@
 #include "DeferredRenderer/Renderer/Environment.h"
 #include "Execution/GraphBuilder.h"
 #include "DeferredRenderer/RenderGraph/PostProcessPlugin.h"
+#include "DeferredRenderer/RenderGraph/SSAOPlugin.h"
+#include "DeferredRenderer/RenderGraph/SSAOUpsamplePlugin.h"
+#include "DeferredRenderer/RenderGraph/BloomPlugin.h"
+#include "DeferredRenderer/RenderGraph/MotionVectorPlugin.h"
+#include "DeferredRenderer/RenderGraph/TemporalResolvePlugin.h"
+#include "DeferredRenderer/RenderGraph/AutoExposurePlugin.h"
 #include "../Utils/CompilerErrorChecker.h"
 
 AQUA_BEGIN
@@ -21,6 +27,14 @@ struct BackEndGraphConfig
 
 	vkLib::Framebuffer mShadingBuffer;
 	vkLib::Framebuffer mPostProcessingBuffer;
+	vkLib::Framebuffer mGBuffer;
+
+	glm::uvec2 mResolution = { 0, 0 };
+	glm::uvec2 mOutputResolution = { 0, 0 }; // past the temporal resolve, the same as above without it
+
+	// What the post processing reads, every effect writes the shading buffer into its own copy
+	vkLib::ImageView mHDRColor;
+	std::string mHDRStage; // the last effect writing it, empty while it's still the shading buffer
 
 	RenderTargetFactory mFramebufferFactory;
 
@@ -32,14 +46,117 @@ struct BackEndGraphConfig
 	EXEC_NAMESPACE::GraphList mGraphList;
 
 	vkLib::Core::Ref<vk::Sampler> mPostProcessSampler;
+	vkLib::Core::Ref<vk::Sampler> mGeometrySampler;
+
+	// SSAO stuff...
+	SSAOFeature mSSAOFeature;
+	vkLib::Buffer<SSAOInfo> mSSAOInfo;
+	vkLib::Buffer<glm::vec2> mHalfOcclusion;
+	vkLib::Image mOcclusionTarget;
+
+	// Bloom stuff...
+	BloomEffectFeature mBloomFeature;
+	BloomInfo mBloomLayout;
+	vkLib::Buffer<BloomInfo> mBloomInfo;
+	vkLib::Buffer<glm::vec4> mBloomChain;
+	vkLib::Image mBloomTarget;
+
+	// Temporal AA stuff...
+	TemporalAAFeature mTemporalFeature;
+	SharedRef<TemporalState> mTemporal = std::make_shared<TemporalState>();
+	vkLib::Image mTemporalTarget;
+
+	// Auto exposure stuff...
+	AutoExposureFeature mExposureFeature;
+	SharedRef<ExposureResources> mExposure = std::make_shared<ExposureResources>();
 
 	vkLib::Context mCtx;
 
 	// Shader stuff...
 	std::string mShaderDirectory = "D:\\Dev\\AquaFlow\\AquaFlow\\Assets\\Shaders\\Deferred\\";
 	vkLib::PShader mPostProcessingShader;
+	vkLib::PShader mSSAOShader;
+	vkLib::PShader mSSAOUpsampleShader;
+	vkLib::PShader mBloomShader;
+	vkLib::PShader mMotionVectorShader;
+	vkLib::PShader mTemporalResolveShader;
+	vkLib::PShader mExposureShader;
 };
 
+float Halton(uint32_t index, uint32_t base)
+{
+	float result = 0.0f;
+	float fraction = 1.0f;
+
+	while (index > 0)
+	{
+		fraction /= static_cast<float>(base);
+		result += fraction * static_cast<float>(index % base);
+		index /= base;
+	}
+
+	return result;
+}
+
+// A full resolution copy of the HDR image for an effect to write into
+vkLib::Image CreateHDRCopy(vkLib::ResourcePool& pool, const glm::uvec2& resolution)
+{
+	vkLib::ImageCreateInfo imageInfo{};
+	imageInfo.Extent = vk::Extent3D(resolution.x, resolution.y, 1);
+	imageInfo.Format = vk::Format::eR32G32B32A32Sfloat;
+	imageInfo.MemProps = vk::MemoryPropertyFlagBits::eDeviceLocal;
+	imageInfo.Type = vk::ImageType::e2D;
+	imageInfo.Usage = vk::ImageUsageFlagBits::eStorage | vk::ImageUsageFlagBits::eSampled;
+
+	vkLib::Image image = pool.CreateImage(imageInfo);
+	image.TransitionLayout(vk::ImageLayout::eGeneral, vk::PipelineStageFlagBits::eTopOfPipe);
+
+	return image;
+}
+
+void UploadSSAOInfo(BackEndGraphConfig& config)
+{
+	const SSAOFeature& feature = config.mSSAOFeature;
+
+	SSAOInfo info{};
+	info.Resolution = config.mResolution;
+	info.HalfResolution = (config.mResolution + 1u) / 2u;
+	info.DirectionCount = feature.DirectionCount;
+	info.StepCount = feature.StepCount;
+	info.Radius = feature.Radius;
+	info.Intensity = feature.Intensity;
+	info.DepthSharpness = feature.DepthSharpness;
+
+	config.mSSAOInfo.SetBuf(&info, &info + 1);
+}
+
+// Halves the resolution level by level until the requested count or a single texel
+void PrepareBloomChain(BackEndGraphConfig& config)
+{
+	const BloomEffectFeature& feature = config.mBloomFeature;
+
+	BloomInfo& layout = config.mBloomLayout;
+	layout = BloomInfo{};
+
+	layout.Resolution = config.mOutputResolution;
+	layout.Color = glm::vec4(feature.Color, feature.Strength);
+	layout.Radius = feature.Radius;
+
+	glm::uvec2 size = config.mOutputResolution;
+	uint32_t offset = 0;
+
+	while (layout.LevelCount < feature.LevelCount && glm::max(size.x, size.y) > 1)
+	{
+		size = (size + 1u) / 2u;
+
+		layout.Levels[layout.LevelCount++] = glm::uvec4(size, offset, 0);
+		offset += size.x * size.y;
+	}
+
+	config.mBloomChain.Resize(glm::max(offset, 1u));
+	config.mBloomInfo.SetBuf(&layout, &layout + 1);
+}
+
 AQUA_END
 
 AQUA_NAMESPACE::BackEndGraph::BackEndGraph()
@@ -53,6 +170,40 @@ AQUA_NAMESPACE::BackEndGraph::BackEndGraph()
 
 	CompileErrorChecker checker(mConfig->mShaderDirectory + "../Logging/ShaderError.glsl");
 	checker.AssertOnError(errors);
+
+	mConfig->mSSAOShader.SetFilepath("eCompute", mConfig->mShaderDirectory + "SSAO.comp");
+	mConfig->mSSAOShader.AddMacro("MATH_PI", std::to_string(glm::pi<float>()));
+
+	errors = mConfig->mSSAOShader.CompileShaders();
+	checker.AssertOnError(errors);
+
+	mConfig->mSSAOUpsampleShader.SetFilepath("eCompute", mConfig->mShaderDirectory + "SSAOUpsample.comp");
+
+	errors = mConfig->mSSAOUpsampleShader.CompileShaders();
+	checker.AssertOnError(errors);
+
+	mConfig->mBloomShader.SetFilepath("eCompute", mConfig->mShaderDirectory + "Bloom.comp");
+	mConfig->mBloomShader.AddMacro("MAX_BLOOM_LEVELS", std::to_string(MAX_BLOOM_LEVELS));
+
+	errors = mConfig->mBloomShader.CompileShaders();
+	checker.AssertOnError(errors);
+
+	mConfig->mMotionVectorShader.SetFilepath("eCompute", mConfig->mShaderDirectory + "MotionVector.comp");
+
+	errors = mConfig->mMotionVectorShader.CompileShaders();
+	checker.AssertOnError(errors);
+
+	mConfig->mTemporalResolveShader.SetFilepath("eCompute", mConfig->mShaderDirectory + "TemporalResolve.comp");
+
+	errors = mConfig->mTemporalResolveShader.CompileShaders();
+	checker.AssertOnError(errors);
+
+	// shared with the wavefront post process
+	mConfig->mExposureShader.SetFilepath("eCompute", mConfig->mShaderDirectory + "../Utils/AutoExposure.comp");
+	mConfig->mExposureShader.AddMacro("EXPOSURE_HISTOGRAM_SIZE", std::to_string(EXPOSURE_HISTOGRAM_SIZE));
+
+	errors = mConfig->mExposureShader.CompileShaders();
+	checker.AssertOnError(errors);
 }
 
 void AQUA_NAMESPACE::BackEndGraph::SetCtx(vkLib::Context ctx)
@@ -62,6 +213,40 @@ void AQUA_NAMESPACE::BackEndGraph::SetCtx(vkLib::Context ctx)
 	mConfig->mResourcePool = ctx.CreateResourcePool();
 
 	mConfig->mPostProcessSampler = mConfig->mResourcePool.CreateSampler({});
+
+	vkLib::SamplerInfo geometrySamplerInfo{};
+	geometrySamplerInfo.MagFilter = vk::Filter::eNearest;
+	geometrySamplerInfo.MinFilter = vk::Filter::eNearest;
+
+	mConfig->mGeometrySampler = mConfig->mResourcePool.CreateSampler(geometrySamplerInfo);
+
+	mConfig->mSSAOInfo = mConfig->mResourcePool.CreateBuffer<SSAOInfo>(vk::BufferUsageFlagBits::eUniformBuffer, vk::MemoryPropertyFlagBits::eHostCoherent);
+	mConfig->mHalfOcclusion = mConfig->mResourcePool.CreateBuffer<glm::vec2>(vk::BufferUsageFlagBits::eStorageBuffer, vk::MemoryPropertyFlagBits::eDeviceLocal);
+
+	mConfig->mBloomInfo = mConfig->mResourcePool.CreateBuffer<BloomInfo>(vk::BufferUsageFlagBits::eUniformBuffer, vk::MemoryPropertyFlagBits::eHostCoherent);
+	mConfig->mBloomChain = mConfig->mResourcePool.CreateBuffer<glm::vec4>(vk::BufferUsageFlagBits::eStorageBuffer, vk::MemoryPropertyFlagBits::eDeviceLocal);
+
+	auto& temporal = *mConfig->mTemporal;
+	temporal.Info = mConfig->mResourcePool.CreateBuffer<TemporalInfo>(vk::BufferUsageFlagBits::eUniformBuffer, vk::MemoryPropertyFlagBits::eHostCoherent);
+	temporal.ModelMotions = mConfig->mResourcePool.CreateBuffer<glm::mat4>(vk::BufferUsageFlagBits::eStorageBuffer, vk::MemoryPropertyFlagBits::eHostCoherent);
+	temporal.MotionVectors = mConfig->mResourcePool.CreateBuffer<glm::vec2>(vk::BufferUsageFlagBits::eStorageBuffer, vk::MemoryPropertyFlagBits::eDeviceLocal);
+
+	for (auto& history : temporal.Histories)
+	{
+		history = mConfig->mResourcePool.CreateBuffer<glm::vec4>(vk::BufferUsageFlagBits::eStorageBuffer, vk::MemoryPropertyFlagBits::eDeviceLocal);
+		history.Resize(1);
+	}
+
+	*mConfig->mExposure = CreateExposureResources(mConfig->mResourcePool);
+
+	mConfig->mSSAOInfo.Resize(1);
+	mConfig->mHalfOcclusion.Resize(1);
+	mConfig->mBloomInfo.Resize(1);
+	mConfig->mBloomChain.Resize(1);
+
+	temporal.Info.Resize(1);
+	temporal.ModelMotions.Resize(1);
+	temporal.MotionVectors.Resize(1);
 }
 
 void AQUA_NAMESPACE::BackEndGraph::SetEnvironment(EnvironmentRef env)
@@ -69,6 +254,11 @@ void AQUA_NAMESPACE::BackEndGraph::SetEnvironment(EnvironmentRef env)
 	mConfig->mEnv = env;
 }
 
+void AQUA_NAMESPACE::BackEndGraph::SetCamera(CameraBuf camera)
+{
+	mConfig->mCamera = camera;
+}
+
 void AQUA_NAMESPACE::BackEndGraph::SetFeaturesInfos(const FeatureInfoMap& featureInfo)
 {
 	mConfig->mFeatureInfos = featureInfo;
@@ -79,13 +269,92 @@ void AQUA_NAMESPACE::BackEndGraph::SetFeatureFlags(RendererFeatureFlags flags)
 	mConfig->mFeatures = flags;
 }
 
+void AQUA_NAMESPACE::BackEndGraph::SetSSAOFeature(const SSAOFeature& feature)
+{
+	_STL_ASSERT(feature.DirectionCount > 0 && feature.StepCount > 0, "Invalid SSAO sample count");
+	_STL_ASSERT(feature.Radius > 0.0f, "Invalid SSAO radius");
+
+	mConfig->mSSAOFeature = feature;
+}
+
+void AQUA_NAMESPACE::BackEndGraph::SetBloomFeature(const BloomEffectFeature& feature)
+{
+	_STL_ASSERT(feature.LevelCount > 0 && feature.LevelCount <= MAX_BLOOM_LEVELS, "Invalid bloom level count");
+
+	mConfig->mBloomFeature = feature;
+}
+
+void AQUA_NAMESPACE::BackEndGraph::SetTemporalAAFeature(const TemporalAAFeature& feature)
+{
+	_STL_ASSERT(feature.JitterPhases > 0, "Invalid jitter phase count");
+	_STL_ASSERT(feature.BlendFactor > 0.0f && feature.BlendFactor <= 1.0f, "Invalid temporal blend factor");
+
+	mConfig->mTemporalFeature = feature;
+}
+
+AQUA_NAMESPACE::CameraInfo AQUA_NAMESPACE::BackEndGraph::AdvanceTemporalFrame(const CameraInfo& camera)
+{
+	auto& temporal = *mConfig->mTemporal;
+	TemporalInfo& layout = temporal.Layout;
+
+	glm::mat4 viewProjection = camera.Projection * camera.View;
+
+	// the first frame has nothing to look back at
+	bool firstFrame = temporal.FrameIndex == 0;
+
+	layout.PrevViewProjection = firstFrame ? viewProjection : layout.ViewProjection;
+	layout.ViewProjection = viewProjection;
+	layout.InvViewProjection = glm::inverse(viewProjection);
+	layout.HistoryValid = !firstFrame;
+
+	uint32_t phase = temporal.FrameIndex % mConfig->mTemporalFeature.JitterPhases + 1;
+	layout.Jitter = glm::vec2(Halton(phase, 2), Halton(phase, 3)) - 0.5f;
+
+	// how far every renderable moved since the last frame
+	std::vector<glm::mat4> models;
+	mConfig->mModels >> models;
+
+	std::vector<glm::mat4> motions(models.size(), glm::mat4(1.0f));
+
+	for (size_t i = 0; i < models.size() && i < temporal.PrevModels.size(); i++)
+		motions[i] = temporal.PrevModels[i] * glm::inverse(models[i]);
+
+	temporal.PrevModels = models;
+
+	temporal.ModelMotions.SetBuf(motions.begin(), motions.end());
+	temporal.Info.SetBuf(&layout, &layout + 1);
+
+	temporal.FrameIndex++;
+
+	// shifts the whole image by the jitter, in pixels of the internal resolution
+	glm::vec2 offset = 2.0f * layout.Jitter / glm::vec2(layout.InternalResolution);
+
+	CameraInfo jittered = camera;
+	jittered.Projection = glm::translate(glm::mat4(1.0f), glm::vec3(offset, 0.0f)) * camera.Projection;
+
+	return jittered;
+}
+
+void AQUA_NAMESPACE::BackEndGraph::SetAutoExposureFeature(const AutoExposureFeature& feature)
+{
+	_STL_ASSERT(feature.MaxLogLuminance > feature.MinLogLuminance, "Invalid exposure luminance range");
+	_STL_ASSERT(feature.AdaptationRate > 0.0f, "Invalid exposure adaptation rate");
+
+	mConfig->mExposureFeature = feature;
+}
+
 void AQUA_NAMESPACE::BackEndGraph::PrepareFeatures()
 {
 	mConfig->mGraphBuilder.Clear();
 	mConfig->mInputs.clear();
 
+	mConfig->mHDRColor = mConfig->mShadingBuffer.GetColorAttachments().front();
+	mConfig->mHDRStage.clear();
+
 	PrepareSSAO();
+	PrepareTemporalAA();
 	PrepareBloomEffect();
+	PrepareAutoExposure();
 	PreparePostProcessing();
 
 	CreateGraph();
@@ -93,15 +362,199 @@ void AQUA_NAMESPACE::BackEndGraph::PrepareFeatures()
 
 void AQUA_NAMESPACE::BackEndGraph::PrepareSSAO()
 {
-	if (mConfig->mFeatures && RenderingFeature::eSSAO == RendererFeatureFlags(0))
+	if (!(mConfig->mFeatures & RendererFeatureFlags(RenderingFeature::eSSAO)))
 		return;
 
+	auto config = mConfig;
+	auto halfResolution = (mConfig->mResolution + 1u) / 2u;
+
+	SSAOPlugin ssaoPlugin{};
+	ssaoPlugin.SetPipelineBuilder(mConfig->mCtx.MakePipelineBuilder());
+	ssaoPlugin.SetShader(mConfig->mSSAOShader);
+	ssaoPlugin.SetHalfResolution(halfResolution);
+	ssaoPlugin.AddPlugin(mConfig->mGraphBuilder, "SSAOStage");
+
+	SSAOUpsamplePlugin upsamplePlugin{};
+	upsamplePlugin.SetPipelineBuilder(mConfig->mCtx.MakePipelineBuilder());
+	upsamplePlugin.SetShader(mConfig->mSSAOUpsampleShader);
+	upsamplePlugin.SetResolution(mConfig->mResolution);
+	upsamplePlugin.AddPlugin(mConfig->mGraphBuilder, "SSAOUpsampleStage");
+
+	// the geometry buffer only exists once the material network is prepared
+	mConfig->mGraphBuilder["SSAOStage"].UpdateFn = [config](EXEC_NAMESPACE::Operation& op)
+		{
+			auto& pipeline = *reinterpret_cast<SSAOPipeline*>(GetRefAddr(op.Cmp));
+			auto colorViews = config->mGBuffer.GetColorAttachments();
+
+			pipeline.SetCamera(config->mCamera);
+			pipeline.SetInfo(config->mSSAOInfo);
+			pipeline.SetGeometry(colorViews[0], colorViews[1], config->mGeometrySampler);
+			pipeline.SetHalfOcclusion(config->mHalfOcclusion);
+
+			pipeline.UpdateDescriptors();
+		};
+
+	mConfig->mGraphBuilder["SSAOUpsampleStage"].UpdateFn = [config](EXEC_NAMESPACE::Operation& op)
+		{
+			auto& pipeline = *reinterpret_cast<SSAOUpsamplePipeline*>(GetRefAddr(op.Cmp));
+			auto colorViews = config->mGBuffer.GetColorAttachments();
+
+			pipeline.SetCamera(config->mCamera);
+			pipeline.SetInfo(config->mSSAOInfo);
+			pipeline.SetGeometry(colorViews[0], colorViews[1], config->mGeometrySampler);
+			pipeline.SetHalfOcclusion(config->mHalfOcclusion);
+			pipeline.SetShading(config->mShadingBuffer.GetColorAttachments().front());
+			pipeline.SetTarget(config->mOcclusionTarget.GetIdentityImageView());
+
+			pipeline.UpdateDescriptors();
+		};
+
+	mConfig->mGraphBuilder.InsertDependency("SSAOStage", "SSAOUpsampleStage", vk::PipelineStageFlagBits::eComputeShader);
+
+	mConfig->mHDRColor = mConfig->mOcclusionTarget.GetIdentityImageView();
+	mConfig->mHDRStage = "SSAOUpsampleStage";
+
+	mConfig->mInputs.emplace_back("SSAOStage");
+}
+
+void AQUA_NAMESPACE::BackEndGraph::PrepareTemporalAA()
+{
+	if (!(mConfig->mFeatures & RendererFeatureFlags(RenderingFeature::eTemporalAA)))
+		return;
+
+	auto config = mConfig;
+
+	MotionVectorPlugin motionPlugin{};
+	motionPlugin.SetPipelineBuilder(mConfig->mCtx.MakePipelineBuilder());
+	motionPlugin.SetShader(mConfig->mMotionVectorShader);
+	motionPlugin.SetResolution(mConfig->mResolution);
+	motionPlugin.AddPlugin(mConfig->mGraphBuilder, "MotionVectorStage");
+
+	TemporalResolvePlugin resolvePlugin{};
+	resolvePlugin.SetPipelineBuilder(mConfig->mCtx.MakePipelineBuilder());
+	resolvePlugin.SetShader(mConfig->mTemporalResolveShader);
+	resolvePlugin.SetState(mConfig->mTemporal);
+	resolvePlugin.AddPlugin(mConfig->mGraphBuilder, "TemporalAAStage");
+
+	mConfig->mGraphBuilder["MotionVectorStage"].UpdateFn = [config](EXEC_NAMESPACE::Operation& op)
+		{
+			auto& pipeline = *reinterpret_cast<MotionVectorPipeline*>(GetRefAddr(op.Cmp));
+			auto& temporal = *config->mTemporal;
+			auto colorViews = config->mGBuffer.GetColorAttachments();
+
+			// one motion per model, sized up front so the per frame uploads never reallocate
+			std::vector<glm::mat4> identities(std::max(config->mModels.GetSize(), size_t(1)), glm::mat4(1.0f));
+			temporal.ModelMotions.SetBuf(identities.begin(), identities.end());
+
+			pipeline.SetInfo(temporal.Info);
+			pipeline.SetGeometry(colorViews[0], colorViews[1], config->mGeometrySampler);
+			pipeline.SetModelMotions(temporal.ModelMotions);
+			pipeline.SetMotionVectors(temporal.MotionVectors);
+
+			pipeline.UpdateDescriptors();
+		};
+
+	// picks up whatever the previous effect left, the shading buffer otherwise
+	vkLib::ImageView source = mConfig->mHDRColor;
+
+	mConfig->mGraphBuilder["TemporalAAStage"].UpdateFn = [config, source](EXEC_NAMESPACE::Operation& op)
+		{
+			auto& pipeline = *reinterpret_cast<TemporalResolvePipeline*>(GetRefAddr(op.Cmp));
+			auto& temporal = *config->mTemporal;
+
+			pipeline.SetInfo(temporal.Info);
+			pipeline.SetSource(source, config->mGeometrySampler);
+			pipeline.SetMotionVectors(temporal.MotionVectors);
+			pipeline.SetHistories(temporal.Histories[0], temporal.Histories[1]);
+			pipeline.SetTarget(config->mTemporalTarget.GetIdentityImageView());
+
+			pipeline.UpdateDescriptors();
+		};
+
+	mConfig->mGraphBuilder.InsertDependency("MotionVectorStage", "TemporalAAStage", vk::PipelineStageFlagBits::eComputeShader);
+
+	if (!mConfig->mHDRStage.empty())
+		mConfig->mGraphBuilder.InsertDependency(mConfig->mHDRStage, "TemporalAAStage", vk::PipelineStageFlagBits::eComputeShader);
+
+	mConfig->mInputs.emplace_back("MotionVectorStage");
+
+	mConfig->mHDRColor = mConfig->mTemporalTarget.GetIdentityImageView();
+	mConfig->mHDRStage = "TemporalAAStage";
 }
 
 void AQUA_NAMESPACE::BackEndGraph::PrepareBloomEffect()
 {
-	if (mConfig->mFeatures && RenderingFeature::eBloomEffect == RendererFeatureFlags(0))
+	if (!(mConfig->mFeatures & RendererFeatureFlags(RenderingFeature::eBloomEffect)))
+		return;
+
+	auto config = mConfig;
+
+	BloomPlugin plugin{};
+	plugin.SetPipelineBuilder(mConfig->mCtx.MakePipelineBuilder());
+	plugin.SetShader(mConfig->mBloomShader);
+	plugin.SetInfo(mConfig->mBloomLayout);
+	plugin.AddPlugin(mConfig->mGraphBuilder, "BloomEffectStage");
+
+	// picks up whatever the previous effect left, the shading buffer otherwise
+	vkLib::ImageView source = mConfig->mHDRColor;
+
+	mConfig->mGraphBuilder["BloomEffectStage"].UpdateFn = [config, source](EXEC_NAMESPACE::Operation& op)
+		{
+			auto& pipeline = *reinterpret_cast<BloomPipeline*>(GetRefAddr(op.Cmp));
+
+			pipeline.SetInfo(config->mBloomInfo);
+			pipeline.SetSource(source, config->mPostProcessSampler);
+			pipeline.SetChain(config->mBloomChain);
+			pipeline.SetTarget(config->mBloomTarget.GetIdentityImageView());
+
+			pipeline.UpdateDescriptors();
+		};
+
+	if (mConfig->mHDRStage.empty())
+		mConfig->mInputs.emplace_back("BloomEffectStage");
+	else
+		mConfig->mGraphBuilder.InsertDependency(mConfig->mHDRStage, "BloomEffectStage", vk::PipelineStageFlagBits::eComputeShader);
+
+	mConfig->mHDRColor = mConfig->mBloomTarget.GetIdentityImageView();
+	mConfig->mHDRStage = "BloomEffectStage";
+}
+
+void AQUA_NAMESPACE::BackEndGraph::PrepareAutoExposure()
+{
+	if (!(mConfig->mFeatures & RendererFeatureFlags(RenderingFeature::eAutoExposure)))
 		return;
+
+	auto config = mConfig;
+
+	AutoExposurePlugin plugin{};
+	plugin.SetPipelineBuilder(mConfig->mCtx.MakePipelineBuilder());
+	plugin.SetShader(mConfig->mExposureShader);
+	plugin.SetResources(mConfig->mExposure);
+	plugin.AddPlugin(mConfig->mGraphBuilder, "AutoExposureStage");
+
+	// measures whatever the effects left, exactly what the post process tone maps
+	vkLib::ImageView source = mConfig->mHDRColor;
+
+	mConfig->mGraphBuilder["AutoExposureStage"].UpdateFn = [config, source](EXEC_NAMESPACE::Operation& op)
+		{
+			auto& pipeline = *reinterpret_cast<ExposurePipeline*>(GetRefAddr(op.Cmp));
+			auto& exposure = *config->mExposure;
+
+			pipeline.SetInfo(exposure.Info);
+			pipeline.SetSource(source, config->mGeometrySampler);
+			pipeline.SetHistogram(exposure.Histogram);
+			pipeline.SetState(exposure.State);
+
+			pipeline.UpdateDescriptors();
+		};
+
+	if (mConfig->mHDRStage.empty())
+		mConfig->mInputs.emplace_back("AutoExposureStage");
+	else
+		mConfig->mGraphBuilder.InsertDependency(mConfig->mHDRStage, "AutoExposureStage", vk::PipelineStageFlagBits::eComputeShader);
+
+	// the image is left alone, but the post process has to wait on the exposure as well
+	mConfig->mHDRStage = "AutoExposureStage";
 }
 
 void AQUA_NAMESPACE::BackEndGraph::PreparePostProcessing()
@@ -118,9 +571,16 @@ void AQUA_NAMESPACE::BackEndGraph::PreparePostProcessing()
 		{
 			auto& pipeline = *reinterpret_cast<TextureVisualizer*>(GetRefAddr(op.GFX));
 
-			pipeline.UpdateTexture(config->mShadingBuffer.GetColorAttachments().front(), config->mPostProcessSampler);
+			pipeline.UpdateTexture(config->mHDRColor, config->mPostProcessSampler);
+			pipeline.UpdateExposure(config->mExposure->State);
 		};
 
+	if (!mConfig->mHDRStage.empty())
+	{
+		mConfig->mGraphBuilder.InsertDependency(mConfig->mHDRStage, "PostProcess", vk::PipelineStageFlagBits::eFragmentShader);
+		return;
+	}
+
 	mConfig->mInputs.emplace_back("PostProcess");
 }
 
@@ -151,8 +611,68 @@ void AQUA_NAMESPACE::BackEndGraph::PrepareFramebuffers(const glm::uvec2& rendere
 
 	_STL_ASSERT(error, "can't validate the post processing framebuffer");
 
-	postProcessFac.SetTargetSize(rendererResolution);
+	bool temporalAA = static_cast<bool>(mConfig->mFeatures & RendererFeatureFlags(RenderingFeature::eTemporalAA));
+
+	mConfig->mResolution = rendererResolution;
+	mConfig->mOutputResolution = rendererResolution;
+
+	// the temporal resolve reconstructs the output from a smaller shading buffer
+	if (temporalAA && mConfig->mTemporalFeature.OutputResolution != glm::uvec2(0))
+		mConfig->mOutputResolution = mConfig->mTemporalFeature.OutputResolution;
+
+	postProcessFac.SetTargetSize(mConfig->mOutputResolution);
 	mConfig->mPostProcessingBuffer = *postProcessFac.CreateFramebuffer();
+
+	if (mConfig->mFeatures & RendererFeatureFlags(RenderingFeature::eSSAO))
+	{
+		// the occluded copy of the shading buffer
+		mConfig->mOcclusionTarget = CreateHDRCopy(mConfig->mResourcePool, rendererResolution);
+
+		glm::uvec2 halfResolution = (rendererResolution + 1u) / 2u;
+		mConfig->mHalfOcclusion.Resize(halfResolution.x * halfResolution.y);
+
+		UploadSSAOInfo(*mConfig);
+	}
+
+	// a zero exposure tells the post process to leave the colors as they are
+	if (mConfig->mFeatures & RendererFeatureFlags(RenderingFeature::eAutoExposure))
+		ResetExposure(*mConfig->mExposure, mConfig->mOutputResolution, mConfig->mExposureFeature);
+	else
+	{
+		ExposureState passthrough{ 0.0f, 0.0f };
+		mConfig->mExposure->State.SetBuf(&passthrough, &passthrough + 1);
+	}
+
+	if (temporalAA)
+	{
+		auto& temporal = *mConfig->mTemporal;
+		glm::uvec2 outputResolution = mConfig->mOutputResolution;
+
+		mConfig->mTemporalTarget = CreateHDRCopy(mConfig->mResourcePool, outputResolution);
+
+		temporal.MotionVectors.Resize(rendererResolution.x * rendererResolution.y);
+
+		for (auto& history : temporal.Histories)
+			history.Resize(outputResolution.x * outputResolution.y);
+
+		// the history starts over with the new targets
+		temporal.Layout = TemporalInfo{};
+		temporal.Layout.InternalResolution = rendererResolution;
+		temporal.Layout.OutputResolution = outputResolution;
+		temporal.Layout.BlendFactor = mConfig->mTemporalFeature.BlendFactor;
+
+		temporal.PrevModels.clear();
+		temporal.FrameIndex = 0;
+
+		temporal.Info.SetBuf(&temporal.Layout, &temporal.Layout + 1);
+	}
+
+	if (mConfig->mFeatures & RendererFeatureFlags(RenderingFeature::eBloomEffect))
+	{
+		mConfig->mBloomTarget = CreateHDRCopy(mConfig->mResourcePool, mConfig->mOutputResolution);
+
+		PrepareBloomChain(*mConfig);
+	}
 }
 
 void AQUA_NAMESPACE::BackEndGraph::SetShadingFrameBuffer(vkLib::Framebuffer framebuffer)
@@ -160,6 +680,11 @@ void AQUA_NAMESPACE::BackEndGraph::SetShadingFrameBuffer(vkLib::Framebuffer fram
 	mConfig->mShadingBuffer = framebuffer;
 }
 
+void AQUA_NAMESPACE::BackEndGraph::SetGBuffer(vkLib::Framebuffer gBuffer)
+{
+	mConfig->mGBuffer = gBuffer;
+}
+
 AQUA_NAMESPACE::EXEC_NAMESPACE::Graph AQUA_NAMESPACE::BackEndGraph::GetGraph() const
 {
 	return mConfig->mGraph;
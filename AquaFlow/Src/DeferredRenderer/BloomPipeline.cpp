@@ -0,0 +1,70 @@
+#include "Core/Aqpch.h"
+#include "DeferredRenderer/Pipelines/BloomPipeline.h"
+
+AQUA_NAMESPACE::BloomPipeline::BloomPipeline(vkLib::PShader shader)
+{
+	this->SetShader(shader);
+}
+
+void AQUA_NAMESPACE::BloomPipeline::UpdateDescriptors()
+{
+	vkLib::UniformBufferWriteInfo uniformInfo{};
+	uniformInfo.Buffer = mInfo.GetNativeHandles().Handle;
+
+	this->UpdateDescriptor({ 0, 0, 0 }, uniformInfo);
+
+	vkLib::SampledImageWriteInfo samplerInfo{};
+	samplerInfo.ImageLayout = vk::ImageLayout::eGeneral;
+	samplerInfo.ImageView = mSource.GetNativeHandle();
+	samplerInfo.Sampler = *mSampler;
+
+	this->UpdateDescriptor({ 0, 1, 0 }, samplerInfo);
+
+	vkLib::StorageBufferWriteInfo storageInfo{};
+	storageInfo.Buffer = mChain.GetNativeHandles().Handle;
+
+	this->UpdateDescriptor({ 0, 2, 0 }, storageInfo);
+
+	vkLib::StorageImageWriteInfo targetInfo{};
+	targetInfo.ImageLayout = vk::ImageLayout::eGeneral;
+	targetInfo.ImageView = mTarget.GetNativeHandle();
+
+	this->UpdateDescriptor({ 0, 3, 0 }, targetInfo);
+}
+
+void AQUA_NAMESPACE::BloomPipeline::operator()(vk::CommandBuffer cmd, const BloomInfo& info) const
+{
+	glm::uvec3 workGroupSize = GetWorkGroupSize();
+
+	// every pass reads what the previous one wrote
+	vk::MemoryBarrier levelBarrier{};
+	levelBarrier.setSrcAccessMask(vk::AccessFlagBits::eShaderWrite);
+	levelBarrier.setDstAccessMask(vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite);
+
+	auto DispatchPass = [&](BloomPass pass, uint32_t level, const glm::uvec2& size)
+		{
+			SetShaderConstant("eCompute.ShaderConstants.Index_0", static_cast<uint32_t>(pass));
+			SetShaderConstant("eCompute.ShaderConstants.Index_1", level);
+
+			Dispatch({ (size.x + workGroupSize.x - 1) / workGroupSize.x,
+				(size.y + workGroupSize.y - 1) / workGroupSize.y, 1 });
+
+			cmd.pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eComputeShader,
+				vk::DependencyFlags(), levelBarrier, nullptr, nullptr);
+		};
+
+	Begin(cmd);
+
+	Activate();
+
+	for (uint32_t level = 0; level < info.LevelCount; level++)
+		DispatchPass(BloomPass::eDownsample, level, glm::uvec2(info.Levels[level]));
+
+	// the smallest level has nothing below it
+	for (uint32_t level = info.LevelCount - 1; level > 0; level--)
+		DispatchPass(BloomPass::eUpsample, level - 1, glm::uvec2(info.Levels[level - 1]));
+
+	DispatchPass(BloomPass::eComposite, 0, info.Resolution);
+
+	End();
+}
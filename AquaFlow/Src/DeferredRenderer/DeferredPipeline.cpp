@@ -38,6 +38,7 @@ void AQUA_NAMESPACE::DeferredPipeline::SetupPipelineConfig(vkLib::GraphicsPipeli
 	config.DynamicStates.emplace_back(vk::DynamicState::eViewport);
 	config.DynamicStates.emplace_back(vk::DynamicState::eLineWidth);
 	config.DynamicStates.emplace_back(vk::DynamicState::eDepthCompareOp);
+	config.DynamicStates.emplace_back(vk::DynamicState::eDepthWriteEnable);
 }
 
 void AQUA_NAMESPACE::DeferredPipeline::UpdateDescriptors()
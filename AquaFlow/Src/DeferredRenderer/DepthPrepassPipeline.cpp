@@ -0,0 +1,15 @@
+#include "Core/Aqpch.h"
+#include "DeferredRenderer/Pipelines/DepthPrepassPipeline.h"
+
+void AQUA_NAMESPACE::DepthPrepassPipeline::UpdateDescriptors()
+{
+	vkLib::UniformBufferWriteInfo uniformInfo{};
+	uniformInfo.Buffer = mCamera.GetNativeHandles().Handle;
+
+	this->UpdateDescriptor({ 0, 0, 0 }, uniformInfo);
+
+	vkLib::StorageBufferWriteInfo storageInfo{};
+	storageInfo.Buffer = mModels.GetNativeHandles().Handle;
+
+	this->UpdateDescriptor({ 0, 1, 0 }, storageInfo);
+}
@@ -0,0 +1,56 @@
+#include "Core/Aqpch.h"
+#include "DeferredRenderer/Pipelines/DepthPyramidPipeline.h"
+
+AQUA_NAMESPACE::DepthPyramidPipeline::DepthPyramidPipeline(vkLib::PShader shader)
+{
+	this->SetShader(shader);
+}
+
+void AQUA_NAMESPACE::DepthPyramidPipeline::UpdateDescriptors()
+{
+	vkLib::SampledImageWriteInfo depthInfo{};
+	depthInfo.ImageLayout = vk::ImageLayout::eGeneral;
+	depthInfo.ImageView = mDepth.GetNativeHandle();
+	depthInfo.Sampler = *mSampler;
+
+	this->UpdateDescriptor({ 0, 0, 0 }, depthInfo);
+
+	vkLib::UniformBufferWriteInfo uniformInfo{};
+	uniformInfo.Buffer = mPyramidInfo.GetNativeHandles().Handle;
+
+	this->UpdateDescriptor({ 0, 1, 0 }, uniformInfo);
+
+	vkLib::StorageBufferWriteInfo storageInfo{};
+	storageInfo.Buffer = mPyramid.GetNativeHandles().Handle;
+
+	this->UpdateDescriptor({ 0, 2, 0 }, storageInfo);
+}
+
+void AQUA_NAMESPACE::DepthPyramidPipeline::operator()(vk::CommandBuffer cmd, const DepthPyramidInfo& info) const
+{
+	glm::uvec3 workGroupSize = GetWorkGroupSize();
+
+	// every level reads the one below it
+	vk::MemoryBarrier levelBarrier{};
+	levelBarrier.setSrcAccessMask(vk::AccessFlagBits::eShaderWrite);
+	levelBarrier.setDstAccessMask(vk::AccessFlagBits::eShaderRead);
+
+	Begin(cmd);
+
+	Activate();
+
+	for (uint32_t level = 0; level < info.LevelCount; level++)
+	{
+		glm::uvec2 size = glm::uvec2(info.Levels[level]);
+
+		SetShaderConstant("eCompute.ShaderConstants.Index_0", level);
+
+		Dispatch({ (size.x + workGroupSize.x - 1) / workGroupSize.x,
+			(size.y + workGroupSize.y - 1) / workGroupSize.y, 1 });
+
+		cmd.pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eComputeShader,
+			vk::DependencyFlags(), levelBarrier, nullptr, nullptr);
+	}
+
+	End();
+}
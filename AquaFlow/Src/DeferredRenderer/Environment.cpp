@@ -29,7 +29,11 @@ void AQUA_NAMESPACE::Environment::SubmitLightSrc(const DirectionalLightInfo& src
 
 void AQUA_NAMESPACE::Environment::SubmitLightSrc(const PointLightInfo& src)
 {
-	mPointLightSrcs.emplace_back(src.SrcInfo);
+	src.Offset = static_cast<uint32_t>(mPointLightSrcs.size());
+	auto& lightSrc = mPointLightSrcs.emplace_back(src.SrcInfo);
+
+	if (lightSrc.Radius <= 0.0f)
+		lightSrc.Radius = CalcPointLightRadius(lightSrc, src.Cutoff);
 
 	// yet to implement the camera insertion
 
@@ -59,3 +63,24 @@ void AQUA_NAMESPACE::Environment::Update()
 	mLightingBuffers.mPointCameraInfos << mPointCameras;
 	mLightingBuffers.mPointLightBuf << mPointLightSrcs;
 }
+
+float AQUA_NAMESPACE::Environment::CalcPointLightRadius(const PointLightSrc& src, float cutoff)
+{
+	// The shader falls off as I / (d * (a * d + b)), solving it for I / cutoff
+	float intensity = glm::max(glm::max(src.Intensity.x, src.Intensity.y), src.Intensity.z);
+	intensity = intensity > 0.0f ? intensity : 1.0f;
+
+	float limit = intensity / glm::max(cutoff, 1e-6f);
+
+	float a = src.DropRate.x;
+	float b = src.DropRate.y;
+
+	if (a > 0.0f)
+		return (-b + glm::sqrt(b * b + 4.0f * a * limit)) / (2.0f * a);
+
+	if (b > 0.0f)
+		return limit / b;
+
+	// No falloff at all, the light reaches everything
+	return std::numeric_limits<float>::max();
+}
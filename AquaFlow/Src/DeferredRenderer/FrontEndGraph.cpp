@@ -2,6 +2,7 @@
 #include "DeferredRenderer/Renderer/FrontEndGraph.h"
 #include "Execution/GraphBuilder.h"
 #include "DeferredRenderer/RenderGraph/ShadowPlugin.h"
+#include "DeferredRenderer/RenderGraph/LightCullingPlugin.h"
 #include "../Utils/CompilerErrorChecker.h"
 
 AQUA_BEGIN
@@ -10,6 +11,7 @@ struct FrontEndGraphConfig
 {
 	RendererFeatureFlags mFeatures;
 	ShadowCascadeFeature mShadowFeature;
+	LightClusterFeature mClusterFeature;
 
 	std::vector<std::string> mOutputs;
 
@@ -19,8 +21,19 @@ struct FrontEndGraphConfig
 	EnvironmentRef mEnv;
 	Mat4Buf mModels;
 
-	std::vector<vkLib::Framebuffer> mDepthBuffers;
-	std::vector<vkLib::ImageView> mDepthViews;
+	// Cascades along the x axis, directional lights along the y axis
+	vkLib::Framebuffer mShadowAtlas;
+	vkLib::ImageView mShadowAtlasView;
+	ShadowAtlasBuffers mShadowBuffers;
+	SharedRef<ShadowAtlasDraws> mShadowDraws;
+
+	std::vector<ShadowCaster> mShadowCasters;
+	std::vector<CameraInfo> mShadowCameras; // the ones the static layer was drawn with
+	std::optional<CameraInfo> mLastCamera;
+
+	glm::uvec2 mResolution = { 0, 0 };
+	LightClusterBuffers mClusterBuffers;
+	uint32_t mClusterCount = 0;
 
 	VertexFactory* mVertexFactory = nullptr;
 	RenderTargetFactory mFramebufferFactory;
@@ -29,10 +42,12 @@ struct FrontEndGraphConfig
 	EXEC_NAMESPACE::GraphBuilder mGraphBuilder;
 	EXEC_NAMESPACE::GraphList mGraphList;
 
+	vkLib::ResourcePool mResourcePool;
 	vkLib::Context mCtx;
 
 	std::string mShaderDirectory = "D:\\Dev\\AquaFlow\\AquaFlow\\Assets\\Shaders\\Deferred\\";
 	vkLib::PShader mDepthShader;
+	vkLib::PShader mLightCullingShader;
 };
 
 AQUA_END
@@ -48,12 +63,33 @@ AQUA_NAMESPACE::FrontEndGraph::FrontEndGraph()
 
 	CompileErrorChecker checker(mConfig->mShaderDirectory + "../Logging/ShaderError.glsl");
 	checker.AssertOnError(errors);
+
+	mConfig->mLightCullingShader.SetFilepath("eCompute", mConfig->mShaderDirectory + "LightCulling.comp");
+
+	errors = mConfig->mLightCullingShader.CompileShaders();
+	checker.AssertOnError(errors);
 }
 
 void AQUA_NAMESPACE::FrontEndGraph::SetCtx(vkLib::Context ctx)
 {
 	mConfig->mCtx = ctx;
 	mConfig->mFramebufferFactory.SetContextBuilder(ctx.FetchRenderContextBuilder(vk::PipelineBindPoint::eGraphics));
+	mConfig->mResourcePool = ctx.CreateResourcePool();
+
+	auto& clusters = mConfig->mClusterBuffers;
+
+	clusters.mInfo = mConfig->mResourcePool.CreateBuffer<LightClusterInfo>(vk::BufferUsageFlagBits::eUniformBuffer, vk::MemoryPropertyFlagBits::eHostCoherent);
+	clusters.mLightCounts = mConfig->mResourcePool.CreateBuffer<uint32_t>(vk::BufferUsageFlagBits::eStorageBuffer, vk::MemoryPropertyFlagBits::eDeviceLocal);
+	clusters.mLightIndices = mConfig->mResourcePool.CreateBuffer<uint32_t>(vk::BufferUsageFlagBits::eStorageBuffer, vk::MemoryPropertyFlagBits::eDeviceLocal);
+
+	auto& shadows = mConfig->mShadowBuffers;
+
+	shadows.mInfo = mConfig->mResourcePool.CreateBuffer<ShadowAtlasInfo>(vk::BufferUsageFlagBits::eUniformBuffer, vk::MemoryPropertyFlagBits::eHostCoherent);
+	shadows.mCameras = mConfig->mResourcePool.CreateBuffer<CameraInfo>(vk::BufferUsageFlagBits::eStorageBuffer, vk::MemoryPropertyFlagBits::eHostCoherent);
+
+	mConfig->mShadowDraws = std::make_shared<ShadowAtlasDraws>();
+	mConfig->mShadowDraws->Commands = mConfig->mResourcePool.CreateBuffer<vk::DrawIndexedIndirectCommand>(
+		vk::BufferUsageFlagBits::eIndirectBuffer, vk::MemoryPropertyFlagBits::eHostCoherent);
 }
 
 void AQUA_NAMESPACE::FrontEndGraph::SetEnvironment(EnvironmentRef env)
@@ -73,9 +109,221 @@ void AQUA_NAMESPACE::FrontEndGraph::SetFeatureFlags(RendererFeatureFlags flags)
 
 void AQUA_NAMESPACE::FrontEndGraph::SetShadowFeature(const ShadowCascadeFeature& feature)
 {
+	_STL_ASSERT(feature.CascadeDivisions > 0 && feature.CascadeDivisions <= MAX_SHADOW_CASCADES,
+		"Invalid shadow cascade count");
+	_STL_ASSERT(feature.NearClip > 0.0f && feature.CascadeDepth > feature.NearClip, "Invalid shadow cascade depth range");
+
 	mConfig->mShadowFeature = feature;
 }
 
+void AQUA_NAMESPACE::FrontEndGraph::SetLightClusterFeature(const LightClusterFeature& feature)
+{
+	mConfig->mClusterFeature = feature;
+}
+
+void AQUA_NAMESPACE::FrontEndGraph::SetCamera(CameraBuf camera)
+{
+	mConfig->mCamera = camera;
+}
+
+void AQUA_NAMESPACE::FrontEndGraph::SetShadowCasters(const std::vector<ShadowCaster>& casters)
+{
+	auto collectStatic = [](const std::vector<ShadowCaster>& list)
+		{
+			std::vector<ShadowCaster> staticCasters;
+
+			std::copy_if(list.begin(), list.end(), std::back_inserter(staticCasters),
+				[](const ShadowCaster& caster) { return !caster.Dynamic; });
+
+			return staticCasters;
+		};
+
+	auto prevStatic = collectStatic(mConfig->mShadowCasters);
+	auto newStatic = collectStatic(casters);
+
+	bool staticChanged = !std::equal(prevStatic.begin(), prevStatic.end(), newStatic.begin(), newStatic.end(),
+		[](const ShadowCaster& x, const ShadowCaster& y)
+		{
+			return x.MinBound == y.MinBound && x.MaxBound == y.MaxBound &&
+				x.FirstIndex == y.FirstIndex && x.IndexCount == y.IndexCount;
+		});
+
+	// The renderables are uploaded every frame, only a different static set costs a redraw
+	if (staticChanged)
+		InvalidateStaticShadows();
+
+	mConfig->mShadowCasters = casters;
+
+	if (mConfig->mLastCamera)
+		UpdateShadowCascades(*mConfig->mLastCamera);
+}
+
+void AQUA_NAMESPACE::FrontEndGraph::InvalidateStaticShadows()
+{
+	auto& draws = *mConfig->mShadowDraws;
+
+	std::fill(draws.StaticDirty.begin(), draws.StaticDirty.end(), true);
+}
+
+void AQUA_NAMESPACE::FrontEndGraph::UpdateShadowCascades(const CameraInfo& camera)
+{
+	mConfig->mLastCamera = camera;
+
+	auto& draws = *mConfig->mShadowDraws;
+
+	if (!IsShadowEnabled() || draws.StaticTiles.empty())
+		return;
+
+	const auto& feature = mConfig->mShadowFeature;
+	const auto& lights = mConfig->mEnv->GetDirLightSrcList();
+	const auto& casters = mConfig->mShadowCasters;
+
+	uint32_t cascadeCount = feature.CascadeDivisions;
+
+	// Practical split scheme, blending the uniform and the logarithmic splits
+	std::array<float, MAX_SHADOW_CASCADES + 1> splits{};
+	splits[0] = feature.NearClip;
+
+	for (uint32_t i = 1; i <= cascadeCount; i++)
+	{
+		float t = static_cast<float>(i) / static_cast<float>(cascadeCount);
+
+		float logSplit = feature.NearClip * glm::pow(feature.CascadeDepth / feature.NearClip, t);
+		float uniformSplit = feature.NearClip + (feature.CascadeDepth - feature.NearClip) * t;
+
+		splits[i] = glm::mix(uniformSplit, logSplit, feature.SplitLambda);
+	}
+
+	// Rays through the frustum corners, scaled to a unit view depth
+	float forward = camera.Projection[2][3] < 0.0f ? -1.0f : 1.0f;
+	glm::mat4 inverseProjection = glm::inverse(camera.Projection);
+	glm::mat4 inverseView = glm::inverse(camera.View);
+
+	std::array<glm::vec3, 4> cornerRays{};
+	std::array<glm::vec2, 4> ndcCorners = { glm::vec2(-1.0f, -1.0f), glm::vec2(1.0f, -1.0f),
+		glm::vec2(-1.0f, 1.0f), glm::vec2(1.0f, 1.0f) };
+
+	for (size_t i = 0; i < ndcCorners.size(); i++)
+	{
+		glm::vec4 point = inverseProjection * glm::vec4(ndcCorners[i], 0.0f, 1.0f);
+		glm::vec3 viewPoint = glm::vec3(point) / point.w;
+
+		cornerRays[i] = viewPoint / (forward * viewPoint.z);
+	}
+
+	ShadowAtlasInfo info{};
+	info.TileResolution = feature.BaseResolution;
+	info.AtlasResolution = mConfig->mShadowAtlas.GetResolution();
+	info.CascadeCount = cascadeCount;
+
+	std::vector<CameraInfo> cameras;
+	std::vector<vk::DrawIndexedIndirectCommand> commands;
+
+	cameras.reserve(draws.StaticTiles.size());
+
+	for (uint32_t lightIdx = 0; lightIdx < static_cast<uint32_t>(lights.size()); lightIdx++)
+	{
+		glm::vec3 direction = glm::normalize(glm::vec3(lights[lightIdx].Direction));
+		glm::vec3 up = glm::abs(direction.y) > 0.99f ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+
+		// No translation, so the snapped cascades stay put while the camera moves
+		glm::mat4 lightView = glm::lookAtLH(glm::vec3(0.0f), direction, up);
+
+		std::vector<ShadowCaster> lightCasters(casters.size());
+		float casterNear = std::numeric_limits<float>::max();
+
+		for (size_t casterIdx = 0; casterIdx < casters.size(); casterIdx++)
+			lightCasters[casterIdx] = TransformBounds(casters[casterIdx], lightView);
+
+		// Only the static casters move the near plane, the cached static layers would be redrawn every
+		// time a dynamic one moved otherwise. Dynamic casters in front of it are flattened onto it instead
+		for (size_t casterIdx = 0; casterIdx < casters.size(); casterIdx++)
+		{
+			if (!casters[casterIdx].Dynamic)
+				casterNear = glm::min(casterNear, lightCasters[casterIdx].MinBound.z);
+		}
+
+		for (uint32_t cascadeIdx = 0; cascadeIdx < cascadeCount; cascadeIdx++)
+		{
+			std::array<glm::vec3, 8> corners{};
+
+			for (size_t i = 0; i < cornerRays.size(); i++)
+			{
+				corners[i] = glm::vec3(inverseView * glm::vec4(cornerRays[i] * splits[cascadeIdx], 1.0f));
+				corners[i + 4] = glm::vec3(inverseView * glm::vec4(cornerRays[i] * splits[cascadeIdx + 1], 1.0f));
+			}
+
+			glm::vec3 center(0.0f);
+
+			for (const auto& corner : corners)
+				center += corner / static_cast<float>(corners.size());
+
+			float radius = 0.0f;
+
+			for (const auto& corner : corners)
+				radius = glm::max(radius, glm::length(corner - center));
+
+			// A bounding sphere keeps the tile size fixed under rotation, rounding hides the float noise
+			radius = glm::ceil(radius * 16.0f) / 16.0f;
+
+			glm::vec2 texelSize = 2.0f * radius / glm::vec2(feature.BaseResolution);
+			glm::vec3 lightCenter = glm::vec3(lightView * glm::vec4(center, 1.0f));
+
+			lightCenter.x = glm::floor(lightCenter.x / texelSize.x) * texelSize.x;
+			lightCenter.y = glm::floor(lightCenter.y / texelSize.y) * texelSize.y;
+
+			glm::vec3 minBound = lightCenter - glm::vec3(radius);
+			glm::vec3 maxBound = lightCenter + glm::vec3(radius);
+
+			// Casters between the light and the slice still throw shadows into it
+			minBound.z = glm::min(minBound.z, casterNear);
+
+			uint32_t tileIdx = lightIdx * cascadeCount + cascadeIdx;
+
+			CameraInfo& cascadeCamera = cameras.emplace_back();
+			cascadeCamera.View = lightView;
+			cascadeCamera.Projection = glm::orthoLH_ZO(minBound.x, maxBound.x, minBound.y, maxBound.y, minBound.z, maxBound.z);
+
+			// Thanks to the snapping, a still camera keeps the cached static layer of the tile
+			if (tileIdx >= mConfig->mShadowCameras.size() ||
+				std::memcmp(&mConfig->mShadowCameras[tileIdx], &cascadeCamera, sizeof(CameraInfo)) != 0)
+				draws.StaticDirty[tileIdx] = true;
+
+			for (bool dynamic : { false, true })
+			{
+				glm::uvec2& range = dynamic ? draws.DynamicRanges[tileIdx] : draws.StaticRanges[tileIdx];
+				range = { static_cast<uint32_t>(commands.size()), 0 };
+
+				for (size_t casterIdx = 0; casterIdx < casters.size(); casterIdx++)
+				{
+					const auto& bounds = lightCasters[casterIdx];
+
+					if (casters[casterIdx].Dynamic != dynamic)
+						continue;
+
+					// nothing is culled for lying in front of the near plane, the shadow pass flattens it onto the plane
+					if (glm::any(glm::greaterThan(bounds.MinBound, maxBound)) ||
+						glm::any(glm::lessThan(glm::vec2(bounds.MaxBound), glm::vec2(minBound))))
+						continue;
+
+					commands.emplace_back(casters[casterIdx].IndexCount, 1, casters[casterIdx].FirstIndex, 0, 0);
+					range.y++;
+				}
+			}
+
+			info.Cascades[cascadeIdx] = glm::vec4(splits[cascadeIdx + 1], glm::max(texelSize.x, texelSize.y), 0.0f, 0.0f);
+		}
+	}
+
+	draws.Commands.Clear();
+	draws.Commands.SetBuf(commands.begin(), commands.end());
+
+	mConfig->mShadowBuffers.mCameras.SetBuf(cameras.begin(), cameras.end());
+	mConfig->mShadowBuffers.mInfo.SetBuf(&info, &info + 1);
+
+	mConfig->mShadowCameras = cameras;
+}
+
 void AQUA_NAMESPACE::FrontEndGraph::SetVertexFactory(VertexFactory& factory)
 {
 	mConfig->mVertexFactory = &factory;
@@ -87,56 +335,71 @@ void AQUA_NAMESPACE::FrontEndGraph::PrepareFeatures()
 	mConfig->mOutputs.clear();
 
 	PrepareDepthCascades();
+	PrepareLightClusters();
 	CreateGraph();
 }
 
 void AQUA_NAMESPACE::FrontEndGraph::PrepareDepthCascades()
 {
-	if (mConfig->mFeatures && RenderingFeature::eShadow == RendererFeatureFlags(0))
+	if (!IsShadowEnabled())
 		return;
 
 	auto config = mConfig;
 
 	ShadowPlugin plugin{};
-	VertexBindingMap vertexBindings{};
-	vertexBindings[0].AddAttribute(0, "RGB32F");
-	vertexBindings[0].SetName(ENTRY_POSITION);
-	vertexBindings[1].AddAttribute(1, "RGB32F");
-	vertexBindings[1].SetName(ENTRY_METADATA);
 
-	plugin.SetBindings(vertexBindings);
+	plugin.SetBindings(ShadowPipeline::GetPositionBindings());
 	plugin.SetShader(mConfig->mDepthShader);
 	plugin.SetPipelineBuilder(mConfig->mCtx.MakePipelineBuilder());
 
-	std::string shadowStage = "ShadowStage_";
+	// Every light and cascade lands in its own tile of the atlas, drawn by a single node
+	plugin.SetDepthBuffer(mConfig->mShadowAtlas);
+	plugin.SetDraws(mConfig->mShadowDraws);
+	plugin.AddPlugin(mConfig->mGraphBuilder, "ShadowStage");
 
-	for (uint32_t i = 0; i < static_cast<uint32_t>(mConfig->mEnv->GetDirLightCount()); i++)
-	{
-		std::string nodeName = shadowStage + std::to_string(i);
+	mConfig->mGraphBuilder["ShadowStage"].UpdateFn = [config](EXEC_NAMESPACE::Operation& op)
+		{
+			auto& pipeline = *reinterpret_cast<ShadowPipeline*>(GetRefAddr(op.GFX));
 
-		plugin.SetDepthBuffer(mConfig->mDepthBuffers[0]);
-		plugin.SetCameraOffset(i);
-		plugin.AddPlugin(mConfig->mGraphBuilder, nodeName);
+			pipeline.SetVertexBuffer(0, (*config->mVertexFactory)[ENTRY_POSITION]);
+			pipeline.SetVertexBuffer(1, (*config->mVertexFactory)[ENTRY_METADATA]);
 
-		mConfig->mGraphBuilder[nodeName].UpdateFn = [config](EXEC_NAMESPACE::Operation& op)
-			{
-				auto& pipeline = *reinterpret_cast<ShadowPipeline*>(GetRefAddr(op.GFX));
+			pipeline.SetIndexBuffer(config->mVertexFactory->GetIndexBuffer());
+
+			pipeline.SetCamerasInfos(config->mShadowBuffers.mCameras);
+			pipeline.SetModels(config->mModels);
 
-				pipeline.SetClearDepthStencilValues(1.0f, 0);
+			pipeline.UpdateDescriptors();
+		};
 
-				pipeline.SetVertexBuffer(0, (*config->mVertexFactory)[ENTRY_POSITION]);
-				pipeline.SetVertexBuffer(1, (*config->mVertexFactory)[ENTRY_METADATA]);
+	mConfig->mOutputs.emplace_back("ShadowStage");
+}
 
-				pipeline.SetIndexBuffer(config->mVertexFactory->GetIndexBuffer());
+void AQUA_NAMESPACE::FrontEndGraph::PrepareLightClusters()
+{
+	auto config = mConfig;
 
-				pipeline.SetCamerasInfos(config->mEnv->GetLightBuffers().mDirCameraInfos);
-				pipeline.SetModels(config->mModels);
+	LightCullingPlugin plugin{};
+	plugin.SetShader(mConfig->mLightCullingShader);
+	plugin.SetEnvironment(mConfig->mEnv);
+	plugin.SetClusterCount(mConfig->mClusterCount);
+	plugin.SetPipelineBuilder(mConfig->mCtx.MakePipelineBuilder());
+	plugin.AddPlugin(mConfig->mGraphBuilder, "LightCullingStage");
 
-				pipeline.UpdateDescriptors();
-			};
+	mConfig->mGraphBuilder["LightCullingStage"].UpdateFn = [config](EXEC_NAMESPACE::Operation& op)
+		{
+			auto& pipeline = *reinterpret_cast<LightCullingPipeline*>(GetRefAddr(op.Cmp));
 
-		mConfig->mOutputs.emplace_back(nodeName);
-	}
+			pipeline.SetCamera(config->mCamera);
+			pipeline.SetPointLights(config->mEnv->GetLightBuffers().mPointLightBuf);
+			pipeline.SetClusterInfo(config->mClusterBuffers.mInfo);
+			pipeline.SetClusterLights(config->mClusterBuffers.mLightCounts, config->mClusterBuffers.mLightIndices);
+
+			pipeline.UpdateDescriptors();
+		};
+
+	// every material pass reads the cluster lists
+	mConfig->mOutputs.emplace_back("LightCullingStage");
 }
 
 void AQUA_NAMESPACE::FrontEndGraph::CreateGraph()
@@ -158,41 +421,112 @@ void AQUA_NAMESPACE::FrontEndGraph::UpdateGraph()
 
 void AQUA_NAMESPACE::FrontEndGraph::PrepareFramebuffers(const glm::uvec2& rendererResolution)
 {
+	mConfig->mResolution = rendererResolution;
+
 	PrepareDepthBuffers();
+	PrepareClusterBuffers();
 }
 
 void AQUA_NAMESPACE::FrontEndGraph::PrepareDepthBuffers()
 {
+	const auto& feature = mConfig->mShadowFeature;
+
+	// The materials sample the atlas even without any light, so there is always a row
+	uint32_t lightCount = glm::max(static_cast<uint32_t>(mConfig->mEnv->GetDirLightCount()), 1u);
+	glm::uvec2 atlasResolution = feature.BaseResolution * glm::uvec2(feature.CascadeDivisions, lightCount);
+
+	uint32_t maxDimension = mConfig->mCtx.GetDeviceInfo().PhysicalDevice.Handle.getProperties().limits.maxImageDimension2D;
+
+	_STL_ASSERT(atlasResolution.x <= maxDimension && atlasResolution.y <= maxDimension,
+		"The shadow atlas doesn't fit in an image, lower the cascade resolution or count");
+
+	// The tiles are cleared once by the shadow stage, each cascade loads what's there
 	mConfig->mFramebufferFactory.Clear();
 	mConfig->mFramebufferFactory.SetDepthAttribute("Depth", "D24UN_S8U");
-	mConfig->mFramebufferFactory.SetDepthProperties(vk::ImageUsageFlagBits::eDepthStencilAttachment | vk::ImageUsageFlagBits::eSampled);
-	mConfig->mFramebufferFactory.SetTargetSize(mConfig->mShadowFeature.BaseResolution);
+	mConfig->mFramebufferFactory.SetDepthProperties(vk::AttachmentLoadOp::eLoad, vk::ImageUsageFlagBits::eDepthStencilAttachment |
+		vk::ImageUsageFlagBits::eSampled | vk::ImageUsageFlagBits::eTransferSrc | vk::ImageUsageFlagBits::eTransferDst);
+	mConfig->mFramebufferFactory.SetTargetSize(atlasResolution);
 
 	auto error = mConfig->mFramebufferFactory.Validate();
 
 	_STL_ASSERT(error, "Failed to validate depth factory");
 
-	mConfig->mDepthBuffers.reserve(mConfig->mEnv->GetDirLightCount());
+	mConfig->mShadowAtlas = *mConfig->mFramebufferFactory.CreateFramebuffer();
 
-	for (const auto& lightSrc : mConfig->mEnv->GetDirLightSrcList())
-	{
-		auto depthBuffer = *mConfig->mFramebufferFactory.CreateFramebuffer();
-
-		vkLib::ImageViewCreateInfo viewInfo{};
-		viewInfo.Type = vk::ImageViewType::e2D;
-		viewInfo.Format = vk::Format::eD24UnormS8Uint;
-		viewInfo.ComponentMaps = { vk::ComponentSwizzle::eR };
-		viewInfo.Subresource.aspectMask = vk::ImageAspectFlagBits::eDepth;
-		viewInfo.Subresource.baseArrayLayer = 0;
-		viewInfo.Subresource.baseMipLevel = 0;
-		viewInfo.Subresource.layerCount = 1;
-		viewInfo.Subresource.levelCount = 1;
-
-		auto depthView = depthBuffer.GetDepthStencilAttachment()->CreateImageView(viewInfo);
-
-		mConfig->mDepthBuffers.emplace_back(depthBuffer);
-		mConfig->mDepthViews.push_back(depthView);
-	}
+	vkLib::ImageViewCreateInfo viewInfo{};
+	viewInfo.Type = vk::ImageViewType::e2D;
+	viewInfo.Format = vk::Format::eD24UnormS8Uint;
+	viewInfo.ComponentMaps = { vk::ComponentSwizzle::eR };
+	viewInfo.Subresource.aspectMask = vk::ImageAspectFlagBits::eDepth;
+	viewInfo.Subresource.baseArrayLayer = 0;
+	viewInfo.Subresource.baseMipLevel = 0;
+	viewInfo.Subresource.layerCount = 1;
+	viewInfo.Subresource.levelCount = 1;
+
+	mConfig->mShadowAtlasView = mConfig->mShadowAtlas.GetDepthStencilAttachment()->CreateImageView(viewInfo);
+
+	uint32_t tileCount = feature.CascadeDivisions * lightCount;
+
+	auto& draws = *mConfig->mShadowDraws;
+	draws.TileResolution = feature.BaseResolution;
+	draws.CascadeCount = feature.CascadeDivisions;
+	draws.StaticRanges.assign(tileCount, glm::uvec2(0));
+	draws.DynamicRanges.assign(tileCount, glm::uvec2(0));
+
+	// Same render context as the atlas, the shadow pipeline draws into both
+	mConfig->mFramebufferFactory.SetTargetSize(feature.BaseResolution);
+
+	draws.StaticTiles.clear();
+
+	for (uint32_t i = 0; i < tileCount; i++)
+		draws.StaticTiles.emplace_back(*mConfig->mFramebufferFactory.CreateFramebuffer());
+
+	// Nothing is cached yet, the atlas gets filled in on the first frame
+	draws.StaticDirty.assign(tileCount, true);
+	draws.AtlasStale.assign(tileCount, true);
+
+	mConfig->mShadowCameras.clear();
+
+	// Sized up front, the material descriptors point at these buffers
+	ShadowAtlasInfo info{};
+	info.TileResolution = feature.BaseResolution;
+	info.AtlasResolution = atlasResolution;
+	info.CascadeCount = 0; // nothing to sample until the cascades are fitted
+
+	mConfig->mShadowBuffers.mInfo.Clear();
+	mConfig->mShadowBuffers.mInfo << info;
+	mConfig->mShadowBuffers.mCameras.Resize(tileCount);
+
+	if (mConfig->mLastCamera)
+		UpdateShadowCascades(*mConfig->mLastCamera);
+}
+
+void AQUA_NAMESPACE::FrontEndGraph::PrepareClusterBuffers()
+{
+	const auto& feature = mConfig->mClusterFeature;
+
+	_STL_ASSERT(feature.TileSize.x > 0 && feature.TileSize.y > 0 && feature.DepthSlices > 0,
+		"Invalid light cluster dimensions");
+	_STL_ASSERT(feature.Near > 0.0f && feature.Far > feature.Near, "Invalid light cluster depth range");
+
+	glm::uvec2 tileCount = (mConfig->mResolution + feature.TileSize - glm::uvec2(1)) / feature.TileSize;
+
+	LightClusterInfo clusterInfo{};
+	clusterInfo.GridSize = glm::uvec4(tileCount, feature.DepthSlices, feature.MaxLightsPerCluster);
+	clusterInfo.TileSize = feature.TileSize;
+	clusterInfo.Near = feature.Near;
+	clusterInfo.Far = feature.Far;
+	clusterInfo.Resolution = mConfig->mResolution;
+
+	mConfig->mClusterCount = tileCount.x * tileCount.y * feature.DepthSlices;
+
+	auto& clusters = mConfig->mClusterBuffers;
+
+	clusters.mInfo.Clear();
+	clusters.mInfo << clusterInfo;
+
+	clusters.mLightCounts.Resize(mConfig->mClusterCount);
+	clusters.mLightIndices.Resize(static_cast<size_t>(mConfig->mClusterCount) * feature.MaxLightsPerCluster);
 }
 
 AQUA_NAMESPACE::EXEC_NAMESPACE::Graph AQUA_NAMESPACE::FrontEndGraph::GetGraph() const
@@ -210,12 +544,48 @@ std::vector<std::string> AQUA_NAMESPACE::FrontEndGraph::GetOutputs() const
 	return mConfig->mOutputs;
 }
 
-std::vector<vkLib::ImageView> AQUA_NAMESPACE::FrontEndGraph::GetDepthViews() const
+vkLib::ImageView AQUA_NAMESPACE::FrontEndGraph::GetShadowAtlasView() const
 {
-	return mConfig->mDepthViews;
+	return mConfig->mShadowAtlasView;
+}
+
+vkLib::Framebuffer AQUA_NAMESPACE::FrontEndGraph::GetShadowAtlas() const
+{
+	return mConfig->mShadowAtlas;
+}
+
+AQUA_NAMESPACE::ShadowAtlasBuffers AQUA_NAMESPACE::FrontEndGraph::GetShadowAtlasBuffers() const
+{
+	return mConfig->mShadowBuffers;
+}
+
+bool AQUA_NAMESPACE::FrontEndGraph::IsShadowEnabled() const
+{
+	return (mConfig->mFeatures & RendererFeatureFlags(RenderingFeature::eShadow)) && mConfig->mEnv &&
+		mConfig->mEnv->GetDirLightCount() > 0;
+}
+
+AQUA_NAMESPACE::ShadowCaster AQUA_NAMESPACE::FrontEndGraph::TransformBounds(const ShadowCaster& caster, const glm::mat4& transform)
+{
+	ShadowCaster transformed = caster;
+	transformed.MinBound = glm::vec3(std::numeric_limits<float>::max());
+	transformed.MaxBound = glm::vec3(-std::numeric_limits<float>::max());
+
+	for (uint32_t i = 0; i < 8; i++)
+	{
+		glm::vec3 corner = { (i & 1) ? caster.MaxBound.x : caster.MinBound.x,
+			(i & 2) ? caster.MaxBound.y : caster.MinBound.y, (i & 4) ? caster.MaxBound.z : caster.MinBound.z };
+
+		glm::vec3 point = glm::vec3(transform * glm::vec4(corner, 1.0f));
+
+		transformed.MinBound = glm::min(transformed.MinBound, point);
+		transformed.MaxBound = glm::max(transformed.MaxBound, point);
+	}
+
+	return transformed;
 }
 
-std::vector <vkLib::Framebuffer> AQUA_NAMESPACE::FrontEndGraph::GetDepthbuffers() const
+AQUA_NAMESPACE::LightClusterBuffers AQUA_NAMESPACE::FrontEndGraph::GetLightClusterBuffers() const
 {
-	return mConfig->mDepthBuffers;
+	return mConfig->mClusterBuffers;
 }
@@ -0,0 +1,46 @@
+#include "Core/Aqpch.h"
+#include "DeferredRenderer/Pipelines/LightCullingPipeline.h"
+
+AQUA_NAMESPACE::LightCullingPipeline::LightCullingPipeline(vkLib::PShader shader)
+{
+	this->SetShader(shader);
+}
+
+void AQUA_NAMESPACE::LightCullingPipeline::UpdateDescriptors()
+{
+	vkLib::UniformBufferWriteInfo uniformInfo{};
+	uniformInfo.Buffer = mCamera.GetNativeHandles().Handle;
+
+	this->UpdateDescriptor({ 0, 0, 0 }, uniformInfo);
+
+	uniformInfo.Buffer = mClusterInfo.GetNativeHandles().Handle;
+
+	this->UpdateDescriptor({ 0, 1, 0 }, uniformInfo);
+
+	vkLib::StorageBufferWriteInfo storageInfo{};
+	storageInfo.Buffer = mPointLights.GetNativeHandles().Handle;
+
+	this->UpdateDescriptor({ 0, 2, 0 }, storageInfo);
+
+	storageInfo.Buffer = mLightCounts.GetNativeHandles().Handle;
+
+	this->UpdateDescriptor({ 0, 3, 0 }, storageInfo);
+
+	storageInfo.Buffer = mLightIndices.GetNativeHandles().Handle;
+
+	this->UpdateDescriptor({ 0, 4, 0 }, storageInfo);
+}
+
+void AQUA_NAMESPACE::LightCullingPipeline::operator()(vk::CommandBuffer cmd, uint32_t pointLightCount, uint32_t clusterCount) const
+{
+	uint32_t workGroupSize = GetWorkGroupSize().x;
+
+	Begin(cmd);
+
+	Activate();
+	SetShaderConstant("eCompute.ShaderConstants.Index_0", pointLightCount);
+
+	Dispatch({ (clusterCount + workGroupSize - 1) / workGroupSize, 1, 1 });
+
+	End();
+}
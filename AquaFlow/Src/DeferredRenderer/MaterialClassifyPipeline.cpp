@@ -0,0 +1,42 @@
+#include "Core/Aqpch.h"
+#include "DeferredRenderer/Pipelines/MaterialClassifyPipeline.h"
+
+AQUA_NAMESPACE::MaterialClassifyPipeline::MaterialClassifyPipeline(vkLib::PShader shader)
+{
+	this->SetShader(shader);
+}
+
+void AQUA_NAMESPACE::MaterialClassifyPipeline::UpdateDescriptors()
+{
+	vkLib::SampledImageWriteInfo normalInfo{};
+	normalInfo.ImageLayout = vk::ImageLayout::eGeneral;
+	normalInfo.ImageView = mNormals.GetNativeHandle();
+	normalInfo.Sampler = *mSampler;
+
+	this->UpdateDescriptor({ 0, 0, 0 }, normalInfo);
+
+	vkLib::UniformBufferWriteInfo uniformInfo{};
+	uniformInfo.Buffer = mTileInfo.GetNativeHandles().Handle;
+
+	this->UpdateDescriptor({ 0, 1, 0 }, uniformInfo);
+
+	vkLib::StorageBufferWriteInfo storageInfo{};
+	storageInfo.Buffer = mDraws.GetNativeHandles().Handle;
+
+	this->UpdateDescriptor({ 0, 2, 0 }, storageInfo);
+
+	storageInfo.Buffer = mTiles.GetNativeHandles().Handle;
+
+	this->UpdateDescriptor({ 0, 3, 0 }, storageInfo);
+}
+
+void AQUA_NAMESPACE::MaterialClassifyPipeline::operator()(vk::CommandBuffer cmd, const glm::uvec2& tileCount) const
+{
+	// One work group per tile
+	Begin(cmd);
+
+	Activate();
+	Dispatch({ tileCount.x, tileCount.y, 1 });
+
+	End();
+}
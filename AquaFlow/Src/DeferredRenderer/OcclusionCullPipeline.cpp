@@ -0,0 +1,50 @@
+#include "Core/Aqpch.h"
+#include "DeferredRenderer/Pipelines/OcclusionCullPipeline.h"
+
+AQUA_NAMESPACE::OcclusionCullPipeline::OcclusionCullPipeline(vkLib::PShader shader)
+{
+	this->SetShader(shader);
+}
+
+void AQUA_NAMESPACE::OcclusionCullPipeline::UpdateDescriptors()
+{
+	vkLib::UniformBufferWriteInfo uniformInfo{};
+	uniformInfo.Buffer = mCamera.GetNativeHandles().Handle;
+
+	this->UpdateDescriptor({ 0, 0, 0 }, uniformInfo);
+
+	uniformInfo.Buffer = mPyramidInfo.GetNativeHandles().Handle;
+
+	this->UpdateDescriptor({ 0, 1, 0 }, uniformInfo);
+
+	vkLib::StorageBufferWriteInfo storageInfo{};
+	storageInfo.Buffer = mPyramid.GetNativeHandles().Handle;
+
+	this->UpdateDescriptor({ 0, 2, 0 }, storageInfo);
+
+	storageInfo.Buffer = mCandidates.GetNativeHandles().Handle;
+
+	this->UpdateDescriptor({ 0, 3, 0 }, storageInfo);
+
+	storageInfo.Buffer = mVisibility.GetNativeHandles().Handle;
+
+	this->UpdateDescriptor({ 0, 4, 0 }, storageInfo);
+
+	storageInfo.Buffer = mDraws.GetNativeHandles().Handle;
+
+	this->UpdateDescriptor({ 0, 5, 0 }, storageInfo);
+}
+
+void AQUA_NAMESPACE::OcclusionCullPipeline::operator()(vk::CommandBuffer cmd, OcclusionPhase phase, uint32_t candidateCount) const
+{
+	uint32_t workGroupSize = GetWorkGroupSize().x;
+
+	Begin(cmd);
+
+	Activate();
+	SetShaderConstant("eCompute.ShaderConstants.Index_0", static_cast<uint32_t>(phase));
+
+	Dispatch({ (candidateCount + workGroupSize - 1) / workGroupSize, 1, 1 });
+
+	End();
+}
@@ -5,6 +5,10 @@
 #include "DeferredRenderer/RenderGraph/ShadowPlugin.h"
 #include "DeferredRenderer/RenderGraph/SkyboxPlugin.h"
 #include "DeferredRenderer/RenderGraph/PostProcessPlugin.h"
+#include "DeferredRenderer/RenderGraph/MaterialClassifyPlugin.h"
+#include "DeferredRenderer/RenderGraph/OcclusionCullPlugin.h"
+#include "DeferredRenderer/RenderGraph/DepthPyramidPlugin.h"
+#include "DeferredRenderer/RenderGraph/DepthPrepassPlugin.h"
 
 #include "DeferredRenderer/Renderable/CopyIndices.h"
 
@@ -44,6 +48,10 @@ struct RendererConfig
 	std::unordered_map<std::string, Renderable> mRenderables;
 	// SUGGESTION: we could use one giant buffer and map the ranges within the buffer for each renderable
 	std::unordered_map<std::string, vkLib::GenericBuffer> mVertexMetaBuffers;
+	// world space bounds for the shadow cascade culling
+	std::unordered_map<std::string, ShadowCaster> mShadowCasters;
+	// renderables in the order of the last upload, their index ranges are kept in the casters
+	std::vector<std::string> mUploadedCasters;
 
 	// the things that will be rendered
 	std::unordered_set<std::string> mActiveRenderables;
@@ -70,6 +78,7 @@ struct RendererConfig
 
 	vkLib::Buffer<FeaturesEnabled> mFeatures;
 	vkLib::Buffer<CameraInfo> mCamera;
+	CameraInfo mCameraInfo; // unjittered, the temporal pass jitters it each frame
 
 	RendererFeatureFlags mFeatureFlags;
 
@@ -81,6 +90,14 @@ struct RendererConfig
 	vkLib::Framebuffer mGBuffer;
 	vkLib::Framebuffer mShadingbuffer;
 
+	// same images as the geometry buffer, loading what the early draws left behind
+	vkLib::Framebuffer mGBufferLate;
+	vkLib::ImageView mDepthView;
+
+	// depth only views of the shading buffer's depth
+	vkLib::Framebuffer mDepthPrepass;
+	vkLib::Framebuffer mDepthPrepassLate;
+
 	RenderTargetFactory mRenderCtxFactory;
 
 	vkLib::Core::Ref<vk::Sampler> mShadingSampler;
@@ -96,6 +113,15 @@ struct RendererConfig
 	EXEC_NAMESPACE::GraphBuilder mRenderGraphBuilder;
 	EXEC_NAMESPACE::GraphList mShadingNetworkGraphList;
 
+	// Screen tiles of each material, so the materials only shade where they are present
+	vkLib::Buffer<MaterialTileInfo> mMaterialTileInfo;
+	vkLib::Buffer<vk::DrawIndirectCommand> mMaterialDraws;
+	vkLib::Buffer<uint32_t> mMaterialTiles;
+	glm::uvec2 mMaterialTileCount = { 0, 0 };
+
+	// Two phase occlusion culling of the renderables against a depth pyramid
+	SharedRef<OcclusionDraws> mOcclusion = std::make_shared<OcclusionDraws>();
+
 	std::vector<CopyIdxPipeline> mCopyIndices;
 
 	std::vector<vk::CommandBuffer> mCmdBufs;
@@ -112,9 +138,16 @@ struct RendererConfig
 	vkLib::PShader mGBufferShader;
 	vkLib::PShader mSkyboxShader;
 	vkLib::PShader mCopyIdxShader;
+	vkLib::PShader mMaterialClassifyShader;
+	vkLib::PShader mDepthPyramidShader;
+	vkLib::PShader mDepthPrepassShader;
+	vkLib::PShader mOcclusionCullShader;
 
 	constexpr static uint64_t sMatTypeID = -1;
 	constexpr static uint64_t sGBufferID = -2;
+
+	constexpr static uint32_t sMaterialTileSize = 16;
+	constexpr static uint32_t sMaxMaterialCount = 256;
 };
 
 void SetFeatures(RendererFeatureFlags flags, vkLib::Buffer<FeaturesEnabled> enabled, bool val)
@@ -136,6 +169,81 @@ void SetFeatures(RendererFeatureFlags flags, vkLib::Buffer<FeaturesEnabled> enab
 	enabled.SetBuf(features.begin(), features.end());
 }
 
+bool IsFeatureEnabled(RendererFeatureFlags flags, RenderingFeature feature)
+{
+	return static_cast<bool>(flags & RendererFeatureFlags(feature));
+}
+
+void UploadOcclusionCandidates(OcclusionDraws& occlusion, const std::vector<ShadowCaster>& casters)
+{
+	std::vector<OcclusionCandidate> candidates;
+	std::vector<glm::uvec2> ranges;
+
+	candidates.reserve(casters.size());
+	ranges.reserve(casters.size());
+
+	for (const auto& caster : casters)
+	{
+		candidates.push_back({ glm::vec4(caster.MinBound, 1.0f), glm::vec4(caster.MaxBound, 1.0f),
+			caster.FirstIndex, caster.IndexCount });
+		ranges.emplace_back(caster.FirstIndex, caster.IndexCount);
+	}
+
+	// last frame's visibility belongs to a different set of renderables
+	if (ranges != occlusion.IndexRanges)
+	{
+		size_t count = glm::max(ranges.size(), size_t(1));
+
+		occlusion.Visibility.Resize(count);
+		occlusion.Commands.Resize(2 * count);
+
+		occlusion.IndexRanges = ranges;
+		occlusion.ResetVisibility = true;
+	}
+
+	if (!candidates.empty())
+		occlusion.Candidates.SetBuf(candidates.begin(), candidates.end());
+
+	occlusion.Layout.CandidateCount = static_cast<uint32_t>(candidates.size());
+	occlusion.PyramidInfo.SetBuf(&occlusion.Layout, &occlusion.Layout + 1);
+}
+
+void ComputeCasterBounds(ShadowCaster& caster, const glm::mat4& model, const std::vector<glm::vec3>& positions)
+{
+	caster.MinBound = glm::vec3(std::numeric_limits<float>::max());
+	caster.MaxBound = glm::vec3(-std::numeric_limits<float>::max());
+
+	for (const auto& position : positions)
+	{
+		glm::vec3 worldPosition = glm::vec3(model * glm::vec4(position, 1.0f));
+
+		caster.MinBound = glm::min(caster.MinBound, worldPosition);
+		caster.MaxBound = glm::max(caster.MaxBound, worldPosition);
+	}
+}
+
+// hands the bounds of the uploaded renderables to the cascade and the occlusion culling
+void PushShadowCasters(SharedRef<RendererConfig> config)
+{
+	std::vector<ShadowCaster> casters;
+	casters.reserve(config->mUploadedCasters.size());
+
+	for (const auto& name : config->mUploadedCasters)
+	{
+		auto found = config->mShadowCasters.find(name);
+
+		// removed since the upload, the next one drops its indices too
+		if (found != config->mShadowCasters.end())
+			casters.push_back(found->second);
+	}
+
+	// the front end only redraws the static cache if a static caster actually changed
+	config->mFrontEnd.SetShadowCasters(casters);
+
+	if (IsFeatureEnabled(config->mFeatureFlags, RenderingFeature::eOcclusionCulling))
+		UploadOcclusionCandidates(*config->mOcclusion, casters);
+}
+
 std::vector<RendererConfig::MaterialInfo>::const_iterator FindMaterialInstance(
 	MaterialInstance& lineMaterial, SharedRef<RendererConfig> config)
 {
@@ -208,9 +316,30 @@ void AQUA_NAMESPACE::Renderer::SetCtx(vkLib::Context ctx)
 	mConfig->mFeatures = mConfig->mResourcePool.CreateBuffer<FeaturesEnabled>(vk::BufferUsageFlagBits::eUniformBuffer, vk::MemoryPropertyFlagBits::eHostCoherent);
 	mConfig->mModels = mConfig->mResourcePool.CreateBuffer<glm::mat4>(vk::BufferUsageFlagBits::eStorageBuffer, vk::MemoryPropertyFlagBits::eHostCoherent);
 
+	mConfig->mMaterialTileInfo = mConfig->mResourcePool.CreateBuffer<MaterialTileInfo>(vk::BufferUsageFlagBits::eUniformBuffer, vk::MemoryPropertyFlagBits::eHostCoherent);
+	mConfig->mMaterialDraws = mConfig->mResourcePool.CreateBuffer<vk::DrawIndirectCommand>(vk::BufferUsageFlagBits::eIndirectBuffer |
+		vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eTransferDst, vk::MemoryPropertyFlagBits::eDeviceLocal);
+	mConfig->mMaterialTiles = mConfig->mResourcePool.CreateBuffer<uint32_t>(vk::BufferUsageFlagBits::eStorageBuffer, vk::MemoryPropertyFlagBits::eDeviceLocal);
+
+	auto& occlusion = *mConfig->mOcclusion;
+	occlusion.Candidates = mConfig->mResourcePool.CreateBuffer<OcclusionCandidate>(vk::BufferUsageFlagBits::eStorageBuffer, vk::MemoryPropertyFlagBits::eHostCoherent);
+	occlusion.Visibility = mConfig->mResourcePool.CreateBuffer<uint32_t>(vk::BufferUsageFlagBits::eStorageBuffer |
+		vk::BufferUsageFlagBits::eTransferDst, vk::MemoryPropertyFlagBits::eDeviceLocal);
+	occlusion.Commands = mConfig->mResourcePool.CreateBuffer<vk::DrawIndexedIndirectCommand>(vk::BufferUsageFlagBits::eIndirectBuffer |
+		vk::BufferUsageFlagBits::eStorageBuffer, vk::MemoryPropertyFlagBits::eDeviceLocal);
+	occlusion.PyramidInfo = mConfig->mResourcePool.CreateBuffer<DepthPyramidInfo>(vk::BufferUsageFlagBits::eUniformBuffer, vk::MemoryPropertyFlagBits::eHostCoherent);
+	occlusion.Pyramid = mConfig->mResourcePool.CreateBuffer<float>(vk::BufferUsageFlagBits::eStorageBuffer, vk::MemoryPropertyFlagBits::eDeviceLocal);
+
+	occlusion.Candidates.Resize(1);
+	occlusion.Visibility.Resize(1);
+	occlusion.Commands.Resize(2);
+
 	mConfig->mCamera.Resize(1);
 	mConfig->mFeatures.Resize(1);
 
+	mConfig->mFrontEnd.SetCamera(mConfig->mCamera);
+	mConfig->mBackEnd.SetCamera(mConfig->mCamera);
+
 	vkLib::SamplerInfo depthSamplerInfo{};
 	depthSamplerInfo.MagFilter = vk::Filter::eNearest;
 	depthSamplerInfo.MinFilter = vk::Filter::eNearest;
@@ -245,6 +374,7 @@ void AQUA_NAMESPACE::Renderer::SetShadingbuffer(vkLib::Framebuffer framebuffer)
 void AQUA_NAMESPACE::Renderer::SetSSAOConfig(const SSAOFeature& config)
 {
 	mConfig->mFeatureInfos[RenderingFeature::eSSAO].UniBuffer.SetBuf(&config, &config + 1, 0);
+	mConfig->mBackEnd.SetSSAOFeature(config);
 }
 
 void AQUA_NAMESPACE::Renderer::SetShadowConfig(const ShadowCascadeFeature& config)
@@ -256,6 +386,24 @@ void AQUA_NAMESPACE::Renderer::SetShadowConfig(const ShadowCascadeFeature& confi
 void AQUA_NAMESPACE::Renderer::SetBloomEffectConfig(const BloomEffectFeature& config)
 {
 	mConfig->mFeatureInfos[RenderingFeature::eBloomEffect].UniBuffer.SetBuf(&config, &config + 1);
+	mConfig->mBackEnd.SetBloomFeature(config);
+}
+
+void AQUA_NAMESPACE::Renderer::SetTemporalAAConfig(const TemporalAAFeature& config)
+{
+	mConfig->mFeatureInfos[RenderingFeature::eTemporalAA].UniBuffer.SetBuf(&config, &config + 1);
+	mConfig->mBackEnd.SetTemporalAAFeature(config);
+}
+
+void AQUA_NAMESPACE::Renderer::SetAutoExposureConfig(const AutoExposureFeature& config)
+{
+	mConfig->mFeatureInfos[RenderingFeature::eAutoExposure].UniBuffer.SetBuf(&config, &config + 1);
+	mConfig->mBackEnd.SetAutoExposureFeature(config);
+}
+
+void AQUA_NAMESPACE::Renderer::SetLightClusterConfig(const LightClusterFeature& config)
+{
+	mConfig->mFrontEnd.SetLightClusterFeature(config);
 }
 
 void AQUA_NAMESPACE::Renderer::SetEnvironment(EnvironmentRef env)
@@ -273,6 +421,9 @@ void AQUA_NAMESPACE::Renderer::SetCamera(const glm::mat4& projection, const glm:
 {
 	CameraInfo camera{ projection, view };
 	mConfig->mCamera.SetBuf(&camera, &camera + 1);
+	mConfig->mCameraInfo = camera;
+
+	mConfig->mFrontEnd.UpdateShadowCascades(camera);
 }
 
 void AQUA_NAMESPACE::Renderer::PrepareFeatures()
@@ -346,6 +497,21 @@ void AQUA_NAMESPACE::Renderer::SubmitRenderable(const std::string& name, const g
 
 	mConfig->mVertexMetaBuffers[name] = vertexDataBuffer;
 
+	ShadowCaster caster{};
+
+	auto prevCaster = mConfig->mShadowCasters.find(name);
+
+	if (prevCaster != mConfig->mShadowCasters.end())
+		caster.Dynamic = prevCaster->second.Dynamic;
+
+	// the bounds may well be the same, so the cached static shadows are thrown away right here
+	if (!caster.Dynamic)
+		mConfig->mFrontEnd.InvalidateStaticShadows();
+
+	ComputeCasterBounds(caster, model, renderable.Info.Mesh.aPositions);
+
+	mConfig->mShadowCasters[name] = caster;
+
 	InsertModelMatrix(model);
 
 	auto materialIdx = static_cast<uint32_t>(config->mMaterials.size());
@@ -486,10 +652,30 @@ void AQUA_NAMESPACE::Renderer::SubmitBezierCurves(const std::string& curveIsland
 	SubmitCurves(curveIsland, basicCurves, thickness);
 }
 
+void AQUA_NAMESPACE::Renderer::SetModelMatrix(const std::string& name, const glm::mat4& model)
+{
+	auto found = mConfig->mRenderables.find(name);
+
+	_STL_ASSERT(found != mConfig->mRenderables.end(), "Renderable doesn't exist");
+
+	std::vector<glm::mat4> models;
+	mConfig->mModels >> models;
+
+	models[found->second.VertexData.ModelIdx] = model;
+	mConfig->mModels.SetBuf(models.begin(), models.end());
+
+	ShadowCaster& caster = mConfig->mShadowCasters[name];
+	ComputeCasterBounds(caster, model, found->second.Info.Mesh.aPositions);
+
+	// the culling must follow the move right away, the vertices don't need another upload
+	PushShadowCasters(mConfig);
+}
+
 void AQUA_NAMESPACE::Renderer::RemoveRenderable(const std::string& name)
 {
 	mConfig->mRenderables.erase(name);
 	mConfig->mVertexMetaBuffers.erase(name);
+	mConfig->mShadowCasters.erase(name);
 
 	if (std::find(mConfig->mActiveRenderables.begin(), mConfig->mActiveRenderables.end(), name) == mConfig->mActiveRenderables.end())
 		mConfig->mActiveRenderables.erase(name);
@@ -502,6 +688,7 @@ void AQUA_NAMESPACE::Renderer::ClearRenderables()
 	mConfig->mMaterials.clear();
 	mConfig->mActiveRenderables.clear();
 	mConfig->mVertexMetaBuffers.clear();
+	mConfig->mShadowCasters.clear();
 	mConfig->mModels.Clear();
 }
 
@@ -511,6 +698,11 @@ void AQUA_NAMESPACE::Renderer::PrepareMaterialNetwork()
 	mConfig->mBackEnd.SetModels(mConfig->mModels);
 
 	PrepareFramebuffers();
+	PrepareDepthPyramid();
+
+	mConfig->mBackEnd.SetGBuffer(mConfig->mGBuffer);
+
+	PrepareMaterialTiles();
 	PrepareShadingNetwork();
 
 	mConfig->mShadingNetwork = *mConfig->mRenderGraphBuilder.GenerateExecutionGraph({ "SkyboxStage" });
@@ -592,6 +784,28 @@ void AQUA_NAMESPACE::Renderer::DeactivateRenderables(const vk::ArrayProxy<std::s
 	}
 }
 
+void AQUA_NAMESPACE::Renderer::MarkRenderablesDynamic(const vk::ArrayProxy<std::string>& names)
+{
+	for (const auto& name : names)
+	{
+		auto found = mConfig->mShadowCasters.find(name);
+
+		if (found != mConfig->mShadowCasters.end())
+			found->second.Dynamic = true;
+	}
+}
+
+void AQUA_NAMESPACE::Renderer::MarkRenderablesStatic(const vk::ArrayProxy<std::string>& names)
+{
+	for (const auto& name : names)
+	{
+		auto found = mConfig->mShadowCasters.find(name);
+
+		if (found != mConfig->mShadowCasters.end())
+			found->second.Dynamic = false;
+	}
+}
+
 void AQUA_NAMESPACE::Renderer::UploadRenderables()
 {
 	UploadModels();
@@ -610,6 +824,13 @@ void AQUA_NAMESPACE::Renderer::IssueDrawCall()
 	size_t i = 0;
 	uint32_t cmdIdx = 0;
 
+	// every frame is rendered at a new sub pixel offset for the temporal pass to accumulate
+	if (IsFeatureEnabled(mConfig->mFeatureFlags, RenderingFeature::eTemporalAA))
+	{
+		CameraInfo jittered = mConfig->mBackEnd.AdvanceTemporalFrame(mConfig->mCameraInfo);
+		mConfig->mCamera.SetBuf(&jittered, &jittered + 1);
+	}
+
 	auto FrontEndGraphList = mConfig->mFrontEnd.GetGraphList();
 	auto BackEndGraphList = mConfig->mBackEnd.GetGraphList();
 
@@ -654,12 +875,12 @@ vkLib::Framebuffer AQUA_NAMESPACE::Renderer::GetGBuffer() const
 
 vkLib::Framebuffer AQUA_NAMESPACE::Renderer::GetDepthbuffer() const
 {
-	return mConfig->mFrontEnd.GetDepthbuffers()[0];
+	return mConfig->mFrontEnd.GetShadowAtlas();
 }
 
 vkLib::ImageView AQUA_NAMESPACE::Renderer::GetDepthView() const
 {
-	return mConfig->mFrontEnd.GetDepthViews()[0];
+	return mConfig->mFrontEnd.GetShadowAtlasView();
 }
 
 void AQUA_NAMESPACE::Renderer::InsertModelMatrix(const glm::mat4& model)
@@ -715,8 +936,12 @@ void AQUA_NAMESPACE::Renderer::UploadModels()
 	// Will be called per frame so it's supposed to work super fast
 	// We'll be utilizing GPU to fill the vertex buffers of the renderer
 	uint32_t vertexCount = 0;
+	uint32_t indexCount = 0;
 	uint32_t renderableIdx = 0;
 
+	mConfig->mUploadedCasters.clear();
+	mConfig->mUploadedCasters.reserve(mConfig->mActiveRenderables.size());
+
 	mConfig->mVertexFactory.ClearBuffers();
 
 	// first reserve the buffer space, and then transfer the data
@@ -752,12 +977,23 @@ void AQUA_NAMESPACE::Renderer::UploadModels()
 		mConfig->mCopyIndices[freeQueue](cmd, mConfig->mVertexFactory.GetIndexBuffer(), renderable.mIndexBuffer, vertexCount);
 		vertexCount += static_cast<uint32_t>(renderable.Info.Mesh.GetVertexCount());
 
+		// the indices are laid out in the same order, so the cascades can draw the renderables one by one
+		ShadowCaster& caster = mConfig->mShadowCasters[renderableName];
+		caster.FirstIndex = indexCount;
+		caster.IndexCount = static_cast<uint32_t>(renderable.mIndexBuffer.GetSize() / sizeof(uint32_t));
+
+		indexCount += caster.IndexCount;
+
+		mConfig->mUploadedCasters.push_back(renderableName);
+
 		cmd.end();
 
 		// TODO: queue selection should occur inside the executor
 		// TODO: Some queues might be busy in other threads, so we'll only wait for those who were utilized...
 		mConfig->mWorkers.SubmitWork(cmd);
 	}
+
+	PushShadowCasters(mConfig);
 }
 
 void AQUA_NAMESPACE::Renderer::UploadLines()
@@ -844,16 +1080,25 @@ void AQUA_NAMESPACE::Renderer::PrepareShadingNetwork()
 
 	mConfig->mRenderGraphBuilder.Clear();
 
+	bool prepass = IsFeatureEnabled(mConfig->mFeatureFlags, RenderingFeature::eDepthPrepass);
+	bool occlusionCulling = IsFeatureEnabled(mConfig->mFeatureFlags, RenderingFeature::eOcclusionCulling);
+
 	// todo: a bit inefficient since the geometry is relatively fixed for each material for now
 	GBufferPlugin gbuffer{};
 	gbuffer.SetBindings(config->mVertexBindingsInfo); // This data can be read from the material instance
 	gbuffer.SetPipelineBuilder(config->mPipelineBuilder);
 	gbuffer.SetGBuffer(mConfig->mGBuffer);
 	gbuffer.SetShader(mConfig->mGBufferShader);
+
+	gbuffer.SetDepthPrepassed(prepass);
+
+	// after the prepass, every renderable that made it into the depth is drawn in one go
+	if (occlusionCulling)
+		gbuffer.SetDraws(mConfig->mOcclusion, prepass ? OcclusionDrawList::eBoth : OcclusionDrawList::eEarly);
+
 	gbuffer.AddPlugin(mConfig->mRenderGraphBuilder, "GBufferStage");
 
-	mConfig->mRenderGraphBuilder["GBufferStage"].OpID = RendererConfig::sGBufferID;
-	mConfig->mRenderGraphBuilder["GBufferStage"].UpdateFn = [config](EXEC_NAMESPACE::Operation& op)
+	auto updateGBuffer = [config](EXEC_NAMESPACE::Operation& op)
 		{
 			auto& pipeline = *reinterpret_cast<DeferredPipeline*>(GetRefAddr(op.GFX));
 
@@ -876,6 +1121,165 @@ void AQUA_NAMESPACE::Renderer::PrepareShadingNetwork()
 			pipeline.UpdateDescriptors();
 		};
 
+	mConfig->mRenderGraphBuilder["GBufferStage"].OpID = RendererConfig::sGBufferID;
+	mConfig->mRenderGraphBuilder["GBufferStage"].UpdateFn = updateGBuffer;
+
+	// the material classification reads the last geometry pass
+	std::string geometryStage = "GBufferStage";
+	// the depth pyramid is built from the first pass writing the depth
+	std::string depthStage = "GBufferStage";
+
+	auto updatePrepass = [config](EXEC_NAMESPACE::Operation& op)
+		{
+			auto& pipeline = *reinterpret_cast<DepthPrepassPipeline*>(GetRefAddr(op.GFX));
+
+			pipeline.SetClearDepthStencilValues(1.0f, 0);
+
+			pipeline.SetVertexBuffer(0, config->mVertexFactory[ENTRY_POSITION]);
+			pipeline.SetVertexBuffer(1, config->mVertexFactory[ENTRY_METADATA]);
+
+			pipeline.SetIndexBuffer(config->mVertexFactory.GetIndexBuffer());
+
+			pipeline.SetCamera(config->mCamera);
+			pipeline.SetModels(config->mModels);
+
+			pipeline.UpdateDescriptors();
+		};
+
+	if (prepass)
+	{
+		DepthPrepassPlugin prepassPlugin{};
+		prepassPlugin.SetPipelineBuilder(config->mPipelineBuilder);
+		prepassPlugin.SetShader(mConfig->mDepthPrepassShader);
+		prepassPlugin.SetDepthBuffer(mConfig->mDepthPrepass);
+
+		if (occlusionCulling)
+			prepassPlugin.SetDraws(mConfig->mOcclusion, OcclusionDrawList::eEarly);
+
+		prepassPlugin.AddPlugin(mConfig->mRenderGraphBuilder, "DepthPrepassStage");
+
+		mConfig->mRenderGraphBuilder["DepthPrepassStage"].UpdateFn = updatePrepass;
+
+		depthStage = "DepthPrepassStage";
+	}
+
+	if (occlusionCulling)
+	{
+		// early draws, the depth pyramid of what they left, and the late draws of whatever came into view
+		auto updateCulling = [config](EXEC_NAMESPACE::Operation& op)
+			{
+				auto& pipeline = *reinterpret_cast<OcclusionCullPipeline*>(GetRefAddr(op.Cmp));
+				const auto& occlusion = *config->mOcclusion;
+
+				pipeline.SetCamera(config->mCamera);
+				pipeline.SetPyramid(occlusion.PyramidInfo, occlusion.Pyramid);
+				pipeline.SetCandidates(occlusion.Candidates);
+				pipeline.SetVisibility(occlusion.Visibility);
+				pipeline.SetDraws(occlusion.Commands);
+
+				pipeline.UpdateDescriptors();
+			};
+
+		OcclusionCullPlugin earlyCulling{};
+		earlyCulling.SetPipelineBuilder(config->mPipelineBuilder);
+		earlyCulling.SetShader(mConfig->mOcclusionCullShader);
+		earlyCulling.SetDraws(mConfig->mOcclusion);
+		earlyCulling.SetPhase(OcclusionPhase::eEarly);
+		earlyCulling.AddPlugin(mConfig->mRenderGraphBuilder, "OcclusionEarlyStage");
+
+		mConfig->mRenderGraphBuilder["OcclusionEarlyStage"].UpdateFn = updateCulling;
+
+		DepthPyramidPlugin pyramidPlugin{};
+		pyramidPlugin.SetPipelineBuilder(config->mPipelineBuilder);
+		pyramidPlugin.SetShader(mConfig->mDepthPyramidShader);
+		pyramidPlugin.SetDraws(mConfig->mOcclusion);
+		pyramidPlugin.AddPlugin(mConfig->mRenderGraphBuilder, "DepthPyramidStage");
+
+		mConfig->mRenderGraphBuilder["DepthPyramidStage"].UpdateFn = [config](EXEC_NAMESPACE::Operation& op)
+			{
+				auto& pipeline = *reinterpret_cast<DepthPyramidPipeline*>(GetRefAddr(op.Cmp));
+
+				pipeline.SetDepth(config->mDepthView, config->mDepthSampler);
+				pipeline.SetPyramidInfo(config->mOcclusion->PyramidInfo);
+				pipeline.SetPyramid(config->mOcclusion->Pyramid);
+
+				pipeline.UpdateDescriptors();
+			};
+
+		OcclusionCullPlugin lateCulling{};
+		lateCulling.SetPipelineBuilder(config->mPipelineBuilder);
+		lateCulling.SetShader(mConfig->mOcclusionCullShader);
+		lateCulling.SetDraws(mConfig->mOcclusion);
+		lateCulling.SetPhase(OcclusionPhase::eLate);
+		lateCulling.AddPlugin(mConfig->mRenderGraphBuilder, "OcclusionLateStage");
+
+		mConfig->mRenderGraphBuilder["OcclusionLateStage"].UpdateFn = updateCulling;
+
+		mConfig->mRenderGraphBuilder.InsertDependency("OcclusionEarlyStage", depthStage, vk::PipelineStageFlagBits::eDrawIndirect);
+		mConfig->mRenderGraphBuilder.InsertDependency(depthStage, "DepthPyramidStage", vk::PipelineStageFlagBits::eComputeShader);
+		mConfig->mRenderGraphBuilder.InsertDependency("DepthPyramidStage", "OcclusionLateStage", vk::PipelineStageFlagBits::eComputeShader);
+
+		if (prepass)
+		{
+			// the late draws only complete the depth, the geometry buffer draws both lists afterwards
+			DepthPrepassPlugin latePrepass{};
+			latePrepass.SetPipelineBuilder(config->mPipelineBuilder);
+			latePrepass.SetShader(mConfig->mDepthPrepassShader);
+			latePrepass.SetDepthBuffer(mConfig->mDepthPrepassLate);
+			latePrepass.SetDraws(mConfig->mOcclusion, OcclusionDrawList::eLate);
+			latePrepass.AddPlugin(mConfig->mRenderGraphBuilder, "DepthPrepassLateStage");
+
+			mConfig->mRenderGraphBuilder["DepthPrepassLateStage"].UpdateFn = updatePrepass;
+
+			mConfig->mRenderGraphBuilder.InsertDependency("OcclusionLateStage", "DepthPrepassLateStage", vk::PipelineStageFlagBits::eDrawIndirect);
+			mConfig->mRenderGraphBuilder.InsertDependency("DepthPrepassLateStage", "GBufferStage",
+				vk::PipelineStageFlagBits::eDrawIndirect | vk::PipelineStageFlagBits::eEarlyFragmentTests);
+		}
+		else
+		{
+			GBufferPlugin lateGBuffer{};
+			lateGBuffer.SetBindings(config->mVertexBindingsInfo);
+			lateGBuffer.SetPipelineBuilder(config->mPipelineBuilder);
+			lateGBuffer.SetGBuffer(mConfig->mGBufferLate);
+			lateGBuffer.SetShader(mConfig->mGBufferShader);
+			lateGBuffer.SetDraws(mConfig->mOcclusion, OcclusionDrawList::eLate);
+			lateGBuffer.AddPlugin(mConfig->mRenderGraphBuilder, "GBufferLateStage");
+
+			mConfig->mRenderGraphBuilder["GBufferLateStage"].UpdateFn = updateGBuffer;
+
+			mConfig->mRenderGraphBuilder.InsertDependency("OcclusionLateStage", "GBufferLateStage", vk::PipelineStageFlagBits::eDrawIndirect);
+
+			geometryStage = "GBufferLateStage";
+		}
+	}
+	else if (prepass)
+	{
+		mConfig->mRenderGraphBuilder.InsertDependency("DepthPrepassStage", "GBufferStage", vk::PipelineStageFlagBits::eEarlyFragmentTests);
+	}
+
+	MaterialClassifyPlugin classifyPlugin{};
+	classifyPlugin.SetPipelineBuilder(config->mPipelineBuilder);
+	classifyPlugin.SetShader(mConfig->mMaterialClassifyShader);
+	classifyPlugin.SetDraws(mConfig->mMaterialDraws);
+	classifyPlugin.SetTileCount(mConfig->mMaterialTileCount);
+	classifyPlugin.SetTileCapacity(mConfig->mMaterialTileCount.x * mConfig->mMaterialTileCount.y);
+	classifyPlugin.SetMaterialCount(static_cast<uint32_t>(mConfig->mMaterials.size()));
+	classifyPlugin.AddPlugin(mConfig->mRenderGraphBuilder, "MaterialClassifyStage");
+
+	mConfig->mRenderGraphBuilder["MaterialClassifyStage"].UpdateFn = [config](EXEC_NAMESPACE::Operation& op)
+		{
+			auto& pipeline = *reinterpret_cast<MaterialClassifyPipeline*>(GetRefAddr(op.Cmp));
+
+			pipeline.SetNormals(config->mGBuffer.GetColorAttachments()[1], config->mShadingSampler);
+			pipeline.SetTileInfo(config->mMaterialTileInfo);
+			pipeline.SetDraws(config->mMaterialDraws);
+			pipeline.SetTiles(config->mMaterialTiles);
+
+			pipeline.UpdateDescriptors();
+		};
+
+	mConfig->mRenderGraphBuilder.InsertDependency(geometryStage, "MaterialClassifyStage", vk::PipelineStageFlagBits::eComputeShader);
+
 	std::string materialPrefix = "DeferMat_";
 	uint32_t materialIdx = 0;
 
@@ -890,7 +1294,9 @@ void AQUA_NAMESPACE::Renderer::PrepareShadingNetwork()
 		if(materialIdx < mConfig->mMaterials.size())
 			mConfig->mRenderGraphBuilder.InsertDependency(instanceName, nextInstance, vk::PipelineStageFlagBits::eTopOfPipe);
 
-		mConfig->mRenderGraphBuilder.InsertDependency("GBufferStage", instanceName);
+		// the tile lists are consumed by the indirect draws and the vertex shader
+		mConfig->mRenderGraphBuilder.InsertDependency("MaterialClassifyStage", instanceName,
+			vk::PipelineStageFlagBits::eDrawIndirect | vk::PipelineStageFlagBits::eVertexShader);
 		mConfig->mRenderGraphBuilder.InsertDependency(instanceName, "SkyboxStage");
 	}
 
@@ -917,6 +1323,9 @@ void AQUA_NAMESPACE::Renderer::PrepareFramebuffers()
 {
 	auto& rcFac = mConfig->mRenderCtxFactory;
 
+	bool prepass = IsFeatureEnabled(mConfig->mFeatureFlags, RenderingFeature::eDepthPrepass);
+	bool occlusionCulling = IsFeatureEnabled(mConfig->mFeatureFlags, RenderingFeature::eOcclusionCulling);
+
 	rcFac.Clear();
 
 	rcFac.AddColorAttribute(ENTRY_POSITION, "RGBA32F");
@@ -928,7 +1337,9 @@ void AQUA_NAMESPACE::Renderer::PrepareFramebuffers()
 	rcFac.SetDepthAttribute("Depth", "D24UN_S8U");
 
 	rcFac.SetAllColorProperties(vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eSampled);
-	rcFac.SetDepthProperties(vk::ImageUsageFlagBits::eDepthStencilAttachment);
+	// with the prepass, the geometry buffer only tests against the depth it left behind
+	rcFac.SetDepthProperties(prepass ? vk::AttachmentLoadOp::eLoad : vk::AttachmentLoadOp::eClear,
+		vk::ImageUsageFlagBits::eDepthStencilAttachment);
 
 	auto error = rcFac.Validate();
 	_STL_ASSERT(error, "Couldn't validate the render factory");
@@ -936,6 +1347,125 @@ void AQUA_NAMESPACE::Renderer::PrepareFramebuffers()
 	rcFac.SetImageView("Depth", mConfig->mShadingbuffer.GetDepthStencilAttachment());
 
 	mConfig->mGBuffer = *rcFac.CreateFramebuffer();
+
+	if (occlusionCulling && !prepass)
+	{
+		// the late draws go on top of the early ones
+		rcFac.SetAllColorProperties(vk::AttachmentLoadOp::eLoad);
+		rcFac.SetDepthProperties(vk::AttachmentLoadOp::eLoad);
+
+		error = rcFac.Validate();
+		_STL_ASSERT(error, "Couldn't validate the render factory");
+
+		auto colorViews = mConfig->mGBuffer.GetColorAttachments();
+
+		rcFac.SetImageView(ENTRY_POSITION, colorViews[0]);
+		rcFac.SetImageView(ENTRY_NORMAL, colorViews[1]);
+		rcFac.SetImageView(ENTRY_TEXCOORDS, colorViews[2]);
+		rcFac.SetImageView(ENTRY_TANGENT, colorViews[3]);
+		rcFac.SetImageView(ENTRY_BITANGENT, colorViews[4]);
+		rcFac.SetImageView("Depth", mConfig->mShadingbuffer.GetDepthStencilAttachment());
+
+		mConfig->mGBufferLate = *rcFac.CreateFramebuffer();
+	}
+
+	if (occlusionCulling)
+	{
+		// the shading buffer's depth has to be created with the sampled usage
+		vkLib::ImageViewCreateInfo viewInfo{};
+		viewInfo.Type = vk::ImageViewType::e2D;
+		viewInfo.Format = vk::Format::eD24UnormS8Uint;
+		viewInfo.ComponentMaps = { vk::ComponentSwizzle::eR };
+		viewInfo.Subresource.aspectMask = vk::ImageAspectFlagBits::eDepth;
+		viewInfo.Subresource.baseArrayLayer = 0;
+		viewInfo.Subresource.baseMipLevel = 0;
+		viewInfo.Subresource.layerCount = 1;
+		viewInfo.Subresource.levelCount = 1;
+
+		mConfig->mDepthView = mConfig->mShadingbuffer.GetDepthStencilAttachment()->CreateImageView(viewInfo);
+	}
+
+	if (!prepass)
+		return;
+
+	// depth only targets over the same depth image, the late one loads what the early draws left
+	rcFac.Clear();
+
+	rcFac.SetDepthAttribute("Depth", "D24UN_S8U");
+	rcFac.SetDepthProperties(vk::AttachmentLoadOp::eClear, vk::ImageUsageFlagBits::eDepthStencilAttachment);
+
+	error = rcFac.Validate();
+	_STL_ASSERT(error, "Couldn't validate the render factory");
+
+	rcFac.SetImageView("Depth", mConfig->mShadingbuffer.GetDepthStencilAttachment());
+
+	mConfig->mDepthPrepass = *rcFac.CreateFramebuffer();
+
+	if (!occlusionCulling)
+		return;
+
+	rcFac.SetDepthProperties(vk::AttachmentLoadOp::eLoad);
+
+	error = rcFac.Validate();
+	_STL_ASSERT(error, "Couldn't validate the render factory");
+
+	rcFac.SetImageView("Depth", mConfig->mShadingbuffer.GetDepthStencilAttachment());
+
+	mConfig->mDepthPrepassLate = *rcFac.CreateFramebuffer();
+}
+
+void AQUA_NAMESPACE::Renderer::PrepareDepthPyramid()
+{
+	if (!IsFeatureEnabled(mConfig->mFeatureFlags, RenderingFeature::eOcclusionCulling))
+		return;
+
+	auto& occlusion = *mConfig->mOcclusion;
+	glm::uvec2 size = mConfig->mShadingbuffer.GetResolution();
+
+	DepthPyramidInfo& layout = occlusion.Layout;
+	layout.Resolution = size;
+	layout.LevelCount = 0;
+
+	uint32_t offset = 0;
+
+	// halving down to a single texel, the odd sizes round up
+	do
+	{
+		size = (size + glm::uvec2(1)) / 2u;
+		layout.Levels[layout.LevelCount++] = glm::uvec4(size, offset, 0);
+
+		offset += size.x * size.y;
+	} while ((size.x > 1 || size.y > 1) && layout.LevelCount < MAX_DEPTH_PYRAMID_LEVELS);
+
+	occlusion.Pyramid.Resize(offset);
+	occlusion.PyramidInfo.SetBuf(&layout, &layout + 1);
+}
+
+void AQUA_NAMESPACE::Renderer::PrepareMaterialTiles()
+{
+	_STL_ASSERT(mConfig->mMaterials.size() <= RendererConfig::sMaxMaterialCount,
+		"Too many materials for the tile classification");
+
+	glm::uvec2 resolution = mConfig->mShadingbuffer.GetResolution();
+	glm::uvec2 tileSize = glm::uvec2(RendererConfig::sMaterialTileSize);
+
+	mConfig->mMaterialTileCount = (resolution + tileSize - glm::uvec2(1)) / tileSize;
+
+	MaterialTileInfo tileInfo{};
+	tileInfo.TileSize = tileSize;
+	tileInfo.TileCount = mConfig->mMaterialTileCount;
+	tileInfo.Resolution = resolution;
+	tileInfo.MaterialCount = static_cast<uint32_t>(mConfig->mMaterials.size());
+	tileInfo.TileCapacity = mConfig->mMaterialTileCount.x * mConfig->mMaterialTileCount.y;
+
+	mConfig->mMaterialTileInfo.Clear();
+	mConfig->mMaterialTileInfo << tileInfo;
+
+	// in the worst case every material touches every tile
+	size_t materialCount = glm::max(mConfig->mMaterials.size(), size_t(1));
+
+	mConfig->mMaterialDraws.Resize(materialCount);
+	mConfig->mMaterialTiles.Resize(materialCount * tileInfo.TileCapacity);
 }
 
 void AQUA_NAMESPACE::Renderer::ConnectFrontEndToShadingNetwork()
@@ -956,7 +1486,8 @@ void AQUA_NAMESPACE::Renderer::ConnectFrontEndToShadingNetwork()
 			EXEC_NAMESPACE::DependencyInjection outInj{};
 			outInj.Connect(output);
 			outInj.SetSignal(mConfig->mCtx.CreateSemaphore());
-			outInj.SetWaitPoint(vk::PipelineStageFlagBits::eColorAttachmentOutput);
+			// the depth maps and the light clusters are read by the fragment shaders
+			outInj.SetWaitPoint(vk::PipelineStageFlagBits::eFragmentShader);
 
 			auto FrontGraph = mConfig->mFrontEnd.GetGraph();
 			auto error = FrontGraph.InjectOutputDependencies(outInj);
@@ -980,12 +1511,16 @@ void AQUA_NAMESPACE::Renderer::ConnectBackEndToShadingNetwork()
 
 	for (const auto& input : backEndOutputs)
 	{
+		auto BackGraph = mConfig->mBackEnd.GetGraph();
+
+		// the compute effects wait at their dispatch rather than at the color output
+		bool compute = BackGraph.Nodes[input]->States.Type == EXEC_NAMESPACE::OpType::eCompute;
+
 		EXEC_NAMESPACE::DependencyInjection inInj{};
 		inInj.Connect(input);
 		inInj.SetSignal(mConfig->mCtx.CreateSemaphore());
-		inInj.SetWaitPoint(vk::PipelineStageFlagBits::eColorAttachmentOutput);
-
-		auto BackGraph = mConfig->mBackEnd.GetGraph();
+		inInj.SetWaitPoint(compute ? vk::PipelineStageFlags(vk::PipelineStageFlagBits::eComputeShader) :
+			vk::PipelineStageFlags(vk::PipelineStageFlagBits::eColorAttachmentOutput));
 
 		auto error = BackGraph.InjectInputDependencies(inInj);
 
@@ -1020,6 +1555,18 @@ void AQUA_NAMESPACE::Renderer::SetupFeatureInfos()
 	mConfig->mFeatureInfos[RenderingFeature::eSSAO].UniBuffer =
 		mConfig->mResourcePool.CreateGenericBuffer(vk::BufferUsageFlagBits::eUniformBuffer, vk::MemoryPropertyFlagBits::eHostCoherent);
 
+	mConfig->mFeatureInfos[RenderingFeature::eTemporalAA].Name = "TemporalAAStage";
+	mConfig->mFeatureInfos[RenderingFeature::eTemporalAA].Stage = RenderingStage::eBackEnd;
+	mConfig->mFeatureInfos[RenderingFeature::eTemporalAA].Type = RenderingFeature::eTemporalAA;
+	mConfig->mFeatureInfos[RenderingFeature::eTemporalAA].UniBuffer =
+		mConfig->mResourcePool.CreateGenericBuffer(vk::BufferUsageFlagBits::eUniformBuffer, vk::MemoryPropertyFlagBits::eHostCoherent);
+
+	mConfig->mFeatureInfos[RenderingFeature::eAutoExposure].Name = "AutoExposureStage";
+	mConfig->mFeatureInfos[RenderingFeature::eAutoExposure].Stage = RenderingStage::eBackEnd;
+	mConfig->mFeatureInfos[RenderingFeature::eAutoExposure].Type = RenderingFeature::eAutoExposure;
+	mConfig->mFeatureInfos[RenderingFeature::eAutoExposure].UniBuffer =
+		mConfig->mResourcePool.CreateGenericBuffer(vk::BufferUsageFlagBits::eUniformBuffer, vk::MemoryPropertyFlagBits::eHostCoherent);
+
 	mConfig->mFeatureInfos[RenderingFeature::eMotionBlur].Name = "MotionBlurStage";
 	mConfig->mFeatureInfos[RenderingFeature::eMotionBlur].Stage = RenderingStage::eFrontEnd;
 	mConfig->mFeatureInfos[RenderingFeature::eMotionBlur].Type = RenderingFeature::eMotionBlur;
@@ -1079,9 +1626,11 @@ void AQUA_NAMESPACE::Renderer::SetupVertexFactory()
 void AQUA_NAMESPACE::Renderer::UpdateMaterialData()
 {
 	auto& gBuffer = mConfig->mGBuffer;
-	auto depthViews = mConfig->mFrontEnd.GetDepthViews();
+	auto shadowAtlas = mConfig->mFrontEnd.GetShadowAtlasView();
+	auto shadowBuffers = mConfig->mFrontEnd.GetShadowAtlasBuffers();
 	auto sampler = mConfig->mShadingSampler;
 	const auto& lightBuffers = mConfig->mEnv->GetLightBuffers();
+	auto clusterBuffers = mConfig->mFrontEnd.GetLightClusterBuffers();
 
 	for (const auto& material : mConfig->mMaterials)
 	{
@@ -1093,12 +1642,21 @@ void AQUA_NAMESPACE::Renderer::UpdateMaterialData()
 		materialInfo.Resources[{0, 3, 0}].SetSampledImage(gBuffer.GetColorAttachments()[3], sampler);
 		materialInfo.Resources[{0, 4, 0}].SetSampledImage(gBuffer.GetColorAttachments()[4], sampler);
 
-		materialInfo.Resources[{0, 5, 0}].SetSampledImage(depthViews[0], mConfig->mDepthSampler);
+		materialInfo.Resources[{0, 5, 0}].SetSampledImage(shadowAtlas, mConfig->mDepthSampler);
 
 		materialInfo.Resources[{1, 0, 0}].SetStorageBuffer(lightBuffers.mDirLightBuf.GetBufferChunk());
 		materialInfo.Resources[{1, 1, 0}].SetStorageBuffer(lightBuffers.mPointLightBuf.GetBufferChunk());
-		materialInfo.Resources[{1, 2, 0}].SetStorageBuffer(lightBuffers.mDirCameraInfos.GetBufferChunk());
+		materialInfo.Resources[{1, 2, 0}].SetStorageBuffer(shadowBuffers.mCameras.GetBufferChunk());
 		materialInfo.Resources[{1, 3, 0}].SetUniformBuffer(mConfig->mCamera.GetBufferChunk());
+
+		materialInfo.Resources[{1, 4, 0}].SetUniformBuffer(clusterBuffers.mInfo.GetBufferChunk());
+		materialInfo.Resources[{1, 5, 0}].SetStorageBuffer(clusterBuffers.mLightCounts.GetBufferChunk());
+		materialInfo.Resources[{1, 6, 0}].SetStorageBuffer(clusterBuffers.mLightIndices.GetBufferChunk());
+
+		materialInfo.Resources[{1, 7, 0}].SetUniformBuffer(shadowBuffers.mInfo.GetBufferChunk());
+
+		materialInfo.Resources[{2, 0, 0}].SetStorageBuffer(mConfig->mMaterialTiles.GetBufferChunk());
+		materialInfo.Resources[{2, 1, 0}].SetUniformBuffer(mConfig->mMaterialTileInfo.GetBufferChunk());
 	}
 }
 
@@ -1122,10 +1680,14 @@ void AQUA_NAMESPACE::Renderer::ExecuteMaterial(vk::CommandBuffer buffer, const E
 
 	pipeline.SetShaderConstant("eFragment.ShaderConstants.Index_0", static_cast<uint32_t>(mConfig->mEnv->GetDirLightCount()));
 	pipeline.SetShaderConstant("eFragment.ShaderConstants.Index_1", static_cast<uint32_t>(mConfig->mEnv->GetPointLightCount()));
-	//pipeline.SetShaderConstant("eFragment.ShaderConstants.Index_2", static_cast<uint32_t>(materialIdx));
+	pipeline.SetShaderConstant("eFragment.ShaderConstants.Index_2", static_cast<uint32_t>(materialIdx));
+
+	pipeline.SetVertexIndirectBuffer(mConfig->mMaterialDraws);
 
 	pipeline.Activate();
-	pipeline.DrawVertices(0, 0, 1, 6);
+
+	// one instanced quad per tile the classification found the material in
+	pipeline.DrawVerticesIndirect(materialIdx * sizeof(vk::DrawIndirectCommand), sizeof(vk::DrawIndirectCommand), 1);
 
 	MaterialInstance::TraverseImageResources(materialInfo.Resources,
 		[buffer](const vkLib::DescriptorLocation& descInfo, vkLib::ImageView& view)
@@ -1214,6 +1776,44 @@ void AQUA_NAMESPACE::Renderer::SetupShaders()
 
 	checker.AssertOnError(error);
 
+	mConfig->mMaterialClassifyShader.SetFilepath("eCompute", mConfig->mShaderDirectory + "MaterialClassify.comp");
+
+	mConfig->mMaterialClassifyShader.AddMacro("TILE_SIZE", std::to_string(RendererConfig::sMaterialTileSize));
+	mConfig->mMaterialClassifyShader.AddMacro("MAX_MATERIAL_COUNT", std::to_string(RendererConfig::sMaxMaterialCount));
+	error = mConfig->mMaterialClassifyShader.CompileShaders();
+
+	checker.GetError(error[0]);
+
+	checker.AssertOnError(error);
+
+	// the fragment stage of the shadow pass is empty, so the prepass shares it
+	mConfig->mDepthPrepassShader.SetFilepath("eVertex", mConfig->mShaderDirectory + "Prepass.vert");
+	mConfig->mDepthPrepassShader.SetFilepath("eFragment", mConfig->mShaderDirectory + "Shadow.frag");
+
+	error = mConfig->mDepthPrepassShader.CompileShaders();
+
+	checker.GetError(error[0]);
+	checker.GetError(error[1]);
+
+	checker.AssertOnError(error);
+
+	mConfig->mDepthPyramidShader.SetFilepath("eCompute", mConfig->mShaderDirectory + "DepthPyramid.comp");
+
+	mConfig->mDepthPyramidShader.AddMacro("MAX_DEPTH_PYRAMID_LEVELS", std::to_string(MAX_DEPTH_PYRAMID_LEVELS));
+	error = mConfig->mDepthPyramidShader.CompileShaders();
+
+	checker.GetError(error[0]);
+
+	checker.AssertOnError(error);
+
+	mConfig->mOcclusionCullShader.SetFilepath("eCompute", mConfig->mShaderDirectory + "OcclusionCull.comp");
+
+	mConfig->mOcclusionCullShader.AddMacro("MAX_DEPTH_PYRAMID_LEVELS", std::to_string(MAX_DEPTH_PYRAMID_LEVELS));
+	error = mConfig->mOcclusionCullShader.CompileShaders();
+
+	checker.GetError(error[0]);
+
+	checker.AssertOnError(error);
 }
 
 void AQUA_NAMESPACE::Renderer::ReserveVertexFactorySpace(uint32_t vertexCount, uint32_t indexCount)
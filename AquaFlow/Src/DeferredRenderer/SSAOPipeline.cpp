@@ -0,0 +1,67 @@
+#include "Core/Aqpch.h"
+#include "DeferredRenderer/Pipelines/SSAOPipeline.h"
+
+AQUA_NAMESPACE::SSAOPipeline::SSAOPipeline(vkLib::PShader shader)
+{
+	this->SetShader(shader);
+}
+
+void AQUA_NAMESPACE::SSAOPipeline::UpdateDescriptors()
+{
+	vkLib::UniformBufferWriteInfo uniformInfo{};
+	uniformInfo.Buffer = mCamera.GetNativeHandles().Handle;
+
+	this->UpdateDescriptor({ 0, 0, 0 }, uniformInfo);
+
+	uniformInfo.Buffer = mInfo.GetNativeHandles().Handle;
+
+	this->UpdateDescriptor({ 0, 1, 0 }, uniformInfo);
+
+	vkLib::SampledImageWriteInfo samplerInfo{};
+	samplerInfo.ImageLayout = vk::ImageLayout::eGeneral;
+	samplerInfo.ImageView = mPositions.GetNativeHandle();
+	samplerInfo.Sampler = *mSampler;
+
+	this->UpdateDescriptor({ 0, 2, 0 }, samplerInfo);
+
+	samplerInfo.ImageView = mNormals.GetNativeHandle();
+
+	this->UpdateDescriptor({ 0, 3, 0 }, samplerInfo);
+
+	vkLib::StorageBufferWriteInfo storageInfo{};
+	storageInfo.Buffer = mHalfOcclusion.GetNativeHandles().Handle;
+
+	this->UpdateDescriptor({ 0, 4, 0 }, storageInfo);
+}
+
+void AQUA_NAMESPACE::SSAOPipeline::operator()(vk::CommandBuffer cmd, const glm::uvec2& size) const
+{
+	glm::uvec3 workGroupSize = GetWorkGroupSize();
+
+	Begin(cmd);
+
+	Activate();
+
+	Dispatch({ (size.x + workGroupSize.x - 1) / workGroupSize.x,
+		(size.y + workGroupSize.y - 1) / workGroupSize.y, 1 });
+
+	End();
+}
+
+void AQUA_NAMESPACE::SSAOUpsamplePipeline::UpdateDescriptors()
+{
+	SSAOPipeline::UpdateDescriptors();
+
+	vkLib::SampledImageWriteInfo samplerInfo{};
+	samplerInfo.ImageLayout = vk::ImageLayout::eGeneral;
+	samplerInfo.ImageView = mShading.GetNativeHandle();
+	samplerInfo.Sampler = *mSampler;
+
+	this->UpdateDescriptor({ 0, 5, 0 }, samplerInfo);
+
+	vkLib::StorageImageWriteInfo targetInfo{};
+	targetInfo.ImageLayout = vk::ImageLayout::eGeneral;
+	targetInfo.ImageView = mTarget.GetNativeHandle();
+
+	this->UpdateDescriptor({ 0, 6, 0 }, targetInfo);
+}
@@ -32,6 +32,17 @@ void AQUA_NAMESPACE::ShadowPipeline::UpdateDescriptors()
 	this->UpdateDescriptor({ 0, 1, 0 }, storageInfo);
 }
 
+AQUA_NAMESPACE::VertexBindingMap AQUA_NAMESPACE::ShadowPipeline::GetPositionBindings()
+{
+	VertexBindingMap vertexBindings{};
+	vertexBindings[0].AddAttribute(0, "RGB32F");
+	vertexBindings[0].SetName(ENTRY_POSITION);
+	vertexBindings[1].AddAttribute(1, "RGB32F");
+	vertexBindings[1].SetName(ENTRY_METADATA);
+
+	return vertexBindings;
+}
+
 void AQUA_NAMESPACE::ShadowPipeline::SetupConfig(vkLib::GraphicsPipelineConfig& config, const glm::uvec2& scrSize)
 {
 	config.CanvasScissor.offset = vk::Offset2D(0, 0);
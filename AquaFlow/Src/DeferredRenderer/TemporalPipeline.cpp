@@ -0,0 +1,103 @@
+#include "Core/Aqpch.h"
+#include "DeferredRenderer/Pipelines/TemporalPipeline.h"
+
+AQUA_NAMESPACE::MotionVectorPipeline::MotionVectorPipeline(vkLib::PShader shader)
+{
+	this->SetShader(shader);
+}
+
+void AQUA_NAMESPACE::MotionVectorPipeline::UpdateDescriptors()
+{
+	vkLib::UniformBufferWriteInfo uniformInfo{};
+	uniformInfo.Buffer = mInfo.GetNativeHandles().Handle;
+
+	this->UpdateDescriptor({ 0, 0, 0 }, uniformInfo);
+
+	vkLib::SampledImageWriteInfo samplerInfo{};
+	samplerInfo.ImageLayout = vk::ImageLayout::eGeneral;
+	samplerInfo.ImageView = mPositions.GetNativeHandle();
+	samplerInfo.Sampler = *mSampler;
+
+	this->UpdateDescriptor({ 0, 1, 0 }, samplerInfo);
+
+	samplerInfo.ImageView = mNormals.GetNativeHandle();
+
+	this->UpdateDescriptor({ 0, 2, 0 }, samplerInfo);
+
+	vkLib::StorageBufferWriteInfo storageInfo{};
+	storageInfo.Buffer = mModelMotions.GetNativeHandles().Handle;
+
+	this->UpdateDescriptor({ 0, 3, 0 }, storageInfo);
+
+	storageInfo.Buffer = mMotionVectors.GetNativeHandles().Handle;
+
+	this->UpdateDescriptor({ 0, 4, 0 }, storageInfo);
+}
+
+void AQUA_NAMESPACE::MotionVectorPipeline::operator()(vk::CommandBuffer cmd, const glm::uvec2& size) const
+{
+	glm::uvec3 workGroupSize = GetWorkGroupSize();
+
+	Begin(cmd);
+
+	Activate();
+
+	Dispatch({ (size.x + workGroupSize.x - 1) / workGroupSize.x,
+		(size.y + workGroupSize.y - 1) / workGroupSize.y, 1 });
+
+	End();
+}
+
+AQUA_NAMESPACE::TemporalResolvePipeline::TemporalResolvePipeline(vkLib::PShader shader)
+{
+	this->SetShader(shader);
+}
+
+void AQUA_NAMESPACE::TemporalResolvePipeline::UpdateDescriptors()
+{
+	vkLib::UniformBufferWriteInfo uniformInfo{};
+	uniformInfo.Buffer = mInfo.GetNativeHandles().Handle;
+
+	this->UpdateDescriptor({ 0, 0, 0 }, uniformInfo);
+
+	vkLib::SampledImageWriteInfo samplerInfo{};
+	samplerInfo.ImageLayout = vk::ImageLayout::eGeneral;
+	samplerInfo.ImageView = mSource.GetNativeHandle();
+	samplerInfo.Sampler = *mSampler;
+
+	this->UpdateDescriptor({ 0, 1, 0 }, samplerInfo);
+
+	vkLib::StorageBufferWriteInfo storageInfo{};
+	storageInfo.Buffer = mMotionVectors.GetNativeHandles().Handle;
+
+	this->UpdateDescriptor({ 0, 2, 0 }, storageInfo);
+
+	storageInfo.Buffer = mHistories[0].GetNativeHandles().Handle;
+
+	this->UpdateDescriptor({ 0, 3, 0 }, storageInfo);
+
+	storageInfo.Buffer = mHistories[1].GetNativeHandles().Handle;
+
+	this->UpdateDescriptor({ 0, 4, 0 }, storageInfo);
+
+	vkLib::StorageImageWriteInfo targetInfo{};
+	targetInfo.ImageLayout = vk::ImageLayout::eGeneral;
+	targetInfo.ImageView = mTarget.GetNativeHandle();
+
+	this->UpdateDescriptor({ 0, 5, 0 }, targetInfo);
+}
+
+void AQUA_NAMESPACE::TemporalResolvePipeline::operator()(vk::CommandBuffer cmd, const glm::uvec2& size, uint32_t parity) const
+{
+	glm::uvec3 workGroupSize = GetWorkGroupSize();
+
+	Begin(cmd);
+
+	Activate();
+	SetShaderConstant("eCompute.ShaderConstants.Index_0", parity);
+
+	Dispatch({ (size.x + workGroupSize.x - 1) / workGroupSize.x,
+		(size.y + workGroupSize.y - 1) / workGroupSize.y, 1 });
+
+	End();
+}
@@ -6,18 +6,22 @@ std::string AQUA_NAMESPACE::MAT_NAMESPACE::MaterialAssembler::sDeferGFXVertexSha
 #version 440 core
 layout(location = 0) out vec2 vTexCoords;
 
-vec2 positions[6] = vec2[](
-
-	vec2(-1.0, -1.0),
-	vec2(1.0, -1.0),
-	vec2(1.0, 1.0),
-	vec2(1.0, 1.0),
-	vec2(-1.0, 1.0),
-	vec2(-1.0, -1.0)
+// Filled by the renderer's tile classification, one instance per screen tile of the material
+layout(std430, set = 2, binding = 0) readonly buffer MaterialTiles
+{
+	uint sMaterialTiles[];
+};
 
-	);
+layout(std140, set = 2, binding = 1) uniform MaterialTileUniform
+{
+	uvec2 TileSize;
+	uvec2 TileCount;
+	uvec2 Resolution;
+	uint MaterialCount;
+	uint TileCapacity;
+} uTiles;
 
-vec2 texCoords[6] = vec2[](
+vec2 corners[6] = vec2[](
 
 	vec2(0.0, 0.0),
 	vec2(1.0, 0.0),
@@ -30,11 +34,17 @@ vec2 texCoords[6] = vec2[](
 
 void main()
 {
-	gl_Position.xy = positions[gl_VertexIndex];
+	uint Tile = sMaterialTiles[gl_InstanceIndex];
+	uvec2 TileCoord = uvec2(Tile % uTiles.TileCount.x, Tile / uTiles.TileCount.x);
+
+	// The edge tiles are clamped to the screen
+	vec2 Pixel = min((vec2(TileCoord) + corners[gl_VertexIndex]) * vec2(uTiles.TileSize), vec2(uTiles.Resolution));
+
+	vTexCoords = Pixel / vec2(uTiles.Resolution);
+
+	gl_Position.xy = 2.0 * vTexCoords - 1.0;
 	gl_Position.z = 1.0;
 	gl_Position.w = 1.0;
-
-	vTexCoords = texCoords[gl_VertexIndex];
 }
 )";
 
@@ -76,6 +86,22 @@ std::expected<AQUA_NAMESPACE::MAT_NAMESPACE::Material, vkLib::CompileError>
 	return execOp;
 }
 
+AQUA_NAMESPACE::MAT_NAMESPACE::Material AQUA_NAMESPACE::MAT_NAMESPACE::MaterialAssembler::CloneRayTracingMaterial(
+	const MAT_NAMESPACE::Material& material)
+{
+	_STL_ASSERT(material.GetOpType() == EXEC_NAMESPACE::OpType::eCompute, "Only ray tracing materials can be cloned!");
+
+	EXEC_NAMESPACE::Operation execOp{};
+
+	vkLib::ComputePipeline fakePipeline;
+	fakePipeline.SetShader(material.Cmp->GetShader());
+
+	execOp.Cmp = std::make_shared<vkLib::ComputePipeline>(mPipelineBuilder.BuildComputePipeline<vkLib::ComputePipeline>(fakePipeline));
+	execOp.States = EXEC_NAMESPACE::OpType::eCompute;
+
+	return execOp;
+}
+
 std::expected<AQUA_NAMESPACE::MAT_NAMESPACE::Material, vkLib::CompileError> 
 	AQUA_NAMESPACE::MAT_NAMESPACE::MaterialAssembler::ConstructDeferGFXMaterial(
 	const std::string& code, vkLib::GraphicsPipelineConfig config, const vkLib::PreprocessorDirectives& directives /*= {}*/)
@@ -1,5 +1,6 @@
 #include "Core/Aqpch.h"
 #include "Material/MaterialBuilder.h"
+#include "DeferredRenderer/Pipelines/PipelineConfig.h"
 
 std::unordered_map<std::string, uint32_t> AQUA_NAMESPACE::MaterialBuilder::sGLSLTypeToSize =
 {
@@ -31,6 +32,8 @@ AQUA_NAMESPACE::MaterialInstance AQUA_NAMESPACE::MaterialBuilder::BuildRTInstanc
 	directives["SHADING_TOLERANCE"] = std::to_string(createInfo.ShadingTolerance);
 	directives["EPSILON"] = std::to_string(std::numeric_limits<float>::epsilon());
 	directives["POWER_HEURISTICS_EXP"] = std::to_string(createInfo.PowerHeuristics);
+	directives["SMOOTH_SHADING"] = std::to_string(createInfo.SmoothShading ? 1 : 0);
+	directives["MOTION_BLUR"] = std::to_string(createInfo.MotionBlur ? 1 : 0);
 	directives["WORKGROUP_SIZE"] = std::to_string(createInfo.WorkGroupSize);
 	directives["SHADER_PARS_SET_IDX"] = std::to_string(mMaterialSetBinding.SetIndex);
 	directives["SHADER_PARS_BINDING_IDX"] = std::to_string(mMaterialSetBinding.Binding);
@@ -71,7 +74,7 @@ AQUA_NAMESPACE::MaterialInstance AQUA_NAMESPACE::MaterialBuilder::BuildDeferGFXI
 
 	vkLib::PreprocessorDirectives directives;
 	directives["SHADING_TOLERANCE"] = std::to_string(createInfo.ShadingTolerance);
-	directives["MAX_DEPTH_ARRAY"] = std::to_string(1);
+	directives["MAX_SHADOW_CASCADES"] = std::to_string(MAX_SHADOW_CASCADES);
 	directives["SHADER_PARS_SET_IDX"] = std::to_string(mMaterialSetBinding.SetIndex);
 	directives["SHADER_PARS_BINDING_IDX"] = std::to_string(mMaterialSetBinding.Binding);
 	directives["MATH_PI"] = std::to_string(glm::pi<float>());
@@ -93,6 +96,20 @@ AQUA_NAMESPACE::MaterialInstance AQUA_NAMESPACE::MaterialBuilder::BuildDeferGFXI
 	return instance;
 }
 
+AQUA_NAMESPACE::MaterialInstance AQUA_NAMESPACE::MaterialBuilder::CloneRTInstance(const MaterialInstance& instance)
+{
+	MaterialInstance clone{};
+	clone.mCoreMaterial = mMaterialAsembler.CloneRayTracingMaterial(instance.mCoreMaterial);
+
+	// The resource map is copied, the parameter buffer in it stays shared
+	clone.mInfo = std::make_shared<MaterialInstanceInfo>(*instance.mInfo);
+	clone.mShaderParBuffer = instance.mShaderParBuffer;
+	clone.mOffset = instance.mOffset;
+	clone.mInstanceID = instance.mInstanceID;
+
+	return clone;
+}
+
 void AQUA_NAMESPACE::MaterialBuilder::InitializeInstance(MaterialInstance& instance, MAT_NAMESPACE::Material material, MAT_NAMESPACE::ShaderParameterSet& set)
 {
 	instance.mCoreMaterial = material;
@@ -0,0 +1,116 @@
+#include "Core/Aqpch.h"
+#include "Utils/AutoExposure.h"
+
+AQUA_NAMESPACE::ExposurePipeline::ExposurePipeline(vkLib::PShader shader)
+{
+	this->SetShader(shader);
+}
+
+void AQUA_NAMESPACE::ExposurePipeline::UpdateDescriptors()
+{
+	vkLib::UniformBufferWriteInfo uniformInfo{};
+	uniformInfo.Buffer = mInfo.GetNativeHandles().Handle;
+
+	this->UpdateDescriptor({ 0, 0, 0 }, uniformInfo);
+
+	vkLib::SampledImageWriteInfo samplerInfo{};
+	samplerInfo.ImageLayout = vk::ImageLayout::eGeneral;
+	samplerInfo.ImageView = mSource.GetNativeHandle();
+	samplerInfo.Sampler = *mSampler;
+
+	this->UpdateDescriptor({ 0, 1, 0 }, samplerInfo);
+
+	vkLib::StorageBufferWriteInfo storageInfo{};
+	storageInfo.Buffer = mHistogram.GetNativeHandles().Handle;
+
+	this->UpdateDescriptor({ 0, 2, 0 }, storageInfo);
+
+	storageInfo.Buffer = mState.GetNativeHandles().Handle;
+
+	this->UpdateDescriptor({ 0, 3, 0 }, storageInfo);
+}
+
+void AQUA_NAMESPACE::ExposurePipeline::operator()(vk::CommandBuffer cmd, const glm::uvec2& size) const
+{
+	glm::uvec3 workGroupSize = GetWorkGroupSize();
+
+	_STL_ASSERT(workGroupSize.x * workGroupSize.y * workGroupSize.z == EXPOSURE_HISTOGRAM_SIZE,
+		"The exposure workgroup must hold one invocation per bin");
+
+	// the adapt pass reads every bin the histogram pass added to
+	vk::MemoryBarrier histogramBarrier{};
+	histogramBarrier.setSrcAccessMask(vk::AccessFlagBits::eShaderWrite);
+	histogramBarrier.setDstAccessMask(vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite);
+
+	Begin(cmd);
+
+	Activate();
+
+	SetShaderConstant("eCompute.ShaderConstants.Index_0", static_cast<uint32_t>(ExposurePass::eHistogram));
+
+	Dispatch({ (size.x + workGroupSize.x - 1) / workGroupSize.x,
+		(size.y + workGroupSize.y - 1) / workGroupSize.y, 1 });
+
+	cmd.pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eComputeShader,
+		vk::DependencyFlags(), histogramBarrier, nullptr, nullptr);
+
+	SetShaderConstant("eCompute.ShaderConstants.Index_0", static_cast<uint32_t>(ExposurePass::eAdapt));
+
+	Dispatch({ 1, 1, 1 });
+
+	End();
+}
+
+AQUA_NAMESPACE::ExposureResources AQUA_NAMESPACE::CreateExposureResources(vkLib::ResourcePool& pool)
+{
+	ExposureResources exposure{};
+
+	// the histogram is cleared by the adapt pass itself, the host only zeroes it on a reset
+	exposure.Info = pool.CreateBuffer<ExposureInfo>(vk::BufferUsageFlagBits::eUniformBuffer, vk::MemoryPropertyFlagBits::eHostCoherent);
+	exposure.Histogram = pool.CreateBuffer<uint32_t>(vk::BufferUsageFlagBits::eStorageBuffer, vk::MemoryPropertyFlagBits::eHostCoherent);
+	exposure.State = pool.CreateBuffer<ExposureState>(vk::BufferUsageFlagBits::eStorageBuffer, vk::MemoryPropertyFlagBits::eHostCoherent);
+
+	exposure.Info.Resize(1);
+	exposure.Histogram.Resize(EXPOSURE_HISTOGRAM_SIZE);
+	exposure.State.Resize(1);
+
+	return exposure;
+}
+
+void AQUA_NAMESPACE::ResetExposure(ExposureResources& exposure, const glm::uvec2& resolution, const ExposureSettings& settings)
+{
+	_STL_ASSERT(settings.MaxLogLuminance > settings.MinLogLuminance, "Invalid exposure luminance range");
+	_STL_ASSERT(settings.MinExposure > 0.0f && settings.MinExposure <= settings.MaxExposure, "Invalid exposure bounds");
+
+	ExposureInfo& layout = exposure.Layout;
+
+	layout.Resolution = resolution;
+	layout.MinLogLuminance = settings.MinLogLuminance;
+	layout.MaxLogLuminance = settings.MaxLogLuminance;
+	layout.Key = settings.Key;
+	layout.AdaptationRate = settings.AdaptationRate;
+	layout.DeltaTime = 0.0f;
+	layout.MinExposure = settings.MinExposure;
+	layout.MaxExposure = settings.MaxExposure;
+
+	std::vector<uint32_t> bins(EXPOSURE_HISTOGRAM_SIZE, 0);
+	ExposureState state{};
+
+	exposure.Info.SetBuf(&layout, &layout + 1);
+	exposure.Histogram.SetBuf(bins.begin(), bins.end());
+	exposure.State.SetBuf(&state, &state + 1);
+
+	exposure.LastMeasurement = std::chrono::steady_clock::now();
+}
+
+void AQUA_NAMESPACE::AdvanceExposure(ExposureResources& exposure)
+{
+	auto now = std::chrono::steady_clock::now();
+	std::chrono::duration<float> elapsed = now - exposure.LastMeasurement;
+
+	exposure.LastMeasurement = now;
+
+	// a long stall shouldn't look like the eye adapting all at once
+	exposure.Layout.DeltaTime = std::min(elapsed.count(), 0.25f);
+	exposure.Info.SetBuf(&exposure.Layout, &exposure.Layout + 1);
+}
@@ -0,0 +1,364 @@
+#include "Core/Aqpch.h"
+#include "Wavefront/AccelerationStructureBuilder.h"
+
+AQUA_BEGIN
+PH_BEGIN
+
+inline vk::DeviceSize AlignUp(vk::DeviceSize value, vk::DeviceSize alignment)
+{
+	return (value + alignment - 1) / alignment * alignment;
+}
+
+PH_END
+AQUA_END
+
+void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::FaceIndexPackPipeline::UpdateDescriptors()
+{
+	vkLib::StorageBufferWriteInfo storageInfo{};
+
+	storageInfo.Buffer = mFaces.GetNativeHandles().Handle;
+	this->UpdateDescriptor({ 0, 0, 0 }, storageInfo);
+
+	storageInfo.Buffer = mIndices.GetNativeHandles().Handle;
+	this->UpdateDescriptor({ 0, 1, 0 }, storageInfo);
+}
+
+AQUA_NAMESPACE::PH_FLUX_NAMESPACE::AccelerationStructureBuilder::AccelerationStructureBuilder(
+	vkLib::Context context, vkLib::ResourcePool pool, const FaceIndexPackPipeline& packer, uint32_t workGroupSize)
+	: mDevice(context.GetHandle()), mResourcePool(pool), mPacker(packer), mWorkGroupSize(workGroupSize)
+{
+	const vkLib::PhysicalDevice& physicalDevice = context.GetDeviceInfo().PhysicalDevice;
+
+	// None of the acceleration structure entry points are exported by the loader
+	mDispatcher = vk::detail::DispatchLoaderDynamic(*physicalDevice.ParentInstance, vkGetInstanceProcAddr,
+		*mDevice, vkGetDeviceProcAddr);
+
+	auto properties = physicalDevice.Handle.getProperties2<vk::PhysicalDeviceProperties2,
+		vk::PhysicalDeviceAccelerationStructurePropertiesKHR>(mDispatcher);
+
+	mScratchAlignment = std::max<vk::DeviceSize>(1, properties.get<
+		vk::PhysicalDeviceAccelerationStructurePropertiesKHR>().minAccelerationStructureScratchOffsetAlignment);
+
+	vk::BufferUsageFlags addressable = vk::BufferUsageFlagBits::eShaderDeviceAddress;
+	vk::MemoryPropertyFlags memProps = vk::MemoryPropertyFlagBits::eDeviceLocal;
+
+	mIndices = pool.CreateBuffer<uint32_t>(vk::BufferUsageFlagBits::eStorageBuffer |
+		vk::BufferUsageFlagBits::eAccelerationStructureBuildInputReadOnlyKHR | addressable, memProps);
+	mScratch = pool.CreateBuffer<uint8_t>(vk::BufferUsageFlagBits::eStorageBuffer | addressable, memProps);
+	mTopLevel.Storage = pool.CreateBuffer<uint8_t>(
+		vk::BufferUsageFlagBits::eAccelerationStructureStorageKHR | addressable, memProps);
+
+	// Rewritten from the host on every build
+	mInstances = pool.CreateBuffer<vk::AccelerationStructureInstanceKHR>(
+		vk::BufferUsageFlagBits::eAccelerationStructureBuildInputReadOnlyKHR | addressable,
+		vk::MemoryPropertyFlagBits::eHostCoherent);
+}
+
+AQUA_NAMESPACE::PH_FLUX_NAMESPACE::AccelerationStructureBuilder::~AccelerationStructureBuilder()
+{
+	for (auto& bottomLevel : mBottomLevels)
+		DestroyStructure(bottomLevel);
+
+	DestroyStructure(mTopLevel);
+}
+
+bool AQUA_NAMESPACE::PH_FLUX_NAMESPACE::AccelerationStructureBuilder::IsSupported(const vkLib::Context& context)
+{
+	const std::vector<const char*>& extensions = context.GetDeviceInfo().Extensions;
+
+	auto Enabled = [&extensions](std::string_view name)
+	{
+		return std::find_if(extensions.begin(), extensions.end(),
+			[name](const char* extension) { return name == extension; }) != extensions.end();
+	};
+
+	return Enabled(VK_KHR_ACCELERATION_STRUCTURE_EXTENSION_NAME) && Enabled(VK_KHR_RAY_QUERY_EXTENSION_NAME);
+}
+
+vk::BufferUsageFlags AQUA_NAMESPACE::PH_FLUX_NAMESPACE::AccelerationStructureBuilder::GetVertexBufferUsage()
+{
+	return vk::BufferUsageFlagBits::eShaderDeviceAddress |
+		vk::BufferUsageFlagBits::eAccelerationStructureBuildInputReadOnlyKHR;
+}
+
+uint32_t AQUA_NAMESPACE::PH_FLUX_NAMESPACE::AccelerationStructureBuilder::AddGeometry(uint32_t faceOffset, uint32_t faceCount)
+{
+	AccelerationStructureGeometry geometry{};
+	geometry.FaceOffset = faceOffset;
+	geometry.FaceCount = faceCount;
+
+	mGeometries.push_back(geometry);
+
+	// The structures of the previous sessions are recycled
+	if (mBottomLevels.size() < mGeometries.size())
+	{
+		AccelerationStructure& bottomLevel = mBottomLevels.emplace_back();
+
+		bottomLevel.Storage = mResourcePool.CreateBuffer<uint8_t>(vk::BufferUsageFlagBits::eAccelerationStructureStorageKHR |
+			vk::BufferUsageFlagBits::eShaderDeviceAddress, vk::MemoryPropertyFlagBits::eDeviceLocal);
+	}
+
+	return static_cast<uint32_t>(mGeometries.size() - 1);
+}
+
+void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::AccelerationStructureBuilder::Record(
+	vk::CommandBuffer commandBuffer, const GeometryBuffers& geometry)
+{
+	RecordBuild(commandBuffer, geometry, 0, static_cast<uint32_t>(mGeometries.size()));
+}
+
+void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::AccelerationStructureBuilder::RecordUpdate(
+	vk::CommandBuffer commandBuffer, const GeometryBuffers& geometry, uint32_t geometryIdx)
+{
+	_STL_ASSERT(geometryIdx < mGeometries.size(), "Acceleration structure geometry index out of range!");
+
+	RecordBuild(commandBuffer, geometry, geometryIdx, 1);
+}
+
+void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::AccelerationStructureBuilder::RecordBuild(vk::CommandBuffer commandBuffer,
+	const GeometryBuffers& geometry, uint32_t firstGeometry, uint32_t geometryCount)
+{
+	_STL_ASSERT(geometry.Faces.GetSize() < (1u << 24),
+		"Instance custom indices can't address more than 2^24 faces!");
+
+	// Every buffer is sized before anything is recorded, a reallocation would free memory the commands refer to
+	RecordIndexPacking(commandBuffer, geometry.Faces);
+
+	vk::DeviceAddress vertexAddress = GetAddress(geometry.Vertices.GetNativeHandles().Handle);
+	vk::DeviceAddress indexAddress = GetAddress(mIndices.GetNativeHandles().Handle);
+	uint32_t vertexCount = static_cast<uint32_t>(geometry.Vertices.GetSize());
+
+	// Build infos point into these, so they can't grow while being filled
+	std::vector<vk::AccelerationStructureGeometryKHR> triangles;
+	std::vector<vk::AccelerationStructureBuildGeometryInfoKHR> buildInfos;
+	std::vector<vk::AccelerationStructureBuildRangeInfoKHR> ranges;
+	std::vector<vk::DeviceSize> scratchOffsets;
+
+	triangles.reserve(geometryCount);
+	buildInfos.reserve(geometryCount);
+	ranges.reserve(geometryCount);
+	scratchOffsets.reserve(geometryCount);
+
+	vk::DeviceSize scratchSize = 0;
+
+	for (uint32_t i = firstGeometry; i < firstGeometry + geometryCount; i++)
+	{
+		const AccelerationStructureGeometry& range = mGeometries[i];
+
+		if (range.FaceCount == 0)
+			continue;
+
+		// Positions are stored as vec4, the w component is skipped by the stride
+		vk::AccelerationStructureGeometryTrianglesDataKHR trianglesData{};
+		trianglesData.setVertexFormat(vk::Format::eR32G32B32Sfloat);
+		trianglesData.setVertexData(vertexAddress);
+		trianglesData.setVertexStride(sizeof(glm::vec4));
+		trianglesData.setMaxVertex(vertexCount - 1);
+		trianglesData.setIndexType(vk::IndexType::eUint32);
+		trianglesData.setIndexData(indexAddress);
+
+		vk::AccelerationStructureGeometryKHR& triangleGeometry = triangles.emplace_back();
+		triangleGeometry.setGeometryType(vk::GeometryTypeKHR::eTriangles);
+		triangleGeometry.geometry.setTriangles(trianglesData);
+		triangleGeometry.setFlags(vk::GeometryFlagBitsKHR::eOpaque);
+
+		vk::AccelerationStructureBuildGeometryInfoKHR& buildInfo = buildInfos.emplace_back();
+		buildInfo.setType(vk::AccelerationStructureTypeKHR::eBottomLevel);
+		buildInfo.setFlags(vk::BuildAccelerationStructureFlagBitsKHR::ePreferFastTrace);
+		buildInfo.setMode(vk::BuildAccelerationStructureModeKHR::eBuild);
+		buildInfo.setGeometries(triangleGeometry);
+
+		vk::AccelerationStructureBuildSizesInfoKHR sizes = mDevice->getAccelerationStructureBuildSizesKHR(
+			vk::AccelerationStructureBuildTypeKHR::eDevice, buildInfo, range.FaceCount, mDispatcher);
+
+		ReserveStructure(mBottomLevels[i], vk::AccelerationStructureTypeKHR::eBottomLevel, sizes.accelerationStructureSize);
+		buildInfo.setDstAccelerationStructure(mBottomLevels[i].Handle);
+
+		// The builds run concurrently, each one needs its own scratch range
+		scratchOffsets.push_back(scratchSize);
+		scratchSize += AlignUp(sizes.buildScratchSize, mScratchAlignment);
+
+		// The index buffer covers all the session faces, the range picks this geometry's share
+		vk::AccelerationStructureBuildRangeInfoKHR& rangeInfo = ranges.emplace_back();
+		rangeInfo.setPrimitiveCount(range.FaceCount);
+		rangeInfo.setPrimitiveOffset(range.FaceOffset * 3 * sizeof(uint32_t));
+	}
+
+	// One instance per non empty geometry; the custom index turns primitive indices into face indices
+	std::vector<vk::AccelerationStructureInstanceKHR> instances;
+	instances.reserve(mGeometries.size());
+
+	vk::TransformMatrixKHR identity(std::array<std::array<float, 4>, 3>{ {
+		{ 1.0f, 0.0f, 0.0f, 0.0f },
+		{ 0.0f, 1.0f, 0.0f, 0.0f },
+		{ 0.0f, 0.0f, 1.0f, 0.0f } } });
+
+	for (size_t i = 0; i < mGeometries.size(); i++)
+	{
+		if (mGeometries[i].FaceCount == 0)
+			continue;
+
+		vk::AccelerationStructureInstanceKHR& instance = instances.emplace_back();
+		instance.setTransform(identity);
+		instance.setInstanceCustomIndex(mGeometries[i].FaceOffset);
+		instance.setMask(0xff);
+		instance.setInstanceShaderBindingTableRecordOffset(0);
+		instance.setFlags(static_cast<VkGeometryInstanceFlagsKHR>(
+			vk::GeometryInstanceFlagBitsKHR::eTriangleFacingCullDisable));
+		instance.setAccelerationStructureReference(mBottomLevels[i].Address);
+	}
+
+	mInstances.Clear();
+	mInstances << instances;
+
+	vk::AccelerationStructureGeometryInstancesDataKHR instancesData{};
+	instancesData.setArrayOfPointers(false);
+	instancesData.setData(GetAddress(mInstances.GetNativeHandles().Handle));
+
+	vk::AccelerationStructureGeometryKHR instanceGeometry{};
+	instanceGeometry.setGeometryType(vk::GeometryTypeKHR::eInstances);
+	instanceGeometry.geometry.setInstances(instancesData);
+
+	vk::AccelerationStructureBuildGeometryInfoKHR topLevelInfo{};
+	topLevelInfo.setType(vk::AccelerationStructureTypeKHR::eTopLevel);
+	topLevelInfo.setFlags(vk::BuildAccelerationStructureFlagBitsKHR::ePreferFastTrace);
+	topLevelInfo.setMode(vk::BuildAccelerationStructureModeKHR::eBuild);
+	topLevelInfo.setGeometries(instanceGeometry);
+
+	uint32_t instanceCount = static_cast<uint32_t>(instances.size());
+
+	vk::AccelerationStructureBuildSizesInfoKHR topLevelSizes = mDevice->getAccelerationStructureBuildSizesKHR(
+		vk::AccelerationStructureBuildTypeKHR::eDevice, topLevelInfo, instanceCount, mDispatcher);
+
+	ReserveStructure(mTopLevel, vk::AccelerationStructureTypeKHR::eTopLevel, topLevelSizes.accelerationStructureSize);
+	topLevelInfo.setDstAccelerationStructure(mTopLevel.Handle);
+
+	// The top level build starts after the bottom level ones finished, so it reuses their scratch
+	vk::DeviceAddress scratchAddress = ReserveScratch(std::max(scratchSize, topLevelSizes.buildScratchSize));
+
+	std::vector<const vk::AccelerationStructureBuildRangeInfoKHR*> rangePtrs;
+
+	for (size_t i = 0; i < buildInfos.size(); i++)
+	{
+		buildInfos[i].scratchData.deviceAddress = scratchAddress + scratchOffsets[i];
+		rangePtrs.push_back(&ranges[i]);
+	}
+
+	if (!buildInfos.empty())
+	{
+		commandBuffer.buildAccelerationStructuresKHR(buildInfos, rangePtrs, mDispatcher);
+
+		InsertBarrier(commandBuffer,
+			vk::PipelineStageFlagBits::eAccelerationStructureBuildKHR, vk::AccessFlagBits::eAccelerationStructureWriteKHR,
+			vk::PipelineStageFlagBits::eAccelerationStructureBuildKHR,
+			vk::AccessFlagBits::eAccelerationStructureReadKHR | vk::AccessFlagBits::eAccelerationStructureWriteKHR);
+	}
+
+	RecordTopLevel(commandBuffer, topLevelInfo, instanceCount, scratchAddress);
+
+	InsertBarrier(commandBuffer,
+		vk::PipelineStageFlagBits::eAccelerationStructureBuildKHR, vk::AccessFlagBits::eAccelerationStructureWriteKHR,
+		vk::PipelineStageFlagBits::eComputeShader, vk::AccessFlagBits::eAccelerationStructureReadKHR);
+}
+
+void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::AccelerationStructureBuilder::RecordIndexPacking(
+	vk::CommandBuffer commandBuffer, const FaceBuffer& faces)
+{
+	uint32_t faceCount = static_cast<uint32_t>(faces.GetSize());
+
+	mIndices.Resize(3 * std::max(faceCount, 1u));
+
+	mPacker.mFaces = faces;
+	mPacker.mIndices = mIndices;
+	mPacker.UpdateDescriptors();
+
+	if (faceCount == 0)
+		return;
+
+	/*   Push constant layout...
+	*
+		layout(push_constant) uniform PackData
+		{
+			uint pFaceCount;
+		};
+	*/
+
+	mPacker.Begin(commandBuffer);
+	mPacker.Activate();
+
+	mPacker.SetShaderConstant("eCompute.PackData.Index_0", faceCount);
+	mPacker.Dispatch({ (faceCount + mWorkGroupSize - 1) / mWorkGroupSize, 1, 1 });
+
+	mPacker.End();
+
+	InsertBarrier(commandBuffer,
+		vk::PipelineStageFlagBits::eComputeShader, vk::AccessFlagBits::eShaderWrite,
+		vk::PipelineStageFlagBits::eAccelerationStructureBuildKHR, vk::AccessFlagBits::eShaderRead);
+}
+
+void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::AccelerationStructureBuilder::RecordTopLevel(vk::CommandBuffer commandBuffer,
+	vk::AccelerationStructureBuildGeometryInfoKHR buildInfo, uint32_t instanceCount, vk::DeviceAddress scratchAddress)
+{
+	buildInfo.scratchData.deviceAddress = scratchAddress;
+
+	vk::AccelerationStructureBuildRangeInfoKHR rangeInfo{};
+	rangeInfo.setPrimitiveCount(instanceCount);
+
+	const vk::AccelerationStructureBuildRangeInfoKHR* rangePtr = &rangeInfo;
+
+	commandBuffer.buildAccelerationStructuresKHR(buildInfo, rangePtr, mDispatcher);
+}
+
+void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::AccelerationStructureBuilder::ReserveStructure(
+	AccelerationStructure& structure, vk::AccelerationStructureTypeKHR type, vk::DeviceSize size)
+{
+	if (structure.Handle && structure.Storage.GetSize() >= size)
+		return;
+
+	DestroyStructure(structure);
+
+	structure.Storage.Resize(size);
+
+	vk::AccelerationStructureCreateInfoKHR createInfo{};
+	createInfo.setBuffer(structure.Storage.GetNativeHandles().Handle);
+	createInfo.setOffset(0);
+	createInfo.setSize(size);
+	createInfo.setType(type);
+
+	structure.Handle = mDevice->createAccelerationStructureKHR(createInfo, nullptr, mDispatcher);
+	structure.Address = mDevice->getAccelerationStructureAddressKHR({ structure.Handle }, mDispatcher);
+}
+
+void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::AccelerationStructureBuilder::DestroyStructure(AccelerationStructure& structure)
+{
+	if (!structure.Handle)
+		return;
+
+	mDevice->destroyAccelerationStructureKHR(structure.Handle, nullptr, mDispatcher);
+
+	structure.Handle = nullptr;
+	structure.Address = 0;
+}
+
+vk::DeviceAddress AQUA_NAMESPACE::PH_FLUX_NAMESPACE::AccelerationStructureBuilder::ReserveScratch(vk::DeviceSize size)
+{
+	// Buffer addresses carry no alignment guarantee beyond the memory requirements, so some slack is added
+	mScratch.Resize(size + mScratchAlignment);
+
+	return AlignUp(GetAddress(mScratch.GetNativeHandles().Handle), mScratchAlignment);
+}
+
+vk::DeviceAddress AQUA_NAMESPACE::PH_FLUX_NAMESPACE::AccelerationStructureBuilder::GetAddress(vk::Buffer buffer) const
+{
+	return mDevice->getBufferAddress(vk::BufferDeviceAddressInfo(buffer), mDispatcher);
+}
+
+void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::AccelerationStructureBuilder::InsertBarrier(vk::CommandBuffer commandBuffer,
+	vk::PipelineStageFlags srcStage, vk::AccessFlags srcAccess, vk::PipelineStageFlags dstStage, vk::AccessFlags dstAccess)
+{
+	vk::MemoryBarrier barrier{};
+	barrier.setSrcAccessMask(srcAccess);
+	barrier.setDstAccessMask(dstAccess);
+
+	commandBuffer.pipelineBarrier(srcStage, dstStage, vk::DependencyFlags(), barrier, nullptr, nullptr);
+}
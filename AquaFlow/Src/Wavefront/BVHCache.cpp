@@ -0,0 +1,265 @@
+#include "Core/Aqpch.h"
+#include "Wavefront/BVHCache.h"
+
+#include <cstring>
+#include <iomanip>
+
+#ifdef _WIN32
+	#ifndef NOMINMAX
+		#define NOMINMAX
+	#endif
+	#include <Windows.h>
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+AQUA_BEGIN
+PH_BEGIN
+
+// Read only view of a whole file, unmapped when it goes out of scope
+class MappedFile
+{
+public:
+	explicit MappedFile(const std::filesystem::path& filepath)
+	{
+	#ifdef _WIN32
+		mFile = CreateFileW(filepath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+			OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+
+		if (mFile == INVALID_HANDLE_VALUE)
+			return;
+
+		LARGE_INTEGER size{};
+
+		if (!GetFileSizeEx(mFile, &size) || size.QuadPart == 0)
+			return;
+
+		mMapping = CreateFileMappingW(mFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+		if (!mMapping)
+			return;
+
+		mData = static_cast<const std::byte*>(MapViewOfFile(mMapping, FILE_MAP_READ, 0, 0, 0));
+		mSize = mData ? static_cast<size_t>(size.QuadPart) : 0;
+	#else
+		mFile = open(filepath.c_str(), O_RDONLY);
+
+		if (mFile < 0)
+			return;
+
+		struct stat info{};
+
+		if (fstat(mFile, &info) != 0 || info.st_size == 0)
+			return;
+
+		void* data = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, mFile, 0);
+
+		if (data == MAP_FAILED)
+			return;
+
+		mData = static_cast<const std::byte*>(data);
+		mSize = static_cast<size_t>(info.st_size);
+	#endif
+	}
+
+	~MappedFile()
+	{
+	#ifdef _WIN32
+		if (mData)
+			UnmapViewOfFile(mData);
+		if (mMapping)
+			CloseHandle(mMapping);
+		if (mFile != INVALID_HANDLE_VALUE)
+			CloseHandle(mFile);
+	#else
+		if (mData)
+			munmap(const_cast<std::byte*>(mData), mSize);
+		if (mFile >= 0)
+			close(mFile);
+	#endif
+	}
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	const std::byte* GetData() const { return mData; }
+	size_t GetSize() const { return mSize; }
+
+private:
+	const std::byte* mData = nullptr;
+	size_t mSize = 0;
+
+#ifdef _WIN32
+	HANDLE mFile = INVALID_HANDLE_VALUE;
+	HANDLE mMapping = nullptr;
+#else
+	int mFile = -1;
+#endif
+};
+
+// FNV-1a, good enough to tell meshes apart
+class ContentHasher
+{
+public:
+	template <typename T>
+	void Add(const T& value)
+	{
+		const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+
+		for (size_t i = 0; i < sizeof(T); i++)
+		{
+			mHash ^= bytes[i];
+			mHash *= 1099511628211ull;
+		}
+	}
+
+	uint64_t GetHash() const { return mHash; }
+
+private:
+	uint64_t mHash = 14695981039346656037ull;
+};
+
+PH_END
+AQUA_END
+
+AQUA_NAMESPACE::PH_FLUX_NAMESPACE::BVHCache::BVHCache(const std::filesystem::path& directory)
+{
+	SetDirectory(directory);
+}
+
+void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::BVHCache::SetDirectory(const std::filesystem::path& directory)
+{
+	mDirectory = directory;
+
+	std::error_code error;
+	std::filesystem::create_directories(mDirectory, error);
+}
+
+uint64_t AQUA_NAMESPACE::PH_FLUX_NAMESPACE::BVHCache::HashKey(
+	const MeshData& meshData, const BVHBuildSettings& settings)
+{
+	ContentHasher hasher;
+
+	hasher.Add(static_cast<uint32_t>(BVH_CACHE_VERSION));
+	hasher.Add(settings.Depth);
+	hasher.Add(settings.SpatialSplitBudget);
+
+	hasher.Add(static_cast<uint64_t>(meshData.aPositions.size()));
+	hasher.Add(static_cast<uint64_t>(meshData.aFaces.size()));
+
+	for (const auto& position : meshData.aPositions)
+		hasher.Add(position);
+
+	// The padding of the faces is never written, so only the meaningful fields go in
+	for (const auto& face : meshData.aFaces)
+	{
+		hasher.Add(face.Indices);
+		hasher.Add(face.MaterialRef);
+		hasher.Add(face.FaceID);
+	}
+
+	return hasher.GetHash();
+}
+
+bool AQUA_NAMESPACE::PH_FLUX_NAMESPACE::BVHCache::Load(uint64_t key, const MeshData& meshData, BVH& bvh) const
+{
+	if (mDirectory.empty())
+		return false;
+
+	MappedFile file(GetFilepath(key));
+
+	if (file.GetSize() < sizeof(FileHeader))
+		return false;
+
+	FileHeader header{};
+	std::memcpy(&header, file.GetData(), sizeof(FileHeader));
+
+	const FileHeader expected{};
+
+	if (std::memcmp(header.Magic, expected.Magic, sizeof(header.Magic)) != 0 ||
+		header.Version != expected.Version || header.Key != key ||
+		header.FaceStride != expected.FaceStride || header.NodeStride != expected.NodeStride ||
+		header.WideNodeStride != expected.WideNodeStride ||
+		header.VertexCount != static_cast<uint32_t>(meshData.aPositions.size()))
+		return false;
+
+	size_t facesSize = header.FaceCount * sizeof(Face);
+	size_t nodesSize = header.NodeCount * sizeof(Node);
+	size_t wideNodesSize = header.WideNodeCount * sizeof(WideNode);
+
+	if (file.GetSize() != sizeof(FileHeader) + facesSize + nodesSize + wideNodesSize)
+		return false;
+
+	const std::byte* cursor = file.GetData() + sizeof(FileHeader);
+
+	// The mapping isn't guaranteed to be aligned for the structures, so they're copied byte wise
+	bvh.Faces.resize(header.FaceCount);
+	std::memcpy(bvh.Faces.data(), cursor, facesSize);
+	cursor += facesSize;
+
+	bvh.Nodes.resize(header.NodeCount);
+	std::memcpy(bvh.Nodes.data(), cursor, nodesSize);
+	cursor += nodesSize;
+
+	bvh.WideNodes.resize(header.WideNodeCount);
+	std::memcpy(bvh.WideNodes.data(), cursor, wideNodesSize);
+
+	bvh.Vertices = meshData.aPositions;
+
+	return true;
+}
+
+bool AQUA_NAMESPACE::PH_FLUX_NAMESPACE::BVHCache::Store(uint64_t key, const BVH& bvh) const
+{
+	if (mDirectory.empty())
+		return false;
+
+	FileHeader header{};
+	header.Key = key;
+	header.VertexCount = static_cast<uint32_t>(bvh.Vertices.size());
+	header.FaceCount = bvh.Faces.size();
+	header.NodeCount = bvh.Nodes.size();
+	header.WideNodeCount = bvh.WideNodes.size();
+
+	std::filesystem::path filepath = GetFilepath(key);
+	std::filesystem::path tempPath = filepath;
+	tempPath += ".tmp";
+
+	{
+		std::ofstream stream(tempPath, std::ios::binary | std::ios::trunc);
+
+		if (!stream)
+			return false;
+
+		stream.write(reinterpret_cast<const char*>(&header), sizeof(FileHeader));
+		stream.write(reinterpret_cast<const char*>(bvh.Faces.data()), bvh.Faces.size() * sizeof(Face));
+		stream.write(reinterpret_cast<const char*>(bvh.Nodes.data()), bvh.Nodes.size() * sizeof(Node));
+		stream.write(reinterpret_cast<const char*>(bvh.WideNodes.data()), bvh.WideNodes.size() * sizeof(WideNode));
+
+		if (!stream)
+			return false;
+	}
+
+	// Renaming at the end keeps a crashed or concurrent writer from leaving a half written file behind
+	std::error_code error;
+	std::filesystem::rename(tempPath, filepath, error);
+
+	if (error)
+	{
+		std::filesystem::remove(tempPath, error);
+		return false;
+	}
+
+	return true;
+}
+
+std::filesystem::path AQUA_NAMESPACE::PH_FLUX_NAMESPACE::BVHCache::GetFilepath(uint64_t key) const
+{
+	std::stringstream name;
+	name << std::hex << std::setw(16) << std::setfill('0') << key << ".bvh";
+
+	return mDirectory / name.str();
+}
@@ -39,6 +39,28 @@ uint32_t CountTriangles(const BVH& bvh, const Node& node, float lambda, float sp
 	return count;
 }
 
+// SBVH helpers...
+struct SplitBin
+{
+	glm::vec3 Min = glm::vec3(FLT_MAX);
+	glm::vec3 Max = glm::vec3(-FLT_MAX);
+
+	uint32_t Enter = 0;
+	uint32_t Exit = 0;
+
+	void Grow(const glm::vec3& min, const glm::vec3& max)
+	{
+		Min = glm::min(Min, min);
+		Max = glm::max(Max, max);
+	}
+};
+
+float BoundsArea(const glm::vec3& min, const glm::vec3& max)
+{
+	glm::vec3 extent = glm::max(max - min, glm::vec3(0.0f));
+	return 2.0f * (extent.x * extent.y + extent.y * extent.z + extent.z * extent.x);
+}
+
 float SpatialSplit(const BVH& bvh, const Node& node, int index)
 {
 	return (node.MaxBound[index] - node.MinBound[index]) / 2.0f;
@@ -84,6 +106,73 @@ void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::BVHFactory::Cleanup()
 	mCurrent.Faces.clear();
 }
 
+void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::BVHFactory::Refit(BVH& bvh) const
+{
+	for (size_t i = bvh.Nodes.size(); i-- > 0;)
+	{
+		Node& node = bvh.Nodes[i];
+
+		if (node.FirstChildIndex == 0 && node.SecondChildIndex == 0)
+		{
+			glm::vec3 minBound = glm::vec3(FLT_MAX);
+			glm::vec3 maxBound = glm::vec3(-FLT_MAX);
+
+			for (uint32_t faceIdx = node.BeginIndex; faceIdx < node.EndIndex; faceIdx++)
+			{
+				for (int j = 0; j < 3; j++)
+				{
+					const glm::vec3& vertex = bvh.Vertices[bvh.Faces[faceIdx].Indices[j]];
+
+					minBound = glm::min(minBound, vertex);
+					maxBound = glm::max(maxBound, vertex);
+				}
+			}
+
+			node.MinBound = minBound - glm::vec3(mTolerence);
+			node.MaxBound = maxBound + glm::vec3(mTolerence);
+
+			continue;
+		}
+
+		// Children sit at higher indices, so they're already refitted
+		const Node& left = bvh.Nodes[node.FirstChildIndex];
+		const Node& right = bvh.Nodes[node.SecondChildIndex];
+
+		node.MinBound = glm::min(left.MinBound, right.MinBound);
+		node.MaxBound = glm::max(left.MaxBound, right.MaxBound);
+	}
+}
+
+float AQUA_NAMESPACE::PH_FLUX_NAMESPACE::BVHFactory::SAHCost(const BVH& bvh)
+{
+	if (bvh.Nodes.empty())
+		return 0.0f;
+
+	auto SurfaceArea = [](const Node& node)
+	{
+		glm::vec3 extent = glm::max(node.MaxBound - node.MinBound, glm::vec3(0.0f));
+		return 2.0f * (extent.x * extent.y + extent.y * extent.z + extent.z * extent.x);
+	};
+
+	float rootArea = SurfaceArea(bvh.Nodes[0]);
+
+	if (rootArea <= 0.0f)
+		return 0.0f;
+
+	// Unit costs for both the node traversal and the triangle test
+	float cost = 0.0f;
+
+	for (const Node& node : bvh.Nodes)
+	{
+		bool isLeaf = node.FirstChildIndex == 0 && node.SecondChildIndex == 0;
+		float faceCount = isLeaf ? static_cast<float>(node.EndIndex - node.BeginIndex) : 1.0f;
+
+		cost += faceCount * SurfaceArea(node) / rootArea;
+	}
+
+	return cost;
+}
+
 void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::BVHFactory::Clear()
 {
 	mCurrent.Nodes.clear();
@@ -268,3 +357,411 @@ std::pair<AQUA_NAMESPACE::PH_FLUX_NAMESPACE::Node, AQUA_NAMESPACE::PH_FLUX_NAMES
 
 	return { leftChild, rightChild };
 }
+
+void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::BVHFactory::BuildSpatialSplits()
+{
+	std::vector<Reference> refs(mFaces.size());
+
+	glm::vec3 rootMin = glm::vec3(FLT_MAX);
+	glm::vec3 rootMax = glm::vec3(-FLT_MAX);
+
+	for (uint32_t i = 0; i < static_cast<uint32_t>(mFaces.size()); i++)
+	{
+		Reference& ref = refs[i];
+		ref.FaceIdx = i;
+		ref.Min = glm::vec3(FLT_MAX);
+		ref.Max = glm::vec3(-FLT_MAX);
+
+		for (int j = 0; j < 3; j++)
+		{
+			ref.Min = glm::min(ref.Min, mVertices[mFaces[i].Indices[j]]);
+			ref.Max = glm::max(ref.Max, mVertices[mFaces[i].Indices[j]]);
+		}
+
+		rootMin = glm::min(rootMin, ref.Min);
+		rootMax = glm::max(rootMax, ref.Max);
+	}
+
+	mDuplicateBudget = static_cast<size_t>(mSpatialSplitBudget * static_cast<float>(mFaces.size()));
+
+	// Leaves copy their faces out in traversal order, duplicates included
+	std::vector<Face> faces;
+	faces.reserve(mFaces.size() + mDuplicateBudget);
+
+	mCurrent.Nodes.emplace_back();
+	SplitReferences(0, refs, faces, mDepth, BoundsArea(rootMin, rootMax));
+
+	mFaces = std::move(faces);
+}
+
+void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::BVHFactory::SplitReferences(
+	uint32_t nodeIdx, std::vector<Reference>& refs, std::vector<Face>& faces, int depth, float rootArea)
+{
+	// Small enough to test every triangle in one go
+	constexpr size_t sMaxLeafSize = 4;
+
+	Node node{};
+
+	node.MinBound = glm::vec3(FLT_MAX);
+	node.MaxBound = glm::vec3(-FLT_MAX);
+
+	for (const auto& ref : refs)
+	{
+		node.MinBound = glm::min(node.MinBound, ref.Min);
+		node.MaxBound = glm::max(node.MaxBound, ref.Max);
+	}
+
+	auto MakeLeaf = [this, &node, &refs, &faces, nodeIdx]()
+	{
+		node.BeginIndex = static_cast<uint32_t>(faces.size());
+
+		for (const auto& ref : refs)
+			faces.push_back(mFaces[ref.FaceIdx]);
+
+		node.EndIndex = static_cast<uint32_t>(faces.size());
+		node.MinBound -= glm::vec3(mTolerence);
+		node.MaxBound += glm::vec3(mTolerence);
+
+		mCurrent.Nodes[nodeIdx] = node;
+	};
+
+	if (refs.size() < 2 || depth == 0)
+	{
+		MakeLeaf();
+		return;
+	}
+
+	SplitCandidate best = FindObjectSplit(refs, node);
+
+	// Only bother with reference splitting where the object split leaves the children overlapping
+	if (mDuplicateBudget > 0 && best.Overlap / rootArea > mSpatialSplitAlpha)
+	{
+		SplitCandidate spatial = FindSpatialSplit(refs, node);
+
+		if (spatial.Cost < best.Cost)
+			best = spatial;
+	}
+
+	float leafCost = static_cast<float>(refs.size());
+
+	if (best.Axis < 0 || (best.Cost >= leafCost && refs.size() <= sMaxLeafSize))
+	{
+		MakeLeaf();
+		return;
+	}
+
+	std::vector<Reference> left, right;
+	left.reserve(refs.size());
+	right.reserve(refs.size());
+
+	if (best.Spatial)
+	{
+		for (const auto& ref : refs)
+		{
+			if (ref.Max[best.Axis] <= best.Position)
+			{
+				left.push_back(ref);
+				continue;
+			}
+
+			if (ref.Min[best.Axis] >= best.Position)
+			{
+				right.push_back(ref);
+				continue;
+			}
+
+			Reference leftRef{}, rightRef{};
+
+			bool leftValid = ClipReference(ref, best.Axis, ref.Min[best.Axis], best.Position, leftRef);
+			bool rightValid = ClipReference(ref, best.Axis, best.Position, ref.Max[best.Axis], rightRef);
+
+			if (leftValid && rightValid && mDuplicateBudget > 0)
+			{
+				left.push_back(leftRef);
+				right.push_back(rightRef);
+
+				mDuplicateBudget--;
+				continue;
+			}
+
+			// Out of budget, the whole reference goes to the side holding its centroid
+			float centroid = (ref.Min[best.Axis] + ref.Max[best.Axis]) * 0.5f;
+			(centroid < best.Position ? left : right).push_back(ref);
+		}
+
+		// Every reference straddled the plane, splitting again won't get us anywhere
+		if (left.size() == refs.size() && right.size() == refs.size())
+		{
+			MakeLeaf();
+			return;
+		}
+	}
+	else
+	{
+		for (const auto& ref : refs)
+		{
+			float centroid = (ref.Min[best.Axis] + ref.Max[best.Axis]) * 0.5f;
+			(centroid < best.Position ? left : right).push_back(ref);
+		}
+	}
+
+	if (left.empty() || right.empty())
+	{
+		// Degenerate centroids, fall back to a median split
+		left.clear();
+		right.clear();
+
+		auto middle = refs.begin() + refs.size() / 2;
+
+		std::nth_element(refs.begin(), middle, refs.end(), [axis = std::max(best.Axis, 0)]
+		(const Reference& a, const Reference& b)
+		{
+			return a.Min[axis] + a.Max[axis] < b.Min[axis] + b.Max[axis];
+		});
+
+		left.assign(refs.begin(), middle);
+		right.assign(middle, refs.end());
+	}
+
+	// Free the parent's references before going down
+	refs.clear();
+	refs.shrink_to_fit();
+
+	node.FirstChildIndex = static_cast<uint32_t>(mCurrent.Nodes.size());
+	node.SecondChildIndex = node.FirstChildIndex + 1;
+
+	node.MinBound -= glm::vec3(mTolerence);
+	node.MaxBound += glm::vec3(mTolerence);
+
+	mCurrent.Nodes[nodeIdx] = node;
+
+	mCurrent.Nodes.emplace_back();
+	mCurrent.Nodes.emplace_back();
+
+	SplitReferences(node.FirstChildIndex, left, faces, depth - 1, rootArea);
+	SplitReferences(node.SecondChildIndex, right, faces, depth - 1, rootArea);
+
+	// Children are laid out depth first, so the faces of the subtree stay contiguous
+	mCurrent.Nodes[nodeIdx].BeginIndex = mCurrent.Nodes[node.FirstChildIndex].BeginIndex;
+	mCurrent.Nodes[nodeIdx].EndIndex = mCurrent.Nodes[node.SecondChildIndex].EndIndex;
+}
+
+AQUA_NAMESPACE::PH_FLUX_NAMESPACE::BVHFactory::SplitCandidate
+	AQUA_NAMESPACE::PH_FLUX_NAMESPACE::BVHFactory::FindObjectSplit(
+		const std::vector<Reference>& refs, const Node& node) const
+{
+	SplitCandidate best{};
+
+	float nodeArea = BoundsArea(node.MinBound, node.MaxBound);
+
+	if (nodeArea <= 0.0f)
+		return best;
+
+	glm::vec3 centroidMin = glm::vec3(FLT_MAX);
+	glm::vec3 centroidMax = glm::vec3(-FLT_MAX);
+
+	for (const auto& ref : refs)
+	{
+		glm::vec3 centroid = (ref.Min + ref.Max) * 0.5f;
+		centroidMin = glm::min(centroidMin, centroid);
+		centroidMax = glm::max(centroidMax, centroid);
+	}
+
+	const uint32_t binCount = mSpatialSplitBins;
+
+	std::vector<SplitBin> bins(binCount);
+	std::vector<SplitBin> rightSweep(binCount);
+
+	for (int axis = 0; axis < 3; axis++)
+	{
+		float extent = centroidMax[axis] - centroidMin[axis];
+
+		if (extent <= 0.0f)
+			continue;
+
+		std::fill(bins.begin(), bins.end(), SplitBin{});
+
+		for (const auto& ref : refs)
+		{
+			float centroid = (ref.Min[axis] + ref.Max[axis]) * 0.5f;
+
+			uint32_t binIdx = static_cast<uint32_t>((centroid - centroidMin[axis]) / extent * binCount);
+			binIdx = std::min(binIdx, binCount - 1);
+
+			bins[binIdx].Grow(ref.Min, ref.Max);
+			bins[binIdx].Enter++;
+		}
+
+		// rightSweep[i] holds everything in bins [i, binCount)
+		SplitBin accum{};
+
+		for (uint32_t i = binCount; i-- > 1;)
+		{
+			accum.Grow(bins[i].Min, bins[i].Max);
+			accum.Enter += bins[i].Enter;
+			rightSweep[i] = accum;
+		}
+
+		SplitBin leftAccum{};
+
+		for (uint32_t i = 1; i < binCount; i++)
+		{
+			leftAccum.Grow(bins[i - 1].Min, bins[i - 1].Max);
+			leftAccum.Enter += bins[i - 1].Enter;
+
+			const SplitBin& rightAccum = rightSweep[i];
+
+			if (leftAccum.Enter == 0 || rightAccum.Enter == 0)
+				continue;
+
+			float cost = 1.0f + (BoundsArea(leftAccum.Min, leftAccum.Max) * leftAccum.Enter +
+				BoundsArea(rightAccum.Min, rightAccum.Max) * rightAccum.Enter) / nodeArea;
+
+			if (cost < best.Cost)
+			{
+				best.Cost = cost;
+				best.Axis = axis;
+				best.Position = centroidMin[axis] + extent * static_cast<float>(i) / binCount;
+				best.Overlap = BoundsArea(glm::max(leftAccum.Min, rightAccum.Min),
+					glm::min(leftAccum.Max, rightAccum.Max));
+				best.Spatial = false;
+			}
+		}
+	}
+
+	return best;
+}
+
+AQUA_NAMESPACE::PH_FLUX_NAMESPACE::BVHFactory::SplitCandidate
+	AQUA_NAMESPACE::PH_FLUX_NAMESPACE::BVHFactory::FindSpatialSplit(
+		const std::vector<Reference>& refs, const Node& node) const
+{
+	SplitCandidate best{};
+
+	float nodeArea = BoundsArea(node.MinBound, node.MaxBound);
+
+	if (nodeArea <= 0.0f)
+		return best;
+
+	const uint32_t binCount = mSpatialSplitBins;
+
+	std::vector<SplitBin> bins(binCount);
+	std::vector<SplitBin> rightSweep(binCount);
+
+	for (int axis = 0; axis < 3; axis++)
+	{
+		float origin = node.MinBound[axis];
+		float extent = node.MaxBound[axis] - origin;
+
+		if (extent <= 0.0f)
+			continue;
+
+		float binWidth = extent / binCount;
+
+		std::fill(bins.begin(), bins.end(), SplitBin{});
+
+		auto BinIndex = [origin, binWidth, binCount](float value)
+		{
+			float idx = std::floor((value - origin) / binWidth);
+			return static_cast<uint32_t>(std::clamp(idx, 0.0f, static_cast<float>(binCount - 1)));
+		};
+
+		// Chop every reference into the bins it spans, counting where it enters and exits
+		for (const auto& ref : refs)
+		{
+			uint32_t first = BinIndex(ref.Min[axis]);
+			uint32_t last = BinIndex(ref.Max[axis]);
+
+			for (uint32_t binIdx = first; binIdx <= last; binIdx++)
+			{
+				Reference clipped{};
+
+				float lo = origin + binWidth * binIdx;
+				float hi = binIdx == binCount - 1 ? node.MaxBound[axis] : lo + binWidth;
+
+				if (ClipReference(ref, axis, std::max(lo, ref.Min[axis]), std::min(hi, ref.Max[axis]), clipped))
+					bins[binIdx].Grow(clipped.Min, clipped.Max);
+			}
+
+			bins[first].Enter++;
+			bins[last].Exit++;
+		}
+
+		SplitBin accum{};
+
+		for (uint32_t i = binCount; i-- > 1;)
+		{
+			accum.Grow(bins[i].Min, bins[i].Max);
+			accum.Exit += bins[i].Exit;
+			rightSweep[i] = accum;
+		}
+
+		SplitBin leftAccum{};
+
+		for (uint32_t i = 1; i < binCount; i++)
+		{
+			leftAccum.Grow(bins[i - 1].Min, bins[i - 1].Max);
+			leftAccum.Enter += bins[i - 1].Enter;
+
+			const SplitBin& rightAccum = rightSweep[i];
+
+			if (leftAccum.Enter == 0 || rightAccum.Exit == 0)
+				continue;
+
+			float cost = 1.0f + (BoundsArea(leftAccum.Min, leftAccum.Max) * leftAccum.Enter +
+				BoundsArea(rightAccum.Min, rightAccum.Max) * rightAccum.Exit) / nodeArea;
+
+			if (cost < best.Cost)
+			{
+				best.Cost = cost;
+				best.Axis = axis;
+				best.Position = origin + binWidth * i;
+				best.Spatial = true;
+			}
+		}
+	}
+
+	return best;
+}
+
+bool AQUA_NAMESPACE::PH_FLUX_NAMESPACE::BVHFactory::ClipReference(
+	const Reference& ref, int axis, float lo, float hi, Reference& clipped) const
+{
+	const Face& face = mFaces[ref.FaceIdx];
+
+	clipped.FaceIdx = ref.FaceIdx;
+	clipped.Min = glm::vec3(FLT_MAX);
+	clipped.Max = glm::vec3(-FLT_MAX);
+
+	// Walk the triangle edges, keeping the vertices inside the slab and the points where edges cross it
+	for (int i = 0; i < 3; i++)
+	{
+		glm::vec3 v0 = mVertices[face.Indices[i]];
+		glm::vec3 v1 = mVertices[face.Indices[(i + 1) % 3]];
+
+		if (v0[axis] >= lo && v0[axis] <= hi)
+		{
+			clipped.Min = glm::min(clipped.Min, v0);
+			clipped.Max = glm::max(clipped.Max, v0);
+		}
+
+		for (float plane : { lo, hi })
+		{
+			if ((v0[axis] < plane && v1[axis] > plane) || (v0[axis] > plane && v1[axis] < plane))
+			{
+				float t = (plane - v0[axis]) / (v1[axis] - v0[axis]);
+				glm::vec3 point = glm::mix(v0, v1, t);
+				point[axis] = plane;
+
+				clipped.Min = glm::min(clipped.Min, point);
+				clipped.Max = glm::max(clipped.Max, point);
+			}
+		}
+	}
+
+	// The reference may already have been clipped by an earlier split
+	clipped.Min = glm::max(clipped.Min, ref.Min);
+	clipped.Max = glm::min(clipped.Max, ref.Max);
+
+	return clipped.Min.x <= clipped.Max.x && clipped.Min.y <= clipped.Max.y && clipped.Min.z <= clipped.Max.z;
+}
@@ -0,0 +1,96 @@
+#include "Core/Aqpch.h"
+#include "Wavefront/BatchRenderer.h"
+
+size_t AQUA_NAMESPACE::PH_FLUX_NAMESPACE::BatchRenderer::Render(const std::vector<BatchJob>& jobs)
+{
+	size_t written = 0;
+
+	for (const auto& job : jobs)
+	{
+		if (Render(job) != TraceResult::eComplete)
+			break;
+
+		if (job.OutputPath.empty())
+			continue;
+
+		if (WriteImage(job.OutputPath))
+			written++;
+	}
+
+	return written;
+}
+
+AQUA_NAMESPACE::PH_FLUX_NAMESPACE::TraceResult AQUA_NAMESPACE::PH_FLUX_NAMESPACE::BatchRenderer::Render(const BatchJob& job)
+{
+	_STL_ASSERT(mSession, "The batch renderer has no trace session to render!");
+
+	// Only the vertices and the instance motions change here, the buffers the executors point at stay put
+	if (mSceneUpdate)
+		mSceneUpdate(mSession, job);
+
+	if (!mValidated)
+	{
+		mScheduler.Validate();
+		mValidated = true;
+	}
+
+	mScheduler.SetCameraView(job.CameraView);
+
+	return mScheduler.Trace();
+}
+
+void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::BatchRenderer::SetDepth(uint32_t depth)
+{
+	mScheduler.SetDepth(depth);
+	mValidated = false;
+}
+
+void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::BatchRenderer::SetTraceSession(const TraceSession& traceSession)
+{
+	mSession = traceSession;
+	mScheduler.SetTraceSession(traceSession);
+	mValidated = false;
+}
+
+bool AQUA_NAMESPACE::PH_FLUX_NAMESPACE::BatchRenderer::WriteImage(const std::filesystem::path& path)
+{
+	glm::ivec2 resolution = mScheduler.GetTargetResolution();
+
+	mScheduler.GetPresentable().FetchImageData(mReadback);
+
+	std::error_code error;
+
+	if (path.has_parent_path())
+		std::filesystem::create_directories(path.parent_path(), error);
+
+	std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+
+	if (!stream)
+		return false;
+
+	// No image writer around, a binary PPM is simple enough to write by hand
+	stream << "P6\n" << resolution.x << " " << resolution.y << "\n255\n";
+
+	std::vector<char> row(static_cast<size_t>(resolution.x) * 3);
+
+	const uint32_t* texels = mReadback.MapMemory(mReadback.GetSize());
+
+	for (int y = 0; y < resolution.y; y++)
+	{
+		for (int x = 0; x < resolution.x; x++)
+		{
+			// RGBA8, red sits in the lowest byte
+			uint32_t texel = texels[static_cast<size_t>(y) * resolution.x + x];
+
+			row[3 * x + 0] = static_cast<char>(texel & 0xff);
+			row[3 * x + 1] = static_cast<char>((texel >> 8) & 0xff);
+			row[3 * x + 2] = static_cast<char>((texel >> 16) & 0xff);
+		}
+
+		stream.write(row.data(), row.size());
+	}
+
+	mReadback.UnmapMemory();
+
+	return stream.good();
+}
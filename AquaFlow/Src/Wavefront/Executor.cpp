@@ -21,6 +21,12 @@ AQUA_NAMESPACE::PH_FLUX_NAMESPACE::Executor::Executor(const Executor& Other)
 
 AQUA_NAMESPACE::PH_FLUX_NAMESPACE::Executor& AQUA_NAMESPACE::PH_FLUX_NAMESPACE::Executor::operator=(const Executor& Other)
 {
+	// The submit buffers come from the old allocator
+	for (auto cmdBuf : mSubmitCmdBufs)
+		mExecutorInfo->CmdAlloc.Free(cmdBuf);
+
+	mSubmitCmdBufs.clear();
+
 	mGraphBuilder = Other.mGraphBuilder;
 	mGraphBuilder.Clear();
 
@@ -40,6 +46,9 @@ AQUA_NAMESPACE::PH_FLUX_NAMESPACE::Executor::~Executor()
 {
 	for (auto cmdBuf : mCmdBufs)
 		mExecutorInfo->CmdAlloc.Free(cmdBuf);
+
+	for (auto cmdBuf : mSubmitCmdBufs)
+		mExecutorInfo->CmdAlloc.Free(cmdBuf);
 }
 
 void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::Executor::ConstructExecutionGraphs(uint32_t depth)
@@ -51,16 +60,24 @@ void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::Executor::ConstructExecutionGraphs(uint3
 	std::string firstIntersectName = "@(intersection_test)._0";
 	std::string postProcessName = "@(post_process)";
 	std::string luminanceName = "@(calc_luminance)";
+	std::string exposureName = "@(auto_exposure)";
 
 	mGraphBuilder.Clear();
 
 	mGraphBuilder.InsertPipelineOp(rayGenerationName, mExecutorInfo->PipelineResources.RayGenerator);
-	mGraphBuilder.InsertDependency(rayGenerationName, firstIntersectName);
+	mGraphBuilder.InsertDependency(rayGenerationName, firstIntersectName,
+		vk::PipelineStageFlagBits::eDrawIndirect | vk::PipelineStageFlagBits::eComputeShader);
 
 	mGraphBuilder[rayGenerationName].SetOpFn([this](vk::CommandBuffer cmd, const EXEC_NAMESPACE::Operation& op)
 		{
 			EXEC_NAMESPACE::Executioner executioner(cmd, op);
-			RecordRayGenerator(cmd, mExecutionBlock.ActiveBuffer);
+
+			// Paths of the previous trace are still alive, only hand out the new samples
+			if (mExecutionBlock.ResetPaths)
+				RecordRayGenerator(cmd, mExecutionBlock.ActiveBuffer);
+			else
+				RecordPathQueueUpdate(cmd, static_cast<uint32_t>(mExecutorInfo->Rays.GetSize() / 2) *
+					mExecutorInfo->CreateInfo.SamplesPerPixel);
 		});
 
 #if 1
@@ -77,7 +94,7 @@ void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::Executor::ConstructExecutionGraphs(uint3
 	mGraphBuilder[luminanceName].SetOpFn([this](vk::CommandBuffer cmd, const EXEC_NAMESPACE::Operation& op)
 		{
 			EXEC_NAMESPACE::Executioner executioner(cmd, op);
-			RecordLuminanceMean(cmd, mExecutionBlock.ActiveBuffer);
+			RecordLuminanceMean(cmd);
 		});
 
 	mGraphBuilder[postProcessName].SetOpFn([this](vk::CommandBuffer cmd, const EXEC_NAMESPACE::Operation& op)
@@ -86,9 +103,25 @@ void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::Executor::ConstructExecutionGraphs(uint3
 			RecordPostProcess(cmd);
 		});
 
-	mGraphBuilder.InsertDependency(luminanceName, postProcessName);
+	// Only tone mapping needs the exposure, it's measured on the fresh pixel mean
+	if (mPostProcess & PostProcessFlags(PostProcessFlagBits::eToneMap))
+	{
+		mGraphBuilder.InsertPipelineOp(exposureName, mExecutorInfo->PipelineResources.Exposure);
 
-	mTraceGraph = *mGraphBuilder.GenerateExecutionGraph(luminanceName);
+		mGraphBuilder[exposureName].SetOpFn([this](vk::CommandBuffer cmd, const EXEC_NAMESPACE::Operation& op)
+			{
+				EXEC_NAMESPACE::Executioner executioner(cmd, op);
+				RecordExposure(cmd);
+			});
+
+		mGraphBuilder.InsertDependency(luminanceName, exposureName);
+		mGraphBuilder.InsertDependency(exposureName, postProcessName);
+	}
+	else
+		mGraphBuilder.InsertDependency(luminanceName, postProcessName);
+
+	// The post process is left out of the graph when there's nothing for it to do
+	mTraceGraph = *mGraphBuilder.GenerateExecutionGraph(mPostProcess ? postProcessName : luminanceName);
 	mTraceExecList = mTraceGraph.SortEntries();
 }
 
@@ -101,11 +134,29 @@ uint32_t AQUA_NAMESPACE::PH_FLUX_NAMESPACE::Executor::GetRandomNumber()
 }
 
 
-AQUA_NAMESPACE::PH_FLUX_NAMESPACE::TraceResult AQUA_NAMESPACE::PH_FLUX_NAMESPACE::Executor::Trace()
+void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::Executor::BeginTrace()
 {
-	UpdateSceneInfo();
+	// Paths carry over between the traces until the session, the tile or the executor is reset
+	bool resetPaths = mExecutionBlock.ResetPaths ||
+		mExecutorInfo->TracingSession.mSessionInfo->State == TraceSessionState::eReady;
+
+	UpdateSceneInfo(resetPaths);
+
+	mExecutionBlock.BounceIdx = 0;
+	mExecutionBlock.ResetPaths = resetPaths;
 
-	mExecutionBlock = {};
+	mTimestamps.Passes.clear();
+
+	if (resetPaths)
+	{
+		mExecutionBlock.ActiveBuffer = 0;
+		ResetPathQueue();
+	}
+}
+
+AQUA_NAMESPACE::PH_FLUX_NAMESPACE::TraceResult AQUA_NAMESPACE::PH_FLUX_NAMESPACE::Executor::Trace()
+{
+	BeginTrace();
 
 	auto& execList = mTraceExecList;
 
@@ -121,9 +172,54 @@ AQUA_NAMESPACE::PH_FLUX_NAMESPACE::TraceResult AQUA_NAMESPACE::PH_FLUX_NAMESPACE
 		op(mCmdBufs[queueIdx], executor);
 	}
 
+	mExecutionBlock.ResetPaths = false;
+
 	return TraceResult::eComplete;
 }
 
+AQUA_NAMESPACE::PH_FLUX_NAMESPACE::TraceResult AQUA_NAMESPACE::PH_FLUX_NAMESPACE::Executor::Submit(
+	vkLib::Core::Ref<vkLib::Core::Queue> worker)
+{
+	BeginTrace();
+
+	auto& execList = mTraceExecList;
+
+	if (execList.empty())
+		return TraceResult::eUnknownError;
+
+	// Nothing of the previous trace can be pending here, so every operation records into its own buffer
+	while (mSubmitCmdBufs.size() < execList.size())
+		mSubmitCmdBufs.push_back(mExecutorInfo->CmdAlloc.Allocate());
+
+	// The submit infos point into these lists, so they're sized once and never reallocate
+	std::vector<EXEC_NAMESPACE::SemaphoreList> waitLists(execList.size());
+	std::vector<EXEC_NAMESPACE::SemaphoreList> signalLists(execList.size());
+	std::vector<EXEC_NAMESPACE::PipelineStageList> stageLists(execList.size());
+
+	std::vector<vk::SubmitInfo> submitInfos;
+	submitInfos.reserve(execList.size());
+
+	for (size_t i = 0; i < execList.size(); i++)
+	{
+		const auto& op = *execList[i];
+
+		op.States.Exec = EXEC_NAMESPACE::State::eExecute;
+
+		op.Fn(mSubmitCmdBufs[i], op);
+		submitInfos.push_back(op.SetupSubmitInfo(mSubmitCmdBufs[i], waitLists[i], signalLists[i], stageLists[i]));
+
+		op.States.Exec = EXEC_NAMESPACE::State::eReady;
+	}
+
+	// A single batch behind a single fence, the CPU is free to feed the other queues meanwhile
+	if (!worker->SubmitRange(submitInfos.data(), submitInfos.data() + submitInfos.size()))
+		return TraceResult::eUnknownError;
+
+	mExecutionBlock.ResetPaths = false;
+
+	return TraceResult::ePending;
+}
+
 void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::Executor::SetTraceSession(const TraceSession& traceSession)
 {
 	_STL_ASSERT(traceSession.GetState() != TraceSessionState::eOpenScope,
@@ -141,51 +237,97 @@ void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::Executor::SetTraceSession(const TraceSes
 
 	pipelines.IntersectionPipeline.mCollisionInfos = mExecutorInfo->CollisionInfos;
 	pipelines.IntersectionPipeline.mRays = mExecutorInfo->Rays;
+	pipelines.IntersectionPipeline.mRayInfos = mExecutorInfo->RayInfos;
+	pipelines.IntersectionPipeline.mPathQueue = mExecutorInfo->PathQueue;
 	pipelines.IntersectionPipeline.mSceneInfo = mExecutorInfo->Scene;
 	pipelines.IntersectionPipeline.mGeometryBuffers = traceSession.mSessionInfo->LocalBuffers;
 	pipelines.IntersectionPipeline.mLightInfos = traceSession.mSessionInfo->LightInfos;
 	pipelines.IntersectionPipeline.mLightProps = traceSession.mSessionInfo->LightPropsInfos;
 	pipelines.IntersectionPipeline.mMeshInfos = traceSession.mSessionInfo->MeshInfos;
+	pipelines.IntersectionPipeline.mInstanceMotions = traceSession.mSessionInfo->InstanceMotions;
+
+	// End() may have recreated the top level structure, so it's fetched again for every session
+	vk::AccelerationStructureKHR topLevel = traceSession.mSessionInfo->RayQueryBuilder ?
+		traceSession.mSessionInfo->RayQueryBuilder->GetTopLevel() : vk::AccelerationStructureKHR();
+
+	pipelines.IntersectionPipeline.mTopLevel = topLevel;
+
+	pipelines.OcclusionTester.mShadowRays = mExecutorInfo->ShadowRays;
+	pipelines.OcclusionTester.mOcclusionMask = mExecutorInfo->OcclusionMask;
+	pipelines.OcclusionTester.mPathQueue = mExecutorInfo->PathQueue;
+	pipelines.OcclusionTester.mSceneInfo = mExecutorInfo->Scene;
+	pipelines.OcclusionTester.mGeometryBuffers = traceSession.mSessionInfo->LocalBuffers;
+	pipelines.OcclusionTester.mLightInfos = traceSession.mSessionInfo->LightInfos;
+	pipelines.OcclusionTester.mMeshInfos = traceSession.mSessionInfo->MeshInfos;
+	pipelines.OcclusionTester.mInstanceMotions = traceSession.mSessionInfo->InstanceMotions;
+	pipelines.OcclusionTester.mTopLevel = topLevel;
 
 	pipelines.PrefixSummer.mRefCounts = mExecutorInfo->RefCounts;
 
 	pipelines.RayRefCounter.mRayRefs = mExecutorInfo->RayRefs;
 	pipelines.RayRefCounter.mRefCounts = mExecutorInfo->RefCounts;
+	pipelines.RayRefCounter.mPathQueue = mExecutorInfo->PathQueue;
 
 	pipelines.RaySortPreparer.mCollisionInfos = mExecutorInfo->CollisionInfos;
 	pipelines.RaySortPreparer.mRayRefs = mExecutorInfo->RayRefs;
 	pipelines.RaySortPreparer.mRays = mExecutorInfo->Rays;
 	pipelines.RaySortPreparer.mRaysInfos = mExecutorInfo->RayInfos;
+	pipelines.RaySortPreparer.mPathQueue = mExecutorInfo->PathQueue;
 
 	pipelines.RaySortFinisher.mRays = mExecutorInfo->Rays;
 	pipelines.RaySortFinisher.mRayRefs = mExecutorInfo->RayRefs;
 	pipelines.RaySortFinisher.mCollisionInfos = mExecutorInfo->CollisionInfos;
 	pipelines.RaySortFinisher.mRaysInfos = mExecutorInfo->RayInfos;
+	pipelines.RaySortFinisher.mPathQueue = mExecutorInfo->PathQueue;
 
 	AssignMaterialsResources(pipelines.InactiveRayShader, *traceSession.mSessionInfo);
 
 	pipelines.LuminanceMean.mPixelMean = mExecutorInfo->Target.PixelMean;
 	pipelines.LuminanceMean.mPixelVariance = mExecutorInfo->Target.PixelVariance;
 	pipelines.LuminanceMean.mPresentable = mExecutorInfo->Target.Presentable;
-	pipelines.LuminanceMean.mRays = mExecutorInfo->Rays;
-	pipelines.LuminanceMean.mRayInfos = mExecutorInfo->RayInfos;
+	pipelines.LuminanceMean.mSampleAccumulator = mExecutorInfo->SampleAccumulator;
 	pipelines.LuminanceMean.mSceneInfo = mExecutorInfo->Scene;
 
+	pipelines.PathRegenerator.mRays = mExecutorInfo->Rays;
+	pipelines.PathRegenerator.mRayInfos = mExecutorInfo->RayInfos;
+	pipelines.PathRegenerator.mPathQueue = mExecutorInfo->PathQueue;
+	pipelines.PathRegenerator.mSampleAccumulator = mExecutorInfo->SampleAccumulator;
+	pipelines.PathRegenerator.mShadowRays = mExecutorInfo->ShadowRays;
+	pipelines.PathRegenerator.mOcclusionMask = mExecutorInfo->OcclusionMask;
+	pipelines.PathRegenerator.mCamera = traceSession.mSessionInfo->CameraSpecsBuffer;
+	pipelines.PathRegenerator.mSceneInfo = mExecutorInfo->Scene;
+
+	pipelines.PathQueueUpdater.mPathQueue = mExecutorInfo->PathQueue;
+
+	pipelines.Exposure.SetInfo(mExecutorInfo->Exposure.Info);
+	pipelines.Exposure.SetSource(mExecutorInfo->Target.PixelMean.GetIdentityImageView(), mExecutorInfo->Target.MeanSampler);
+	pipelines.Exposure.SetHistogram(mExecutorInfo->Exposure.Histogram);
+	pipelines.Exposure.SetState(mExecutorInfo->Exposure.State);
+
 	pipelines.PostProcessor.mPresentable = mExecutorInfo->Target.Presentable;
+	pipelines.PostProcessor.mPixelMean = mExecutorInfo->Target.PixelMean;
+	pipelines.PostProcessor.mExposure = mExecutorInfo->Exposure.State;
 
 	InvalidateMaterialData();
 
 	pipelines.RayGenerator.UpdateDescriptors();
 	pipelines.IntersectionPipeline.UpdateDescriptors();
+	pipelines.OcclusionTester.UpdateDescriptors();
 	pipelines.PrefixSummer.UpdateDescriptors();
 	pipelines.RayRefCounter.UpdateDescriptors();
 	pipelines.RaySortPreparer.UpdateDescriptors();
 	pipelines.RaySortFinisher.UpdateDescriptors();
 	pipelines.LuminanceMean.UpdateDescriptors();
+	pipelines.PathRegenerator.UpdateDescriptors();
+	pipelines.PathQueueUpdater.UpdateDescriptors();
+	pipelines.Exposure.UpdateDescriptors();
 	pipelines.PostProcessor.UpdateDescriptors();
 	pipelines.InactiveRayShader.UpdateDescriptors();
 
 	UpdateMaterialDescriptors();
+
+	// The live paths belong to the old session
+	mExecutionBlock.ResetPaths = true;
 }
 
 void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::Executor::SetCameraView(const glm::mat4& cameraView)
@@ -197,6 +339,21 @@ void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::Executor::SetCameraView(const glm::mat4&
 	mExecutorInfo->TracingSession.SetCameraView(cameraView);
 }
 
+void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::Executor::SetTileOrigin(const glm::ivec2& origin)
+{
+	if (mExecutionBlock.TileOrigin == origin)
+		return;
+
+	// The live paths and the pixel mean belong to the old tile
+	mExecutionBlock.TileOrigin = origin;
+	mExecutionBlock.ResetPaths = true;
+}
+
+void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::Executor::SetExposureSettings(const ExposureSettings& settings)
+{
+	ResetExposure(mExecutorInfo->Exposure, glm::uvec2(mExecutorInfo->CreateInfo.TileSize), settings);
+}
+
 void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::Executor::RecordRayGenerator(vk::CommandBuffer commandBuffer, uint32_t pActiveBuffer)
 {
 	auto workGroupSize = mExecutorInfo->PipelineResources.RayGenerator.GetWorkGroupSize().x;
@@ -218,9 +375,7 @@ void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::Executor::RecordRayGenerator(vk::Command
 
 void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::Executor::ExecuteRaySortFinisher(vk::CommandBuffer commandBuffer)
 {
-	auto workGroupSize = mExecutorInfo->PipelineResources.RaySortFinisher.GetWorkGroupSize().x;
 	uint32_t pRayCount = static_cast<uint32_t>(mExecutorInfo->Rays.GetSize()) / 2;
-	glm::uvec3 workGroups = { pRayCount / workGroupSize + 1, 1, 1 };
 
 	mExecutorInfo->PipelineResources.RaySortFinisher.Begin(commandBuffer);
 
@@ -230,7 +385,9 @@ void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::Executor::ExecuteRaySortFinisher(vk::Com
 	mExecutorInfo->PipelineResources.RaySortFinisher.SetShaderConstant("eCompute.RayData.Index_1", mExecutionBlock.ActiveBuffer);
 	mExecutorInfo->PipelineResources.RaySortFinisher.SetShaderConstant("eCompute.RayData.Index_2", 0 /*comes from the sorting rays*/);
 
-	mExecutorInfo->PipelineResources.RaySortFinisher.Dispatch(workGroups);
+	// The sort passes share the intersection workgroup size, so its arguments cover the live paths
+	mExecutorInfo->PipelineResources.RaySortFinisher.DispatchIndirect(
+		mExecutorInfo->PathQueue.GetNativeHandles().Handle, offsetof(PathQueue, IntersectionDispatch));
 
 	mExecutorInfo->PipelineResources.RaySortFinisher.End();
 }
@@ -254,9 +411,7 @@ void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::Executor::ExecuteRayCounter(vk::CommandB
 {
 	uint32_t pMaterialCount = static_cast<uint32_t>(mExecutorInfo->MaterialResources.size() + 2);
 
-	auto workGroupSize = mExecutorInfo->PipelineResources.RayRefCounter.GetWorkGroupSize().x;
 	uint32_t pRayCount = static_cast<uint32_t>(mExecutorInfo->Rays.GetSize()) / 2;
-	glm::uvec3 workGroups = { pRayCount / workGroupSize + 1, 1, 1 };
 
 	mExecutorInfo->PipelineResources.RayRefCounter.Begin(commandBuffer);
 
@@ -265,7 +420,8 @@ void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::Executor::ExecuteRayCounter(vk::CommandB
 	mExecutorInfo->PipelineResources.RayRefCounter.SetShaderConstant("eCompute.MetaData.Index_0", pRayCount);
 	mExecutorInfo->PipelineResources.RayRefCounter.SetShaderConstant("eCompute.MetaData.Index_1", pMaterialCount);
 
-	mExecutorInfo->PipelineResources.RayRefCounter.Dispatch(workGroups);
+	mExecutorInfo->PipelineResources.RayRefCounter.DispatchIndirect(
+		mExecutorInfo->PathQueue.GetNativeHandles().Handle, offsetof(PathQueue, IntersectionDispatch));
 
 	mExecutorInfo->PipelineResources.RayRefCounter.End();
 }
@@ -274,9 +430,7 @@ void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::Executor::ExecuteRaySortPreparer(vk::Com
 {
 	uint32_t pMaterialCount = static_cast<uint32_t>(mExecutorInfo->MaterialResources.size() + 2);
 
-	auto workGroupSize = mExecutorInfo->PipelineResources.RaySortPreparer.GetWorkGroupSize().x;
 	uint32_t pRayCount = static_cast<uint32_t>(mExecutorInfo->Rays.GetSize()) / 2;
-	glm::uvec3 workGroups = { pRayCount / workGroupSize + 1, 1, 1 };
 
 	mExecutorInfo->PipelineResources.RaySortPreparer.Begin(commandBuffer);
 
@@ -285,18 +439,15 @@ void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::Executor::ExecuteRaySortPreparer(vk::Com
 	mExecutorInfo->PipelineResources.RaySortPreparer.SetShaderConstant("eCompute.RayData.Index_0", pRayCount);
 	mExecutorInfo->PipelineResources.RaySortPreparer.SetShaderConstant("eCompute.RayData.Index_1", pActiveBuffer);
 
-	mExecutorInfo->PipelineResources.RaySortPreparer.Dispatch(workGroups);
+	mExecutorInfo->PipelineResources.RaySortPreparer.DispatchIndirect(
+		mExecutorInfo->PathQueue.GetNativeHandles().Handle, offsetof(PathQueue, IntersectionDispatch));
 
 	mExecutorInfo->PipelineResources.RaySortPreparer.End();
 }
 
 void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::Executor::RecordIntersectionTester(vk::CommandBuffer commandBuffer, uint32_t pActiveBuffer)
 {
-	uint32_t pMaterialCount = static_cast<uint32_t>(mExecutorInfo->MaterialResources.size() + 2);
-
-	auto workGroupSize = mExecutorInfo->PipelineResources.IntersectionPipeline.GetWorkGroupSize().x;
 	uint32_t pRayCount = static_cast<uint32_t>(mExecutorInfo->Rays.GetSize()) / 2;
-	glm::uvec3 workGroups = { pRayCount / workGroupSize + 1, 1, 1 };
 
 	mExecutorInfo->PipelineResources.IntersectionPipeline.Begin(commandBuffer);
 
@@ -305,36 +456,102 @@ void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::Executor::RecordIntersectionTester(vk::C
 	mExecutorInfo->PipelineResources.IntersectionPipeline.SetShaderConstant("eCompute.RayData.Index_0", pRayCount);
 	mExecutorInfo->PipelineResources.IntersectionPipeline.SetShaderConstant("eCompute.RayData.Index_1", pActiveBuffer);
 
-	mExecutorInfo->PipelineResources.IntersectionPipeline.Dispatch(workGroups);
+	uint32_t timestampIdx = BeginPassTimestamp(commandBuffer, WavefrontPass::eIntersection);
+
+	// Only the live paths are dispatched, the group count comes from the path queue
+	mExecutorInfo->PipelineResources.IntersectionPipeline.DispatchIndirect(
+		mExecutorInfo->PathQueue.GetNativeHandles().Handle, offsetof(PathQueue, IntersectionDispatch));
+
+	EndPassTimestamp(commandBuffer, timestampIdx);
 
 	mExecutorInfo->PipelineResources.IntersectionPipeline.End();
 }
 
-void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::Executor::RecordLuminanceMean(vk::CommandBuffer commandBuffer, uint32_t pActiveBuffer)
+void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::Executor::RecordOcclusionTester(vk::CommandBuffer commandBuffer)
 {
-	uint32_t pMaterialCount = static_cast<uint32_t>(mExecutorInfo->MaterialResources.size() + 2);
+	mExecutorInfo->PipelineResources.OcclusionTester.Begin(commandBuffer);
 
-	auto workGroupSize = mExecutorInfo->PipelineResources.LuminanceMean.GetWorkGroupSize().x;
+	mExecutorInfo->PipelineResources.OcclusionTester.Activate();
+
+	// Shadow rays share the slots of the live paths, so the intersection arguments fit them too
+	mExecutorInfo->PipelineResources.OcclusionTester.DispatchIndirect(
+		mExecutorInfo->PathQueue.GetNativeHandles().Handle, offsetof(PathQueue, IntersectionDispatch));
+
+	mExecutorInfo->PipelineResources.OcclusionTester.End();
+}
+
+void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::Executor::RecordPathRegenerator(vk::CommandBuffer commandBuffer, uint32_t pActiveBuffer)
+{
+	auto workGroupSize = mExecutorInfo->PipelineResources.PathRegenerator.GetWorkGroupSize().x;
 	uint32_t pRayCount = static_cast<uint32_t>(mExecutorInfo->Rays.GetSize()) / 2;
 	glm::uvec3 workGroups = { pRayCount / workGroupSize + 1, 1, 1 };
 
+	mExecutorInfo->PipelineResources.PathRegenerator.Begin(commandBuffer);
+
+	mExecutorInfo->PipelineResources.PathRegenerator.Activate();
+
+	mExecutorInfo->PipelineResources.PathRegenerator.SetShaderConstant("eCompute.RegenerationData.Index_0", mExecutorInfo->TracingInfo.CameraView);
+	mExecutorInfo->PipelineResources.PathRegenerator.SetShaderConstant("eCompute.RegenerationData.Index_1", GetRandomNumber());
+	mExecutorInfo->PipelineResources.PathRegenerator.SetShaderConstant("eCompute.RegenerationData.Index_2", pRayCount);
+	mExecutorInfo->PipelineResources.PathRegenerator.SetShaderConstant("eCompute.RegenerationData.Index_3", pActiveBuffer);
+	mExecutorInfo->PipelineResources.PathRegenerator.SetShaderConstant("eCompute.RegenerationData.Index_4", mExecutorInfo->TracingInfo.MaxBounceLimit);
+
+	mExecutorInfo->PipelineResources.PathRegenerator.Dispatch(workGroups);
+
+	mExecutorInfo->PipelineResources.PathRegenerator.End();
+}
+
+void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::Executor::RecordPathQueueUpdate(vk::CommandBuffer commandBuffer, uint32_t pSampleGrant)
+{
+	uint32_t pPixelCount = static_cast<uint32_t>(mExecutorInfo->Rays.GetSize()) / 2;
+
+	mExecutorInfo->PipelineResources.PathQueueUpdater.Begin(commandBuffer);
+
+	mExecutorInfo->PipelineResources.PathQueueUpdater.Activate();
+
+	mExecutorInfo->PipelineResources.PathQueueUpdater.SetShaderConstant("eCompute.QueueData.Index_0", pPixelCount);
+	mExecutorInfo->PipelineResources.PathQueueUpdater.SetShaderConstant("eCompute.QueueData.Index_1", pSampleGrant);
+
+	mExecutorInfo->PipelineResources.PathQueueUpdater.Dispatch({ 1, 1, 1 });
+
+	mExecutorInfo->PipelineResources.PathQueueUpdater.End();
+}
+
+void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::Executor::RecordLuminanceMean(vk::CommandBuffer commandBuffer)
+{
+	// Same tile the scene info describes
+	glm::ivec2 tileSize = mExecutorInfo->CreateInfo.TileSize;
+
+	auto workGroupSize = mExecutorInfo->PipelineResources.LuminanceMean.GetWorkGroupSize().x;
+	uint32_t pPixelCount = static_cast<uint32_t>(tileSize.x * tileSize.y);
+	glm::uvec3 workGroups = { pPixelCount / workGroupSize + 1, 1, 1 };
+
 	mExecutorInfo->PipelineResources.LuminanceMean.Begin(commandBuffer);
 
 	mExecutorInfo->PipelineResources.LuminanceMean.Activate();
 
-	mExecutorInfo->PipelineResources.LuminanceMean.SetShaderConstant("eCompute.ShaderData.Index_0", pRayCount);
-	mExecutorInfo->PipelineResources.LuminanceMean.SetShaderConstant("eCompute.ShaderData.Index_1", pActiveBuffer);
+	mExecutorInfo->PipelineResources.LuminanceMean.SetShaderConstant("eCompute.ShaderData.Index_0", pPixelCount);
+	mExecutorInfo->PipelineResources.LuminanceMean.SetShaderConstant("eCompute.ShaderData.Index_1", static_cast<uint32_t>(tileSize.x));
 
 	mExecutorInfo->PipelineResources.LuminanceMean.Dispatch(workGroups);
 
 	mExecutorInfo->PipelineResources.LuminanceMean.End();
 }
 
+void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::Executor::RecordExposure(vk::CommandBuffer commandBuffer)
+{
+	// Adapts over the time between the traces
+	AdvanceExposure(mExecutorInfo->Exposure);
+
+	mExecutorInfo->PipelineResources.Exposure(commandBuffer, glm::uvec2(mExecutorInfo->CreateInfo.TileSize));
+}
+
 void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::Executor::RecordPostProcess(vk::CommandBuffer commandBuffer)
 {
-	glm::uvec3 rayGroupSize = mExecutorInfo->PipelineResources.RayGenerator.GetWorkGroupSize();
-	glm::uvec3 workGroups = { mExecutorInfo->CreateInfo.TileSize.x / rayGroupSize.x,
-	mExecutorInfo->CreateInfo.TileSize.y / rayGroupSize.y, 1 };
+	glm::uvec3 groupSize = mExecutorInfo->PipelineResources.PostProcessor.GetWorkGroupSize();
+	glm::uvec2 tileSize(mExecutorInfo->CreateInfo.TileSize);
+	glm::uvec3 workGroups = { (tileSize.x + groupSize.x - 1) / groupSize.x,
+		(tileSize.y + groupSize.y - 1) / groupSize.y, 1 };
 
 	mExecutorInfo->PipelineResources.PostProcessor.Begin(commandBuffer);
 
@@ -349,14 +566,16 @@ void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::Executor::RecordPostProcess(vk::CommandB
 	mExecutorInfo->PipelineResources.PostProcessor.End();
 }
 
-void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::Executor::UpdateSceneInfo()
+void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::Executor::UpdateSceneInfo(bool resetPaths)
 {
-	WavefrontSceneInfo& sceneInfo = mExecutorInfo->TracingSession.mSessionInfo->SceneData;
+	// Several executors may trace the same session, so the tile and the frame count stay local
+	WavefrontSceneInfo sceneInfo = mExecutorInfo->TracingSession.mSessionInfo->SceneData;
 	sceneInfo.ImageResolution = mExecutorInfo->CreateInfo.TargetResolution;
-	sceneInfo.MinBound = { 0, 0 };
-	sceneInfo.MaxBound = mExecutorInfo->CreateInfo.TargetResolution;
-	sceneInfo.FrameCount = mExecutorInfo->TracingSession.mSessionInfo->State == TraceSessionState::eReady ?
-		1 : sceneInfo.FrameCount + 1;
+	sceneInfo.MinBound = mExecutionBlock.TileOrigin;
+	sceneInfo.MaxBound = mExecutionBlock.TileOrigin + mExecutorInfo->CreateInfo.TileSize;
+	sceneInfo.FrameCount = resetPaths ? 1 : mExecutionBlock.FrameCount + 1;
+
+	mExecutionBlock.FrameCount = sceneInfo.FrameCount;
 
 	mExecutorInfo->Scene.Clear();
 	mExecutorInfo->Scene << sceneInfo;
@@ -364,14 +583,39 @@ void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::Executor::UpdateSceneInfo()
 	mExecutorInfo->TracingSession.mSessionInfo->State = TraceSessionState::eTracing;
 
 	ShaderData shaderData{};
-	shaderData.uRayCount = (uint32_t) mExecutorInfo->Rays.GetSize();
-	shaderData.uSkyboxColor = glm::vec4(0.0f, 1.0f, 1.0f, 0.0f);
-	shaderData.uSkyboxExists = false;
+	shaderData.uRayCount = (uint32_t) mExecutorInfo->Rays.GetSize() / 2;
+	const SessionInfo& session = *mExecutorInfo->TracingSession.mSessionInfo;
+
+	shaderData.uSkyboxColor = glm::vec4(0.0f, 1.0f, 1.0f, session.EnvironmentRotation);
+	shaderData.uSkyboxExists = session.EnvironmentResolution.x * session.EnvironmentResolution.y != 0;
+	shaderData.uEnvResolution = session.EnvironmentResolution;
+	shaderData.uEnvIntegral = session.EnvironmentIntegral;
 
 	mExecutorInfo->TracingSession.mSessionInfo->ShaderConstData.Clear();
 	mExecutorInfo->TracingSession.mSessionInfo->ShaderConstData << shaderData;
 }
 
+void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::Executor::ResetPathQueue()
+{
+	uint32_t rayCount = static_cast<uint32_t>(mExecutorInfo->Rays.GetSize()) / 2;
+
+	uint32_t intersectionGroupSize = mExecutorInfo->PipelineResources.IntersectionPipeline.GetWorkGroupSize().x;
+	uint32_t materialGroupSize = reinterpret_cast<const vkLib::ComputePipeline*>(
+		mExecutorInfo->PipelineResources.InactiveRayShader.GetBasicPipeline())->GetWorkGroupSize().x;
+
+	// The ray generation stage takes the first sample of every pixel
+	PathQueue pathQueue{};
+	pathQueue.ActiveCount = rayCount;
+	pathQueue.NextActiveCount = 0;
+	pathQueue.SampleCounter = rayCount;
+	pathQueue.SampleBudget = rayCount * mExecutorInfo->CreateInfo.SamplesPerPixel;
+	pathQueue.IntersectionDispatch = { (rayCount + intersectionGroupSize - 1) / intersectionGroupSize, 1, 1, 0 };
+	pathQueue.MaterialDispatch = { (rayCount + materialGroupSize - 1) / materialGroupSize, 1, 1, 0 };
+
+	mExecutorInfo->PathQueue.Clear();
+	mExecutorInfo->PathQueue << pathQueue;
+}
+
 void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::Executor::InvalidateMaterialData()
 {
 	if (!mExecutorInfo->TracingSession)
@@ -397,14 +641,19 @@ void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::Executor::AssignMaterialsResources(Mater
 	instance[{ 0, 6, 0 }].SetStorageBuffer(TracingSession.LocalBuffers.Faces.GetBufferChunk());
 	instance[{ 0, 7, 0 }].SetStorageBuffer(TracingSession.LightInfos.GetBufferChunk());
 	instance[{ 0, 8, 0 }].SetStorageBuffer(TracingSession.LightPropsInfos.GetBufferChunk());
+	instance[{ 0, 10, 0 }].SetStorageBuffer(mExecutorInfo->PathQueue.GetBufferChunk());
+	instance[{ 0, 11, 0 }].SetStorageBuffer(TracingSession.LightEmitters.GetBufferChunk());
+	instance[{ 0, 12, 0 }].SetStorageBuffer(TracingSession.LightTree.GetBufferChunk());
+	instance[{ 0, 13, 0 }].SetStorageBuffer(TracingSession.EnvironmentTexels.GetBufferChunk());
+	instance[{ 0, 14, 0 }].SetStorageBuffer(TracingSession.EnvironmentCDF.GetBufferChunk());
+	instance[{ 0, 15, 0 }].SetStorageBuffer(mExecutorInfo->ShadowRays.GetBufferChunk());
+	instance[{ 0, 16, 0 }].SetStorageBuffer(TracingSession.LocalBuffers.Tangents.GetBufferChunk());
+	instance[{ 0, 17, 0 }].SetStorageBuffer(TracingSession.InstanceMotions.GetBufferChunk());
 	instance[{ 1, 0, 0 }].SetUniformBuffer(TracingSession.ShaderConstData.GetBufferChunk());
 }
 
 void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::Executor::RecordMaterialPipeline(vk::CommandBuffer commandBuffer, uint32_t pMaterialRef, uint32_t pBounceIdx, uint32_t pActiveBuffer)
 {
-	uint32_t pRayCount = static_cast<uint32_t>(mExecutorInfo->Rays.GetSize()) / 2;
-	glm::uvec3 workGroups = { pRayCount / 256, 1, 1 };
-
 	uint32_t MaterialCount = static_cast<uint32_t>(mExecutorInfo->MaterialResources.size());
 
 	const vkLib::ComputePipeline* pipelinePtr = nullptr; 
@@ -427,11 +676,40 @@ void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::Executor::RecordMaterialPipeline(vk::Com
 		pipeline.SetShaderConstant("eCompute.ShaderConstants.Index_2", GetRandomNumber());
 	//pipeline.SetShaderConstant("eCompute.ShaderConstants.Index_3", pBounceIdx);
 
-	pipeline.Dispatch(workGroups);
+	uint32_t timestampIdx = BeginPassTimestamp(commandBuffer, WavefrontPass::eMaterialEval);
+
+	// Every material runs over the compacted live paths
+	pipeline.DispatchIndirect(mExecutorInfo->PathQueue.GetNativeHandles().Handle,
+		offsetof(PathQueue, MaterialDispatch));
+
+	EndPassTimestamp(commandBuffer, timestampIdx);
 
 	pipeline.End();
 }
 
+uint32_t AQUA_NAMESPACE::PH_FLUX_NAMESPACE::Executor::BeginPassTimestamp(vk::CommandBuffer commandBuffer, WavefrontPass pass)
+{
+	if (!mTimestamps.Pool || mTimestamps.Passes.size() >= mTimestamps.Capacity)
+		return MAX_UINT32;
+
+	uint32_t pairIdx = static_cast<uint32_t>(mTimestamps.Passes.size());
+	mTimestamps.Passes.push_back(pass);
+
+	// Reset in the same command buffer, so the pool never needs a host side reset
+	commandBuffer.resetQueryPool(mTimestamps.Pool, 2 * pairIdx, 2);
+	commandBuffer.writeTimestamp(vk::PipelineStageFlagBits::eTopOfPipe, mTimestamps.Pool, 2 * pairIdx);
+
+	return pairIdx;
+}
+
+void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::Executor::EndPassTimestamp(vk::CommandBuffer commandBuffer, uint32_t pairIdx)
+{
+	if (pairIdx == MAX_UINT32)
+		return;
+
+	commandBuffer.writeTimestamp(vk::PipelineStageFlagBits::eBottomOfPipe, mTimestamps.Pool, 2 * pairIdx + 1);
+}
+
 void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::Executor::UpdateMaterialDescriptors()
 {
 	for (auto& instance : mExecutorInfo->MaterialResources)
@@ -448,13 +726,17 @@ void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::Executor::Sweep(EXEC_NAMESPACE::GraphBui
 	std::string nextIntersectName = "@(intersection_test)._" + std::to_string(currDepth + 1);
 	std::string materialName = "@(material)._" + std::to_string(currDepth) + "_";
 	std::string emptyMaterial = "@(empty_material)._" + std::to_string(currDepth);
+	std::string occlusionName = "@(occlusion_test)._" + std::to_string(currDepth);
+	std::string regenerationName = "@(path_regeneration)._" + std::to_string(currDepth);
+	std::string queueUpdateName = "@(path_queue)._" + std::to_string(currDepth);
 
 	builder.InsertPipelineOp(intersectionName, mExecutorInfo->PipelineResources.IntersectionPipeline);
 
 	builder[intersectionName].SetOpFn([this](vk::CommandBuffer cmd, const EXEC_NAMESPACE::Operation& op)
 		{
 			EXEC_NAMESPACE::Executioner executioner(cmd, op);
-			RecordIntersectionTester(cmd, mExecutionBlock.BounceIdx++);
+			RecordIntersectionTester(cmd, mExecutionBlock.ActiveBuffer);
+			mExecutionBlock.BounceIdx++;
 		});
 
 	uint32_t instanceIdx = 0;
@@ -474,7 +756,7 @@ void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::Executor::Sweep(EXEC_NAMESPACE::GraphBui
 		instanceIdx++;
 
 		builder.InsertDependency(intersectionName, instanceName);
-		builder.InsertDependency(instanceName, closingOp.empty() ? nextIntersectName : closingOp);
+		builder.InsertDependency(instanceName, occlusionName);
 	}
 
 	builder[emptyMaterial] = mExecutorInfo->PipelineResources.InactiveRayShader.GetMaterial();
@@ -486,6 +768,39 @@ void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::Executor::Sweep(EXEC_NAMESPACE::GraphBui
 		});
 
 	builder.InsertDependency(intersectionName, emptyMaterial);
-	builder.InsertDependency(emptyMaterial, closingOp.empty() ? nextIntersectName : closingOp);
+	builder.InsertDependency(emptyMaterial, occlusionName);
+
+	// Visibility of the light samples queued by the material passes
+	builder.InsertPipelineOp(occlusionName, mExecutorInfo->PipelineResources.OcclusionTester);
+
+	builder[occlusionName].SetOpFn([this](vk::CommandBuffer cmd, const EXEC_NAMESPACE::Operation& op)
+		{
+			EXEC_NAMESPACE::Executioner executioner(cmd, op);
+			RecordOcclusionTester(cmd);
+		});
+
+	builder.InsertDependency(occlusionName, regenerationName);
+
+	// Finished paths are retired and refilled, the survivors move into the other half of the buffers
+	builder.InsertPipelineOp(regenerationName, mExecutorInfo->PipelineResources.PathRegenerator);
+
+	builder[regenerationName].SetOpFn([this](vk::CommandBuffer cmd, const EXEC_NAMESPACE::Operation& op)
+		{
+			EXEC_NAMESPACE::Executioner executioner(cmd, op);
+			RecordPathRegenerator(cmd, mExecutionBlock.ActiveBuffer);
+			mExecutionBlock.ActiveBuffer = 1 - mExecutionBlock.ActiveBuffer;
+		});
+
+	builder.InsertPipelineOp(queueUpdateName, mExecutorInfo->PipelineResources.PathQueueUpdater);
+
+	builder[queueUpdateName].SetOpFn([this](vk::CommandBuffer cmd, const EXEC_NAMESPACE::Operation& op)
+		{
+			EXEC_NAMESPACE::Executioner executioner(cmd, op);
+			RecordPathQueueUpdate(cmd, 0);
+		});
+
+	builder.InsertDependency(regenerationName, queueUpdateName);
+	builder.InsertDependency(queueUpdateName, closingOp.empty() ? nextIntersectName : closingOp,
+		vk::PipelineStageFlagBits::eDrawIndirect | vk::PipelineStageFlagBits::eComputeShader);
 }
 
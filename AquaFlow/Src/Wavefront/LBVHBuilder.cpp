@@ -0,0 +1,214 @@
+#include "Core/Aqpch.h"
+#include "Wavefront/LBVHBuilder.h"
+
+void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::LBVHBuildPipeline::UpdateDescriptors()
+{
+/*
+* Descriptor layout of the builder, see BVH/LBVHCommon.glsl
+* 
+	binding = 0 --> positions
+	binding = 1 --> input faces (scratch)
+	binding = 2 --> faces
+	binding = 3 --> nodes
+	binding = 4 --> wide nodes
+	binding = 5 --> morton refs
+	binding = 6 --> parents
+	binding = 7 --> visit flags
+	binding = 8 --> centroid bounds
+*/
+
+	auto Write = [this](uint32_t binding, vk::Buffer buffer)
+	{
+		vkLib::StorageBufferWriteInfo storageInfo{};
+		storageInfo.Buffer = buffer;
+
+		this->UpdateDescriptor({ 0, binding, 0 }, storageInfo);
+	};
+
+	switch (mStage)
+	{
+		case LBVHStage::eCentroidBounds:
+			Write(0, mGeometry.Vertices.GetNativeHandles().Handle);
+			Write(1, mInputFaces.GetNativeHandles().Handle);
+			Write(8, mCentroidBounds.GetNativeHandles().Handle);
+			break;
+		case LBVHStage::eMortonCodes:
+			Write(0, mGeometry.Vertices.GetNativeHandles().Handle);
+			Write(1, mInputFaces.GetNativeHandles().Handle);
+			Write(5, mMortonRefs.GetNativeHandles().Handle);
+			Write(8, mCentroidBounds.GetNativeHandles().Handle);
+			break;
+		case LBVHStage::eHierarchy:
+			Write(0, mGeometry.Vertices.GetNativeHandles().Handle);
+			Write(1, mInputFaces.GetNativeHandles().Handle);
+			Write(2, mGeometry.Faces.GetNativeHandles().Handle);
+			Write(3, mGeometry.Nodes.GetNativeHandles().Handle);
+			Write(5, mMortonRefs.GetNativeHandles().Handle);
+			Write(6, mParents.GetNativeHandles().Handle);
+			break;
+		case LBVHStage::eRefit:
+			Write(3, mGeometry.Nodes.GetNativeHandles().Handle);
+			Write(6, mParents.GetNativeHandles().Handle);
+			Write(7, mVisitFlags.GetNativeHandles().Handle);
+			break;
+		case LBVHStage::eCollapse:
+			Write(3, mGeometry.Nodes.GetNativeHandles().Handle);
+			Write(4, mGeometry.WideNodes.GetNativeHandles().Handle);
+			break;
+		default:
+			_STL_ASSERT(false, "Invalid LBVH build stage!");
+			break;
+	}
+}
+
+AQUA_NAMESPACE::PH_FLUX_NAMESPACE::LBVHBuilder::LBVHBuilder(vkLib::PipelineBuilder builder,
+	vkLib::ResourcePool pool, const LBVHPipelines& pipelines, uint32_t workGroupSize)
+	: mPipelines(pipelines), mWorkGroupSize(workGroupSize)
+{
+	mPipelines.CentroidBounds.mStage = LBVHStage::eCentroidBounds;
+	mPipelines.MortonCodes.mStage = LBVHStage::eMortonCodes;
+	mPipelines.Hierarchy.mStage = LBVHStage::eHierarchy;
+	mPipelines.Refit.mStage = LBVHStage::eRefit;
+	mPipelines.Collapse.mStage = LBVHStage::eCollapse;
+
+	mSorter = std::make_shared<SortRecorder<uint32_t>>(builder, pool);
+	mSorter->InvalidateSorterPipeline(workGroupSize);
+
+	vk::BufferUsageFlags usage = vk::BufferUsageFlagBits::eStorageBuffer;
+	vk::MemoryPropertyFlags memProps = vk::MemoryPropertyFlagBits::eDeviceLocal;
+
+	mInputFaces = pool.CreateBuffer<Face>(usage, memProps);
+	mParents = pool.CreateBuffer<uint32_t>(usage, memProps);
+	mVisitFlags = pool.CreateBuffer<uint32_t>(usage, memProps);
+	mCentroidBounds = pool.CreateBuffer<glm::uvec4>(usage, memProps);
+
+	mCentroidBounds.Resize(2);
+}
+
+void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::LBVHBuilder::Record(vk::CommandBuffer commandBuffer, const LBVHBuildInfo& buildInfo)
+{
+	_STL_ASSERT(buildInfo.FaceCount != 0, "Can't build a BVH over zero faces!");
+	_STL_ASSERT(buildInfo.Geometry.Nodes.GetSize() >= buildInfo.NodeOffset + GetNodeCount(buildInfo.FaceCount),
+		"Node range of the LBVH must be reserved before recording the build!");
+	_STL_ASSERT(buildInfo.Geometry.WideNodes.GetSize() >= buildInfo.WideNodeOffset + GetWideNodeCount(buildInfo.FaceCount),
+		"Wide node range of the LBVH must be reserved before recording the build!");
+
+	ReserveScratch(buildInfo.FaceCount);
+	UpdateDescriptors(buildInfo);
+
+	// Take a copy of the faces, the hierarchy writes them back sorted
+	vk::BufferCopy faceCopy{};
+	faceCopy.setSrcOffset(buildInfo.FaceOffset);
+	faceCopy.setDstOffset(0);
+	faceCopy.setSize(buildInfo.FaceCount);
+
+	vkLib::RecordCopyBufferRegions(commandBuffer, mInputFaces, buildInfo.Geometry.Faces, { faceCopy });
+
+	// Empty centroid bounds in the ordered uint encoding, and no visited nodes
+	vk::Buffer bounds = mCentroidBounds.GetNativeHandles().Handle;
+
+	commandBuffer.fillBuffer(bounds, 0, sizeof(glm::uvec4), ~0u);
+	commandBuffer.fillBuffer(bounds, sizeof(glm::uvec4), sizeof(glm::uvec4), 0u);
+	commandBuffer.fillBuffer(mVisitFlags.GetNativeHandles().Handle, 0, VK_WHOLE_SIZE, 0u);
+
+	InsertBarrier(commandBuffer, vk::PipelineStageFlagBits::eTransfer, vk::AccessFlagBits::eTransferWrite);
+
+	RecordStage(commandBuffer, mPipelines.CentroidBounds, buildInfo, buildInfo.FaceCount, 0);
+	InsertBarrier(commandBuffer, vk::PipelineStageFlagBits::eComputeShader, vk::AccessFlagBits::eShaderWrite);
+
+	RecordStage(commandBuffer, mPipelines.MortonCodes, buildInfo, buildInfo.FaceCount, 0);
+	InsertBarrier(commandBuffer, vk::PipelineStageFlagBits::eComputeShader, vk::AccessFlagBits::eShaderWrite);
+
+	uint32_t sortedBuffer = mSorter->Run(commandBuffer);
+	InsertBarrier(commandBuffer, vk::PipelineStageFlagBits::eComputeShader, vk::AccessFlagBits::eShaderWrite);
+
+	RecordStage(commandBuffer, mPipelines.Hierarchy, buildInfo, buildInfo.FaceCount, sortedBuffer);
+	InsertBarrier(commandBuffer, vk::PipelineStageFlagBits::eComputeShader, vk::AccessFlagBits::eShaderWrite);
+
+	RecordStage(commandBuffer, mPipelines.Refit, buildInfo, buildInfo.FaceCount, sortedBuffer);
+	InsertBarrier(commandBuffer, vk::PipelineStageFlagBits::eComputeShader, vk::AccessFlagBits::eShaderWrite);
+
+	RecordStage(commandBuffer, mPipelines.Collapse, buildInfo, GetWideNodeCount(buildInfo.FaceCount), sortedBuffer);
+	InsertBarrier(commandBuffer, vk::PipelineStageFlagBits::eComputeShader, vk::AccessFlagBits::eShaderWrite);
+}
+
+void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::LBVHBuilder::ReserveScratch(uint32_t faceCount)
+{
+	mInputFaces.Resize(faceCount);
+	mParents.Resize(GetNodeCount(faceCount));
+	mVisitFlags.Resize(GetWideNodeCount(faceCount));
+
+	// The sorter ping-pongs between the two halves
+	mSorter->ResizeBuffer(2 * faceCount);
+}
+
+void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::LBVHBuilder::UpdateDescriptors(const LBVHBuildInfo& buildInfo)
+{
+	for (LBVHBuildPipeline* pipeline : { &mPipelines.CentroidBounds, &mPipelines.MortonCodes,
+		&mPipelines.Hierarchy, &mPipelines.Refit, &mPipelines.Collapse })
+	{
+		pipeline->mGeometry = buildInfo.Geometry;
+		pipeline->mInputFaces = mInputFaces;
+		pipeline->mMortonRefs = mSorter->GetBuffer();
+		pipeline->mParents = mParents;
+		pipeline->mVisitFlags = mVisitFlags;
+		pipeline->mCentroidBounds = mCentroidBounds;
+
+		pipeline->UpdateDescriptors();
+	}
+}
+
+void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::LBVHBuilder::RecordStage(vk::CommandBuffer commandBuffer,
+	const LBVHBuildPipeline& pipeline, const LBVHBuildInfo& buildInfo, uint32_t threadCount, uint32_t sortedBuffer)
+{
+	/*   Push constant layout...
+	*
+		layout(push_constant) uniform BuildData
+		{
+			uint pFaceCount;
+			uint pFaceOffset;
+			uint pNodeOffset;
+			uint pWideNodeOffset;
+			uint pSortedBuffer;
+		};
+	*/
+
+	pipeline.Begin(commandBuffer);
+	pipeline.Activate();
+
+	// Only the fields a stage reads survive in its reflections
+	pipeline.SetShaderConstant("eCompute.BuildData.Index_0", buildInfo.FaceCount);
+
+	switch (pipeline.mStage)
+	{
+		case LBVHStage::eHierarchy:
+			pipeline.SetShaderConstant("eCompute.BuildData.Index_1", buildInfo.FaceOffset);
+			pipeline.SetShaderConstant("eCompute.BuildData.Index_2", buildInfo.NodeOffset);
+			pipeline.SetShaderConstant("eCompute.BuildData.Index_4", sortedBuffer);
+			break;
+		case LBVHStage::eRefit:
+			pipeline.SetShaderConstant("eCompute.BuildData.Index_2", buildInfo.NodeOffset);
+			break;
+		case LBVHStage::eCollapse:
+			pipeline.SetShaderConstant("eCompute.BuildData.Index_2", buildInfo.NodeOffset);
+			pipeline.SetShaderConstant("eCompute.BuildData.Index_3", buildInfo.WideNodeOffset);
+			break;
+		default:
+			break;
+	}
+
+	pipeline.Dispatch({ (threadCount + mWorkGroupSize - 1) / mWorkGroupSize, 1, 1 });
+
+	pipeline.End();
+}
+
+void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::LBVHBuilder::InsertBarrier(vk::CommandBuffer commandBuffer,
+	vk::PipelineStageFlags srcStage, vk::AccessFlags srcAccess)
+{
+	vk::MemoryBarrier barrier{};
+	barrier.setSrcAccessMask(srcAccess);
+	barrier.setDstAccessMask(vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite);
+
+	commandBuffer.pipelineBarrier(srcStage, vk::PipelineStageFlagBits::eComputeShader,
+		vk::DependencyFlags(), barrier, nullptr, nullptr);
+}
@@ -0,0 +1,143 @@
+#include "Core/Aqpch.h"
+#include "Wavefront/LightTreeFactory.h"
+
+AQUA_BEGIN
+PH_BEGIN
+
+float GetLuminance(const glm::vec3& color)
+{
+	return glm::dot(color, glm::vec3(0.2126f, 0.7152f, 0.0722f));
+}
+
+PH_END
+AQUA_END
+
+void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::LightTreeFactory::AddTriangleEmitter(const glm::vec3& a,
+	const glm::vec3& b, const glm::vec3& c, uint32_t primitiveID, const glm::vec3& radiance)
+{
+	float area = 0.5f * glm::length(glm::cross(b - a, c - a));
+
+	// Degenerate triangles can never be sampled
+	if (area <= 0.0f)
+		return;
+
+	LightEmitter emitter{};
+	emitter.Position = (a + b + c) / 3.0f;
+	emitter.PrimitiveID = primitiveID;
+	emitter.Radiance = radiance;
+
+	// Lambertian emitter; both sides of the triangle emit
+	emitter.Power = 2.0f * glm::pi<float>() * area * GetLuminance(radiance);
+
+	mEmitters.push_back(emitter);
+	mBounds.emplace_back(glm::min(a, glm::min(b, c)), glm::max(a, glm::max(b, c)));
+}
+
+void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::LightTreeFactory::AddPointEmitter(const glm::vec3& position, const glm::vec3& intensity)
+{
+	LightEmitter emitter{};
+	emitter.Position = position;
+	emitter.PrimitiveID = uint32_t(-1);
+	emitter.Radiance = intensity;
+	emitter.Power = 4.0f * glm::pi<float>() * GetLuminance(intensity);
+
+	mEmitters.push_back(emitter);
+	mBounds.emplace_back(position, position);
+}
+
+AQUA_NAMESPACE::PH_FLUX_NAMESPACE::LightTree AQUA_NAMESPACE::PH_FLUX_NAMESPACE::LightTreeFactory::Build()
+{
+	mCurrent = {};
+	mOrder.resize(mEmitters.size());
+
+	for (uint32_t i = 0; i < static_cast<uint32_t>(mOrder.size()); i++)
+		mOrder[i] = i;
+
+	if (mEmitters.empty())
+	{
+		// A root without any power tells the shaders that there is nothing to sample
+		mCurrent.Nodes.emplace_back();
+		mCurrent.Emitters.emplace_back();
+
+		return mCurrent;
+	}
+
+	mCurrent.Nodes.reserve(2 * mEmitters.size() - 1);
+	mCurrent.Emitters.reserve(mEmitters.size());
+
+	BuildRecursive(0, static_cast<uint32_t>(mEmitters.size()));
+
+	return mCurrent;
+}
+
+void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::LightTreeFactory::Clear()
+{
+	mEmitters.clear();
+	mBounds.clear();
+	mOrder.clear();
+
+	mCurrent = {};
+}
+
+uint32_t AQUA_NAMESPACE::PH_FLUX_NAMESPACE::LightTreeFactory::BuildRecursive(uint32_t begin, uint32_t end)
+{
+	uint32_t nodeIdx = static_cast<uint32_t>(mCurrent.Nodes.size());
+	mCurrent.Nodes.emplace_back();
+
+	LightTreeNode node{};
+	node.MinBound = glm::vec3(FLT_MAX);
+	node.MaxBound = glm::vec3(-FLT_MAX);
+
+	glm::vec3 centroidMin = glm::vec3(FLT_MAX);
+	glm::vec3 centroidMax = glm::vec3(-FLT_MAX);
+
+	for (uint32_t i = begin; i < end; i++)
+	{
+		const Box& bounds = mBounds[mOrder[i]];
+
+		node.MinBound = glm::min(node.MinBound, bounds.Min);
+		node.MaxBound = glm::max(node.MaxBound, bounds.Max);
+		node.Power += mEmitters[mOrder[i]].Power;
+
+		centroidMin = glm::min(centroidMin, GetCentroid(mOrder[i]));
+		centroidMax = glm::max(centroidMax, GetCentroid(mOrder[i]));
+	}
+
+	if (end - begin == 1)
+	{
+		node.EmitterIndex = static_cast<uint32_t>(mCurrent.Emitters.size());
+		mCurrent.Emitters.push_back(mEmitters[mOrder[begin]]);
+
+		mCurrent.Nodes[nodeIdx] = node;
+		return nodeIdx;
+	}
+
+	// Median split along the widest axis of the centroids
+	glm::vec3 extent = centroidMax - centroidMin;
+
+	int axis = 0;
+
+	if (extent.y > extent[axis])
+		axis = 1;
+	if (extent.z > extent[axis])
+		axis = 2;
+
+	uint32_t mid = begin + (end - begin) / 2;
+
+	std::nth_element(mOrder.begin() + begin, mOrder.begin() + mid, mOrder.begin() + end,
+		[this, axis](uint32_t lhs, uint32_t rhs)
+	{
+		return GetCentroid(lhs)[axis] < GetCentroid(rhs)[axis];
+	});
+
+	node.FirstChildIndex = BuildRecursive(begin, mid);
+	node.SecondChildIndex = BuildRecursive(mid, end);
+
+	mCurrent.Nodes[nodeIdx] = node;
+	return nodeIdx;
+}
+
+glm::vec3 AQUA_NAMESPACE::PH_FLUX_NAMESPACE::LightTreeFactory::GetCentroid(uint32_t emitterIdx) const
+{
+	return 0.5f * (mBounds[emitterIdx].Min + mBounds[emitterIdx].Max);
+}
@@ -89,6 +89,7 @@ void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::MaterialPipeline::UpdateDescriptors()
 	UpdateIfExists(setLayoutBindingMap, 0, 4, mHandle.mGeometry.Normals, writer);
 	UpdateIfExists(setLayoutBindingMap, 0, 5, mHandle.mGeometry.TexCoords, writer);
 	UpdateIfExists(setLayoutBindingMap, 0, 6, mHandle.mGeometry.Faces, writer);
+	UpdateIfExists(setLayoutBindingMap, 0, 16, mHandle.mGeometry.Tangents, writer);
 
 	for (const auto& [location, image] : mHandle.mImages)
 	{
@@ -0,0 +1,181 @@
+#include "Core/Aqpch.h"
+#include "Wavefront/TileScheduler.h"
+
+AQUA_NAMESPACE::PH_FLUX_NAMESPACE::TraceResult AQUA_NAMESPACE::PH_FLUX_NAMESPACE::TileScheduler::Trace()
+{
+	_STL_ASSERT(!mSlots.empty(), "The tile scheduler must be created by the WavefrontEstimator!");
+
+	size_t slotCount = mSlots.size();
+	uint32_t passCount = glm::max(mCreateInfo.PassesPerTile, 1u);
+
+	// The tiles go out in waves of one tile per slot, the passes of a wave take turns on the queues
+	for (size_t waveBegin = 0; waveBegin < mTiles.size(); waveBegin += slotCount)
+	{
+		size_t waveSize = glm::min(slotCount, mTiles.size() - waveBegin);
+
+		for (uint32_t pass = 0; pass < passCount; pass++)
+		{
+			for (size_t i = 0; i < waveSize; i++)
+			{
+				TileSlot& slot = mSlots[i];
+
+				// The slot's host visible buffers are rewritten by the next submit
+				slot.Worker->WaitIdle();
+
+				if (pass == 0)
+				{
+					CollectTile(slot);
+
+					slot.PendingTile = static_cast<int64_t>(waveBegin + i);
+					slot.Tracer.SetTileOrigin(mTiles[slot.PendingTile].Origin);
+
+					// The slot may land on the tile it traced last time, which must not keep accumulating
+					slot.Tracer.InvalidatePaths();
+				}
+
+				if (slot.Tracer.Submit(slot.Worker) == TraceResult::eUnknownError)
+					return TraceResult::eUnknownError;
+			}
+		}
+	}
+
+	for (auto& slot : mSlots)
+	{
+		slot.Worker->WaitIdle();
+		CollectTile(slot);
+	}
+
+	if (mPostProcess)
+		PostProcessTarget();
+
+	return TraceResult::eComplete;
+}
+
+void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::TileScheduler::Validate()
+{
+	for (auto& slot : mSlots)
+		slot.Tracer.Validate();
+}
+
+void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::TileScheduler::SetDepth(uint32_t depth)
+{
+	for (auto& slot : mSlots)
+		slot.Tracer.SetDepth(depth);
+}
+
+void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::TileScheduler::SetTraceSession(const TraceSession& traceSession)
+{
+	// Descriptors are rewritten, nothing may still be reading them
+	for (auto& slot : mSlots)
+	{
+		slot.Worker->WaitIdle();
+		slot.Tracer.SetTraceSession(traceSession);
+	}
+}
+
+void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::TileScheduler::SetCameraView(const glm::mat4& cameraView)
+{
+	for (auto& slot : mSlots)
+		slot.Tracer.SetCameraView(cameraView);
+}
+
+void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::TileScheduler::SetSortingFlag(bool allowSort)
+{
+	for (auto& slot : mSlots)
+		slot.Tracer.SetSortingFlag(allowSort);
+}
+
+void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::TileScheduler::SetExposureSettings(const ExposureSettings& settings)
+{
+	ResetExposure(mExposure, glm::uvec2(mCreateInfo.TargetResolution), settings);
+}
+
+void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::TileScheduler::SplitTarget()
+{
+	mTiles.clear();
+
+	glm::ivec2 target = mCreateInfo.TargetResolution;
+	glm::ivec2 tileSize = mCreateInfo.TileSize;
+
+	for (int y = 0; y < target.y; y += tileSize.y)
+	{
+		for (int x = 0; x < target.x; x += tileSize.x)
+		{
+			TileRegion& tile = mTiles.emplace_back();
+			tile.Origin = { x, y };
+			tile.Extent = glm::min(tileSize, target - tile.Origin);
+		}
+	}
+}
+
+void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::TileScheduler::CollectTile(TileSlot& slot)
+{
+	if (slot.PendingTile < 0)
+		return;
+
+	const TileRegion& tile = mTiles[slot.PendingTile];
+
+	// A plain copy of the visible part, the edge tiles may hang over the target
+	vkLib::ImageBlitInfo blitInfo{};
+	blitInfo.Filter = vk::Filter::eNearest;
+	blitInfo.SrcBeginRegion = { 0, 0 };
+	blitInfo.SrcEndRegion = glm::uvec2(tile.Extent);
+	blitInfo.DstBeginRegion = glm::uvec2(tile.Origin);
+	blitInfo.DstEndRegion = glm::uvec2(tile.Origin + tile.Extent);
+
+	// Blocking, so the copies never touch the target from two queues at once
+	// The post process needs the raw mean of every tile before it can run
+	if (mPostProcess)
+		mTargetMean.Blit(slot.Tracer.GetMean(), blitInfo);
+	else
+		mTarget.Blit(slot.Tracer.GetPresentable(), blitInfo);
+
+	slot.PendingTile = -1;
+}
+
+void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::TileScheduler::PostProcessTarget()
+{
+	glm::uvec2 resolution(mCreateInfo.TargetResolution);
+	glm::uvec3 groupSize = mPostProcessor.GetWorkGroupSize();
+	glm::uvec3 workGroups = { (resolution.x + groupSize.x - 1) / groupSize.x,
+		(resolution.y + groupSize.y - 1) / groupSize.y, 1 };
+
+	// The post process reads the exposure the adapt pass just wrote
+	vk::MemoryBarrier exposureBarrier{};
+	exposureBarrier.setSrcAccessMask(vk::AccessFlagBits::eShaderWrite);
+	exposureBarrier.setDstAccessMask(vk::AccessFlagBits::eShaderRead);
+
+	mPostProcessCmd.reset();
+	mPostProcessCmd.begin({ vk::CommandBufferUsageFlagBits::eOneTimeSubmit });
+
+	// Every tile is binned into the one histogram and a single adapt pass runs before anything is tone mapped
+	if (mPostProcess & PostProcessFlags(PostProcessFlagBits::eToneMap))
+	{
+		AdvanceExposure(mExposure);
+
+		mExposurePipeline(mPostProcessCmd, resolution);
+
+		mPostProcessCmd.pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eComputeShader,
+			vk::DependencyFlags(), exposureBarrier, nullptr, nullptr);
+	}
+
+	mPostProcessor.Begin(mPostProcessCmd);
+
+	mPostProcessor.Activate();
+
+	mPostProcessor.SetShaderConstant("eCompute.ShaderData.Index_0", resolution.x);
+	mPostProcessor.SetShaderConstant("eCompute.ShaderData.Index_1", resolution.y);
+	mPostProcessor.SetShaderConstant("eCompute.ShaderData.Index_2", (uint32_t) (int) mPostProcess);
+
+	mPostProcessor.Dispatch(workGroups);
+
+	mPostProcessor.End();
+
+	mPostProcessCmd.end();
+
+	// Blocking like the tile copies, the target is complete once Trace returns
+	auto worker = mSlots.front().Worker;
+
+	worker->Submit(mPostProcessCmd);
+	worker->WaitIdle();
+}
@@ -2,6 +2,47 @@
 #include "Wavefront/TraceSession.h"
 
 #include "Wavefront/BVHFactory.h"
+#include "Wavefront/WideBVHFactory.h"
+
+// Tangents go to the GPU with the handedness of the bitangent in w
+// Zero tangents tell the material pass to build the frame from the normal alone
+static std::vector<glm::vec4> PackTangents(const AQUA_NAMESPACE::MeshData& meshData, size_t vertexCount)
+{
+	std::vector<glm::vec4> tangents(vertexCount, glm::vec4(0.0f));
+
+	if (meshData.aTangents.size() != vertexCount || meshData.aBitangents.size() != vertexCount ||
+		meshData.aNormals.size() != vertexCount)
+		return tangents;
+
+	for (size_t i = 0; i < vertexCount; i++)
+	{
+		float handedness = glm::dot(glm::cross(meshData.aNormals[i], meshData.aTangents[i]),
+			meshData.aBitangents[i]) < 0.0f ? -1.0f : 1.0f;
+
+		tangents[i] = glm::vec4(meshData.aTangents[i], handedness);
+	}
+
+	return tangents;
+}
+
+// Splits an object to world transform into the parts the traversal interpolates over the shutter
+static void DecomposeMotionTransform(const glm::mat4& transform,
+	glm::vec3& translation, glm::vec4& rotation, glm::vec3& scale)
+{
+	glm::mat3 basis = glm::mat3(transform);
+
+	_STL_ASSERT(glm::determinant(basis) > 0.0f, "Mirrored or degenerate motion transforms aren't supported!");
+
+	translation = glm::vec3(transform[3]);
+	scale = glm::vec3(glm::length(basis[0]), glm::length(basis[1]), glm::length(basis[2]));
+
+	basis[0] /= scale.x;
+	basis[1] /= scale.y;
+	basis[2] /= scale.z;
+
+	glm::quat quaternion = glm::normalize(glm::quat_cast(basis));
+	rotation = glm::vec4(quaternion.x, quaternion.y, quaternion.z, quaternion.w);
+}
 
 void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::TraceSession::Begin(const WavefrontTraceInfo& beginInfo)
 {
@@ -22,22 +63,75 @@ void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::TraceSession::Begin(const WavefrontTrace
 	Cleanup();
 }
 
-void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::TraceSession::SubmitRenderable(const MeshData& meshData, uint32_t bvhDepth)
+void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::TraceSession::SubmitRenderable(const MeshData& meshData,
+	uint32_t bvhDepth, bool deformable)
 {
 	_STL_ASSERT(mSessionInfo->State == TraceSessionState::eOpenScope,
 		"SubmitRenderable method requires the WavefrontEstimator to be in eOpenScope state!");
 
-	auto bvhStruct = std::move(CreateBVH(meshData, bvhDepth));
+	RenderableRecord record{};
+	record.VertexOffset = static_cast<uint32_t>(mSessionInfo->LocalBuffers.Vertices.GetSize());
+	record.VertexCount = static_cast<uint32_t>(meshData.aPositions.size());
+	record.FaceOffset = static_cast<uint32_t>(mSessionInfo->LocalBuffers.Faces.GetSize());
+	record.FaceCount = static_cast<uint32_t>(meshData.aFaces.size());
+	record.NodeOffset = static_cast<uint32_t>(mSessionInfo->LocalBuffers.Nodes.GetSize());
+	record.WideNodeOffset = static_cast<uint32_t>(mSessionInfo->LocalBuffers.WideNodes.GetSize());
+	record.BVHDepth = bvhDepth;
+	record.Deformable = deformable;
+	record.BuildMode = meshData.aFaces.empty() ? BVHBuildMode::eCPU : mSessionInfo->BuildMode;
+
+	if (record.BuildMode == BVHBuildMode::eGPU)
+	{
+		// Only the vertices and the faces go up, the nodes are written by the builder
+		BVH rawGeometry{};
+		rawGeometry.Vertices = meshData.aPositions;
+		rawGeometry.Faces = meshData.aFaces;
 
-	size_t NodeCount = mSessionInfo->LocalBuffers.Nodes.GetSize();
+		CopyAllVertexAttribs(rawGeometry, meshData, RenderableType::eObject);
+
+		record.NodeCapacity = LBVHBuilder::GetNodeCount(record.FaceCount);
+		record.WideNodeCapacity = LBVHBuilder::GetWideNodeCount(record.FaceCount);
 
-	CopyAllVertexAttribs(bvhStruct, meshData, RenderableType::eObject);
+		BuildBVHOnGPU(record.FaceCount, record.FaceOffset, record.NodeOffset, record.WideNodeOffset);
+	}
+	else
+	{
+		// Duplicated references would break the fixed face ranges that refitting writes into
+		float splitBudget = deformable ? 0.0f : mSessionInfo->SpatialSplitBudget;
+
+		auto bvhStruct = std::move(CreateBVH(meshData, bvhDepth, splitBudget));
+		CopyAllVertexAttribs(bvhStruct, meshData, RenderableType::eObject);
+
+		record.FaceCount = static_cast<uint32_t>(bvhStruct.Faces.size());
+
+		record.NodeCapacity = static_cast<uint32_t>(bvhStruct.Nodes.size());
+		record.WideNodeCapacity = static_cast<uint32_t>(bvhStruct.WideNodes.size());
+
+		if (deformable)
+		{
+			// A binary tree never needs more than 2N - 1 nodes, nor a wide one more than N - 1
+			record.NodeCapacity = std::max(record.NodeCapacity, LBVHBuilder::GetNodeCount(record.FaceCount));
+			record.WideNodeCapacity = std::max(record.WideNodeCapacity, LBVHBuilder::GetWideNodeCount(record.FaceCount));
+
+			mSessionInfo->LocalBuffers.Nodes.Resize(record.NodeOffset + record.NodeCapacity);
+			mSessionInfo->LocalBuffers.WideNodes.Resize(record.WideNodeOffset + record.WideNodeCapacity);
+
+			record.BuildCost = BVHFactory::SAHCost(bvhStruct);
+			record.HostBVH = std::move(bvhStruct);
+		}
+	}
+
+	if (mSessionInfo->RayQueryBuilder)
+		record.GeometryIdx = mSessionInfo->RayQueryBuilder->AddGeometry(record.FaceOffset, record.FaceCount);
 
 	MeshInfo meshInfo{};
-	meshInfo.BeginIndex = static_cast<uint32_t>(NodeCount);
+	meshInfo.BeginIndex = record.NodeOffset;
+	meshInfo.WideRootIndex = record.WideNodeOffset;
 	meshInfo.EndIndex = static_cast<uint32_t>(mSessionInfo->LocalBuffers.Nodes.GetSize());
 
 	mSessionInfo->MeshInfos << std::vector<MeshInfo>({ meshInfo });
+	mSessionInfo->InstanceMotions << std::vector<InstanceMotion>({ InstanceMotion() });
+	mSessionInfo->Renderables.emplace_back(std::move(record));
 }
 
 void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::TraceSession::SubmitLightSrc(const MeshData& meshData,
@@ -49,9 +143,25 @@ void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::TraceSession::SubmitLightSrc(const MeshD
 	auto bvhStruct = std::move(CreateBVH(meshData, bvhDepth));
 
 	size_t NodeCount = mSessionInfo->LocalBuffers.Nodes.GetSize();
+	size_t WideNodeCount = mSessionInfo->LocalBuffers.WideNodes.GetSize();
+	size_t FaceCount = mSessionInfo->LocalBuffers.Faces.GetSize();
+
+	// Every triangle of the light src becomes an emitter of the light tree
+	for (size_t i = 0; i < bvhStruct.Faces.size(); i++)
+	{
+		const glm::uvec4& indices = bvhStruct.Faces[i].Indices;
+
+		mSessionInfo->LightTreeBuilder.AddTriangleEmitter(bvhStruct.Vertices[indices.x],
+			bvhStruct.Vertices[indices.y], bvhStruct.Vertices[indices.z],
+			static_cast<uint32_t>(FaceCount + i), lightIntensity);
+	}
 
 	CopyAllVertexAttribs(bvhStruct, meshData, RenderableType::eLightSrc);
 
+	if (mSessionInfo->RayQueryBuilder)
+		mSessionInfo->RayQueryBuilder->AddGeometry(static_cast<uint32_t>(FaceCount),
+			static_cast<uint32_t>(bvhStruct.Faces.size()));
+
 	LightProperties props;
 	props.Color = lightIntensity;
 
@@ -59,12 +169,21 @@ void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::TraceSession::SubmitLightSrc(const MeshD
 
 	LightInfo lightInfo{};
 	lightInfo.BeginIndex = static_cast<uint32_t>(NodeCount);
+	lightInfo.WideRootIndex = static_cast<uint32_t>(WideNodeCount);
 	lightInfo.EndIndex = static_cast<uint32_t>(mSessionInfo->SharedBuffers.Nodes.GetSize());
 	lightInfo.LightPropIndex = static_cast<uint32_t>(mSessionInfo->LightPropsInfos.GetSize() - 1);
 
 	mSessionInfo->LightInfos << std::vector<LightInfo>({ lightInfo });
 }
 
+void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::TraceSession::SubmitPointLight(const glm::vec3& position, const glm::vec3& intensity)
+{
+	_STL_ASSERT(mSessionInfo->State == TraceSessionState::eOpenScope,
+		"SubmitPointLight method requires the WavefrontEstimator to be in eOpenScope state!");
+
+	mSessionInfo->LightTreeBuilder.AddPointEmitter(position, intensity);
+}
+
 void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::TraceSession::End()
 {
 	_STL_ASSERT(mSessionInfo->State == TraceSessionState::eOpenScope,
@@ -77,11 +196,124 @@ void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::TraceSession::End()
 	// For now, it has been done in submit functions...
 
 	UpdateSceneBuffers();
+	UpdateLightTree();
 
+	if (mSessionInfo->RayQueryBuilder)
+		BuildAccelerationStructures();
 
 	mSessionInfo->State = TraceSessionState::eReady;
 }
 
+void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::TraceSession::UpdateRenderable(uint32_t renderableIdx, const MeshData& meshData)
+{
+	_STL_ASSERT(mSessionInfo->State == TraceSessionState::eReady ||
+		mSessionInfo->State == TraceSessionState::eTracing,
+		"UpdateRenderable method requires the WavefrontEstimator to be in eReady/eTracing state!");
+	_STL_ASSERT(renderableIdx < mSessionInfo->Renderables.size(), "Renderable index out of range!");
+
+	RenderableRecord& record = mSessionInfo->Renderables[renderableIdx];
+
+	_STL_ASSERT(record.Deformable, "Only the renderables submitted as deformable can be updated!");
+	_STL_ASSERT(record.VertexCount == meshData.aPositions.size() && record.FaceCount == meshData.aFaces.size(),
+		"UpdateRenderable can't change the topology of a renderable, resubmit it instead!");
+
+	WriteVertexAttrib(mSessionInfo->SharedBuffers.Vertices, mSessionInfo->LocalBuffers.Vertices, record.VertexOffset,
+		meshData.aPositions.begin(), meshData.aPositions.end(),
+		[](glm::vec4* BeginDevice, glm::vec4* EndDevice,
+			const glm::vec3* BeginHost, const glm::vec3* EndHost)
+	{
+		while (BeginDevice != EndDevice)
+		{
+			*BeginDevice = glm::vec4(*BeginHost, 1.0f);
+
+			BeginDevice++;
+			BeginHost++;
+		}
+	});
+
+	if (meshData.aNormals.size() == record.VertexCount)
+	{
+		WriteVertexAttrib(mSessionInfo->SharedBuffers.Normals, mSessionInfo->LocalBuffers.Normals, record.VertexOffset,
+			meshData.aNormals.begin(), meshData.aNormals.end(),
+			[](glm::vec4* BeginDevice, glm::vec4* EndDevice,
+				const glm::vec3* BeginHost, const glm::vec3* EndHost)
+		{
+			while (BeginDevice != EndDevice)
+			{
+				*BeginDevice = glm::vec4(*BeginHost, 1.0f);
+
+				BeginDevice++;
+				BeginHost++;
+			}
+		});
+	}
+
+	if (meshData.aTangents.size() == record.VertexCount)
+	{
+		std::vector<glm::vec4> tangents = PackTangents(meshData, record.VertexCount);
+
+		WriteVertexAttrib(mSessionInfo->SharedBuffers.Tangents, mSessionInfo->LocalBuffers.Tangents, record.VertexOffset,
+			tangents.begin(), tangents.end(),
+			[](glm::vec4* BeginDevice, glm::vec4* EndDevice,
+				const glm::vec4* BeginHost, const glm::vec4* EndHost)
+		{
+			std::copy(BeginHost, EndHost, BeginDevice);
+		});
+	}
+
+	if (record.BuildMode == BVHBuildMode::eGPU)
+	{
+		BuildBVHOnGPU(record.FaceCount, record.FaceOffset, record.NodeOffset, record.WideNodeOffset);
+	}
+	else
+	{
+		record.HostBVH.Vertices = meshData.aPositions;
+		RefitRenderable(record);
+	}
+
+	if (mSessionInfo->RayQueryBuilder)
+		BuildAccelerationStructures(&record);
+
+	// The paths traced so far saw the old geometry
+	if (mSessionInfo->State == TraceSessionState::eTracing)
+		mSessionInfo->State = TraceSessionState::eReady;
+}
+
+void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::TraceSession::SetRenderableMotion(uint32_t renderableIdx,
+	const glm::mat4& start, const glm::mat4& end)
+{
+	_STL_ASSERT(mSessionInfo->State != TraceSessionState::eReset,
+		"SetRenderableMotion method requires the WavefrontEstimator to be in eOpenScope/eReady/eTracing state!");
+	_STL_ASSERT(renderableIdx < mSessionInfo->Renderables.size(), "Renderable index out of range!");
+
+	InstanceMotion motion{};
+	motion.Moving = 1;
+
+	DecomposeMotionTransform(start, motion.StartTranslation, motion.StartRotation, motion.StartScale);
+	DecomposeMotionTransform(end, motion.EndTranslation, motion.EndRotation, motion.EndScale);
+
+	InstanceMotion* memory = mSessionInfo->InstanceMotions.MapMemory(1, renderableIdx);
+	*memory = motion;
+	mSessionInfo->InstanceMotions.UnmapMemory();
+
+	if (mSessionInfo->State == TraceSessionState::eTracing)
+		mSessionInfo->State = TraceSessionState::eReady;
+}
+
+void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::TraceSession::RemoveRenderableMotion(uint32_t renderableIdx)
+{
+	_STL_ASSERT(mSessionInfo->State != TraceSessionState::eReset,
+		"RemoveRenderableMotion method requires the WavefrontEstimator to be in eOpenScope/eReady/eTracing state!");
+	_STL_ASSERT(renderableIdx < mSessionInfo->Renderables.size(), "Renderable index out of range!");
+
+	InstanceMotion* memory = mSessionInfo->InstanceMotions.MapMemory(1, renderableIdx);
+	*memory = InstanceMotion();
+	mSessionInfo->InstanceMotions.UnmapMemory();
+
+	if (mSessionInfo->State == TraceSessionState::eTracing)
+		mSessionInfo->State = TraceSessionState::eReady;
+}
+
 void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::TraceSession::Clear()
 {
 	_STL_ASSERT(mSessionInfo->State == TraceSessionState::eReady || 
@@ -101,6 +333,75 @@ void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::TraceSession::Reset()
 	mSessionInfo->State = TraceSessionState::eReset;
 }
 
+void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::TraceSession::SetEnvironmentMap(const std::vector<glm::vec4>& radiance,
+	const glm::uvec2& resolution, float rotation)
+{
+	// The buffers may be reallocated, the executors only bind them when they take the session
+	_STL_ASSERT(mSessionInfo->State == TraceSessionState::eOpenScope,
+		"SetEnvironmentMap method requires the WavefrontEstimator to be in eOpenScope state!");
+
+	_STL_ASSERT(radiance.size() == static_cast<size_t>(resolution.x) * resolution.y && !radiance.empty(),
+		"Environment map texels don't match the given resolution!");
+
+	std::vector<float> cdf(resolution.y + static_cast<size_t>(resolution.x) * resolution.y);
+
+	float* marginal = cdf.data();
+	float* conditional = cdf.data() + resolution.y;
+
+	float total = 0.0f;
+
+	for (uint32_t row = 0; row < resolution.y; row++)
+	{
+		// Rows near the poles cover less solid angle
+		float sinTheta = glm::sin(glm::pi<float>() * (static_cast<float>(row) + 0.5f) / static_cast<float>(resolution.y));
+
+		float* rowCDF = conditional + static_cast<size_t>(row) * resolution.x;
+		float rowSum = 0.0f;
+
+		for (uint32_t col = 0; col < resolution.x; col++)
+		{
+			const glm::vec4& texel = radiance[static_cast<size_t>(row) * resolution.x + col];
+
+			rowSum += glm::dot(glm::vec3(texel), glm::vec3(0.2126f, 0.7152f, 0.0722f)) * sinTheta;
+			rowCDF[col] = rowSum;
+		}
+
+		for (uint32_t col = 0; col < resolution.x; col++)
+			rowCDF[col] = rowSum > 0.0f ? rowCDF[col] / rowSum : static_cast<float>(col + 1) / resolution.x;
+
+		total += rowSum;
+		marginal[row] = total;
+	}
+
+	for (uint32_t row = 0; row < resolution.y; row++)
+		marginal[row] = total > 0.0f ? marginal[row] / total : static_cast<float>(row + 1) / resolution.y;
+
+	// Guard against the float round off at the tail
+	marginal[resolution.y - 1] = 1.0f;
+
+	for (uint32_t row = 0; row < resolution.y; row++)
+		conditional[static_cast<size_t>(row) * resolution.x + resolution.x - 1] = 1.0f;
+
+	mSessionInfo->EnvironmentTexels.Clear();
+	mSessionInfo->EnvironmentTexels << radiance;
+
+	mSessionInfo->EnvironmentCDF.Clear();
+	mSessionInfo->EnvironmentCDF << cdf;
+
+	mSessionInfo->EnvironmentResolution = resolution;
+	mSessionInfo->EnvironmentIntegral = total;
+	mSessionInfo->EnvironmentRotation = rotation;
+}
+
+void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::TraceSession::RemoveEnvironmentMap()
+{
+	mSessionInfo->EnvironmentResolution = glm::uvec2(0);
+	mSessionInfo->EnvironmentIntegral = 0.0f;
+
+	if (mSessionInfo->State == TraceSessionState::eTracing)
+		mSessionInfo->State = TraceSessionState::eReady;
+}
+
 void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::TraceSession::SetCameraSpecs(const PhysicalCamera& camera)
 {
 	mSessionInfo->CameraSpecs = camera;
@@ -125,17 +426,29 @@ void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::TraceSession::Cleanup()
 	mSessionInfo->LocalBuffers.Faces.Clear();
 	mSessionInfo->LocalBuffers.Normals.Clear();
 	mSessionInfo->LocalBuffers.TexCoords.Clear();
+	mSessionInfo->LocalBuffers.Tangents.Clear();
 	mSessionInfo->LocalBuffers.Nodes.Clear();
+	mSessionInfo->LocalBuffers.WideNodes.Clear();
 
 	mSessionInfo->SharedBuffers.Vertices.Clear();
 	mSessionInfo->SharedBuffers.Faces.Clear();
 	mSessionInfo->SharedBuffers.Normals.Clear();
 	mSessionInfo->SharedBuffers.TexCoords.Clear();
+	mSessionInfo->SharedBuffers.Tangents.Clear();
 	mSessionInfo->SharedBuffers.Nodes.Clear();
+	mSessionInfo->SharedBuffers.WideNodes.Clear();
 
 	mSessionInfo->MeshInfos.Clear();
+	mSessionInfo->InstanceMotions.Clear();
 	mSessionInfo->LightInfos.Clear();
 	mSessionInfo->LightPropsInfos.Clear();
+
+	mSessionInfo->LightTreeBuilder.Clear();
+
+	mSessionInfo->Renderables.clear();
+
+	if (mSessionInfo->RayQueryBuilder)
+		mSessionInfo->RayQueryBuilder->Clear();
 }
 
 void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::TraceSession::UpdateSceneBuffers()
@@ -144,10 +457,37 @@ void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::TraceSession::UpdateSceneBuffers()
 	mSessionInfo->CameraSpecsBuffer << mSessionInfo->CameraSpecs;
 }
 
+void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::TraceSession::UpdateLightTree()
+{
+	LightTree lightTree = mSessionInfo->LightTreeBuilder.Build();
+
+	mSessionInfo->LightEmitters.Clear();
+	mSessionInfo->LightEmitters << lightTree.Emitters;
+
+	mSessionInfo->LightTree.Clear();
+	mSessionInfo->LightTree << lightTree.Nodes;
+}
+
 AQUA_NAMESPACE::PH_FLUX_NAMESPACE::BVH AQUA_NAMESPACE::PH_FLUX_NAMESPACE::TraceSession::CreateBVH(
-	const MeshData& meshData, uint32_t bvhDepth)
+	const MeshData& meshData, uint32_t bvhDepth, float spatialSplitBudget, bool cacheable)
 {
-	// TODO: Here, we could use GPU to create BVH tree and store it ahead of time!
+	BVHBuildSettings settings{};
+	settings.Depth = bvhDepth;
+	settings.SpatialSplitBudget = spatialSplitBudget;
+
+	uint64_t cacheKey = 0;
+	cacheable = cacheable && !mSessionInfo->Cache.GetDirectory().empty();
+
+	if (cacheable)
+	{
+		cacheKey = BVHCache::HashKey(meshData, settings);
+
+		BVH cached{};
+
+		if (mSessionInfo->Cache.Load(cacheKey, meshData, cached))
+			return cached;
+	}
+
 	BVHFactory bvhFactory;
 
 	SplitStrategy strategy{};
@@ -155,19 +495,121 @@ AQUA_NAMESPACE::PH_FLUX_NAMESPACE::BVH AQUA_NAMESPACE::PH_FLUX_NAMESPACE::TraceS
 
 	bvhFactory.SetSplitStrategy(strategy);
 	bvhFactory.SetDepth(bvhDepth);
+	bvhFactory.SetSpatialSplitBudget(spatialSplitBudget);
 
 	BVH bvhStruct = bvhFactory.Build(meshData.aPositions.begin(), meshData.aPositions.end(),
 		meshData.aFaces.begin(), meshData.aFaces.end());
 
+	// The wide nodes point into the same face order, so both trees can live side by side
+	WideBVHFactory wideFactory;
+	bvhStruct.WideNodes = wideFactory.Build(bvhStruct.Nodes);
+
+	// A failed write only costs us the next build
+	if (cacheable)
+		mSessionInfo->Cache.Store(cacheKey, bvhStruct);
+
 	return bvhStruct;
 }
 
+void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::TraceSession::RefitRenderable(RenderableRecord& record)
+{
+	BVHFactory bvhFactory;
+	bvhFactory.Refit(record.HostBVH);
+
+	float cost = BVHFactory::SAHCost(record.HostBVH);
+
+	if (cost > mSessionInfo->RebuildThreshold * record.BuildCost)
+	{
+		RebuildRenderable(record);
+		return;
+	}
+
+	// Same topology, so the wide tree collapses into the same number of nodes
+	WideBVHFactory wideFactory;
+	record.HostBVH.WideNodes = wideFactory.Build(record.HostBVH.Nodes);
+
+	WriteBVHNodes(record.HostBVH, record.FaceOffset, record.NodeOffset, record.WideNodeOffset);
+}
+
+void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::TraceSession::RebuildRenderable(RenderableRecord& record)
+{
+	MeshData meshData{};
+	meshData.aPositions = std::move(record.HostBVH.Vertices);
+	meshData.aFaces = std::move(record.HostBVH.Faces);
+
+	record.HostBVH = CreateBVH(meshData, record.BVHDepth, 0.0f, false);
+	record.BuildCost = BVHFactory::SAHCost(record.HostBVH);
+
+	_STL_ASSERT(record.HostBVH.Nodes.size() <= record.NodeCapacity &&
+		record.HostBVH.WideNodes.size() <= record.WideNodeCapacity,
+		"Rebuilt BVH doesn't fit into the reserved node range!");
+
+	// The build reorders the faces
+	uint32_t instanceIndex = static_cast<uint32_t>(&record - mSessionInfo->Renderables.data());
+
+	WriteFaces(record.HostBVH.Faces, record.FaceOffset, record.VertexOffset, RenderableType::eObject, instanceIndex);
+	WriteBVHNodes(record.HostBVH, record.FaceOffset, record.NodeOffset, record.WideNodeOffset);
+}
+
+void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::TraceSession::BuildBVHOnGPU(
+	uint32_t faceCount, uint32_t faceOffset, uint32_t nodeOffset, uint32_t wideNodeOffset)
+{
+	GeometryBuffers& localBuffers = mSessionInfo->LocalBuffers;
+
+	// Only ever grows, a rebuild of an earlier renderable must not cut off the nodes of the later ones
+	localBuffers.Nodes.Resize(std::max(localBuffers.Nodes.GetSize(),
+		static_cast<size_t>(nodeOffset + LBVHBuilder::GetNodeCount(faceCount))));
+	localBuffers.WideNodes.Resize(std::max(localBuffers.WideNodes.GetSize(),
+		static_cast<size_t>(wideNodeOffset + LBVHBuilder::GetWideNodeCount(faceCount))));
+
+	LBVHBuildInfo buildInfo{};
+	buildInfo.Geometry = localBuffers;
+	buildInfo.FaceCount = faceCount;
+	buildInfo.FaceOffset = faceOffset;
+	buildInfo.NodeOffset = nodeOffset;
+	buildInfo.WideNodeOffset = wideNodeOffset;
+
+	vk::CommandBuffer cmd = mSessionInfo->BuildCmd;
+
+	cmd.reset();
+	cmd.begin({ vk::CommandBufferUsageFlagBits::eOneTimeSubmit });
+
+	mSessionInfo->GPUBuilder->Record(cmd, buildInfo);
+
+	cmd.end();
+
+	// The builder's scratch buffers are shared by all meshes, so wait before the next submission
+	uint32_t queueIdx = mSessionInfo->BuildWorkers.SubmitWork(cmd);
+	mSessionInfo->BuildWorkers[queueIdx]->WaitIdle();
+}
+
+void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::TraceSession::BuildAccelerationStructures(const RenderableRecord* record)
+{
+	vk::CommandBuffer cmd = mSessionInfo->BuildCmd;
+
+	cmd.reset();
+	cmd.begin({ vk::CommandBufferUsageFlagBits::eOneTimeSubmit });
+
+	// Faces may have been reordered by a rebuild, so the indices are always packed again
+	if (record)
+		mSessionInfo->RayQueryBuilder->RecordUpdate(cmd, mSessionInfo->LocalBuffers, record->GeometryIdx);
+	else
+		mSessionInfo->RayQueryBuilder->Record(cmd, mSessionInfo->LocalBuffers);
+
+	cmd.end();
+
+	// Scratch and instance buffers are reused by the next build
+	uint32_t queueIdx = mSessionInfo->BuildWorkers.SubmitWork(cmd);
+	mSessionInfo->BuildWorkers[queueIdx]->WaitIdle();
+}
+
 void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::TraceSession::CopyAllVertexAttribs(BVH& bvhStruct,
 	const MeshData& meshData, RenderableType renderableType)
 {
 	size_t VertexCount = mSessionInfo->LocalBuffers.Vertices.GetSize();
 	size_t FaceCount = mSessionInfo->LocalBuffers.Faces.GetSize();
 	size_t NodeCount = mSessionInfo->LocalBuffers.Nodes.GetSize();
+	size_t WideNodeCount = mSessionInfo->LocalBuffers.WideNodes.GetSize();
 
 	CopyVertexAttrib(mSessionInfo->SharedBuffers.Vertices, mSessionInfo->LocalBuffers.Vertices,
 		bvhStruct.Vertices.begin(), bvhStruct.Vertices.end(),
@@ -183,8 +625,22 @@ void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::TraceSession::CopyAllVertexAttribs(BVH&
 		}
 	});
 
+	// Every attribute is written for every vertex, zero filled where the mesh has none,
+	// so that the vertex indices of the faces stay valid across all the attribute buffers
+	size_t MeshVertexCount = bvhStruct.Vertices.size();
+
+	std::vector<glm::vec3> MissingAttribs;
+
+	if (meshData.aNormals.size() != MeshVertexCount || meshData.aTexCoords.size() != MeshVertexCount)
+		MissingAttribs.resize(MeshVertexCount, glm::vec3(0.0f));
+
+	const std::vector<glm::vec3>& Normals = meshData.aNormals.size() == MeshVertexCount ?
+		meshData.aNormals : MissingAttribs;
+	const std::vector<glm::vec3>& TexCoords = meshData.aTexCoords.size() == MeshVertexCount ?
+		meshData.aTexCoords : MissingAttribs;
+
 	CopyVertexAttrib(mSessionInfo->SharedBuffers.Normals, mSessionInfo->LocalBuffers.Normals,
-		meshData.aNormals.begin(), meshData.aNormals.end(),
+		Normals.begin(), Normals.end(),
 		[](glm::vec4* BeginDevice, glm::vec4* EndDevice,
 			const glm::vec3* BeginHost, const glm::vec3* EndHost)
 	{
@@ -198,7 +654,7 @@ void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::TraceSession::CopyAllVertexAttribs(BVH&
 	});
 
 	CopyVertexAttrib(mSessionInfo->SharedBuffers.TexCoords, mSessionInfo->LocalBuffers.TexCoords,
-		meshData.aTexCoords.begin(), meshData.aTexCoords.end(),
+		TexCoords.begin(), TexCoords.end(),
 		[](glm::vec2* BeginDevice, glm::vec2* EndDevice,
 			const glm::vec3* BeginHost, const glm::vec3* EndHost)
 	{
@@ -211,39 +667,93 @@ void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::TraceSession::CopyAllVertexAttribs(BVH&
 		}
 	});
 
-	CopyVertexAttrib(mSessionInfo->SharedBuffers.Faces, mSessionInfo->LocalBuffers.Faces,
-		bvhStruct.Faces.begin(), bvhStruct.Faces.end(),
-		[VertexCount, renderableType](Face* BeginDevice, Face* EndDevice,
-			Face* BeginHost, Face* EndHost)
+	std::vector<glm::vec4> Tangents = PackTangents(meshData, MeshVertexCount);
+
+	CopyVertexAttrib(mSessionInfo->SharedBuffers.Tangents, mSessionInfo->LocalBuffers.Tangents,
+		Tangents.begin(), Tangents.end(),
+		[](glm::vec4* BeginDevice, glm::vec4* EndDevice,
+			const glm::vec4* BeginHost, const glm::vec4* EndHost)
+	{
+		std::copy(BeginHost, EndHost, BeginDevice);
+	});
+
+	mSessionInfo->LocalBuffers.Faces.Resize(FaceCount + bvhStruct.Faces.size());
+	// Renderables are pushed right after their attributes, so the next mesh index is theirs
+	uint32_t instanceIndex = renderableType == RenderableType::eObject ?
+		static_cast<uint32_t>(mSessionInfo->MeshInfos.GetSize()) : uint32_t(-1);
+
+	WriteFaces(bvhStruct.Faces, FaceCount, VertexCount, renderableType, instanceIndex);
+
+	mSessionInfo->LocalBuffers.Nodes.Resize(NodeCount + bvhStruct.Nodes.size());
+	mSessionInfo->LocalBuffers.WideNodes.Resize(WideNodeCount + bvhStruct.WideNodes.size());
+	WriteBVHNodes(bvhStruct, FaceCount, NodeCount, WideNodeCount);
+}
+
+void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::TraceSession::WriteFaces(const std::vector<Face>& faces,
+	size_t faceOffset, size_t vertexOffset, RenderableType renderableType, uint32_t instanceIndex)
+{
+	WriteVertexAttrib(mSessionInfo->SharedBuffers.Faces, mSessionInfo->LocalBuffers.Faces, faceOffset,
+		faces.begin(), faces.end(),
+		[vertexOffset, renderableType, instanceIndex](Face* BeginDevice, Face* EndDevice,
+			const Face* BeginHost, const Face* EndHost)
 	{
 		while (BeginDevice != EndDevice)
 		{
-			BeginDevice->Indices.x = BeginHost->Indices.x + static_cast<uint32_t>(VertexCount);
-			BeginDevice->Indices.y = BeginHost->Indices.y + static_cast<uint32_t>(VertexCount);
-			BeginDevice->Indices.z = BeginHost->Indices.z + static_cast<uint32_t>(VertexCount);
+			BeginDevice->Indices.x = BeginHost->Indices.x + static_cast<uint32_t>(vertexOffset);
+			BeginDevice->Indices.y = BeginHost->Indices.y + static_cast<uint32_t>(vertexOffset);
+			BeginDevice->Indices.z = BeginHost->Indices.z + static_cast<uint32_t>(vertexOffset);
 
 			BeginDevice->MaterialRef = BeginHost->MaterialRef;
+			BeginDevice->InstanceIndex = instanceIndex;
 			BeginDevice->FaceID = renderableType == RenderableType::eObject ? OBJECT_FACE_ID : LIGHT_FACE_ID;
 
 			BeginDevice++;
 			BeginHost++;
 		}
 	});
+}
 
-	CopyVertexAttrib(mSessionInfo->SharedBuffers.Nodes, mSessionInfo->LocalBuffers.Nodes,
+void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::TraceSession::WriteBVHNodes(const BVH& bvhStruct,
+	size_t faceOffset, size_t nodeOffset, size_t wideNodeOffset)
+{
+	WriteVertexAttrib(mSessionInfo->SharedBuffers.Nodes, mSessionInfo->LocalBuffers.Nodes, nodeOffset,
 		bvhStruct.Nodes.begin(), bvhStruct.Nodes.end(),
-		[FaceCount, NodeCount](Node* BeginDevice, Node* EndDevice,
-			Node* BeginHost, Node* EndHost)
+		[faceOffset, nodeOffset](Node* BeginDevice, Node* EndDevice,
+			const Node* BeginHost, const Node* EndHost)
+	{
+		while (BeginDevice != EndDevice)
+		{
+			Node node = *BeginHost;
+
+			node.BeginIndex += static_cast<uint32_t>(faceOffset);
+			node.EndIndex += static_cast<uint32_t>(faceOffset);
+
+			node.FirstChildIndex += static_cast<uint32_t>(nodeOffset);
+			node.SecondChildIndex += static_cast<uint32_t>(nodeOffset);
+
+			*BeginDevice = node;
+
+			BeginDevice++;
+			BeginHost++;
+		}
+	});
+
+	WriteVertexAttrib(mSessionInfo->SharedBuffers.WideNodes, mSessionInfo->LocalBuffers.WideNodes, wideNodeOffset,
+		bvhStruct.WideNodes.begin(), bvhStruct.WideNodes.end(),
+		[faceOffset, wideNodeOffset](WideNode* BeginDevice, WideNode* EndDevice,
+			const WideNode* BeginHost, const WideNode* EndHost)
 	{
 		while (BeginDevice != EndDevice)
 		{
-			Node& node = *BeginHost;
+			WideNode node = *BeginHost;
 
-			node.BeginIndex += static_cast<uint32_t>(FaceCount);
-			node.EndIndex += static_cast<uint32_t>(FaceCount);
+			for (int i = 0; i < WIDE_BVH_WIDTH; i++)
+			{
+				if (node.ChildIndex[i] == WIDE_BVH_INVALID_CHILD)
+					continue;
 
-			node.FirstChildIndex += static_cast<uint32_t>(NodeCount);
-			node.SecondChildIndex += static_cast<uint32_t>(NodeCount);
+				node.ChildIndex[i] += static_cast<uint32_t>(node.ChildFaceCount[i] == 0 ? wideNodeOffset : faceOffset);
+			}
 
 			*BeginDevice = node;
 
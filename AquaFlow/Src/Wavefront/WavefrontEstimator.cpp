@@ -11,6 +11,16 @@ AQUA_NAMESPACE::PH_FLUX_NAMESPACE::WavefrontEstimator::WavefrontEstimator(
 	mResourcePool = mCreateInfo.Context.CreateResourcePool();
 	mPipelineBuilder = mCreateInfo.Context.MakePipelineBuilder();
 
+	// Settled once here, every pipeline and session of the estimator uses the same backend
+	if (mCreateInfo.MotionBlur)
+		mCreateInfo.Backend = IntersectionBackend::eCompute;
+
+	if (mCreateInfo.Backend != IntersectionBackend::eCompute)
+	{
+		mCreateInfo.Backend = AccelerationStructureBuilder::IsSupported(mCreateInfo.Context) ?
+			IntersectionBackend::eRayQuery : IntersectionBackend::eCompute;
+	}
+
 	MAT_NAMESPACE::MaterialAssembler assembler{};
 	assembler.SetPipelineBuilder(mPipelineBuilder);
 
@@ -29,6 +39,29 @@ AQUA_NAMESPACE::PH_FLUX_NAMESPACE::TraceSession AQUA_NAMESPACE::PH_FLUX_NAMESPAC
 
 	CreateTraceBuffers(*traceSession.mSessionInfo);
 
+	LBVHPipelines lbvhPipelines{};
+	lbvhPipelines.CentroidBounds = mPipelineBuilder.BuildComputePipeline<LBVHBuildPipeline>(GetLBVHShader(LBVHStage::eCentroidBounds));
+	lbvhPipelines.MortonCodes = mPipelineBuilder.BuildComputePipeline<LBVHBuildPipeline>(GetLBVHShader(LBVHStage::eMortonCodes));
+	lbvhPipelines.Hierarchy = mPipelineBuilder.BuildComputePipeline<LBVHBuildPipeline>(GetLBVHShader(LBVHStage::eHierarchy));
+	lbvhPipelines.Refit = mPipelineBuilder.BuildComputePipeline<LBVHBuildPipeline>(GetLBVHShader(LBVHStage::eRefit));
+	lbvhPipelines.Collapse = mPipelineBuilder.BuildComputePipeline<LBVHBuildPipeline>(GetLBVHShader(LBVHStage::eCollapse));
+
+	SessionInfo& session = *traceSession.mSessionInfo;
+
+	session.GPUBuilder = std::make_shared<LBVHBuilder>(mPipelineBuilder, mResourcePool,
+		lbvhPipelines, mCreateInfo.IntersectionWorkgroupSize);
+
+	session.BuildCmdAlloc = mCreateInfo.Context.CreateCommandPools()[0];
+	session.BuildWorkers = mCreateInfo.Context.FetchExecutor(0, vkLib::QueueAccessType::eGeneric);
+	session.BuildCmd = session.BuildCmdAlloc.Allocate();
+
+	if (mCreateInfo.Backend == IntersectionBackend::eRayQuery)
+	{
+		session.RayQueryBuilder = std::make_shared<AccelerationStructureBuilder>(mCreateInfo.Context, mResourcePool,
+			mPipelineBuilder.BuildComputePipeline<FaceIndexPackPipeline>(GetFaceIndexPackShader()),
+			mCreateInfo.IntersectionWorkgroupSize);
+	}
+
 	return traceSession;
 }
 
@@ -42,7 +75,12 @@ std::expected<::AQUA_NAMESPACE::MaterialInstance, vkLib::CompileError>
 	* RR_CUTOFF_CONST
 	*/
 
-	return mMaterialSystem.BuildRTInstance(createInfo);
+	// The indirect dispatch arguments are written for a single work group size
+	RTMaterialCreateInfo materialInfo = createInfo;
+	materialInfo.WorkGroupSize = mCreateInfo.MaterialEvalWorkgroupSize;
+	materialInfo.MotionBlur = mCreateInfo.MotionBlur;
+
+	return mMaterialSystem.BuildRTInstance(materialInfo);
 }
 
 AQUA_NAMESPACE::PH_FLUX_NAMESPACE::Executor AQUA_NAMESPACE::PH_FLUX_NAMESPACE::WavefrontEstimator::CreateExecutor(const ExecutorCreateInfo& createInfo)
@@ -70,12 +108,110 @@ AQUA_NAMESPACE::PH_FLUX_NAMESPACE::Executor AQUA_NAMESPACE::PH_FLUX_NAMESPACE::W
 	return executor;
 }
 
+AQUA_NAMESPACE::PH_FLUX_NAMESPACE::TileScheduler AQUA_NAMESPACE::PH_FLUX_NAMESPACE::WavefrontEstimator::CreateTileScheduler(
+	const TileSchedulerCreateInfo& createInfo)
+{
+	_STL_ASSERT(createInfo.TileSize.x > 0 && createInfo.TileSize.y > 0, "Tile size must be positive!");
+
+	TileScheduler scheduler{};
+	scheduler.mCreateInfo = createInfo;
+	scheduler.SplitTarget();
+
+	// Every slot gets a queue of its own; without dedicated workers the generic queues are shared out
+	auto workers = mCreateInfo.Context.FetchExecutor(0, vkLib::QueueAccessType::eWorker);
+
+	size_t workerCount = workers.GetWorkerQueueCount();
+	size_t workerBegin = workers.GetQueueCount() - workerCount;
+
+	if (workerCount == 0)
+	{
+		workerBegin = 0;
+		workerCount = workers.GetQueueCount();
+	}
+
+	size_t slotCount = createInfo.TilesInFlight == 0 ? workerCount : createInfo.TilesInFlight;
+	slotCount = glm::max<size_t>(glm::min(slotCount, scheduler.mTiles.size()), 1);
+
+	ExecutorCreateInfo executorInfo{};
+	executorInfo.TargetResolution = createInfo.TargetResolution;
+	executorInfo.TileSize = createInfo.TileSize;
+	executorInfo.AllowSorting = createInfo.AllowSorting;
+	executorInfo.SamplesPerPixel = createInfo.SamplesPerPixel;
+
+	scheduler.mSlots.reserve(slotCount);
+
+	for (size_t i = 0; i < slotCount; i++)
+		scheduler.mSlots.push_back({ CreateExecutor(executorInfo), workers[workerBegin + i % workerCount] });
+
+	vkLib::ImageCreateInfo imageInfo{};
+	imageInfo.Extent = vk::Extent3D(createInfo.TargetResolution.x, createInfo.TargetResolution.y, 1);
+	imageInfo.Format = vk::Format::eR8G8B8A8Unorm;
+	imageInfo.MemProps = vk::MemoryPropertyFlagBits::eDeviceLocal;
+	imageInfo.Type = vk::ImageType::e2D;
+	imageInfo.Usage = vk::ImageUsageFlagBits::eStorage | vk::ImageUsageFlagBits::eTransferDst |
+		vk::ImageUsageFlagBits::eTransferSrc;
+
+	scheduler.mTarget = mResourcePool.CreateImage(imageInfo);
+	scheduler.mTarget.TransitionLayout(vk::ImageLayout::eGeneral, vk::PipelineStageFlagBits::eTopOfPipe);
+
+	// The post process runs once over the whole target, on the means gathered from the tiles
+	imageInfo.Format = vk::Format::eR32G32B32A32Sfloat;
+	imageInfo.Usage = vk::ImageUsageFlagBits::eStorage | vk::ImageUsageFlagBits::eSampled |
+		vk::ImageUsageFlagBits::eTransferDst;
+
+	scheduler.mTargetMean = mResourcePool.CreateImage(imageInfo);
+	scheduler.mTargetMean.TransitionLayout(vk::ImageLayout::eGeneral, vk::PipelineStageFlagBits::eTopOfPipe);
+
+	vkLib::SamplerInfo samplerInfo{};
+	samplerInfo.MagFilter = vk::Filter::eNearest;
+	samplerInfo.MinFilter = vk::Filter::eNearest;
+
+	scheduler.mExposure = CreateExposureResources(mResourcePool);
+	ResetExposure(scheduler.mExposure, glm::uvec2(createInfo.TargetResolution), {});
+
+	scheduler.mExposurePipeline = mPipelineBuilder.BuildComputePipeline<ExposurePipeline>(GetAutoExposureShader());
+	scheduler.mExposurePipeline.SetInfo(scheduler.mExposure.Info);
+	scheduler.mExposurePipeline.SetSource(scheduler.mTargetMean.GetIdentityImageView(), mResourcePool.CreateSampler(samplerInfo));
+	scheduler.mExposurePipeline.SetHistogram(scheduler.mExposure.Histogram);
+	scheduler.mExposurePipeline.SetState(scheduler.mExposure.State);
+	scheduler.mExposurePipeline.UpdateDescriptors();
+
+	scheduler.mPostProcessor = mPipelineBuilder.BuildComputePipeline<PostProcessImagePipeline>(GetPostProcessImageShader());
+	scheduler.mPostProcessor.mPresentable = scheduler.mTarget;
+	scheduler.mPostProcessor.mPixelMean = scheduler.mTargetMean;
+	scheduler.mPostProcessor.mExposure = scheduler.mExposure.State;
+	scheduler.mPostProcessor.UpdateDescriptors();
+
+	scheduler.mCmdAlloc = mCreateInfo.Context.CreateCommandPools()[0];
+	scheduler.mPostProcessCmd = scheduler.mCmdAlloc.Allocate();
+
+	scheduler.mCloneMaterial = [this](const MaterialInstance& instance)
+		{ return mMaterialSystem.CloneRTInstance(instance); };
+
+	return scheduler;
+}
+
+AQUA_NAMESPACE::PH_FLUX_NAMESPACE::BatchRenderer AQUA_NAMESPACE::PH_FLUX_NAMESPACE::WavefrontEstimator::CreateBatchRenderer(
+	const TileSchedulerCreateInfo& createInfo)
+{
+	BatchRenderer renderer{};
+	renderer.mScheduler = CreateTileScheduler(createInfo);
+
+	renderer.mReadback = mResourcePool.CreateBuffer<uint32_t>(vk::BufferUsageFlagBits::eTransferDst,
+		vk::MemoryPropertyFlagBits::eHostCoherent);
+
+	renderer.mReadback.Reserve(static_cast<size_t>(createInfo.TargetResolution.x) * createInfo.TargetResolution.y);
+
+	return renderer;
+}
+
 AQUA_NAMESPACE::PH_FLUX_NAMESPACE::ExecutionPipelines AQUA_NAMESPACE::PH_FLUX_NAMESPACE::WavefrontEstimator::CreatePipelines()
 {
 	RTMaterialCreateInfo inactiveMaterialInfo{};
 	inactiveMaterialInfo.PowerHeuristics = 2.0f;
 	inactiveMaterialInfo.ShadingTolerance = 0.001f;
-	inactiveMaterialInfo.WorkGroupSize = mCreateInfo.IntersectionWorkgroupSize;
+	inactiveMaterialInfo.WorkGroupSize = mCreateInfo.MaterialEvalWorkgroupSize;
+	inactiveMaterialInfo.MotionBlur = mCreateInfo.MotionBlur;
 
 	std::string emptyShader = "SampleInfo Evaluate(in Ray ray, in CollisionInfo collisionInfo)"
 		"{ SampleInfo sampleInfo; sampleInfo.Weight = 1.0; sampleInfo.Luminance = vec3(0.0);"
@@ -92,12 +228,22 @@ AQUA_NAMESPACE::PH_FLUX_NAMESPACE::ExecutionPipelines AQUA_NAMESPACE::PH_FLUX_NA
 
 	pipelines.RayGenerator = mPipelineBuilder.BuildComputePipeline<RayGenerationPipeline>(GetRayGenerationShader());
 	pipelines.IntersectionPipeline = mPipelineBuilder.BuildComputePipeline<IntersectionPipeline>(GetIntersectionShader());
+	pipelines.IntersectionPipeline.mWideBVH = mCreateInfo.WideBVH;
+	pipelines.IntersectionPipeline.mBackend = mCreateInfo.Backend;
+	pipelines.IntersectionPipeline.mMotionBlur = mCreateInfo.MotionBlur;
+	pipelines.OcclusionTester = mPipelineBuilder.BuildComputePipeline<OcclusionPipeline>(GetOcclusionShader());
+	pipelines.OcclusionTester.mWideBVH = mCreateInfo.WideBVH;
+	pipelines.OcclusionTester.mBackend = mCreateInfo.Backend;
+	pipelines.OcclusionTester.mMotionBlur = mCreateInfo.MotionBlur;
 	pipelines.RaySortPreparer = mPipelineBuilder.BuildComputePipeline<RaySortEpiloguePipeline>(GetRaySortEpilogueShader(RaySortEvent::ePrepare));
 	pipelines.RaySortFinisher = mPipelineBuilder.BuildComputePipeline<RaySortEpiloguePipeline>(GetRaySortEpilogueShader(RaySortEvent::eFinish));
 	pipelines.RayRefCounter = mPipelineBuilder.BuildComputePipeline<RayRefCounterPipeline>(GetRayRefCounterShader());
 	pipelines.PrefixSummer = mPipelineBuilder.BuildComputePipeline<PrefixSumPipeline>(GetPrefixSumShader());
 	pipelines.InactiveRayShader = *CreateMaterialInstance(inactiveMaterialInfo);
 	pipelines.LuminanceMean = mPipelineBuilder.BuildComputePipeline<LuminanceMeanPipeline>(GetLuminanceMeanShader());
+	pipelines.PathRegenerator = mPipelineBuilder.BuildComputePipeline<PathRegenerationPipeline>(GetPathRegenerationShader());
+	pipelines.PathQueueUpdater = mPipelineBuilder.BuildComputePipeline<PathQueuePipeline>(GetPathQueueShader());
+	pipelines.Exposure = mPipelineBuilder.BuildComputePipeline<ExposurePipeline>(GetAutoExposureShader());
 	pipelines.PostProcessor = mPipelineBuilder.BuildComputePipeline<PostProcessImagePipeline>(GetPostProcessImageShader());
 
 	return pipelines;
@@ -112,19 +258,40 @@ void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::WavefrontEstimator::CreateTraceBuffers(S
 	session.SharedBuffers.Faces = mResourcePool.CreateBuffer<Face>(usage, memProps);
 	session.SharedBuffers.TexCoords = mResourcePool.CreateBuffer<glm::vec2>(usage, memProps);
 	session.SharedBuffers.Normals = mResourcePool.CreateBuffer<glm::vec4>(usage, memProps);
+	session.SharedBuffers.Tangents = mResourcePool.CreateBuffer<glm::vec4>(usage, memProps);
 	session.SharedBuffers.Nodes = mResourcePool.CreateBuffer<Node>(usage, memProps);
+	session.SharedBuffers.WideNodes = mResourcePool.CreateBuffer<WideNode>(usage, memProps);
 
 	session.MeshInfos = mResourcePool.CreateBuffer<MeshInfo>(usage, memProps);
+	session.InstanceMotions = mResourcePool.CreateBuffer<InstanceMotion>(usage, memProps);
 	session.LightInfos = mResourcePool.CreateBuffer<LightInfo>(usage, memProps);
 	session.LightPropsInfos = mResourcePool.CreateBuffer<LightProperties>(usage, memProps);
 
+	session.LightEmitters = mResourcePool.CreateBuffer<LightEmitter>(usage, memProps);
+	session.LightTree = mResourcePool.CreateBuffer<LightTreeNode>(usage, memProps);
+
+	session.EnvironmentTexels = mResourcePool.CreateBuffer<glm::vec4>(usage, memProps);
+	session.EnvironmentCDF = mResourcePool.CreateBuffer<float>(usage, memProps);
+
+	// Placeholders until an environment map is set
+	session.EnvironmentTexels.Resize(1);
+	session.EnvironmentCDF.Resize(1);
+
 	memProps = vk::MemoryPropertyFlagBits::eDeviceLocal;
 
-	session.LocalBuffers.Vertices = mResourcePool.CreateBuffer<glm::vec4>(usage, memProps);
+	// The acceleration structures are built straight from the session vertices
+	vk::BufferUsageFlags vertexUsage = usage;
+
+	if (mCreateInfo.Backend == IntersectionBackend::eRayQuery)
+		vertexUsage |= AccelerationStructureBuilder::GetVertexBufferUsage();
+
+	session.LocalBuffers.Vertices = mResourcePool.CreateBuffer<glm::vec4>(vertexUsage, memProps);
 	session.LocalBuffers.Faces = mResourcePool.CreateBuffer<Face>(usage, memProps);
 	session.LocalBuffers.TexCoords = mResourcePool.CreateBuffer<glm::vec2>(usage, memProps);
 	session.LocalBuffers.Normals = mResourcePool.CreateBuffer<glm::vec4>(usage, memProps);
+	session.LocalBuffers.Tangents = mResourcePool.CreateBuffer<glm::vec4>(usage, memProps);
 	session.LocalBuffers.Nodes = mResourcePool.CreateBuffer<Node>(usage, memProps);
+	session.LocalBuffers.WideNodes = mResourcePool.CreateBuffer<WideNode>(usage, memProps);
 
 	// SceneInfo and physical camera buffer is a uniform and should be host coherent...
 	usage = vk::BufferUsageFlagBits::eUniformBuffer;
@@ -160,12 +327,31 @@ void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::WavefrontEstimator::CreateExecutorBuffer
 
 	executionInfo.RefCounts = mResourcePool.CreateBuffer<uint32_t>(usage, memProps);
 
-	uint32_t RayCount = executorInfo.TargetResolution.x * executorInfo.TargetResolution.y;
+	// One path slot per pixel of the tile
+	uint32_t RayCount = executorInfo.TileSize.x * executorInfo.TileSize.y;
 
 	executionInfo.Rays.Resize(2 * RayCount);
 	executionInfo.RayInfos.Resize(2 * RayCount);
 	executionInfo.CollisionInfos.Resize(2 * RayCount);
 
+	executionInfo.SampleAccumulator = mResourcePool.CreateBuffer<glm::uvec4>(usage, memProps);
+	executionInfo.SampleAccumulator << std::vector<glm::uvec4>(RayCount, glm::uvec4(0));
+
+	// Both start out empty, the regeneration pass clears every slot it consumes
+	executionInfo.ShadowRays = mResourcePool.CreateBuffer<ShadowRay>(usage, memProps);
+	executionInfo.ShadowRays << std::vector<ShadowRay>(RayCount);
+
+	executionInfo.OcclusionMask = mResourcePool.CreateBuffer<uint32_t>(usage, memProps);
+	executionInfo.OcclusionMask << std::vector<uint32_t>((RayCount + 31) / 32, 0);
+
+	// The path queue also feeds the indirect dispatches of the intersection and material stages
+	executionInfo.PathQueue = mResourcePool.CreateBuffer<PathQueue>(
+		usage | vk::BufferUsageFlagBits::eIndirectBuffer, memProps);
+	executionInfo.PathQueue.Resize(1);
+
+	executionInfo.Exposure = CreateExposureResources(mResourcePool);
+	ResetExposure(executionInfo.Exposure, glm::uvec2(executorInfo.TileSize), {});
+
 	usage = vk::BufferUsageFlagBits::eUniformBuffer;
 	memProps = vk::MemoryPropertyFlagBits::eHostCoherent;
 
@@ -181,16 +367,26 @@ void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::WavefrontEstimator::CreateExecutorImages
 	imageInfo.Format = vk::Format::eR32G32B32A32Sfloat;
 	imageInfo.MemProps = vk::MemoryPropertyFlagBits::eDeviceLocal;
 	imageInfo.Type = vk::ImageType::e2D;
-	imageInfo.Usage = vk::ImageUsageFlagBits::eStorage;
+	// The tile schedulers gather the means of the tiles when they post process the target
+	imageInfo.Usage = vk::ImageUsageFlagBits::eStorage | vk::ImageUsageFlagBits::eSampled |
+		vk::ImageUsageFlagBits::eTransferSrc;
 
 	executionInfo.Target.PixelMean = mResourcePool.CreateImage(imageInfo);
 	executionInfo.Target.PixelVariance = mResourcePool.CreateImage(imageInfo);
 
+	// The tile schedulers copy it into the full target
 	imageInfo.Format = vk::Format::eR8G8B8A8Unorm;
+	imageInfo.Usage = vk::ImageUsageFlagBits::eStorage | vk::ImageUsageFlagBits::eTransferSrc;
 	executionInfo.Target.Presentable = mResourcePool.CreateImage(imageInfo);
 
 	executionInfo.Target.ImageResolution = executorInfo.TargetResolution;
 
+	vkLib::SamplerInfo samplerInfo{};
+	samplerInfo.MagFilter = vk::Filter::eNearest;
+	samplerInfo.MinFilter = vk::Filter::eNearest;
+
+	executionInfo.Target.MeanSampler = mResourcePool.CreateSampler(samplerInfo);
+
 	executionInfo.Target.PixelMean.TransitionLayout(
 		vk::ImageLayout::eGeneral, vk::PipelineStageFlagBits::eTopOfPipe);
 
@@ -215,10 +411,13 @@ void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::WavefrontEstimator::RetrieveFrontAndBack
 
 	// All the front shaders and custom libraries...
 	AddText(mShaderFrontEnd, GetShaderDirectory() + "Wavefront/Common.glsl");
+	AddText(mShaderFrontEnd, GetShaderDirectory() + "Wavefront/Motion.glsl");
 	AddText(mShaderFrontEnd, GetShaderDirectory() + "BSDFs/CommonBSDF.glsl");
 	AddText(mShaderFrontEnd, GetShaderDirectory() + "BSDFs/BSDF_Samplers.glsl");
 	AddText(mShaderFrontEnd, GetShaderDirectory() + "MaterialShaders/ShaderFrontEnd.glsl");
 	AddText(mShaderFrontEnd, GetShaderDirectory() + "BSDFs/Utils.glsl");
+	AddText(mShaderFrontEnd, GetShaderDirectory() + "MaterialShaders/LightTree.glsl");
+	AddText(mShaderFrontEnd, GetShaderDirectory() + "MaterialShaders/EnvironmentMap.glsl");
 
 	/* TODO: This is temporary, should be dealt by an import system */
 
@@ -280,6 +479,7 @@ vkLib::PShader AQUA_NAMESPACE::PH_FLUX_NAMESPACE::WavefrontEstimator::GetRayGene
 	vkLib::PShader shader{};
 
 	shader.AddMacro("WORKGROUP_SIZE", std::to_string(mCreateInfo.RayGenWorkgroupSize.x));
+	shader.AddMacro("MOTION_BLUR", std::to_string(mCreateInfo.MotionBlur ? 1 : 0));
 	shader.SetFilepath("eCompute", GetShaderDirectory() + "Wavefront/RayGeneration.comp", optimizerFlag);
 
 	auto Errors = shader.CompileShaders();
@@ -304,8 +504,14 @@ vkLib::PShader AQUA_NAMESPACE::PH_FLUX_NAMESPACE::WavefrontEstimator::GetInterse
 	shader.AddMacro("TOLERANCE", std::to_string(mCreateInfo.Tolerance));
 	shader.AddMacro("MAX_DIS", std::to_string(FLT_MAX));
 	shader.AddMacro("FLT_MAX", std::to_string(FLT_MAX));
+	shader.AddMacro("WIDE_BVH", std::to_string(mCreateInfo.WideBVH ? 1 : 0));
+	shader.AddMacro("LIGHT_FACE_ID", std::to_string(LIGHT_FACE_ID));
+	shader.AddMacro("MOTION_BLUR", std::to_string(mCreateInfo.MotionBlur ? 1 : 0));
+
+	std::string shaderPath = mCreateInfo.Backend == IntersectionBackend::eRayQuery ?
+		"Wavefront/IntersectionRayQuery.glsl" : "Wavefront/Intersection.glsl";
 
-	shader.SetFilepath("eCompute", GetShaderDirectory() + "Wavefront/Intersection.glsl", OPTIMIZE_INTERSECTION == 1 ?
+	shader.SetFilepath("eCompute", GetShaderDirectory() + shaderPath, OPTIMIZE_INTERSECTION == 1 ?
 		vkLib::OptimizerFlag::eO3 : optimizerFlag);
 
 	auto Errors = shader.CompileShaders();
@@ -318,6 +524,41 @@ vkLib::PShader AQUA_NAMESPACE::PH_FLUX_NAMESPACE::WavefrontEstimator::GetInterse
 	return shader;
 }
 
+vkLib::PShader AQUA_NAMESPACE::PH_FLUX_NAMESPACE::WavefrontEstimator::GetOcclusionShader()
+{
+	vkLib::OptimizerFlag optimizerFlag = vkLib::OptimizerFlag::eO3;
+
+#if _DEBUG
+	optimizerFlag = vkLib::OptimizerFlag::eNone;
+#endif
+
+	vkLib::PShader shader;
+
+	// Dispatched with the intersection arguments of the path queue, so the group sizes must match
+	shader.AddMacro("WORKGROUP_SIZE", std::to_string(mCreateInfo.IntersectionWorkgroupSize));
+	shader.AddMacro("TOLERANCE", std::to_string(mCreateInfo.Tolerance));
+	shader.AddMacro("MAX_DIS", std::to_string(FLT_MAX));
+	shader.AddMacro("FLT_MAX", std::to_string(FLT_MAX));
+	shader.AddMacro("WIDE_BVH", std::to_string(mCreateInfo.WideBVH ? 1 : 0));
+	shader.AddMacro("LIGHT_FACE_ID", std::to_string(LIGHT_FACE_ID));
+	shader.AddMacro("MOTION_BLUR", std::to_string(mCreateInfo.MotionBlur ? 1 : 0));
+
+	std::string shaderPath = mCreateInfo.Backend == IntersectionBackend::eRayQuery ?
+		"Wavefront/OcclusionRayQuery.glsl" : "Wavefront/Occlusion.glsl";
+
+	shader.SetFilepath("eCompute", GetShaderDirectory() + shaderPath, OPTIMIZE_INTERSECTION == 1 ?
+		vkLib::OptimizerFlag::eO3 : optimizerFlag);
+
+	auto Errors = shader.CompileShaders();
+
+	CompileErrorChecker checker("Logging/ShaderFails/Shader.glsl");
+
+	auto ErrorInfos = checker.GetErrors(Errors);
+	checker.AssertOnError(ErrorInfos);
+
+	return shader;
+}
+
 vkLib::PShader AQUA_NAMESPACE::PH_FLUX_NAMESPACE::WavefrontEstimator::GetRaySortEpilogueShader(RaySortEvent sortEvent)
 {
 	vkLib::OptimizerFlag optimizerFlag = vkLib::OptimizerFlag::eO3;
@@ -368,6 +609,7 @@ vkLib::PShader AQUA_NAMESPACE::PH_FLUX_NAMESPACE::WavefrontEstimator::GetRayRefC
 
 	shader.AddMacro("WORKGROUP_SIZE", std::to_string(mCreateInfo.IntersectionWorkgroupSize));
 	shader.AddMacro("PRIMITIVE_TYPE", "uint");
+	shader.AddMacro("LIVE_COUNT", "1");
 
 	shader.SetFilepath("eCompute", GetShaderDirectory() + "Utils/CountElements.glsl", optimizerFlag);
 
@@ -427,6 +669,127 @@ vkLib::PShader AQUA_NAMESPACE::PH_FLUX_NAMESPACE::WavefrontEstimator::GetLuminan
 	return shader;
 }
 
+vkLib::PShader AQUA_NAMESPACE::PH_FLUX_NAMESPACE::WavefrontEstimator::GetPathRegenerationShader()
+{
+	vkLib::OptimizerFlag optimizerFlag = vkLib::OptimizerFlag::eO3;
+
+#if _DEBUG
+	optimizerFlag = vkLib::OptimizerFlag::eNone;
+#endif
+
+	vkLib::PShader shader;
+
+	shader.AddMacro("WORKGROUP_SIZE", std::to_string(mCreateInfo.IntersectionWorkgroupSize));
+	shader.AddMacro("MOTION_BLUR", std::to_string(mCreateInfo.MotionBlur ? 1 : 0));
+	shader.SetFilepath("eCompute", GetShaderDirectory() + "Wavefront/RegeneratePaths.glsl", optimizerFlag);
+
+	auto Errors = shader.CompileShaders();
+
+	CompileErrorChecker checker("Logging/ShaderFails/Shader.glsl");
+
+	auto ErrorInfos = checker.GetErrors(Errors);
+	checker.AssertOnError(ErrorInfos);
+
+	return shader;
+}
+
+vkLib::PShader AQUA_NAMESPACE::PH_FLUX_NAMESPACE::WavefrontEstimator::GetPathQueueShader()
+{
+	vkLib::OptimizerFlag optimizerFlag = vkLib::OptimizerFlag::eO3;
+
+#if _DEBUG
+	optimizerFlag = vkLib::OptimizerFlag::eNone;
+#endif
+
+	vkLib::PShader shader;
+
+	shader.AddMacro("INTERSECTION_WORKGROUP_SIZE", std::to_string(mCreateInfo.IntersectionWorkgroupSize));
+	shader.AddMacro("MATERIAL_WORKGROUP_SIZE", std::to_string(mCreateInfo.MaterialEvalWorkgroupSize));
+	shader.SetFilepath("eCompute", GetShaderDirectory() + "Wavefront/UpdatePathQueue.glsl", optimizerFlag);
+
+	auto Errors = shader.CompileShaders();
+
+	CompileErrorChecker checker("Logging/ShaderFails/Shader.glsl");
+
+	auto ErrorInfos = checker.GetErrors(Errors);
+	checker.AssertOnError(ErrorInfos);
+
+	return shader;
+}
+
+vkLib::PShader AQUA_NAMESPACE::PH_FLUX_NAMESPACE::WavefrontEstimator::GetLBVHShader(LBVHStage stage)
+{
+	vkLib::OptimizerFlag optimizerFlag = vkLib::OptimizerFlag::eO3;
+
+#if _DEBUG
+	optimizerFlag = vkLib::OptimizerFlag::eNone;
+#endif
+
+	std::string filename;
+
+	switch (stage)
+	{
+		case LBVHStage::eCentroidBounds:
+			filename = "BVH/CentroidBounds.glsl";
+			break;
+		case LBVHStage::eMortonCodes:
+			filename = "BVH/MortonCodes.glsl";
+			break;
+		case LBVHStage::eHierarchy:
+			filename = "BVH/BuildHierarchy.glsl";
+			break;
+		case LBVHStage::eRefit:
+			filename = "BVH/RefitBounds.glsl";
+			break;
+		case LBVHStage::eCollapse:
+			filename = "BVH/CollapseWide.glsl";
+			break;
+		default:
+			_STL_ASSERT(false, "Invalid LBVH build stage!");
+			break;
+	}
+
+	vkLib::PShader shader;
+
+	shader.AddMacro("WORKGROUP_SIZE", std::to_string(mCreateInfo.IntersectionWorkgroupSize));
+	shader.AddMacro("TOLERANCE", std::to_string(mCreateInfo.Tolerance));
+	shader.AddMacro("FLT_MAX", std::to_string(FLT_MAX));
+	shader.AddMacro("TREE_ROTATIONS", "1");
+	shader.SetFilepath("eCompute", GetShaderDirectory() + filename, optimizerFlag);
+
+	auto Errors = shader.CompileShaders();
+
+	CompileErrorChecker checker("Logging/ShaderFails/Shader.glsl");
+
+	auto ErrorInfos = checker.GetErrors(Errors);
+	checker.AssertOnError(ErrorInfos);
+
+	return shader;
+}
+
+vkLib::PShader AQUA_NAMESPACE::PH_FLUX_NAMESPACE::WavefrontEstimator::GetFaceIndexPackShader()
+{
+	vkLib::OptimizerFlag optimizerFlag = vkLib::OptimizerFlag::eO3;
+
+#if _DEBUG
+	optimizerFlag = vkLib::OptimizerFlag::eNone;
+#endif
+
+	vkLib::PShader shader;
+
+	shader.AddMacro("WORKGROUP_SIZE", std::to_string(mCreateInfo.IntersectionWorkgroupSize));
+	shader.SetFilepath("eCompute", GetShaderDirectory() + "BVH/PackFaceIndices.glsl", optimizerFlag);
+
+	auto Errors = shader.CompileShaders();
+
+	CompileErrorChecker checker("Logging/ShaderFails/Shader.glsl");
+
+	auto ErrorInfos = checker.GetErrors(Errors);
+	checker.AssertOnError(ErrorInfos);
+
+	return shader;
+}
+
 vkLib::PShader AQUA_NAMESPACE::PH_FLUX_NAMESPACE::WavefrontEstimator::GetPostProcessImageShader()
 {
 	vkLib::OptimizerFlag optimizerFlag = vkLib::OptimizerFlag::eO3;
@@ -459,3 +822,27 @@ vkLib::PShader AQUA_NAMESPACE::PH_FLUX_NAMESPACE::WavefrontEstimator::GetPostPro
 
 	return shader;
 }
+
+vkLib::PShader AQUA_NAMESPACE::PH_FLUX_NAMESPACE::WavefrontEstimator::GetAutoExposureShader()
+{
+	vkLib::OptimizerFlag optimizerFlag = vkLib::OptimizerFlag::eO3;
+
+#if _DEBUG
+	optimizerFlag = vkLib::OptimizerFlag::eNone;
+#endif
+
+	vkLib::PShader shader;
+
+	// Shared with the deferred back end
+	shader.AddMacro("EXPOSURE_HISTOGRAM_SIZE", std::to_string(EXPOSURE_HISTOGRAM_SIZE));
+	shader.SetFilepath("eCompute", GetShaderDirectory() + "../Utils/AutoExposure.comp", optimizerFlag);
+
+	auto Errors = shader.CompileShaders();
+
+	CompileErrorChecker checker("Logging/ShaderFails/Shader.glsl");
+
+	auto ErrorInfos = checker.GetErrors(Errors);
+	checker.AssertOnError(ErrorInfos);
+
+	return shader;
+}
@@ -20,10 +20,31 @@ void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::IntersectionPipeline::UpdateDescriptors(
 
 	this->UpdateDescriptor({ 0, 2, 0 }, collisionInfo);
 
-	vkLib::UniformBufferWriteInfo sceneInfo{};
-	sceneInfo.Buffer = mSceneInfo.GetNativeHandles().Handle;
+	vkLib::StorageBufferWriteInfo pathQueue{};
+	pathQueue.Buffer = mPathQueue.GetNativeHandles().Handle;
 
-	this->UpdateDescriptor({ 1, 9, 0 }, sceneInfo);
+	this->UpdateDescriptor({ 0, 5, 0 }, pathQueue);
+
+	// The ray query kernel doesn't loop over the meshes and lights
+	if (mBackend != IntersectionBackend::eRayQuery)
+	{
+		vkLib::UniformBufferWriteInfo sceneInfo{};
+		sceneInfo.Buffer = mSceneInfo.GetNativeHandles().Handle;
+
+		this->UpdateDescriptor({ 1, 9, 0 }, sceneInfo);
+	}
+
+	// Motion blur always traces with the compute kernel
+	if (mMotionBlur)
+	{
+		vkLib::StorageBufferWriteInfo storageInfo{};
+
+		storageInfo.Buffer = mRayInfos.GetNativeHandles().Handle;
+		this->UpdateDescriptor({ 0, 4, 0 }, storageInfo);
+
+		storageInfo.Buffer = mInstanceMotions.GetNativeHandles().Handle;
+		this->UpdateDescriptor({ 1, 12, 0 }, storageInfo);
+	}
 
 	UpdateGeometryBuffers();
 }
@@ -58,6 +79,11 @@ void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::IntersectionPipeline::UpdateGeometryBuff
 		Node sNodes[];
 	};
 
+	layout(std430, set = 1, binding = 5) readonly buffer WideNodeBuffer
+	{
+		WideNode sWideNodes[];
+	};
+
 	layout(std430, set = 1, binding = 6) readonly buffer LightPropsBuffer
 	{
 		LightProperties sLightPropsInfos[];
@@ -79,6 +105,19 @@ void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::IntersectionPipeline::UpdateGeometryBuff
 	storageInfo.Buffer = mGeometryBuffers.Vertices.GetNativeHandles().Handle;
 	this->UpdateDescriptor({ 1, 0, 0 }, storageInfo);
 
+	storageInfo.Buffer = mGeometryBuffers.Faces.GetNativeHandles().Handle;
+	this->UpdateDescriptor({ 1, 3, 0 }, storageInfo);
+
+	// The ray query kernel only looks up the committed face, the hierarchy lives in the acceleration structure
+	if (mBackend == IntersectionBackend::eRayQuery)
+	{
+		vkLib::AccelerationStructureWriteInfo topLevelInfo{};
+		topLevelInfo.Handle = mTopLevel;
+
+		this->UpdateDescriptor({ 1, 11, 0 }, topLevelInfo);
+		return;
+	}
+
 #if 0
 	storageInfo.Buffer = mGeometryBuffers.Normals.GetNativeHandles().Handle;
 	writer.Update({ 1, 1, 0 }, storageInfo);
@@ -88,11 +127,16 @@ void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::IntersectionPipeline::UpdateGeometryBuff
 
 #endif
 
-	storageInfo.Buffer = mGeometryBuffers.Faces.GetNativeHandles().Handle;
-	this->UpdateDescriptor({ 1, 3, 0 }, storageInfo);
-
-	storageInfo.Buffer = mGeometryBuffers.Nodes.GetNativeHandles().Handle;
-	this->UpdateDescriptor({ 1, 4, 0 }, storageInfo);
+	if (mWideBVH)
+	{
+		storageInfo.Buffer = mGeometryBuffers.WideNodes.GetNativeHandles().Handle;
+		this->UpdateDescriptor({ 1, 5, 0 }, storageInfo);
+	}
+	else
+	{
+		storageInfo.Buffer = mGeometryBuffers.Nodes.GetNativeHandles().Handle;
+		this->UpdateDescriptor({ 1, 4, 0 }, storageInfo);
+	}
 
 	// Meta data about vertices and light sources
 	storageInfo.Buffer = mLightProps.GetNativeHandles().Handle;
@@ -105,6 +149,65 @@ void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::IntersectionPipeline::UpdateGeometryBuff
 	this->UpdateDescriptor({ 1, 8, 0 }, storageInfo);
 }
 
+void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::OcclusionPipeline::UpdateDescriptors()
+{
+	vkLib::StorageBufferWriteInfo storageInfo{};
+
+	storageInfo.Buffer = mPathQueue.GetNativeHandles().Handle;
+	this->UpdateDescriptor({ 0, 5, 0 }, storageInfo);
+
+	storageInfo.Buffer = mShadowRays.GetNativeHandles().Handle;
+	this->UpdateDescriptor({ 0, 7, 0 }, storageInfo);
+
+	storageInfo.Buffer = mOcclusionMask.GetNativeHandles().Handle;
+	this->UpdateDescriptor({ 0, 8, 0 }, storageInfo);
+
+	// Opaque geometry, so the ray query kernel needs nothing but the top level structure
+	if (mBackend == IntersectionBackend::eRayQuery)
+	{
+		vkLib::AccelerationStructureWriteInfo topLevelInfo{};
+		topLevelInfo.Handle = mTopLevel;
+
+		this->UpdateDescriptor({ 1, 11, 0 }, topLevelInfo);
+		return;
+	}
+
+	// Same geometry bindings as the intersection pipeline
+	storageInfo.Buffer = mGeometryBuffers.Vertices.GetNativeHandles().Handle;
+	this->UpdateDescriptor({ 1, 0, 0 }, storageInfo);
+
+	storageInfo.Buffer = mGeometryBuffers.Faces.GetNativeHandles().Handle;
+	this->UpdateDescriptor({ 1, 3, 0 }, storageInfo);
+
+	if (mWideBVH)
+	{
+		storageInfo.Buffer = mGeometryBuffers.WideNodes.GetNativeHandles().Handle;
+		this->UpdateDescriptor({ 1, 5, 0 }, storageInfo);
+	}
+	else
+	{
+		storageInfo.Buffer = mGeometryBuffers.Nodes.GetNativeHandles().Handle;
+		this->UpdateDescriptor({ 1, 4, 0 }, storageInfo);
+	}
+
+	storageInfo.Buffer = mMeshInfos.GetNativeHandles().Handle;
+	this->UpdateDescriptor({ 1, 7, 0 }, storageInfo);
+
+	storageInfo.Buffer = mLightInfos.GetNativeHandles().Handle;
+	this->UpdateDescriptor({ 1, 8, 0 }, storageInfo);
+
+	if (mMotionBlur)
+	{
+		storageInfo.Buffer = mInstanceMotions.GetNativeHandles().Handle;
+		this->UpdateDescriptor({ 1, 12, 0 }, storageInfo);
+	}
+
+	vkLib::UniformBufferWriteInfo sceneInfo{};
+	sceneInfo.Buffer = mSceneInfo.GetNativeHandles().Handle;
+
+	this->UpdateDescriptor({ 1, 9, 0 }, sceneInfo);
+}
+
 void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::RaySortEpiloguePipeline::UpdateDescriptors()
 {
 	if (mSortingEvent == RaySortEvent::eFinish)
@@ -127,6 +230,11 @@ void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::RaySortEpiloguePipeline::UpdateDescripto
 	rayRefs.Buffer = mRayRefs.GetNativeHandles().Handle;
 
 	this->UpdateDescriptor({ 0, 3, 0 }, rayRefs);
+
+	vkLib::StorageBufferWriteInfo pathQueue{};
+	pathQueue.Buffer = mPathQueue.GetNativeHandles().Handle;
+
+	this->UpdateDescriptor({ 0, 5, 0 }, pathQueue);
 }
 
 void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::RayRefCounterPipeline::UpdateDescriptors()
@@ -140,6 +248,11 @@ void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::RayRefCounterPipeline::UpdateDescriptors
 	counts.Buffer = mRefCounts.GetNativeHandles().Handle;
 
 	this->UpdateDescriptor({ 0, 1, 0 }, counts);
+
+	vkLib::StorageBufferWriteInfo pathQueue{};
+	pathQueue.Buffer = mPathQueue.GetNativeHandles().Handle;
+
+	this->UpdateDescriptor({ 0, 2, 0 }, pathQueue);
 }
 
 void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::PrefixSumPipeline::UpdateDescriptors()
@@ -164,14 +277,10 @@ void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::LuminanceMeanPipeline::UpdateDescriptors
 	mean.ImageView = mPixelMean.GetIdentityImageView().GetNativeHandle();
 	this->UpdateDescriptor({ 2, 1, 0 }, mean);
 
-	vkLib::StorageBufferWriteInfo rayInfos{};
-	rayInfos.Buffer = mRays.GetNativeHandles().Handle;
+	vkLib::StorageBufferWriteInfo accumulator{};
+	accumulator.Buffer = mSampleAccumulator.GetNativeHandles().Handle;
 
-	this->UpdateDescriptor({ 0, 0, 0 }, rayInfos);
-
-	rayInfos.Buffer = mRayInfos.GetNativeHandles().Handle;
-
-	this->UpdateDescriptor({ 0, 4, 0 }, rayInfos);
+	this->UpdateDescriptor({ 0, 6, 0 }, accumulator);
 
 	vkLib::UniformBufferWriteInfo sceneInfo{};
 	sceneInfo.Buffer = mSceneInfo.GetNativeHandles().Handle;
@@ -179,6 +288,45 @@ void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::LuminanceMeanPipeline::UpdateDescriptors
 	this->UpdateDescriptor({ 1, 9, 0 }, sceneInfo);
 }
 
+void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::PathRegenerationPipeline::UpdateDescriptors()
+{
+	vkLib::StorageBufferWriteInfo storageInfo{};
+
+	storageInfo.Buffer = mRays.GetNativeHandles().Handle;
+	this->UpdateDescriptor({ 0, 0, 0 }, storageInfo);
+
+	storageInfo.Buffer = mRayInfos.GetNativeHandles().Handle;
+	this->UpdateDescriptor({ 0, 4, 0 }, storageInfo);
+
+	storageInfo.Buffer = mPathQueue.GetNativeHandles().Handle;
+	this->UpdateDescriptor({ 0, 5, 0 }, storageInfo);
+
+	storageInfo.Buffer = mSampleAccumulator.GetNativeHandles().Handle;
+	this->UpdateDescriptor({ 0, 6, 0 }, storageInfo);
+
+	storageInfo.Buffer = mShadowRays.GetNativeHandles().Handle;
+	this->UpdateDescriptor({ 0, 7, 0 }, storageInfo);
+
+	storageInfo.Buffer = mOcclusionMask.GetNativeHandles().Handle;
+	this->UpdateDescriptor({ 0, 8, 0 }, storageInfo);
+
+	vkLib::UniformBufferWriteInfo uniformInfo{};
+
+	uniformInfo.Buffer = mCamera.GetNativeHandles().Handle;
+	this->UpdateDescriptor({ 0, 1, 0 }, uniformInfo);
+
+	uniformInfo.Buffer = mSceneInfo.GetNativeHandles().Handle;
+	this->UpdateDescriptor({ 1, 9, 0 }, uniformInfo);
+}
+
+void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::PathQueuePipeline::UpdateDescriptors()
+{
+	vkLib::StorageBufferWriteInfo pathQueue{};
+	pathQueue.Buffer = mPathQueue.GetNativeHandles().Handle;
+
+	this->UpdateDescriptor({ 0, 5, 0 }, pathQueue);
+}
+
 void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::PostProcessImagePipeline::UpdateDescriptors()
 {
 	vkLib::DescriptorWriter& writer = this->GetDescriptorWriter();
@@ -188,4 +336,12 @@ void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::PostProcessImagePipeline::UpdateDescript
 
 	mean.ImageView = mPresentable.GetIdentityImageView().GetNativeHandle();
 	writer.Update({ 0, 0, 0 }, mean);
+
+	mean.ImageView = mPixelMean.GetIdentityImageView().GetNativeHandle();
+	writer.Update({ 0, 1, 0 }, mean);
+
+	vkLib::StorageBufferWriteInfo exposure{};
+	exposure.Buffer = mExposure.GetNativeHandles().Handle;
+
+	writer.Update({ 0, 2, 0 }, exposure);
 }
@@ -0,0 +1,151 @@
+#include "Core/Aqpch.h"
+#include "Wavefront/WideBVHFactory.h"
+
+std::vector<AQUA_NAMESPACE::PH_FLUX_NAMESPACE::WideNode> 
+	AQUA_NAMESPACE::PH_FLUX_NAMESPACE::WideBVHFactory::Build(const std::vector<Node>& nodes)
+{
+	mWideNodes.clear();
+
+	if (nodes.empty())
+		return {};
+
+	mNodes = &nodes;
+
+	// The root is always stored at zero
+	CollapseRecursive(0);
+
+	mNodes = nullptr;
+
+	return std::move(mWideNodes);
+}
+
+uint32_t AQUA_NAMESPACE::PH_FLUX_NAMESPACE::WideBVHFactory::CollapseRecursive(uint32_t binaryIdx)
+{
+	const Node& parent = (*mNodes)[binaryIdx];
+
+	uint32_t wideIdx = static_cast<uint32_t>(mWideNodes.size());
+	mWideNodes.emplace_back();
+
+	std::vector<uint32_t> children = GatherChildren(binaryIdx);
+
+	WideNode wideNode{};
+	QuantizeChildren(wideNode, parent, children);
+
+	for (size_t i = 0; i < children.size(); i++)
+	{
+		const Node& child = (*mNodes)[children[i]];
+
+		if (IsLeaf(child))
+		{
+			wideNode.ChildIndex[i] = child.BeginIndex;
+			wideNode.ChildFaceCount[i] = child.EndIndex - child.BeginIndex;
+			continue;
+		}
+
+		wideNode.ChildIndex[i] = CollapseRecursive(children[i]);
+		wideNode.ChildFaceCount[i] = 0;
+	}
+
+	// mWideNodes might have been reallocated by the recursion
+	mWideNodes[wideIdx] = wideNode;
+
+	return wideIdx;
+}
+
+std::vector<uint32_t> AQUA_NAMESPACE::PH_FLUX_NAMESPACE::WideBVHFactory::GatherChildren(uint32_t binaryIdx) const
+{
+	const Node& root = (*mNodes)[binaryIdx];
+
+	// A single leaf root still needs a wide node to live in
+	if (IsLeaf(root))
+		return { binaryIdx };
+
+	std::vector<uint32_t> children = { root.FirstChildIndex, root.SecondChildIndex };
+
+	while (children.size() < WIDE_BVH_WIDTH)
+	{
+		int bestIdx = -1;
+		float bestArea = -1.0f;
+
+		for (size_t i = 0; i < children.size(); i++)
+		{
+			const Node& candidate = (*mNodes)[children[i]];
+
+			if (IsLeaf(candidate))
+				continue;
+
+			float area = SurfaceArea(candidate);
+
+			if (area > bestArea)
+			{
+				bestArea = area;
+				bestIdx = static_cast<int>(i);
+			}
+		}
+
+		if (bestIdx < 0)
+			break;
+
+		const Node& opened = (*mNodes)[children[bestIdx]];
+
+		children[bestIdx] = opened.FirstChildIndex;
+		children.push_back(opened.SecondChildIndex);
+	}
+
+	return children;
+}
+
+void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::WideBVHFactory::QuantizeChildren(
+	WideNode& wideNode, const Node& parent, const std::vector<uint32_t>& children) const
+{
+	glm::vec3 parentMin = parent.MinBound;
+	glm::vec3 parentMax = parent.MaxBound;
+
+	// Children are expected inside the parent, but grow it to be safe
+	for (uint32_t childIdx : children)
+	{
+		parentMin = glm::min(parentMin, (*mNodes)[childIdx].MinBound);
+		parentMax = glm::max(parentMax, (*mNodes)[childIdx].MaxBound);
+	}
+
+	wideNode.Origin = parentMin;
+	wideNode.Exponents = 0;
+
+	glm::vec3 scale{};
+
+	for (int axis = 0; axis < 3; axis++)
+	{
+		float extent = glm::max(parentMax[axis] - parentMin[axis], FLT_MIN);
+
+		// Power of two scale so that the shader can rebuild it exactly with exp2
+		int exponent = static_cast<int>(glm::ceil(glm::log2(extent / 255.0f)));
+		exponent = glm::clamp(exponent, -127, 128);
+
+		scale[axis] = glm::exp2(static_cast<float>(exponent));
+		wideNode.Exponents |= static_cast<uint32_t>(exponent + 127) << (8 * axis);
+	}
+
+	for (size_t i = 0; i < children.size(); i++)
+	{
+		const Node& child = (*mNodes)[children[i]];
+
+		// Rounding outwards keeps the quantized box conservative
+		glm::vec3 qMin = glm::floor((child.MinBound - wideNode.Origin) / scale);
+		glm::vec3 qMax = glm::ceil((child.MaxBound - wideNode.Origin) / scale);
+
+		qMin = glm::clamp(qMin, glm::vec3(0.0f), glm::vec3(255.0f));
+		qMax = glm::clamp(qMax, glm::vec3(0.0f), glm::vec3(255.0f));
+
+		wideNode.QuantizedMin[i] = static_cast<uint32_t>(qMin.x) |
+			(static_cast<uint32_t>(qMin.y) << 8) | (static_cast<uint32_t>(qMin.z) << 16);
+
+		wideNode.QuantizedMax[i] = static_cast<uint32_t>(qMax.x) |
+			(static_cast<uint32_t>(qMax.y) << 8) | (static_cast<uint32_t>(qMax.z) << 16);
+	}
+}
+
+float AQUA_NAMESPACE::PH_FLUX_NAMESPACE::WideBVHFactory::SurfaceArea(const Node& node) const
+{
+	glm::vec3 extent = glm::max(node.MaxBound - node.MinBound, glm::vec3(0.0f));
+	return 2.0f * (extent.x * extent.y + extent.y * extent.z + extent.z * extent.x);
+}
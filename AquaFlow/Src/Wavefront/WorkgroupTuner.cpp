@@ -0,0 +1,261 @@
+#include "Core/Aqpch.h"
+#include "Wavefront/WorkgroupTuner.h"
+
+#include <iomanip>
+
+AQUA_NAMESPACE::PH_FLUX_NAMESPACE::WorkgroupTuner::WorkgroupTuner(const WorkgroupTunerCreateInfo& createInfo)
+	: mCreateInfo(createInfo)
+{
+	vkLib::Context context = mCreateInfo.EstimatorInfo.Context;
+
+	mDevice = context.GetHandle();
+	mDeviceProps = context.GetDeviceInfo().PhysicalDevice.Handle.getProperties();
+
+	std::error_code error;
+
+	if (!mCreateInfo.ProfileDirectory.empty())
+		std::filesystem::create_directories(mCreateInfo.ProfileDirectory, error);
+}
+
+bool AQUA_NAMESPACE::PH_FLUX_NAMESPACE::WorkgroupTuner::IsSupported(const vkLib::Context& context)
+{
+	auto limits = context.GetDeviceInfo().PhysicalDevice.Handle.getProperties().limits;
+
+	return limits.timestampComputeAndGraphics && limits.timestampPeriod > 0.0f;
+}
+
+AQUA_NAMESPACE::PH_FLUX_NAMESPACE::WorkgroupProfile AQUA_NAMESPACE::PH_FLUX_NAMESPACE::WorkgroupTuner::LoadOrTune(
+	const WorkgroupTunerSetupFn& setup)
+{
+	auto profile = Load();
+
+	if (profile)
+		return *profile;
+
+	return Tune(setup);
+}
+
+AQUA_NAMESPACE::PH_FLUX_NAMESPACE::WorkgroupProfile AQUA_NAMESPACE::PH_FLUX_NAMESPACE::WorkgroupTuner::Tune(
+	const WorkgroupTunerSetupFn& setup)
+{
+	_STL_ASSERT(IsSupported(mCreateInfo.EstimatorInfo.Context), "The device can't write timestamps on the compute queues!");
+	_STL_ASSERT(mCreateInfo.Depth > 0 && mCreateInfo.TimedTraces > 0, "The tuner needs at least one bounce and one timed trace!");
+
+	const auto& limits = mDeviceProps.limits;
+
+	mTimings.clear();
+
+	for (uint32_t candidate : mCreateInfo.Candidates)
+	{
+		bool powerOfTwo = candidate != 0 && (candidate & (candidate - 1)) == 0;
+
+		if (!powerOfTwo || candidate > limits.maxComputeWorkGroupInvocations ||
+			candidate > limits.maxComputeWorkGroupSize[0])
+			continue;
+
+		mTimings.push_back(Measure(candidate, setup));
+	}
+
+	WorkgroupProfile profile = GetDeviceProfile();
+
+	if (mTimings.empty())
+		return profile;
+
+	// The two passes are separate dispatches, so each one keeps its own winner
+	profile.IntersectionWorkgroupSize = std::min_element(mTimings.begin(), mTimings.end(),
+		[](const WorkgroupTiming& a, const WorkgroupTiming& b) { return a.IntersectionMs < b.IntersectionMs; })->WorkgroupSize;
+
+	profile.MaterialEvalWorkgroupSize = std::min_element(mTimings.begin(), mTimings.end(),
+		[](const WorkgroupTiming& a, const WorkgroupTiming& b) { return a.MaterialEvalMs < b.MaterialEvalMs; })->WorkgroupSize;
+
+	Store(profile);
+
+	return profile;
+}
+
+std::optional<AQUA_NAMESPACE::PH_FLUX_NAMESPACE::WorkgroupProfile> AQUA_NAMESPACE::PH_FLUX_NAMESPACE::WorkgroupTuner::Load() const
+{
+	if (mCreateInfo.ProfileDirectory.empty())
+		return {};
+
+	std::ifstream stream(GetFilepath());
+
+	if (!stream)
+		return {};
+
+	std::string magic;
+	uint32_t version = 0;
+
+	stream >> magic >> version;
+
+	if (!stream || magic != "AQWG" || version != WORKGROUP_PROFILE_VERSION)
+		return {};
+
+	WorkgroupProfile expected = GetDeviceProfile();
+	WorkgroupProfile profile{};
+
+	profile.IntersectionWorkgroupSize = 0;
+	profile.MaterialEvalWorkgroupSize = 0;
+
+	std::string key;
+	uint32_t value = 0;
+
+	while (stream >> key >> value)
+	{
+		if (key == "VendorID")
+			profile.VendorID = value;
+		else if (key == "DeviceID")
+			profile.DeviceID = value;
+		else if (key == "DriverVersion")
+			profile.DriverVersion = value;
+		else if (key == "IntersectionWorkgroupSize")
+			profile.IntersectionWorkgroupSize = value;
+		else if (key == "MaterialEvalWorkgroupSize")
+			profile.MaterialEvalWorkgroupSize = value;
+	}
+
+	// A driver update can move the sweet spot, so the profile has to be measured again
+	if (profile.VendorID != expected.VendorID || profile.DeviceID != expected.DeviceID ||
+		profile.DriverVersion != expected.DriverVersion)
+		return {};
+
+	if (profile.IntersectionWorkgroupSize == 0 || profile.MaterialEvalWorkgroupSize == 0)
+		return {};
+
+	return profile;
+}
+
+bool AQUA_NAMESPACE::PH_FLUX_NAMESPACE::WorkgroupTuner::Store(const WorkgroupProfile& profile) const
+{
+	if (mCreateInfo.ProfileDirectory.empty())
+		return false;
+
+	std::ofstream stream(GetFilepath(), std::ios::trunc);
+
+	if (!stream)
+		return false;
+
+	stream << "AQWG " << WORKGROUP_PROFILE_VERSION << "\n";
+	stream << "VendorID " << profile.VendorID << "\n";
+	stream << "DeviceID " << profile.DeviceID << "\n";
+	stream << "DriverVersion " << profile.DriverVersion << "\n";
+	stream << "IntersectionWorkgroupSize " << profile.IntersectionWorkgroupSize << "\n";
+	stream << "MaterialEvalWorkgroupSize " << profile.MaterialEvalWorkgroupSize << "\n";
+
+	return static_cast<bool>(stream);
+}
+
+AQUA_NAMESPACE::PH_FLUX_NAMESPACE::WorkgroupTiming AQUA_NAMESPACE::PH_FLUX_NAMESPACE::WorkgroupTuner::Measure(
+	uint32_t workgroupSize, const WorkgroupTunerSetupFn& setup)
+{
+	WavefrontEstimatorCreateInfo estimatorInfo = mCreateInfo.EstimatorInfo;
+	estimatorInfo.IntersectionWorkgroupSize = workgroupSize;
+	estimatorInfo.MaterialEvalWorkgroupSize = workgroupSize;
+
+	WavefrontEstimator estimator(estimatorInfo);
+
+	ExecutorCreateInfo executorInfo{};
+	executorInfo.TargetResolution = mCreateInfo.Resolution;
+	executorInfo.TileSize = mCreateInfo.Resolution;
+
+	Executor executor = estimator.CreateExecutor(executorInfo);
+
+	setup(estimator, executor);
+
+	executor.SetDepth(mCreateInfo.Depth);
+	executor.Validate();
+
+	auto workers = executor.mExecutorInfo->Workers;
+
+	auto waitWorkers = [&workers]()
+		{
+			for (size_t i = 0; i < workers.GetQueueCount(); i++)
+				workers[i]->WaitIdle();
+		};
+
+	for (uint32_t i = 0; i < mCreateInfo.WarmupTraces; i++)
+		executor.Trace();
+
+	waitWorkers();
+
+	// One pair per intersection and per material dispatch (the inactive ray shader included) of every bounce
+	uint32_t pairCount = mCreateInfo.Depth *
+		static_cast<uint32_t>(executor.mExecutorInfo->MaterialResources.size() + 2);
+
+	vk::QueryPoolCreateInfo poolInfo{};
+	poolInfo.setQueryType(vk::QueryType::eTimestamp);
+	poolInfo.setQueryCount(2 * pairCount);
+
+	vk::QueryPool pool = mDevice->createQueryPool(poolInfo);
+
+	executor.mTimestamps.Pool = pool;
+	executor.mTimestamps.Capacity = pairCount;
+
+	// Nanoseconds per tick
+	double period = static_cast<double>(mDeviceProps.limits.timestampPeriod);
+
+	WorkgroupTiming timing{};
+	timing.WorkgroupSize = workgroupSize;
+
+	for (uint32_t i = 0; i < mCreateInfo.TimedTraces; i++)
+	{
+		executor.Trace();
+		waitWorkers();
+
+		const auto& passes = executor.mTimestamps.Passes;
+
+		if (passes.empty())
+			continue;
+
+		uint32_t queryCount = 2 * static_cast<uint32_t>(passes.size());
+
+		auto results = mDevice->getQueryPoolResults<uint64_t>(pool, 0, queryCount, queryCount * sizeof(uint64_t),
+			sizeof(uint64_t), vk::QueryResultFlagBits::e64 | vk::QueryResultFlagBits::eWait);
+
+		if (results.result != vk::Result::eSuccess)
+			continue;
+
+		for (size_t pairIdx = 0; pairIdx < passes.size(); pairIdx++)
+		{
+			uint64_t begin = results.value[2 * pairIdx];
+			uint64_t end = results.value[2 * pairIdx + 1];
+
+			double elapsed = end > begin ? static_cast<double>(end - begin) * period * 1e-6 : 0.0;
+
+			if (passes[pairIdx] == WavefrontPass::eIntersection)
+				timing.IntersectionMs += elapsed;
+			else
+				timing.MaterialEvalMs += elapsed;
+		}
+	}
+
+	executor.mTimestamps = PassTimestamps();
+	mDevice->destroyQueryPool(pool);
+
+	timing.IntersectionMs /= mCreateInfo.TimedTraces;
+	timing.MaterialEvalMs /= mCreateInfo.TimedTraces;
+
+	return timing;
+}
+
+AQUA_NAMESPACE::PH_FLUX_NAMESPACE::WorkgroupProfile AQUA_NAMESPACE::PH_FLUX_NAMESPACE::WorkgroupTuner::GetDeviceProfile() const
+{
+	WorkgroupProfile profile{};
+	profile.VendorID = mDeviceProps.vendorID;
+	profile.DeviceID = mDeviceProps.deviceID;
+	profile.DriverVersion = mDeviceProps.driverVersion;
+
+	profile.IntersectionWorkgroupSize = mCreateInfo.EstimatorInfo.IntersectionWorkgroupSize;
+	profile.MaterialEvalWorkgroupSize = mCreateInfo.EstimatorInfo.MaterialEvalWorkgroupSize;
+
+	return profile;
+}
+
+std::filesystem::path AQUA_NAMESPACE::PH_FLUX_NAMESPACE::WorkgroupTuner::GetFilepath() const
+{
+	std::stringstream name;
+	name << std::hex << std::setfill('0') << std::setw(4) << mDeviceProps.vendorID << "_"
+		<< std::setw(4) << mDeviceProps.deviceID << ".wgprofile";
+
+	return mCreateInfo.ProfileDirectory / name.str();
+}
@@ -119,6 +119,48 @@ void Application::SetupContext(const ApplicationCreateInfo& info)
 	deviceInfo.SwapchainInfo.PresentMode = vk::PresentModeKHR::eMailbox;
 	deviceInfo.SwapchainInfo.Surface = mSurface;
 
+	// Opt into the ray query intersection backend when the device has it, the estimator falls back to compute otherwise
+	vk::PhysicalDeviceBufferDeviceAddressFeatures addressFeatures{};
+	vk::PhysicalDeviceAccelerationStructureFeaturesKHR accelerationFeatures{};
+	vk::PhysicalDeviceRayQueryFeaturesKHR rayQueryFeatures{};
+
+	auto supportedExtensions = deviceInfo.PhysicalDevice.Handle.enumerateDeviceExtensionProperties();
+
+	auto IsExtensionSupported = [&supportedExtensions](const char* name)
+	{
+		return std::find_if(supportedExtensions.begin(), supportedExtensions.end(),
+			[name](const vk::ExtensionProperties& props)
+		{ return std::string_view(props.extensionName.data()) == name; }) != supportedExtensions.end();
+	};
+
+	if (deviceInfo.PhysicalDevice.Props.apiVersion >= VK_API_VERSION_1_2 &&
+		IsExtensionSupported(VK_KHR_ACCELERATION_STRUCTURE_EXTENSION_NAME) &&
+		IsExtensionSupported(VK_KHR_RAY_QUERY_EXTENSION_NAME) &&
+		IsExtensionSupported(VK_KHR_DEFERRED_HOST_OPERATIONS_EXTENSION_NAME))
+	{
+		auto features = deviceInfo.PhysicalDevice.Handle.getFeatures2<vk::PhysicalDeviceFeatures2,
+			vk::PhysicalDeviceBufferDeviceAddressFeatures, vk::PhysicalDeviceAccelerationStructureFeaturesKHR,
+			vk::PhysicalDeviceRayQueryFeaturesKHR>();
+
+		if (features.get<vk::PhysicalDeviceBufferDeviceAddressFeatures>().bufferDeviceAddress &&
+			features.get<vk::PhysicalDeviceAccelerationStructureFeaturesKHR>().accelerationStructure &&
+			features.get<vk::PhysicalDeviceRayQueryFeaturesKHR>().rayQuery)
+		{
+			addressFeatures.bufferDeviceAddress = VK_TRUE;
+			accelerationFeatures.accelerationStructure = VK_TRUE;
+			rayQueryFeatures.rayQuery = VK_TRUE;
+
+			addressFeatures.pNext = &accelerationFeatures;
+			accelerationFeatures.pNext = &rayQueryFeatures;
+
+			deviceInfo.Extensions.push_back(VK_KHR_ACCELERATION_STRUCTURE_EXTENSION_NAME);
+			deviceInfo.Extensions.push_back(VK_KHR_RAY_QUERY_EXTENSION_NAME);
+			deviceInfo.Extensions.push_back(VK_KHR_DEFERRED_HOST_OPERATIONS_EXTENSION_NAME);
+
+			deviceInfo.FeatureChain = &addressFeatures;
+		}
+	}
+
 	try
 	{
 		mContext = std::make_shared<vkLib::Context>(deviceInfo);
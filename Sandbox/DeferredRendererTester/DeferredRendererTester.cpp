@@ -227,7 +227,7 @@ void DeferredRendererTester::PrepareRenderer()
 	AquaFlow::ShadowCascadeFeature shadowFeature{};
 	shadowFeature.BaseResolution = { 2048, 2048 };
 	shadowFeature.CascadeDepth = 500.0f;
-	shadowFeature.CascadeDivisions = 10;
+	shadowFeature.CascadeDivisions = 4;
 
 	mEnv = std::make_shared<AquaFlow::Environment>();
 
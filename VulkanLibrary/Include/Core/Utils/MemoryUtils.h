@@ -138,7 +138,7 @@ uint32_t FindMemoryTypeIndex(vk::PhysicalDevice device,
 	uint32_t memTypeBits, vk::MemoryPropertyFlags memProps);
 
 vk::DeviceMemory AllocateMemory(const vk::MemoryRequirements& memReq, vk::MemoryPropertyFlags props, 
-	vk::Device logicalDevice, vk::PhysicalDevice physicalDevice);
+	vk::Device logicalDevice, vk::PhysicalDevice physicalDevice, vk::MemoryAllocateFlags allocFlags = {});
 
 // Buffer functionality
 
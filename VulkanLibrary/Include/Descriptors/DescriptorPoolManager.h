@@ -13,6 +13,11 @@ public:
 	Core::DescriptorSetAllocator FetchAllocator(
 		vk::DescriptorPoolCreateFlags createFlags, size_t batchSize = 100) const;
 
+	// Same as above, with room for the acceleration structures as well
+	// Kept apart since the type is only valid once VK_KHR_acceleration_structure is enabled
+	Core::DescriptorSetAllocator FetchAccelerationStructureAllocator(
+		vk::DescriptorPoolCreateFlags createFlags, size_t batchSize = 100) const;
+
 	Core::DescriptorSetAllocator FetchAllocator(
 		vk::DescriptorPoolCreateFlags createFlags, 
 		const std::unordered_set<vk::DescriptorType> Types,
@@ -21,6 +26,9 @@ public:
 private:
 	Core::DescriptorPoolBuilder mPoolBuilder;
 
+private:
+	static std::unordered_set<vk::DescriptorType> GetDefaultTypes();
+
 	friend class Context;
 };
 
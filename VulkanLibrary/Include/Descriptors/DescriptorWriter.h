@@ -71,6 +71,10 @@ public:
 		const DescriptorLocation& info,
 		const DynamicUniformBufferWriteInfo& bufferInfo) const;
 
+	void Update(
+		const DescriptorLocation& info,
+		const AccelerationStructureWriteInfo& accelerationInfo) const;
+
 private:
 	Core::Ref<vk::Device> mDevice; // Vulkan device handle
 	std::vector<vk::DescriptorSet> mDescriptorSets; // Descriptor sets to update
@@ -132,4 +132,9 @@ struct DynamicUniformBufferWriteInfo {
 	vk::DeviceSize Range;
 };
 
+// Struct for acceleration structure information (VK_KHR_acceleration_structure)
+struct AccelerationStructureWriteInfo {
+	vk::AccelerationStructureKHR Handle;
+};
+
 VK_END
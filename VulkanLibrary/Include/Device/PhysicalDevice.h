@@ -43,6 +43,10 @@ struct ContextCreateInfo
 	PhysicalDevice PhysicalDevice;
 	vk::PhysicalDeviceFeatures RequiredFeatures;
 
+	// Extension feature structs (e.g vk::PhysicalDeviceRayQueryFeaturesKHR) chained onto the device create info
+	// Must stay alive until the context is created
+	void* FeatureChain = nullptr;
+
 	vk::QueueFlags DeviceCapabilities;
 	uint32_t MaxQueueCount = 4;
 
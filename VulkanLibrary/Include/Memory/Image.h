@@ -17,6 +17,11 @@ public:
 	template <typename T>
 	void CopyBufferData(const Buffer<T>& buffer);
 
+	// Reads back every texel of the base level, the buffer is resized to fit
+	// The buffer needs the eTransferDst usage and the image must be in eGeneral or eTransferSrcOptimal
+	template <typename T>
+	void FetchImageData(Buffer<T>& buffer) const;
+
 	void Blit(const Image& src, ImageBlitInfo blitInfo);
 
 	void TransitionLayout(vk::ImageLayout newLayout, 
@@ -27,6 +32,10 @@ public:
 	virtual void BeginCommands(vk::CommandBuffer commandBuffer) const override;
 
 	void RecordBlit(const Image& src, ImageBlitInfo blitInfo, bool restoreOriginalLayout = true) const;
+	// Copies the whole source at the offset, the formats must be compatible
+	void RecordCopy(const Image& src, const glm::uvec2& dstOffset = { 0, 0 }, bool restoreOriginalLayout = true) const;
+	// The image needs the eTransferDst usage
+	void RecordClearDepthStencil(const vk::ClearDepthStencilValue& value, bool restoreOriginalLayout = true) const;
 	void RecordTransitionLayout(vk::ImageLayout newLayout, 
 		vk::PipelineStageFlags usageStage = vk::PipelineStageFlagBits::eTopOfPipe) const;
 
@@ -83,6 +92,9 @@ private:
 	void CopyFromBuffer(Core::Image& DstImage, const Core::Buffer& SrcBuffer,
 		const vk::ArrayProxy<vk::BufferImageCopy>& CopyRegions) const;
 
+	void CopyToBuffer(const Core::Buffer& DstBuffer, const Core::Image& SrcImage,
+		const vk::ArrayProxy<vk::BufferImageCopy>& CopyRegions) const;
+
 	void ReleaseImage(uint32_t dstQueueFamily) const;
 	void AcquireImage(uint32_t dstQueueFamily) const;
 
@@ -107,6 +119,24 @@ void VK_NAMESPACE::Image::CopyBufferData(const Buffer<T>& buffer)
 	CopyFromBuffer(mChunk->ImageHandles, buffer.GetNativeHandles(), CopyRegion);
 }
 
+template <typename T>
+void VK_NAMESPACE::Image::FetchImageData(Buffer<T>& buffer) const
+{
+	vk::Extent3D Extent = mChunk->ImageHandles.Config.Extent;
+	buffer.Resize(Extent.width * Extent.height * Extent.depth);
+
+	vk::BufferImageCopy CopyRegion{};
+	CopyRegion.setBufferOffset(0);
+	CopyRegion.setBufferImageHeight(0);
+	CopyRegion.setBufferRowLength(0);
+
+	CopyRegion.setImageOffset({ 0, 0, 0 });
+	CopyRegion.setImageExtent(Extent);
+	CopyRegion.setImageSubresource(GetSubresourceLayers().front());
+
+	CopyToBuffer(buffer.GetNativeHandles(), mChunk->ImageHandles, CopyRegion);
+}
+
 void RecordBlitImages(vk::CommandBuffer commandBuffer, Image& Dst,
 	vk::ImageLayout dstLayout, const Image& Src, 
 	vk::ImageLayout srcLayout, ImageBlitInfo blitInfo);
@@ -33,6 +33,9 @@ public:
 	// Async Dispatch...
 	void Dispatch(const glm::uvec3& workGroups) const;
 
+	// Workgroup counts are read from a VkDispatchIndirectCommand in the buffer at the given byte offset
+	void DispatchIndirect(vk::Buffer argBuffer, vk::DeviceSize offset = 0) const;
+
 	virtual void End() const;
 
 	virtual vk::PipelineBindPoint GetPipelineBindPoint() const { return vk::PipelineBindPoint::eCompute; }
@@ -106,6 +109,18 @@ inline void BasicComputePipeline<BasePipeline>::Dispatch(const glm::uvec3& WorkG
 	commandBuffer.dispatch(WorkGroups.x, WorkGroups.y, WorkGroups.z);
 }
 
+template<typename BasePipeline>
+inline void BasicComputePipeline<BasePipeline>::DispatchIndirect(vk::Buffer argBuffer, vk::DeviceSize offset) const
+{
+	vk::CommandBuffer commandBuffer = ((BasePipeline*) this)->GetCommandBuffer();
+
+	if (!mHandles->SetCache.empty())
+		commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eCompute,
+			mHandles->LayoutData.Layout, 0, mHandles->SetCache, nullptr);
+
+	commandBuffer.dispatchIndirect(argBuffer, offset);
+}
+
 template<typename BasePipeline>
 inline void BasicComputePipeline<BasePipeline>::End() const
 {
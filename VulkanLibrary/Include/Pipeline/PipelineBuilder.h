@@ -319,13 +319,22 @@ vk::PipelineDynamicStateCreateInfo PipelineBuilder::GetGraphicsDynamicState(cons
 
 PipelineLayoutData PipelineBuilder::CreatePipelineLayout(const PShader& shader) const
 {
-	Core::DescriptorSetAllocator DescAllocator = mDescPoolManager.FetchAllocator({});
 	std::vector<Core::Ref<DescriptorResource>> resources;
 
 	std::vector<vk::DescriptorSetLayout> setLayouts;
 
 	auto [setLayoutInfos, pushConstantInfos] = shader.GetPipelineLayoutInfo();
 
+	// Only the shaders tracing acceleration structures pull them into their pools
+	bool accelerationStructures = false;
+
+	for (const auto& setInfo : setLayoutInfos)
+		for (const auto& binding : setInfo.second)
+			accelerationStructures |= binding.descriptorType == vk::DescriptorType::eAccelerationStructureKHR;
+
+	Core::DescriptorSetAllocator DescAllocator = accelerationStructures ?
+		mDescPoolManager.FetchAccelerationStructureAllocator({}) : mDescPoolManager.FetchAllocator({});
+
 	setLayouts.resize(setLayoutInfos.size());
 	resources.resize(setLayoutInfos.size());
 
@@ -45,6 +45,7 @@ vk::Device VK_NAMESPACE::VK_CORE::VK_UTILS::CreateDevice(const ContextCreateInfo
 	vk::DeviceCreateInfo RawCreateInfo{};
 
 	RawCreateInfo.pEnabledFeatures = &createInfo.RequiredFeatures;
+	RawCreateInfo.pNext = createInfo.FeatureChain;
 
 	RawCreateInfo.pQueueCreateInfos = infos.data();
 	RawCreateInfo.queueCreateInfoCount = static_cast<uint32_t>(infos.size());
@@ -147,8 +147,14 @@ VK_NAMESPACE::VK_CORE::Buffer VK_NAMESPACE::VK_CORE::VK_UTILS::CreateBuffer(Buff
 
 	bufferInput.ElemCount = memReq.size / bufferInput.TypeSize;
 
+	// Buffers whose address is queried (acceleration structure inputs etc) need it in their memory too
+	vk::MemoryAllocateFlags allocFlags{};
+
+	if (bufferInput.Usage & vk::BufferUsageFlagBits::eShaderDeviceAddress)
+		allocFlags |= vk::MemoryAllocateFlagBits::eDeviceAddress;
+
 	auto Memory = AllocateMemory(memReq, bufferInput.MemProps, 
-		bufferInput.LogicalDevice, bufferInput.PhysicalDevice);
+		bufferInput.LogicalDevice, bufferInput.PhysicalDevice, allocFlags);
 
 	bufferInput.LogicalDevice.bindBufferMemory(Handle, Memory, 0);
 
@@ -157,13 +163,19 @@ VK_NAMESPACE::VK_CORE::Buffer VK_NAMESPACE::VK_CORE::VK_UTILS::CreateBuffer(Buff
 
 vk::DeviceMemory VK_NAMESPACE::VK_CORE::VK_UTILS::AllocateMemory(
 	const vk::MemoryRequirements& memReq, vk::MemoryPropertyFlags props,
-	vk::Device logicalDevice, vk::PhysicalDevice physicalDevice)
+	vk::Device logicalDevice, vk::PhysicalDevice physicalDevice, vk::MemoryAllocateFlags allocFlags)
 {
 	vk::MemoryAllocateInfo allocInfo{};
 	allocInfo.setAllocationSize(memReq.size);
 	allocInfo.setMemoryTypeIndex(FindMemoryTypeIndex(physicalDevice,
 		memReq.memoryTypeBits, props));
 
+	vk::MemoryAllocateFlagsInfo flagsInfo{};
+	flagsInfo.setFlags(allocFlags);
+
+	if (allocFlags)
+		allocInfo.setPNext(&flagsInfo);
+
 	return logicalDevice.allocateMemory(allocInfo);
 }
 
@@ -5,16 +5,14 @@
 VK_NAMESPACE::VK_CORE::DescriptorSetAllocator VK_NAMESPACE::DescriptorPoolManager::
 	FetchAllocator(vk::DescriptorPoolCreateFlags createFlags, size_t batchSize /*= 100*/) const
 {
-	// TODO: Include all necessary types...
-
-	std::unordered_set<vk::DescriptorType> descTypes;
+	return FetchAllocator(createFlags, GetDefaultTypes(), batchSize);
+}
 
-	descTypes.insert(vk::DescriptorType::eUniformBuffer);
-	descTypes.insert(vk::DescriptorType::eStorageBuffer);
-	descTypes.insert(vk::DescriptorType::eCombinedImageSampler);
-	descTypes.insert(vk::DescriptorType::eStorageImage);
-	descTypes.insert(vk::DescriptorType::eSampledImage);
-	descTypes.insert(vk::DescriptorType::eSampler);
+VK_NAMESPACE::VK_CORE::DescriptorSetAllocator VK_NAMESPACE::DescriptorPoolManager::
+	FetchAccelerationStructureAllocator(vk::DescriptorPoolCreateFlags createFlags, size_t batchSize /*= 100*/) const
+{
+	std::unordered_set<vk::DescriptorType> descTypes = GetDefaultTypes();
+	descTypes.insert(vk::DescriptorType::eAccelerationStructureKHR);
 
 	return FetchAllocator(createFlags, descTypes, batchSize);
 }
@@ -37,3 +35,19 @@ VK_NAMESPACE::VK_CORE::DescriptorSetAllocator VK_NAMESPACE::DescriptorPoolManage
 
 	return { allocatorInfoRef, mPoolBuilder };
 }
+
+std::unordered_set<vk::DescriptorType> VK_NAMESPACE::DescriptorPoolManager::GetDefaultTypes()
+{
+	// TODO: Include all necessary types...
+
+	std::unordered_set<vk::DescriptorType> descTypes;
+
+	descTypes.insert(vk::DescriptorType::eUniformBuffer);
+	descTypes.insert(vk::DescriptorType::eStorageBuffer);
+	descTypes.insert(vk::DescriptorType::eCombinedImageSampler);
+	descTypes.insert(vk::DescriptorType::eStorageImage);
+	descTypes.insert(vk::DescriptorType::eSampledImage);
+	descTypes.insert(vk::DescriptorType::eSampler);
+
+	return descTypes;
+}
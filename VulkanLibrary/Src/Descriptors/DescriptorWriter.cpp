@@ -225,6 +225,26 @@ void DescriptorWriter::Update(
 	mDevice->updateDescriptorSets(1, &writeDescriptorSet, 0, nullptr);
 }
 
+void DescriptorWriter::Update(
+	const DescriptorLocation& info,
+	const AccelerationStructureWriteInfo& accelerationInfo) const
+{
+	// The handle doesn't fit any of the buffer/image infos, it travels in the pNext chain
+	vk::WriteDescriptorSetAccelerationStructureKHR accelerationDescriptor;
+	accelerationDescriptor.accelerationStructureCount = 1;
+	accelerationDescriptor.pAccelerationStructures = &accelerationInfo.Handle;
+
+	vk::WriteDescriptorSet writeDescriptorSet;
+	writeDescriptorSet.dstSet = mDescriptorSets[info.SetIndex];
+	writeDescriptorSet.dstBinding = info.Binding;
+	writeDescriptorSet.dstArrayElement = info.ArrayIndex;
+	writeDescriptorSet.descriptorType = vk::DescriptorType::eAccelerationStructureKHR;
+	writeDescriptorSet.descriptorCount = 1;
+	writeDescriptorSet.pNext = &accelerationDescriptor;
+
+	mDevice->updateDescriptorSets(1, &writeDescriptorSet, 0, nullptr);
+}
+
 bool operator==(const DescriptorLocation& left, const DescriptorLocation& right)
 {
 	return left.SetIndex == right.SetIndex && 
@@ -118,6 +118,55 @@ void VK_NAMESPACE::Image::RecordBlit(const Image& src, ImageBlitInfo blitInfo, b
 		mWorkingCommandBuffer, OwnerCaps);
 }
 
+void VK_NAMESPACE::Image::RecordCopy(const Image& src, const glm::uvec2& dstOffset /*= { 0, 0 }*/, bool restoreOriginalLayout /*= true*/) const
+{
+	auto DstLayout = mChunk->ImageHandles.RecordedLayout;
+	auto SrcLayout = src.mChunk->ImageHandles.RecordedLayout;
+
+	auto OwnerCaps = mQueueManager->GetFamilyCapabilities(
+		mChunk->ImageHandles.Config.ResourceOwner);
+
+	glm::uvec2 srcSize = src.GetSize();
+
+	_STL_ASSERT(dstOffset.x + srcSize.x <= GetSize().x && dstOffset.y + srcSize.y <= GetSize().y,
+		"The copied region doesn't fit in the destination image");
+
+	RecordTransitionLayout(vk::ImageLayout::eTransferDstOptimal, vk::PipelineStageFlagBits::eTransfer);
+	src.RecordTransitionLayoutInternal(
+		vk::ImageLayout::eTransferSrcOptimal, vk::PipelineStageFlagBits::eTransfer,
+		SrcLayout.Layout, SrcLayout.Stages, mWorkingCommandBuffer, OwnerCaps);
+
+	vk::ImageCopy copyRegion{};
+	copyRegion.srcSubresource = src.GetSubresourceLayers().front();
+	copyRegion.dstSubresource = GetSubresourceLayers().front();
+	copyRegion.srcOffset = vk::Offset3D(0, 0, 0);
+	copyRegion.dstOffset = vk::Offset3D(dstOffset.x, dstOffset.y, 0);
+	copyRegion.extent = vk::Extent3D(srcSize.x, srcSize.y, 1);
+
+	mWorkingCommandBuffer.copyImage(src.mChunk->ImageHandles.Handle, vk::ImageLayout::eTransferSrcOptimal,
+		mChunk->ImageHandles.Handle, vk::ImageLayout::eTransferDstOptimal, copyRegion);
+
+	if (restoreOriginalLayout)
+		RecordTransitionLayout(DstLayout.Layout, DstLayout.Stages);
+
+	src.RecordTransitionLayoutInternal(SrcLayout.Layout, SrcLayout.Stages,
+		vk::ImageLayout::eTransferSrcOptimal, vk::PipelineStageFlagBits::eTransfer,
+		mWorkingCommandBuffer, OwnerCaps);
+}
+
+void VK_NAMESPACE::Image::RecordClearDepthStencil(const vk::ClearDepthStencilValue& value, bool restoreOriginalLayout /*= true*/) const
+{
+	auto DstLayout = mChunk->ImageHandles.RecordedLayout;
+
+	RecordTransitionLayout(vk::ImageLayout::eTransferDstOptimal, vk::PipelineStageFlagBits::eTransfer);
+
+	mWorkingCommandBuffer.clearDepthStencilImage(mChunk->ImageHandles.Handle,
+		vk::ImageLayout::eTransferDstOptimal, value, GetSubresourceRanges());
+
+	if (restoreOriginalLayout)
+		RecordTransitionLayout(DstLayout.Layout, DstLayout.Stages);
+}
+
 void VK_NAMESPACE::Image::RecordTransitionLayout(vk::ImageLayout newLayout, 
 	vk::PipelineStageFlags usageStage) const
 {
@@ -275,6 +324,18 @@ void VK_NAMESPACE::Image::CopyFromBuffer(Core::Image& DstImage,
 	});
 }
 
+void VK_NAMESPACE::Image::CopyToBuffer(const Core::Buffer& DstBuffer,
+	const Core::Image& SrcImage, const vk::ArrayProxy<vk::BufferImageCopy>& CopyRegions) const
+{
+	uint32_t Owner = mChunk->ImageHandles.Config.ResourceOwner;
+
+	InvokeOneTimeProcess(Owner, [&DstBuffer, &SrcImage, &CopyRegions](vk::CommandBuffer CmdBuffer)
+	{
+		CmdBuffer.copyImageToBuffer(SrcImage.Handle, SrcImage.Config.CurrLayout,
+			DstBuffer.Handle, CopyRegions);
+	});
+}
+
 void VK_NAMESPACE::Image::ReleaseImage(uint32_t dstQueueFamily) const
 {
 	uint32_t Owner = mChunk->ImageHandles.Config.ResourceOwner;
@@ -108,7 +108,7 @@ bool VK_NAMESPACE::VK_CORE::Queue::SubmitRange(
 	mProcessFinished = semaphore;
 
 	mDevice.resetFences(mFence);
-	mHandle.submit(submitInfos);
+	mHandle.submit(submitInfos, mFence);
 
 	return true;
 }
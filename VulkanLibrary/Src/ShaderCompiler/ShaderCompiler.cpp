@@ -547,6 +547,7 @@ void VK_NAMESPACE::ShaderCompiler::ReflectDescriptorLayouts(CompileResult& Resul
 	FillDescriptor(ShaderResources.separate_samplers, vk::DescriptorType::eSampler);
 	FillDescriptor(ShaderResources.separate_images, vk::DescriptorType::eSampledImage);
 	FillDescriptor(ShaderResources.storage_images, vk::DescriptorType::eStorageImage);
+	FillDescriptor(ShaderResources.acceleration_structures, vk::DescriptorType::eAccelerationStructureKHR);
 
 	// Store the push constants
 	FillPushConstants();